@@ -1,3 +1,4 @@
+#include <csignal>
 #include <iostream>
 
 #include "G4RunManager.hh"
@@ -13,6 +14,8 @@
 #include "ActionInitialization.hh"
 #include "CrashHandler.hh"
 #include "SimulationLogger.hh"
+#include "EventStream.hh"
+#include "Constants.hh"
 
 void PrintUsage() {
     G4cout << "\nUsage: ./epicChargeSharing [options] [macro_file]\n" << G4endl;
@@ -31,6 +34,13 @@ void PrintUsage() {
 
 int main(int argc, char** argv)
 {
+    // Event stream: take stdout before anything is printed (Geant4 banner included) and let a
+    // vanished consumer surface as EPIPE instead of SIGPIPE terminating the run
+    if (Constants::ENABLE_EVENT_STREAM) {
+        ReserveStdoutForEventStream();
+        std::signal(SIGPIPE, SIG_IGN);
+    }
+    
     // Default settings
     G4bool isBatch = false;
     G4bool forceSingleThreaded = false;
@@ -140,6 +140,7 @@ struct DiagonalFitResultsCeres {
 // Fits central row and column separately with Gaussian functions
 // Function form: y(x) = A * exp(-(x - m)^2 / (2 * sigma^2)) + B
 // Uses most robust Ceres settings regardless of computation time
+// If warm_start points to a successful previous fit, its row/column parameters seed the initial guesses
 GaussianFit2DResultsCeres Fit2DGaussianCeres(
     const std::vector<double>& x_coords,
     const std::vector<double>& y_coords, 
@@ -148,7 +149,8 @@ GaussianFit2DResultsCeres Fit2DGaussianCeres(
     double center_y_estimate,
     double pixel_spacing,
     bool verbose = false,
-    bool enable_outlier_filtering = false
+    bool enable_outlier_filtering = false,
+    const GaussianFit2DResultsCeres* warm_start = nullptr
 );
 
 // Function to perform diagonal Gaussian fitting using Ceres Solver with robust optimization
@@ -34,6 +34,11 @@ struct GaussianFit3DResultsCeres {
     double pp = 0.0; // p-value
     bool fit_successful = false;
     
+    // Coarse-to-fine bookkeeping (stage is a CoarseToFineStage value)
+    int fit_stage = 0;
+    double fit_time_ms = 0.0;         // Time of the fit that produced these results
+    double reference_time_ms = -1.0;  // Plain full-grid fit time on sampled events, -1 otherwise
+    
     // Constructor
     GaussianFit3DResultsCeres() = default;
 };
@@ -41,6 +41,11 @@ struct LorentzianFit3DResultsCeres {
     // Overall success status
     G4bool fit_successful;
     
+    // Coarse-to-fine bookkeeping (stage is a CoarseToFineStage value)
+    G4int fit_stage;
+    G4double fit_time_ms;        // Time of the fit that produced these results
+    G4double reference_time_ms;  // Plain full-grid fit time on sampled events, -1 otherwise
+    
     // Constructor with default values
     LorentzianFit3DResultsCeres() : 
         center_x(0), center_y(0), gamma_x(0), gamma_y(0), amplitude(0), vertical_offset(0),
@@ -48,7 +53,8 @@ struct LorentzianFit3DResultsCeres {
         amplitude_err(0), vertical_offset_err(0),
         chi2red(0), pp(0), dof(0),
         charge_uncertainty(0),
-        fit_successful(false) {}
+        fit_successful(false),
+        fit_stage(0), fit_time_ms(0), reference_time_ms(-1) {}
 };
 
 // Function to perform 3D Lorentzian fitting using Ceres Solver with robust optimization
@@ -43,6 +43,11 @@ struct PowerLorentzianFit3DResultsCeres {
     // Overall success status
     G4bool fit_successful;
     
+    // Coarse-to-fine bookkeeping (stage is a CoarseToFineStage value)
+    G4int fit_stage;
+    G4double fit_time_ms;        // Time of the fit that produced these results
+    G4double reference_time_ms;  // Plain full-grid fit time on sampled events, -1 otherwise
+    
     // Constructor with default values
     PowerLorentzianFit3DResultsCeres() : 
         center_x(0), center_y(0), gamma_x(1), gamma_y(1), beta(1), amplitude(0), vertical_offset(0),
@@ -50,7 +55,8 @@ struct PowerLorentzianFit3DResultsCeres {
         amplitude_err(0), vertical_offset_err(0),
         chi2red(0), pp(0), dof(0),
         charge_uncertainty(0),
-        fit_successful(false) {}
+        fit_successful(false),
+        fit_stage(0), fit_time_ms(0), reference_time_ms(-1) {}
 };
 
 // Function to perform 3D Power-Law Lorentzian fitting using Ceres Solver with robust optimization
@@ -0,0 +1,73 @@
+#ifndef THREEDSYMMETRICFITCERES_HH
+#define THREEDSYMMETRICFITCERES_HH
+
+#include <vector>
+
+// Symmetry-constrained 3D surface models: one width instead of independent x/y widths,
+// or the charge sharing weight itself as a function of distance from the hit
+// With r^2 = (x - mx)^2 + (y - my)^2:
+//   ISOTROPIC_GAUSSIAN:          z = A * exp(-r^2 / (2 * w^2)) + B                  [A, mx, my, w, B]
+//   ISOTROPIC_LORENTZIAN:        z = A / (1 + r^2 / w^2) + B                         [A, mx, my, w, B]
+//   ISOTROPIC_POWER_LORENTZIAN:  z = A / (1 + r^2 / w^2)^β + B                       [A, mx, my, w, β, B]
+//   RADIAL_CHARGE_SHARING:       z = A * α(r) / ln(r / d0) + B                       [A, mx, my, B]
+//     α(r) = atan[(l/2 * √2) / (l/2 * √2 + r)], r clamped to max(l/2, 2 * d0)
+enum class Symmetric3DModel {
+    ISOTROPIC_GAUSSIAN = 0,
+    ISOTROPIC_LORENTZIAN = 1,
+    ISOTROPIC_POWER_LORENTZIAN = 2,
+    RADIAL_CHARGE_SHARING = 3
+};
+
+const int kNumSymmetric3DModels = 4;
+
+// Results structure for symmetry-constrained 3D fits using Ceres
+struct SymmetricFit3DResultsCeres {
+    // Fit parameters (width and beta are unused by the models that lack them)
+    double amplitude = 0.0;
+    double center_x = 0.0;
+    double center_y = 0.0;
+    double width = 0.0;
+    double beta = 0.0;
+    double vertical_offset = 0.0;
+    
+    // Parameter uncertainties from the solver covariance
+    double center_x_err = 0.0;
+    double center_y_err = 0.0;
+    double width_err = 0.0;
+    
+    // Fit quality
+    double charge_uncertainty = 0.0;
+    double chi2red = 0.0;
+    int dof = 0;
+    double pp = 0.0;
+    int num_parameters = 0;
+    bool fit_successful = false;
+    
+    SymmetricFit3DResultsCeres() = default;
+};
+
+// Number of free parameters of a symmetric model
+int GetSymmetric3DParameterCount(Symmetric3DModel model);
+
+// Whether the model's enable flag in Constants is set
+bool IsSymmetric3DModelEnabled(Symmetric3DModel model);
+
+// Short model label used for ROOT branch prefixes and log summaries (e.g. "3DGaussianIso")
+const char* GetSymmetric3DModelLabel(Symmetric3DModel model);
+
+// Fit one symmetric model to the neighborhood surface; pixel_size and d0 (same length unit as
+// the coordinates) are only used by the radial charge sharing model
+SymmetricFit3DResultsCeres Fit3DSymmetricCeres(
+    Symmetric3DModel model,
+    const std::vector<double>& x_coords,
+    const std::vector<double>& y_coords,
+    const std::vector<double>& charge_values,
+    double center_x_estimate,
+    double center_y_estimate,
+    double pixel_spacing,
+    double pixel_size,
+    double d0,
+    bool verbose = false
+);
+
+#endif // THREEDSYMMETRICFITCERES_HH
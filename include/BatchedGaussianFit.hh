@@ -0,0 +1,51 @@
+#ifndef BATCHEDGAUSSIANFIT_HH
+#define BATCHEDGAUSSIANFIT_HH
+
+#include <vector>
+#include <cstddef>
+
+// Batch of independent 1D Gaussian fits y(x) = A * exp(-(x-m)^2/(2*sigma^2)) + B, one per lane.
+// Lanes are queued one at a time (inputs packed back to back) and solved together by
+// FitGaussianBatch, which stores every per-lane quantity as a structure of arrays.
+struct GaussianFitBatch {
+    // Inputs: lane l owns points [lane_offset[l], lane_offset[l] + lane_size[l])
+    std::vector<double> x_vals;
+    std::vector<double> y_vals;
+    std::vector<size_t> lane_offset;
+    std::vector<int> lane_size;
+    std::vector<double> center_estimate;
+    std::vector<double> pixel_spacing;
+
+    // Results per lane
+    std::vector<double> amplitude;
+    std::vector<double> center;
+    std::vector<double> sigma;
+    std::vector<double> offset;
+    std::vector<double> amplitude_err;
+    std::vector<double> center_err;
+    std::vector<double> sigma_err;
+    std::vector<double> offset_err;
+    std::vector<double> chi2_reduced;
+    std::vector<int> iterations;
+    std::vector<unsigned char> converged;
+
+    size_t NumLanes() const { return lane_size.size(); }
+    size_t NumPoints() const { return x_vals.size(); }
+    void Clear();
+};
+
+// Queue one fit; returns its lane index, or -1 if there are too few points (< 4)
+int AddGaussianFitLane(GaussianFitBatch& batch,
+                       const std::vector<double>& x_vals,
+                       const std::vector<double>& y_vals,
+                       double center_estimate,
+                       double pixel_spacing);
+
+// Projected Levenberg-Marquardt on all lanes in lockstep: each iteration accumulates the normal
+// equations of every lane in one pass over a point-major, zero-padded layout (inner loop over
+// lanes, so it vectorizes), then takes one damped step per lane. Converged or stalled lanes are
+// masked out; a stalled lane counts as converged only after at least one accepted step at a point
+// with a vanishing projected gradient. Parameters, covariance errors and chi2red are written back per lane.
+void FitGaussianBatch(GaussianFitBatch& batch, int max_iterations);
+
+#endif // BATCHEDGAUSSIANFIT_HH
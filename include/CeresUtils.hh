@@ -2,6 +2,7 @@
 #define CERESUTILS_HH
 
 #include "ceres/ceres.h"
+#include <chrono>
 #include <vector>
 
 // Solver configuration presets
@@ -19,4 +20,116 @@ void SetStandardBounds(ceres::Problem& problem, double* parameters,
                       double center_x, double center_y = 0.0, // center_y optional for 1D fits
                       bool is_3d = false, bool has_beta = false);
 
+// Lattice structure of a 3D fit dataset: the distinct column x and row y positions,
+// and each point's column/row index into them (points need not fill the full grid)
+struct SurfaceGrid {
+    std::vector<double> column_x;
+    std::vector<double> row_y;
+    std::vector<int> point_column;
+    std::vector<int> point_row;
+};
+
+// Group points into columns/rows; coordinates closer than tolerance share an axis position
+SurfaceGrid BuildSurfaceGrid(const double* x_vals, const double* y_vals, size_t num_points,
+                             double tolerance);
+
+// Coarse-to-fine 3D surface fitting: which stages produced the final fit
+enum class CoarseToFineStage {
+    FULL_GRID = 0,      // Coarse-to-fine disabled, or the core already holds every pad: plain full-grid fit
+    CORE_ONLY = 1,      // Core fit already met the full-grid χ²ᵣ criterion, refinement skipped
+    CORE_REFINED = 2,   // Core fit followed by a short full-grid refinement
+    FULL_FALLBACK = 3   // Core fit or refinement failed on a real core/full split: plain full-grid fit
+};
+
+// Indices of the pads within core_radius pitches (per axis) of the max-charge pad
+std::vector<int> SelectCorePads(const std::vector<double>& x_vals, const std::vector<double>& y_vals,
+                                const std::vector<double>& z_vals, double pixel_spacing, int core_radius);
+
+// Reduced χ² of the problem at its current parameter values
+double EvaluateReducedChi2(ceres::Problem& problem, int num_points, int num_parameters);
+
+// Short bounded refinement of a 3D surface fit from a previous solution; parameter layout
+// [A, x0, y0, wx, wy, B] or [A, x0, y0, wx, wy, β, B]. Reports the final χ²ᵣ through chi2_reduced
+bool RefineSurfaceFit(ceres::Problem& problem, double* parameters, int num_parameters, int num_points,
+                      double charge_range, double pixel_spacing, int max_iterations, double& chi2_reduced);
+
+// True on every COARSE_TO_FINE_REFERENCE_INTERVAL-th call per thread: also time a plain full-grid fit
+bool ShouldSampleCoarseToFineReference();
+
+// Standard errors of the parameter block of a problem at its current values, variance_scale times the
+// ceres::Covariance diagonal (DENSE_SVD, as in the joint and symmetric fits). False if the covariance
+// cannot be computed, e.g. for a rank-deficient Jacobian
+bool ComputeParameterErrors(ceres::Problem& problem, const double* parameters, int num_parameters,
+                            double variance_scale, double* errors);
+
+// Normalized fit frame: coordinates in pitch units relative to the nearest pixel, charges divided by
+// the maximum charge, so parameters, residuals and tolerances are O(1) regardless of units
+struct NormalizedFitFrame {
+    double origin_x = 0.0;
+    double origin_y = 0.0;
+    double length_scale = 1.0;   // Pixel pitch
+    double charge_scale = 1.0;   // Max |charge| of the fitted data
+};
+
+NormalizedFitFrame MakeNormalizedFitFrame(double origin_x, double origin_y, double pixel_spacing,
+                                          const std::vector<double>& charge_values);
+
+// (value - origin) / scale for every element
+std::vector<double> ToFrameValues(const std::vector<double>& values, double origin, double scale);
+
+// Marks fits on this thread as running in a normalized frame while in scope; SolveFitProblem
+// then derives the tolerances from FIT_POSITION_RESOLUTION in pitch units
+class ScopedNormalizedFitFrame {
+public:
+    explicit ScopedNormalizedFitFrame(const NormalizedFitFrame& frame);
+    ~ScopedNormalizedFitFrame();
+    ScopedNormalizedFitFrame(const ScopedNormalizedFitFrame&) = delete;
+    ScopedNormalizedFitFrame& operator=(const ScopedNormalizedFitFrame&) = delete;
+private:
+    const NormalizedFitFrame* previous_;
+};
+
+// ceres::Solve with frame-aware tolerances and per-thread solve/iteration accounting
+void SolveFitProblem(ceres::Solver::Options options, ceres::Problem* problem, ceres::Solver::Summary* summary);
+
+// Per-thread solver statistics: fits started, Ceres solves, minimizer iterations and escalations
+// to the expensive fallback configurations
+struct FitSolveStatistics {
+    long long fits = 0;
+    long long solves = 0;
+    long long iterations = 0;
+    long long fallbacks = 0;
+};
+
+void RecordFitStart();
+void RecordFitFallback();
+
+// Returns this thread's statistics since the last call and resets them
+FitSolveStatistics TakeFitSolveStatistics();
+
+// Raw-frame reference: every NORMALIZED_FRAME_REFERENCE_INTERVAL-th normalized fit on a thread is
+// also solved in the raw frame on the same data (result discarded), so a diagnostic run reports solver
+// work before and after the normalized frame (off by default). While in scope, fits use the raw tolerances, their solves,
+// iterations and fallbacks go to separate statistics and escalation statistics are not recorded
+bool ShouldSampleRawFrameReference();
+
+class ScopedRawFrameReference {
+public:
+    ScopedRawFrameReference();
+    ~ScopedRawFrameReference();
+    ScopedRawFrameReference(const ScopedRawFrameReference&) = delete;
+    ScopedRawFrameReference& operator=(const ScopedRawFrameReference&) = delete;
+private:
+    const NormalizedFitFrame* previous_frame_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+bool IsRawFrameReferenceActive();
+
+// Returns this thread's raw-frame reference statistics since the last call and resets them
+FitSolveStatistics TakeRawFrameReferenceStatistics();
+
+// Total wall time this thread spent in raw-frame reference fits (monotonic, for excluding it from fit timing)
+double RawFrameReferenceTimeMs();
+
 #endif // CERESUTILS_HH 
\ No newline at end of file
@@ -0,0 +1,46 @@
+#ifndef CHARGESHARINGWEIGHTTABLE_HH
+#define CHARGESHARINGWEIGHTTABLE_HH
+
+#include "globals.hh"
+#include <vector>
+
+// Precomputed radial table for the charge sharing model
+// Both the pad angle α(d) = atan((l/2·√2) / (l/2·√2 + d)) and the weight α(d) / max(ln(d/d0), MIN_LOG_VALUE)
+// depend only on the in-plane distance d, so they are tabulated once per geometry on a uniform grid
+// and linearly interpolated. The table is rebuilt whenever pixel size, d0 or the required range change.
+class ChargeSharingWeightTable {
+public:
+    ChargeSharingWeightTable();
+    
+    // Exact model (also used to fill the table)
+    static G4double EvaluateAlpha(G4double distance, G4double pixelSize);
+    static G4double EvaluateWeight(G4double distance, G4double alpha, G4double d0);
+    
+    // Tabulate α and weight on [0, maxDistance] with the given step
+    void Build(G4double pixelSize, G4double d0, G4double maxDistance, G4double step);
+    
+    // True if built for this pixel size and d0 and covering distances up to maxDistance
+    G4bool Covers(G4double pixelSize, G4double d0, G4double maxDistance) const;
+    
+    // Interpolation is only accurate away from the ln(d/d0) singularity: use for d >= GetMinDistance()
+    G4double GetMinDistance() const { return fMinDistance; }
+    G4double GetMaxDistance() const { return fMaxDistance; }
+    
+    // Raw access for the neighborhood kernel (index = d * inverse step)
+    const G4double* GetAlphaData() const { return fAlpha.data(); }
+    const G4double* GetWeightData() const { return fWeight.data(); }
+    G4double GetInverseStep() const { return fInverseStep; }
+    size_t GetSize() const { return fWeight.size(); }
+    
+private:
+    std::vector<G4double> fAlpha;   // α(d) [rad]
+    std::vector<G4double> fWeight;  // unnormalized charge sharing weight
+    G4double fPixelSize;
+    G4double fD0;
+    G4double fStep;
+    G4double fInverseStep;
+    G4double fMinDistance;
+    G4double fMaxDistance;
+};
+
+#endif // CHARGESHARINGWEIGHTTABLE_HH
@@ -0,0 +1,82 @@
+#ifndef COLUMNARWRITER_HH
+#define COLUMNARWRITER_HH
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+class TTree;
+
+// Flat columnar output next to the "Hits" tree: every scalar branch becomes one fixed-width,
+// uncompressed, contiguous column that numpy can memory-map (python/ColumnarLoader.py).
+//
+// File layout (little-endian):
+//   "ECSCOLS1"                                          magic
+//   uint64 header size, uint64 entries, uint32 columns, uint32 metadata pairs
+//   metadata pairs:  string key, string value          (string = uint32 length + bytes)
+//   columns:         string name, string title, char type ('d' double, 'i' int32, '?' bool),
+//                    uint64 data offset
+//   column data, each starting at a COLUMNAR_ALIGNMENT-byte aligned offset
+//
+// Entries are buffered in blocks and spooled to a temporary file while the run is in progress;
+// Finish() lays the columns out contiguously once the entry count is known.
+
+using ColumnarMetadata = std::vector<std::pair<std::string, std::string>>;
+
+class ColumnarWriter
+{
+public:
+    ColumnarWriter();
+    ~ColumnarWriter();
+
+    ColumnarWriter(const ColumnarWriter&) = delete;
+    ColumnarWriter& operator=(const ColumnarWriter&) = delete;
+
+    // Add every single-value Double_t/Int_t/Bool_t branch of the tree (vector branches are skipped);
+    // the branch addresses are read on each Fill(), so the tree's bound variables must outlive the writer
+    void AddTreeColumns(TTree* tree);
+
+    // Start spooling to <path>.spool; the final file is written to path by Finish()
+    bool Open(const std::string& path);
+
+    // Append the current values of all columns (no locking: one writer per thread)
+    void Fill();
+
+    // Write the final file with the given metadata in its header and remove the spool
+    bool Finish(const ColumnarMetadata& metadata);
+
+    std::uint64_t GetEntries() const { return fEntries; }
+    size_t GetNumColumns() const { return fColumns.size(); }
+
+    // Concatenate per-thread files with identical columns (in the given order) into one file
+    static bool Merge(const std::vector<std::string>& inputs, const std::string& output,
+                      const ColumnarMetadata& metadata);
+
+    static std::string FileNameFor(const std::string& rootFileName);  // "x.root" -> "x.cols"
+
+private:
+    struct Column {
+        std::string name;
+        std::string title;
+        char type;                 // 'd', 'i' or '?'
+        std::uint32_t width;       // Bytes per entry
+        const void* address;       // Bound branch variable
+        size_t blockOffset;        // Start of this column in the block buffer
+    };
+
+    void FlushBlock();
+
+    std::vector<Column> fColumns;
+    std::vector<unsigned char> fBlock;  // Column-major block of up to fBlockCapacity entries
+    std::uint64_t fBlockCapacity;
+    std::uint64_t fBlockEntries;
+    std::uint64_t fEntries;
+    size_t fEntryBytes;
+    std::string fPath;
+    std::string fSpoolPath;
+    std::FILE* fSpool;
+};
+
+#endif // COLUMNARWRITER_HH
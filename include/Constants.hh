@@ -44,11 +44,79 @@ namespace Constants {
     const G4int MIN_AUTO_RADIUS = 4;                     // Minimum radius for auto selection (5x5 grid)
     const G4int MAX_AUTO_RADIUS = 10;                     // Maximum radius for auto selection (13x13 grid)
     const G4bool ENABLE_AUTO_RADIUS = false;             // Enable automatic radius selection per hit
+    const G4int AUTO_RADIUS_PATIENCE = 2;                // Stop the radius scan after this many radii without quality improvement
     
     // Fit quality thresholds for radius selection
     const G4double RESIDUAL_OUTLIER_THRESHOLD = 3.0;     // Outlier threshold in standard deviations
     const G4int MIN_POINTS_FOR_FIT = 3;                  // Minimum number of points required for fitting
     
+    // ========================
+    // ADAPTIVE REGION OF INTEREST (ROI) CONSTANTS
+    // ========================
+    
+    // Pad selection for fitting (applied after charge sharing, before all fits)
+    const G4bool ENABLE_ADAPTIVE_ROI = false;            // Fit only selected pads instead of every pad with charge in the grid
+    const G4double ROI_RELATIVE_CHARGE_THRESHOLD = 0.1;  // Keep pads with charge >= threshold * max pad charge
+    const G4int ROI_TOP_K_PADS = 0;                      // If > 0, keep the K highest-charge pads instead (overrides threshold)
+    const G4int ROI_MIN_PADS = 7;                        // Fall back to all pads if fewer would be selected
+    
+    // Sampled neighborhood grid storage: the per-pad Grid* vector branches are filled only for sampled entries
+    // (empty otherwise); scalar branches are written for every event and HasGridData flags the sampled ones.
+    // Random sampling hashes the event ID, so it is reproducible and leaves the Geant4 random sequence untouched
+    enum GridSamplingMode {
+        GRID_SAMPLE_ALL = 0,          // Every event (no sampling)
+        GRID_SAMPLE_EVERY_NTH = 1,    // Event IDs divisible by GRID_SAMPLING_INTERVAL
+        GRID_SAMPLE_RANDOM = 2,       // A GRID_SAMPLING_FRACTION of the events
+        GRID_SAMPLE_POOR_FIT = 3      // Events with a failed enabled row/column or 3D fit, or χ²ᵣ above the cut
+    };
+    const GridSamplingMode GRID_SAMPLING_MODE = GRID_SAMPLE_ALL;
+    const G4int GRID_SAMPLING_INTERVAL = 100;            // Every Nth event (GRID_SAMPLE_EVERY_NTH)
+    const G4double GRID_SAMPLING_FRACTION = 0.01;        // Sampled fraction (GRID_SAMPLE_RANDOM)
+    const G4double GRID_SAMPLING_MAX_CHI2RED = 5.0;      // χ²ᵣ above which a fit counts as poor (GRID_SAMPLE_POOR_FIT)
+    
+    // Output clustering for targeted reads: reading one entry decompresses one cluster of every branch read.
+    // With a separate grid tree the per-pad vectors go to "GridNeighborhood" (entry-aligned friend of "Hits")
+    // and get their own cluster size. "EventIndex" holds EventID and a fit-status bitmask per "Hits" entry
+    const G4int HITS_CLUSTER_ENTRIES = 1000;             // AutoFlush of "Hits"
+    const G4bool ENABLE_SEPARATE_GRID_TREE = false;      // Grid* vectors in their own tree
+    const G4int GRID_CLUSTER_ENTRIES = 10000;            // AutoFlush of "GridNeighborhood"
+    const G4bool ENABLE_EVENT_INDEX = true;              // Write the "EventIndex" tree
+    
+    // Per-thread memory budget for the basket buffers of a worker's trees. Each tree gets a weighted share
+    // (Hits and GridNeighborhood 8, EventIndex and BatchedGaussFits 1): its clusters are sized in bytes
+    // (SetAutoFlush(-share), replacing the entry counts above) and OptimizeBaskets(share) bounds its baskets
+    // after the first cluster. The peak basket memory of every worker is printed at end of run
+    const G4bool ENABLE_MEMORY_BUDGET = false;           // Derive cluster and basket sizes from the budget
+    const G4double WORKER_MEMORY_BUDGET_MB = 256.0;      // Basket memory per worker thread [MB]
+    const G4int TREE_MEMORY_SAMPLE_ENTRIES = 100;        // Fills between basket memory samples (budget on or off)
+    
+    // Flat columnar output: every scalar "Hits"/"EventIndex" branch as an uncompressed fixed-width column in
+    // epicChargeSharingOutput.cols (same entry order as "Hits"), memory-mapped by python/ColumnarLoader.py
+    const G4bool ENABLE_COLUMNAR_OUTPUT = false;         // Write the .cols file next to the ROOT file
+    const G4int COLUMNAR_BLOCK_ENTRIES = 1024;           // Entries buffered per thread before spooling
+    const G4int COLUMNAR_ALIGNMENT = 64;                 // Byte alignment of every column
+    
+    // Event stream for online consumers: one length-prefixed record per "Hits" entry (event ID, fit status,
+    // true position, reconstructed position of every enabled method), written by the workers through a sink
+    // lock that is independent of the ROOT writer. Record layout in include/EventStream.hh
+    const G4bool ENABLE_EVENT_STREAM = false;            // Stream records to EVENT_STREAM_TARGET
+    const char* const EVENT_STREAM_TARGET = "fifo:epicChargeSharingStream"; // "stdout", "fifo:<path>" or "unix:<path>"
+    const G4int EVENT_STREAM_FLUSH_EVENTS = 64;          // Records buffered per thread before one write
+    const G4bool ENABLE_ROOT_OUTPUT = true;              // false = no ROOT files (stream-only throughput scans)
+    
+    // Online resolution summary: per-thread count, Welford mean/variance, t-digest quantiles and failure count of
+    // the x/y residuals of every enabled method, merged by G4AccumulableManager and printed at end of run. Written
+    // as the "ResolutionSummary" tree of the output file (epicChargeSharingResolution.txt without ROOT output)
+    const G4bool ENABLE_RESOLUTION_SUMMARY = true;       // Accumulate and report the resolution per method
+    const G4double RESOLUTION_TDIGEST_COMPRESSION = 200.0; // t-digest compression (centroids ~ compression)
+    
+    // Online sub-pixel residual maps: per-thread TProfile2D of the x/y residual of every enabled method vs the true
+    // position relative to the pixel center (one pitch, both axes), merged by G4AccumulableManager. Written with
+    // derived RMS maps to the "ResidualMaps" directory of the output file (epicChargeSharingResidualMaps.root
+    // without ROOT output), so bias maps exist even when per-event storage is skipped
+    const G4bool ENABLE_RESIDUAL_MAPS = true;            // Accumulate residual mean/spread vs sub-pixel position
+    const G4int RESIDUAL_MAP_BINS = 50;                  // Bins per axis over one pixel pitch
+    
     // ========================
     // SIMULATION CONSTANTS
     // ========================
@@ -59,6 +127,10 @@ namespace Constants {
     // Charge sharing calculations
     const G4double ALPHA_WEIGHT_MULTIPLIER = 1000.0;     // Weight for very close pixels
     
+    // Precomputed radial weight table (interpolated α(d) and weight(d) instead of per-pixel atan/log)
+    const G4bool ENABLE_WEIGHT_TABLE = false;            // Use the interpolated table in the neighborhood kernel
+    const G4double WEIGHT_TABLE_STEP = 0.5*um;           // Table spacing (max relative error ~2.5e-5 at 100 um pads)
+    
     // Primary generator constants
     const G4double PRIMARY_PARTICLE_Z_POSITION = 2.0*cm; // Z position for primary particle generation
     
@@ -110,6 +182,70 @@ namespace Constants {
     const G4bool ENABLE_3D_LORENTZIAN_FITTING = false;    // Enable 3D Lorentzian surface fitting
     const G4bool ENABLE_3D_POWER_LORENTZIAN_FITTING = false; // Enable 3D Power-Law Lorentzian surface fitting
     
+    // Symmetry-constrained 3D fits run next to the anisotropic ones: a single width instead of
+    // σx/σy (γx/γy), or the radial charge sharing weight α/ln(r/d0) fitted against distance from (mx, my)
+    const G4bool ENABLE_3D_GAUSSIAN_ISOTROPIC_FITTING = false;        // Isotropic 3D Gaussian (5 parameters)
+    const G4bool ENABLE_3D_LORENTZIAN_ISOTROPIC_FITTING = false;      // Isotropic 3D Lorentzian (5 parameters)
+    const G4bool ENABLE_3D_POWER_LORENTZIAN_ISOTROPIC_FITTING = false; // Isotropic 3D Power-Law Lorentzian (6 parameters)
+    const G4bool ENABLE_3D_RADIAL_FITTING = false;                    // Radial charge sharing profile (4 parameters)
+    
+    // Joint Gaussian fit of the central row, column and both diagonals: one solve with shared center
+    // (and shared row/column and diagonal widths), giving a single coherent position and covariance
+    const G4bool ENABLE_JOINT_PROFILE_FITTING = false;   // Enable joint row/column/diagonal Gaussian fit
+    
+    // Normalized fit frame: every row/column/diagonal and 3D fit runs with coordinates in pitch units
+    // around the nearest pixel and charges divided by their maximum; results are transformed back
+    const G4bool ENABLE_NORMALIZED_FIT_FRAME = true;     // Solve in the normalized frame
+    const G4double FIT_POSITION_RESOLUTION = 0.1*um;     // Requested position resolution (sets parameter_tolerance)
+    const G4double NORMALIZED_FUNCTION_TOLERANCE = 1e-8; // Relative cost change tolerance in the normalized frame
+    const G4double NORMALIZED_GRADIENT_TOLERANCE = 1e-10; // Gradient tolerance in the normalized frame
+    const G4int NORMALIZED_FRAME_REFERENCE_INTERVAL = 0; // Diagnostic: also solve every Nth fit in the raw frame and report both (0 = off)
+    
+    // Adaptive solver escalation: per-thread counts of which ladder stage produced the accepted fit,
+    // per model and neighborhood size, reorder the expensive stages and prune those that rarely win
+    const G4bool ENABLE_ADAPTIVE_ESCALATION = false;     // Reorder/prune the expensive stages from run-time statistics
+    const G4int ESCALATION_MIN_SAMPLES = 100;            // Escalations per model/class before the ladder adapts
+    const G4double ESCALATION_PRUNE_FRACTION = 0.02;     // Drop stages accepted in fewer than this fraction of attempts
+    const G4bool ESCALATION_POLICY_FREEZE = false;       // Write the run's statistics to ESCALATION_POLICY_FILE at end of run
+    const G4bool ESCALATION_POLICY_USE_FROZEN = false;   // Order the ladder from ESCALATION_POLICY_FILE instead of learning
+    const char* const ESCALATION_POLICY_FILE = "escalationPolicy.txt";
+    
+    // Coarse-to-fine 3D surface fits: fit the core around the max-charge pad first, then run a short
+    // refinement on the full grid from that solution (skipped when the core solution already fits it)
+    const G4bool ENABLE_COARSE_TO_FINE_3D = false;       // Enable two-stage 3D surface fitting
+    const G4int COARSE_TO_FINE_CORE_RADIUS = 1;          // Core half-width in pads (1 = 3x3, 2 = 5x5)
+    const G4double COARSE_TO_FINE_SKIP_CHI2 = 0.7;       // Skip refinement if full-grid χ²ᵣ at the core solution is below this
+    const G4int COARSE_TO_FINE_REFINE_ITERATIONS = 25;   // Iteration cap of the full-grid refinement
+    const G4int COARSE_TO_FINE_REFERENCE_INTERVAL = 50;  // Every Nth 3D fit per thread also times a plain full-grid fit (0 = never)
+    
+    // Mixed-precision Gaussian row/column/diagonal fits: single-precision LM on normalized data, then a
+    // short double-precision polish; falls back to the Ceres path if the single-precision stage fails.
+    // Off until mixedPrecisionFitTest (ctest) has compared it with Ceres on a target machine
+    const G4bool ENABLE_MIXED_PRECISION_FIT = false;     // Use the mixed-precision path for the cheap stage
+    const G4int MIXED_PRECISION_MAX_FLOAT_ITERATIONS = 50; // Single-precision LM iteration cap
+    const G4int MIXED_PRECISION_POLISH_ITERATIONS = 2;   // Double-precision refinement iterations
+
+    // Batched Gaussian row/column fits: each worker queues the central row and column of every event and
+    // fits BATCHED_FIT_FLUSH_EVENTS events at once with a lockstep LM over a structure-of-arrays layout.
+    // Results go to the "BatchedGaussFits" tree, one entry per "Hits" entry (use as a friend tree)
+    const G4bool ENABLE_BATCHED_GAUSSIAN_FITTING = false; // Enable the deferred batched fit path
+    const G4int BATCHED_FIT_FLUSH_EVENTS = 64;           // Events queued per thread before a batch is fitted
+    const G4int BATCHED_FIT_MAX_ITERATIONS = 200;        // LM rounds per batch (rejected steps included)
+
+    // Per-event arena: grouping maps and scratch vectors of the charge sharing and fitting code come from a
+    // per-thread monotonic buffer released at the start of every event (arena use per event is logged;
+    // heap calls only with the COUNT_HEAP_ALLOCATIONS CMake option)
+    const G4bool ENABLE_EVENT_ARENA = true;              // false = same containers on the global heap
+    const G4int EVENT_ARENA_INITIAL_BYTES = 64 * 1024;   // Initial arena buffer per thread (grows to the largest event)
+    
+    // Power-Law Lorentzian cost: hand-derived Jacobian (ln D shared by value and β derivative) instead of
+    // AutoDiff pow on Jets. Off until powerLorentzianDerivativeTest (ctest) has timed both on a target machine
+    const G4bool ENABLE_ANALYTIC_POWER_LORENTZIAN = false; // Use the analytic Power-Law Lorentzian cost
+    
+    // 3D cost evaluation: one grid-structured residual block with per-column/per-row factors and
+    // analytic Jacobians, instead of one AutoDiff residual block per pad (same model and minimum)
+    const G4bool ENABLE_SEPARABLE_3D_COST = true;        // Use the grid-structured 3D cost functions
+    
     // ========================
     // VERTICAL CHARGE UNCERTAINTIES CONTROL
     // ========================
@@ -0,0 +1,48 @@
+#ifndef ESCALATIONPOLICY_HH
+#define ESCALATIONPOLICY_HH
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+// Fit models with a cheap-then-expensive solver escalation ladder
+enum class EscalationModel {
+    GAUSSIAN_1D = 0,
+    LORENTZIAN_1D = 1,
+    POWER_LORENTZIAN_1D = 2,
+    GAUSSIAN_3D = 3,
+    LORENTZIAN_3D = 4,
+    POWER_LORENTZIAN_3D = 5
+};
+
+const int kNumEscalationModels = 6;
+const int kNumNeighborhoodClasses = 3;  // Points per axis: <= 3, <= 5, larger
+const int kMaxEscalationStages = 4;     // Stage 0 is the cheap config, 1.. the expensive configs
+
+// Neighborhood class from the number of fitted points (surface fits use points per axis)
+int GetEscalationNeighborhoodClass(size_t num_points, bool surface_fit);
+
+// Order of the expensive stages (1 .. num_stages-1) to try after the cheap stage.
+// The statistics come from ESCALATION_POLICY_FILE when ESCALATION_POLICY_USE_FROZEN is set, else
+// from this thread's live counters when ENABLE_ADAPTIVE_ESCALATION is set; with neither, or before
+// ESCALATION_MIN_SAMPLES escalations of this model/class, this is the hard-coded ladder. Afterwards
+// stages are sorted by how often they produced the accepted fit, and stages that almost never win
+// are pruned (at least one is kept).
+std::vector<int> GetEscalationOrder(EscalationModel model, int neighborhood_class, int num_stages);
+
+// Per-thread counters: a stage was tried / a stage produced the accepted fit.
+// They are never cleared, so the learned order carries over to later runs in the same process.
+void RecordEscalationAttempt(EscalationModel model, int neighborhood_class, int stage);
+void RecordEscalationAccepted(EscalationModel model, int neighborhood_class, int stage);
+
+// Start of run (master): clear the run totals so the written policy covers this run only
+void ResetEscalationStatistics();
+
+// End of run: fold what this thread counted since its last merge into the run totals
+// (call on every thread that fits)
+void MergeEscalationStatistics();
+
+// Write the merged run totals as a frozen policy, loaded by later runs with ESCALATION_POLICY_USE_FROZEN
+bool WriteEscalationPolicy(const std::string& filename);
+
+#endif // ESCALATIONPOLICY_HH
@@ -4,10 +4,12 @@
 #include "G4UserEventAction.hh"
 #include "globals.hh"
 #include "G4ThreeVector.hh"
+#include "NeighborhoodKernel.hh"
 #include <vector>
 
 class RunAction;
 class DetectorConstruction;
+struct GaussianFit2DResultsCeres;
 
 class EventAction : public G4UserEventAction
 {
@@ -41,6 +43,10 @@ public:
     // Method to calculate charge sharing in the neighborhood (9x9) grid
     void CalculateNeighborhoodChargeSharing();
     
+    // Fused kernel: angles, distances, charge fractions and charges for the neighborhood grid in one pass
+    // Equivalent to CalculateNeighborhoodGridAngles + CalculateNeighborhoodChargeSharing
+    void CalculateNeighborhoodGrid(const G4ThreeVector& hitPosition, G4int hitPixelI, G4int hitPixelJ);
+    
     // Method to set neighborhood radius (default is 4 for 9x9 grid)
     void SetNeighborhoodRadius(G4int radius) { fNeighborhoodRadius = radius; }
     G4int GetNeighborhoodRadius() const { return fNeighborhoodRadius; }
@@ -96,9 +102,40 @@ private:
     G4int fSelectedRadius;
     G4double fSelectedFitQuality;
     
+    // Fused neighborhood kernel (per thread: owns its runtime-radius scratch and the weight table)
+    NeighborhoodKernel fKernel;
+    std::vector<G4double> fKernelDistances;  // Scratch distances for weight-only evaluations
+    std::vector<G4double> fKernelAlphas;     // Scratch angles for weight-only evaluations
+    
+    // Reused fit inputs and auto-radius weights, reserved for MAX_AUTO_RADIUS in the constructor.
+    // The fitters receive them as std::vector and still allocate internally (datasets, Ceres problems).
+    std::vector<double> fFitXCoords;
+    std::vector<double> fFitYCoords;
+    std::vector<double> fFitChargeValues;
+    std::vector<G4double> fAutoRadiusWeights;
+    
     // Helper methods for automatic radius selection
     G4int SelectOptimalRadius(const G4ThreeVector& hitPosition, G4int hitPixelI, G4int hitPixelJ);
-    G4double EvaluateFitQuality(G4int radius, const G4ThreeVector& hitPosition, G4int hitPixelI, G4int hitPixelJ);
+    G4double EvaluateFitQuality(G4int radius, G4int maxRadius, const std::vector<G4double>& maxRadiusWeights,
+                                G4double centerX, G4double centerY,
+                                const GaussianFit2DResultsCeres* warmStart,
+                                GaussianFit2DResultsCeres& fitResults);
+    
+    // Unnormalized charge sharing weights for a (2r+1)x(2r+1) grid (-1 marks out-of-bounds pixels)
+    void CalculateNeighborhoodWeights(const G4ThreeVector& hitPosition, G4int hitPixelI, G4int hitPixelJ,
+                                      G4int radius, std::vector<G4double>& weights);
+    
+    // Charge sharing weight α_i * ln(d_i/d_0)^(-1) for a single pixel
+    G4double CalculateChargeSharingWeight(G4double distance, G4double alpha, G4double d0) const;
+    
+    // Fused kernel core: distances [mm], α [rad] and unnormalized weights (-1 out of bounds)
+    // for a (2r+1)x(2r+1) grid in column-major order; output arrays must hold (2r+1)^2 values
+    void ComputeNeighborhoodKernel(G4double hitX, G4double hitY, G4int hitPixelI, G4int hitPixelJ,
+                                   G4int radius, G4double* distances, G4double* alphas, G4double* weights);
+    
+    // Adaptive region of interest: compacts the fit inputs in place, returns the number of pads kept
+    G4int SelectRegionOfInterest(std::vector<double>& x_coords, std::vector<double>& y_coords,
+                                 std::vector<double>& charge_values) const;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,47 @@
+#ifndef EVENTARENA_HH
+#define EVENTARENA_HH
+
+#include <cstddef>
+#include <map>
+#include <memory_resource>
+#include <utility>
+#include <vector>
+
+// Per-thread monotonic arena for per-event temporaries (grouping maps and scratch vectors of the
+// charge sharing code, the fitters' gathered datasets and the mixed-precision fit's normalized copies).
+// Deallocation is a no-op; everything is released at once by ResetEventArena() at the start of the
+// next event, so containers allocated from the arena must not outlive the event. When an event
+// overflows the arena buffer, the buffer grows to that size at the next reset, so steady-state
+// events make no heap calls for these containers. The fit inputs are EventAction member buffers
+// that keep their capacity, so they stop allocating after the first events.
+// Events are still not heap-free: each ceres::Problem with its cost functions, the outlier filter's
+// index masks and the fit result structs come from the global heap.
+
+// Arena of the calling thread (the global heap if Constants::ENABLE_EVENT_ARENA is false)
+std::pmr::memory_resource* GetEventArena();
+
+// Release everything allocated from this thread's arena (BeginOfEventAction)
+void ResetEventArena();
+
+// Per-event containers on the arena
+using ArenaDoubleVector = std::pmr::vector<double>;
+using ArenaPointVector = std::pmr::vector<std::pair<double, double>>;
+template <typename Key>
+using ArenaPointGroups = std::pmr::map<Key, ArenaPointVector>;  // Row/column/diagonal -> [(position, charge), ...]
+
+// Per-thread allocation statistics since the last reset. Heap calls are only counted in builds
+// configured with -DCOUNT_HEAP_ALLOCATIONS=ON, which replaces the global operator new/delete;
+// otherwise use an external tool (heaptrack, an LD_PRELOAD malloc counter)
+struct EventAllocationStatistics {
+    long long heap_allocations = -1; // Global operator new calls on this thread, -1 when not counted
+    long long arena_bytes = 0;       // Bytes handed out by the arena
+    long long arena_overflows = 0;   // Arena chunks that had to come from the heap
+};
+
+// Returns this thread's statistics since the last call and resets them
+EventAllocationStatistics TakeEventAllocationStatistics();
+
+// Whether this build counts heap calls (COUNT_HEAP_ALLOCATIONS)
+bool HeapAllocationsCounted();
+
+#endif // EVENTARENA_HH
@@ -0,0 +1,181 @@
+#ifndef EVENTRECORD_HH
+#define EVENTRECORD_HH
+
+#include "globals.hh"
+#include "3DSymmetricFitCeres.hh"
+
+#include <functional>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// =============================================
+// PER-EVENT RECORD
+// =============================================
+// Plain-data blocks filled in place by EventAction and bound to the "Hits" tree by RunAction
+// (one binding call per block). All positions in mm, energies in MeV.
+
+// True/initial position, nearest pixel and pixel classification
+struct HitRecord {
+    G4double true_x, true_y, true_z;
+    G4double init_x, init_y, init_z;
+    G4double pixel_x, pixel_y, pixel_z;
+    G4double edep;
+    G4double initial_energy;
+    G4double pixel_true_delta_x;     // x_pixel - x_true
+    G4double pixel_true_delta_y;     // y_pixel - y_true
+    G4bool is_pixel_hit;             // On pixel or distance <= D0
+    G4int selected_radius;           // Automatically selected neighborhood radius
+    G4int roi_candidate_pads;        // Pads with positive charge in the neighborhood grid
+    G4int roi_selected_pads;         // Pads passed to the fits after ROI selection
+    G4bool has_grid_data;            // Neighborhood grid vectors stored for this entry (grid sampling)
+};
+
+// One 1D fit of a row, column or diagonal projection.
+// width is sigma (Gaussian) or gamma (Lorentzian models); beta only for the Power-Law Lorentzian.
+struct ProfileFitRecord {
+    G4double amplitude, amplitude_err;
+    G4double width, width_err;
+    G4double beta, beta_err;
+    G4double vertical_offset, vertical_offset_err;
+    G4double center, center_err;
+    G4double chi2red, pp;
+    G4int dof;
+    G4double charge_uncertainty;     // Row/column fits only (0 if uncertainties are disabled)
+};
+
+// Row, column and diagonal fits of one 1D model and the quantities derived from them
+struct ProfileModelRecord {
+    ProfileFitRecord row, column;
+    ProfileFitRecord main_diag_x, main_diag_y;
+    ProfileFitRecord second_diag_x, second_diag_y;
+    G4bool row_column_successful;    // Overall flag of the row/column fit
+
+    // Derived (fit - true, diagonal centers rotated back to x/y, mean over estimators)
+    G4double row_delta_x, column_delta_y;
+    G4double main_diag_transformed_x, main_diag_transformed_y;
+    G4double main_diag_transformed_delta_x, main_diag_transformed_delta_y;
+    G4double second_diag_transformed_x, second_diag_transformed_y;
+    G4double second_diag_transformed_delta_x, second_diag_transformed_delta_y;
+    G4double mean_true_delta_x, mean_true_delta_y;
+};
+
+// 3D surface fit; width_x/width_y are sigma or gamma, beta only for the Power-Law Lorentzian
+struct SurfaceFitRecord {
+    G4double center_x, center_y;
+    G4double width_x, width_y;
+    G4double beta;
+    G4double amplitude, vertical_offset;
+    G4double center_x_err, center_y_err;
+    G4double width_x_err, width_y_err;
+    G4double beta_err;
+    G4double amplitude_err, vertical_offset_err;
+    G4double chi2red, pp;
+    G4int dof;
+    G4double charge_uncertainty;
+    G4bool successful;
+    G4double delta_x, delta_y;       // Derived: fit - true
+};
+
+// Joint row/column/diagonal Gaussian fit with shared center and widths
+struct JointFitRecord {
+    G4double center_x, center_y;
+    G4double center_x_err, center_y_err;
+    G4double center_xy_cov;          // [mm^2]
+    G4double sigma, sigma_err;
+    G4double diag_sigma, diag_sigma_err;
+    G4int num_profiles;
+    G4double chi2red, pp;
+    G4int dof;
+    G4bool successful;
+    G4double delta_x, delta_y;       // Derived: fit - true
+};
+
+// Symmetry-constrained 3D fit (one per Symmetric3DModel)
+struct SymmetricFitRecord {
+    G4double center_x, center_y;
+    G4double center_x_err, center_y_err;
+    G4double width, width_err;       // Unused by the radial model
+    G4double chi2red;
+    G4int dof;
+    G4bool successful;
+    G4double delta_x, delta_y;       // Derived: fit - true
+};
+
+// Bits of EventIndexRecord::fit_status: set when the fit (or condition) succeeded. Disabled fits leave
+// their bit clear, so failed fits are EnabledFitStatusMask() & ~fit_status
+enum FitStatusBit {
+    FIT_STATUS_GAUSS_ROW_COLUMN = 1 << 0,
+    FIT_STATUS_LORENTZ_ROW_COLUMN = 1 << 1,
+    FIT_STATUS_POWER_LORENTZ_ROW_COLUMN = 1 << 2,
+    FIT_STATUS_GAUSS_3D = 1 << 3,
+    FIT_STATUS_LORENTZ_3D = 1 << 4,
+    FIT_STATUS_POWER_LORENTZ_3D = 1 << 5,
+    FIT_STATUS_JOINT = 1 << 6,
+    FIT_STATUS_SYMMETRIC_FIRST = 1 << 7,   // One bit per Symmetric3DModel from here
+    FIT_STATUS_PIXEL_HIT = 1 << 12,        // Conditions, not fits
+    FIT_STATUS_GRID_DATA = 1 << 13
+};
+
+// Entry of the "EventIndex" tree (entry-aligned with "Hits")
+struct EventIndexRecord {
+    G4int event_id;
+    G4int fit_status;                // FitStatusBit mask
+};
+
+struct EventRecord {
+    EventIndexRecord index;
+    HitRecord hit;
+    ProfileModelRecord gauss;
+    ProfileModelRecord lorentz;
+    ProfileModelRecord power_lorentz;
+    SurfaceFitRecord gauss_3d;
+    SurfaceFitRecord lorentz_3d;
+    SurfaceFitRecord power_lorentz_3d;
+    JointFitRecord joint;
+    SymmetricFitRecord symmetric[kNumSymmetric3DModels];
+};
+
+static_assert(FIT_STATUS_SYMMETRIC_FIRST << kNumSymmetric3DModels <= FIT_STATUS_PIXEL_HIT,
+              "Symmetric fit status bits overlap the condition bits");
+static_assert(std::is_trivially_copyable<EventRecord>::value,
+              "EventRecord must stay plain data (reset by copy, bound by address)");
+
+// Sentinel state of a record: fit parameters 0, flags false, derived quantities NaN
+// (what the "no fit performed" path used to write through the setters)
+const EventRecord& GetEventRecordTemplate();
+
+// FitStatusBit mask of a filled record, and the bits of the fits enabled in Constants
+G4int FitStatusMask(const EventRecord& record);
+G4int EnabledFitStatusMask();
+
+// Fit - true deltas, transformed diagonal coordinates and mean estimators of the fits enabled in
+// Constants; disabled fits keep their sentinels. Run once per entry by RunAction::FillTree
+void ComputeDerivedQuantities(EventRecord& record);
+
+// Reset to the sentinel state with a single copy from the template
+inline void ResetEventRecord(EventRecord& record) {
+    record = GetEventRecordTemplate();
+}
+
+// =============================================
+// RECONSTRUCTION METHODS
+// =============================================
+// Position estimates of a filled record (after FillTree's derived-quantity stage), for consumers that
+// aggregate per method instead of reading the branches. Both are NaN where the record's delta is NaN.
+
+struct PositionXY {
+    G4double x, y;
+};
+
+struct ReconstructionMethod {
+    std::string name;                                       // Branch prefix, e.g. "GaussRowColumn", "3DGaussian"
+    std::function<PositionXY(const EventRecord&)> position; // Reconstructed position [mm]
+    std::function<PositionXY(const EventRecord&)> delta;    // Reconstructed - true [mm], as in the *Delta* branches
+    G4bool fitted = true;                                   // Fits only run on non-pixel hits
+};
+
+// Methods whose deltas are computed with the fits enabled in Constants (pixel center first)
+const std::vector<ReconstructionMethod>& EnabledReconstructionMethods();
+
+#endif // EVENTRECORD_HH
@@ -0,0 +1,74 @@
+#ifndef EVENTSTREAM_HH
+#define EVENTSTREAM_HH
+
+#include "globals.hh"
+#include "EventRecord.hh"
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Binary event stream for online consumers (Constants::ENABLE_EVENT_STREAM), little-endian:
+//
+//   stream header (once):  "ECSSTRM1", uint32 method count, method names (uint32 length + bytes),
+//                          in EnabledReconstructionMethods() order
+//   event record:          uint32 payload bytes, then the payload:
+//                          int32 event ID, int32 FitStatusBit mask, float32 true x, true y,
+//                          float32 x, y per method (NaN where the fit failed), positions in mm
+//
+// Records are whole at the byte level (each write holds complete records), so a consumer can read
+// length-prefixed records until EOF. python/EventStreamReader.py is a reference consumer.
+
+// For the "stdout" target, fd 1 must belong to the stream before the first line of text: main() calls
+// this first thing when the stream is enabled. It keeps the original stdout for the stream and points
+// fd 1 at stderr (no-op for the other targets). main() also ignores SIGPIPE, so a vanished consumer
+// surfaces as a write error instead of terminating the run
+void ReserveStdoutForEventStream();
+
+// Shared sink of the process. Targets: "stdout" (Geant4 text output then moves to stderr),
+// "fifo:<path>" (created if missing; opening waits for a reader) or "unix:<path>" (connects to a
+// listening stream socket). On a write error (consumer gone) the stream is closed and later records
+// are dropped; the simulation and its ROOT output carry on.
+class EventStream
+{
+public:
+    // Opened on first use at Constants::EVENT_STREAM_TARGET
+    static EventStream& Instance();
+
+    G4bool IsOpen() const { return fOpen.load(); }
+
+    // Write complete records under the sink lock (the ROOT lock is never taken)
+    void Write(const unsigned char* data, size_t size);
+
+private:
+    EventStream();
+    ~EventStream();
+
+    G4bool Open(const std::string& target);
+    void Close();
+
+    int fFd;
+    std::mutex fMutex;
+    std::atomic<bool> fOpen;
+};
+
+// Per-thread encoder in front of the shared sink: buffers EVENT_STREAM_FLUSH_EVENTS records per write
+class EventStreamWriter
+{
+public:
+    EventStreamWriter();
+    ~EventStreamWriter();
+
+    // Encode one filled record (after FillTree's derived-quantity stage)
+    void Append(const EventRecord& record);
+
+    // Hand the buffered records to the sink (end of run)
+    void Flush();
+
+private:
+    std::vector<unsigned char> fBuffer;
+    G4int fPending;
+};
+
+#endif // EVENTSTREAM_HH
@@ -0,0 +1,52 @@
+#ifndef JOINTPROFILEFITCERES_HH
+#define JOINTPROFILEFITCERES_HH
+
+#include <vector>
+
+// Results of the joint Gaussian fit of the central row, column and both diagonals
+// Model per profile k with unit direction u_k through the center pixel c:
+//   q(s) = A_k * exp(-(s - s0)^2 / (2 * σ_k^2)) + B_k,  s = (p - c)·u_k,  s0 = (x0 - c)·u_k
+// (x0, y0) is shared by all profiles, σ is shared by row/column and σ_diag by the two diagonals
+// A pad on k used profiles (always the center pad) enters each with weight 1/k and counts once in the DOF
+struct GaussianJointFitResultsCeres {
+    // Shared parameters
+    double center_x = 0.0;
+    double center_y = 0.0;
+    double sigma = 0.0;         // Row/column width
+    double diag_sigma = 0.0;    // Diagonal width (along the diagonal)
+    
+    // Uncertainties from the solver covariance
+    double center_x_err = 0.0;
+    double center_y_err = 0.0;
+    double center_xy_cov = 0.0;
+    double sigma_err = 0.0;
+    double diag_sigma_err = 0.0;
+    
+    // Per-profile amplitude and offset (row, column, main diagonal, secondary diagonal)
+    double amplitude[4] = {0.0, 0.0, 0.0, 0.0};
+    double vertical_offset[4] = {0.0, 0.0, 0.0, 0.0};
+    bool profile_used[4] = {false, false, false, false};
+    int num_profiles = 0;
+    
+    // Fit quality
+    double charge_uncertainty = 0.0;
+    double chi2red = 0.0;
+    int dof = 0;
+    double pp = 0.0;
+    bool fit_successful = false;
+    
+    GaussianJointFitResultsCeres() = default;
+};
+
+// Single Ceres solve over all central profiles with at least 4 pads
+GaussianJointFitResultsCeres FitJointGaussianProfilesCeres(
+    const std::vector<double>& x_coords,
+    const std::vector<double>& y_coords,
+    const std::vector<double>& charge_values,
+    double center_x_estimate,
+    double center_y_estimate,
+    double pixel_spacing,
+    bool verbose = false
+);
+
+#endif // JOINTPROFILEFITCERES_HH
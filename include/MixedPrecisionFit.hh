@@ -0,0 +1,34 @@
+#ifndef MIXEDPRECISIONFIT_HH
+#define MIXEDPRECISIONFIT_HH
+
+#include <cstddef>
+
+// Result of a mixed-precision Gaussian fit
+// Parameters are (A, m, sigma, B) for y(x) = A * exp(-(x-m)^2/(2*sigma^2)) + B
+struct MixedPrecisionFitResult {
+    double params[4];
+    double cost;            // 0.5 * sum(((y_fit - y) / uncertainty)^2), same convention as Ceres
+    int float_iterations;   // Accepted single-precision LM steps
+    int double_iterations;  // Accepted double-precision polish steps
+    bool converged;
+    
+    MixedPrecisionFitResult() : params{0, 0, 0, 0}, cost(0), float_iterations(0),
+                                double_iterations(0), converged(false) {}
+};
+
+// Bounded Levenberg-Marquardt fit of the 1D Gaussian model
+// Iterates in single precision on normalized data (x in units of the initial sigma around the initial
+// center, y in units of the uncertainty), then polishes with a few double-precision steps.
+// Returns false if the single-precision stage does not converge, including a stall without an accepted
+// step or away from a stationary point (caller falls back to Ceres).
+// The normalized copies of the data live on the calling thread's event arena.
+bool FitGaussian1DMixedPrecision(const double* x_vals,
+                                 const double* y_vals,
+                                 size_t num_points,
+                                 double uncertainty,
+                                 const double initial[4],
+                                 const double lower[4],
+                                 const double upper[4],
+                                 MixedPrecisionFitResult& result);
+
+#endif // MIXEDPRECISIONFIT_HH
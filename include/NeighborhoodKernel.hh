@@ -0,0 +1,63 @@
+#ifndef NEIGHBORHOODKERNEL_HH
+#define NEIGHBORHOODKERNEL_HH
+
+#include "globals.hh"
+#include "ChargeSharingWeightTable.hh"
+
+#include <vector>
+
+// =============================================
+// FUSED NEIGHBORHOOD KERNEL
+// =============================================
+// Distances, pad angles α and unnormalized charge sharing weights α * ln(d/d0)^(-1) for the
+// (2r+1)x(2r+1) pixel grid around the hit pixel, in one pass (column-major: column outer, row inner).
+// Radius 4 to 10 runs a compile-time grid size with stack scratch; other radii use member vectors.
+
+// Detector geometry and model parameters the kernel needs (lengths in Geant4 units)
+struct NeighborhoodKernelGeometry {
+    G4double pixelSize;
+    G4double pixelSpacing;
+    G4double pixelCornerOffset;
+    G4double detSize;
+    G4int numBlocksPerSide;
+    G4double d0;                        // Charge sharing reference distance
+    G4int tableRadius;                  // Largest radius in use (sizes the weight table)
+};
+
+class NeighborhoodKernel
+{
+public:
+    // Output arrays must hold (2r+1)^2 values; out-of-bounds pixels get weight -1
+    void Compute(const NeighborhoodKernelGeometry& geometry, G4double hitX, G4double hitY,
+                 G4int hitPixelI, G4int hitPixelJ, G4int radius,
+                 G4double* distances, G4double* alphas, G4double* weights);
+
+    // Same result through the runtime grid size for every radius (reference for the benchmark)
+    void ComputeRuntime(const NeighborhoodKernelGeometry& geometry, G4double hitX, G4double hitY,
+                        G4int hitPixelI, G4int hitPixelJ, G4int radius,
+                        G4double* distances, G4double* alphas, G4double* weights);
+
+private:
+    template <G4int Radius>
+    void ComputeFixed(const NeighborhoodKernelGeometry& geometry, G4double hitX, G4double hitY,
+                      G4int hitPixelI, G4int hitPixelJ,
+                      G4double* distances, G4double* alphas, G4double* weights);
+
+    // Kernel body; GridSize = 2r+1 for fixed instantiations, 0 for a runtime grid size
+    template <G4int GridSize>
+    void Evaluate(const NeighborhoodKernelGeometry& geometry, G4double hitX, G4double hitY,
+                  G4int hitPixelI, G4int hitPixelJ, G4int radius,
+                  G4double* columnDX, G4double* rowDY, G4double* columnValid, G4double* rowValid,
+                  G4double* distances, G4double* alphas, G4double* weights);
+
+    // Per-axis scratch of the runtime path (capacity persists across events)
+    std::vector<G4double> fColumnDX;    // Hit x - pixel center x for each grid column
+    std::vector<G4double> fRowDY;       // Hit y - pixel center y for each grid row
+    std::vector<G4double> fColumnValid; // 1 if the grid column is inside the detector, else 0
+    std::vector<G4double> fRowValid;    // 1 if the grid row is inside the detector, else 0
+
+    // Precomputed radial weight table (per thread, rebuilt lazily when geometry or range changes)
+    ChargeSharingWeightTable fWeightTable;
+};
+
+#endif // NEIGHBORHOODKERNEL_HH
@@ -0,0 +1,134 @@
+#ifndef POWERLORENTZIANCOST_HH
+#define POWERLORENTZIANCOST_HH
+
+#include "ceres/ceres.h"
+
+#include <cmath>
+
+// Residual of one Power-Law Lorentzian data point, (A / (1 + ((x-m)/γ)^2)^β + B - y) / σ,
+// as an AutoDiff functor (reference) and with a hand-derived Jacobian. Shared by the 2D fitter and
+// the derivative test (tests/PowerLorentzianDerivativeTest.cc).
+
+// Power-Law Lorentzian cost function
+// Function form: y(x) = A / (1 + ((x-m)/gamma)^2)^beta + B
+struct PowerLorentzianCostFunction {
+    PowerLorentzianCostFunction(double x, double y, double uncertainty) 
+        : x_(x), y_(y), uncertainty_(uncertainty) {}
+    
+    template <typename T>
+    bool operator()(const T* const params, T* residual) const {
+        // params[0] = A (amplitude)
+        // params[1] = m (center)
+        // params[2] = gamma (width parameter, like HWHM)
+        // params[3] = beta (power exponent)
+        // params[4] = B (baseline)
+        
+        const T& A = params[0];
+        const T& m = params[1];
+        const T& gamma = params[2];
+        const T& beta = params[3];
+        const T& B = params[4];
+        
+        // Robust handling of gamma (prevent division by zero)
+        T safe_gamma = ceres::abs(gamma);
+        if (safe_gamma < T(1e-12)) {
+            safe_gamma = T(1e-12);
+        }
+        
+        // Ensure beta stability (positive values)
+        T safe_beta = ceres::abs(beta);
+        if (safe_beta < T(0.1)) {
+            safe_beta = T(0.1);
+        }
+        
+        // Power-Law Lorentzian function: y(x) = A / (1 + ((x - m) / γ)^2)^β + B
+        T dx = x_ - m;
+        T normalized_dx = dx / safe_gamma;
+        T denominator_base = T(1.0) + normalized_dx * normalized_dx;
+        
+        // Prevent numerical issues with very small denominators
+        if (denominator_base < T(1e-12)) {
+            denominator_base = T(1e-12);
+        }
+        
+        // Apply power exponent
+        T denominator = ceres::pow(denominator_base, safe_beta);
+        T predicted = A / denominator + B;
+        
+        // Residual divided by uncertainty (standard weighted least squares) - same as Lorentzian
+        residual[0] = (predicted - T(y_)) / T(uncertainty_);
+        
+        return true;
+    }
+    
+    static ceres::CostFunction* Create(double x, double y, double uncertainty) {
+        return (new ceres::AutoDiffCostFunction<PowerLorentzianCostFunction, 1, 5>(
+            new PowerLorentzianCostFunction(x, y, uncertainty)));
+    }
+    
+private:
+    const double x_;
+    const double y_;
+    const double uncertainty_;
+};
+
+// Power-Law Lorentzian cost function with hand-derived Jacobian
+// Same model, guards and residual as PowerLorentzianCostFunction, but D^(-β) is formed as exp(-β ln D)
+// with ln D computed once and shared by the value and the β derivative (AutoDiff's pow on Jets pays a
+// log and an exp per derivative lane). With D = 1 + u, u = ((x-m)/γ)^2 and f = A D^(-β):
+//   df/dA = D^(-β),  df/dm = -β f/D * du/dm,  df/dγ = -β f/D * du/dγ,  df/dβ = -f ln D,  df/dB = 1
+class PowerLorentzianAnalyticCostFunction : public ceres::SizedCostFunction<1, 5> {
+public:
+    PowerLorentzianAnalyticCostFunction(double x, double y, double uncertainty)
+        : x_(x), y_(y), inv_uncertainty_(1.0 / uncertainty) {}
+    
+    bool Evaluate(double const* const* parameters, double* residuals, double** jacobians) const override {
+        const double* params = parameters[0];
+        const double A = params[0];
+        const double m = params[1];
+        const double B = params[4];
+        
+        // Guards as in the AutoDiff form; a clamped parameter has zero derivative
+        double safe_gamma = std::abs(params[2]);
+        double gamma_sign = (params[2] < 0) ? -1.0 : 1.0;
+        if (safe_gamma < 1e-12) {
+            safe_gamma = 1e-12;
+            gamma_sign = 0.0;
+        }
+        double safe_beta = std::abs(params[3]);
+        double beta_sign = (params[3] < 0) ? -1.0 : 1.0;
+        if (safe_beta < 0.1) {
+            safe_beta = 0.1;
+            beta_sign = 0.0;
+        }
+        
+        const double dx = x_ - m;
+        const double inv_gamma2 = 1.0 / (safe_gamma * safe_gamma);
+        const double u = dx * dx * inv_gamma2;
+        const double denominator_base = 1.0 + u;  // >= 1, no small-denominator guard needed
+        const double log_base = std::log(denominator_base);
+        const double power = std::exp(-safe_beta * log_base);  // D^(-β)
+        const double f = A * power;
+        
+        residuals[0] = (f + B - y_) * inv_uncertainty_;
+        
+        if (jacobians && jacobians[0]) {
+            double* J = jacobians[0];
+            const double k = -safe_beta * f / denominator_base * inv_uncertainty_;
+            J[0] = power * inv_uncertainty_;
+            J[1] = k * (-2.0 * dx * inv_gamma2);
+            J[2] = k * (-2.0 * u / safe_gamma) * gamma_sign;
+            J[3] = -f * log_base * beta_sign * inv_uncertainty_;
+            J[4] = inv_uncertainty_;
+        }
+        
+        return true;
+    }
+    
+private:
+    const double x_;
+    const double y_;
+    const double inv_uncertainty_;
+};
+
+#endif // POWERLORENTZIANCOST_HH
@@ -0,0 +1,44 @@
+#ifndef RESIDUALMAPS_HH
+#define RESIDUALMAPS_HH
+
+#include "globals.hh"
+#include "G4VAccumulable.hh"
+#include "EventRecord.hh"
+
+#include <memory>
+#include <vector>
+
+class TDirectory;
+class TProfile2D;
+
+// =============================================
+// ONLINE SUB-PIXEL RESIDUAL MAPS
+// =============================================
+// Mean and spread of the x/y residuals of every enabled reconstruction method against the true
+// position relative to the nearest pixel center, in fixed-size per-thread TProfile2D maps (not
+// attached to any ROOT directory) merged by G4AccumulableManager. Position-dependent bias shows up
+// without storing per-event data; the maps are the input of a sub-pixel calibration.
+class ResidualMapAccumulable : public G4VAccumulable
+{
+public:
+    ResidualMapAccumulable();
+    ~ResidualMapAccumulable() override;
+
+    // (Re)create the maps over one pixel pitch, [-pitch/2, pitch/2) on both axes (start of run)
+    void Book(G4double pixelSpacing);
+
+    // Residuals of one filled record (after FillTree's derived-quantity stage)
+    void Fill(const EventRecord& record);
+
+    void Merge(const G4VAccumulable& other) override;
+    void Reset() override;
+
+    // Write per method and axis the mean map (TProfile2D, spread option) and the RMS map (TH2D)
+    void Write(TDirectory* directory) const;
+
+private:
+    // Per method: residual X map, residual Y map (EnabledReconstructionMethods() order)
+    std::vector<std::unique_ptr<TProfile2D>> fMaps;
+};
+
+#endif // RESIDUALMAPS_HH
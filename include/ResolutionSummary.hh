@@ -0,0 +1,105 @@
+#ifndef RESOLUTIONSUMMARY_HH
+#define RESOLUTIONSUMMARY_HH
+
+#include "globals.hh"
+#include "G4VAccumulable.hh"
+#include "EventRecord.hh"
+
+#include <string>
+#include <vector>
+
+// =============================================
+// ONLINE RESOLUTION SUMMARY
+// =============================================
+// Streaming statistics of the x/y residuals (reconstructed - true) of every enabled reconstruction
+// method, filled per thread from FillTree and merged across threads by G4AccumulableManager, so the
+// headline resolution numbers exist without reading the tree back (or with no per-event output at all).
+
+// Merging t-digest (Dunning): quantile sketch whose per-thread digests merge without loss of accuracy
+class TDigest
+{
+public:
+    explicit TDigest(G4double compression = 100.0);
+
+    void Add(G4double value, G4double weight = 1.0);
+    void Merge(const TDigest& other);
+    void Reset();
+
+    // Quantile estimate (NaN if empty), q in [0, 1]
+    G4double Quantile(G4double q) const;
+
+    G4double GetTotalWeight() const { return fTotal; }
+
+private:
+    struct Centroid {
+        G4double mean;
+        G4double weight;
+    };
+
+    void Compress();
+
+    G4double fCompression;
+    std::vector<Centroid> fCentroids;   // Sorted by mean after Compress()
+    std::vector<Centroid> fBuffer;      // Unmerged values
+    G4double fTotal;
+    G4double fMin, fMax;
+};
+
+// Count, Welford mean/variance and quantile digest of one residual
+struct ResidualStatistics {
+    G4long n = 0;
+    G4double mean = 0.0;
+    G4double m2 = 0.0;                  // Sum of squared deviations from the mean
+    TDigest digest;
+
+    explicit ResidualStatistics(G4double compression) : digest(compression) {}
+
+    void Add(G4double residual);
+    void Merge(const ResidualStatistics& other);   // Chan et al. pairwise update
+    void Reset();
+
+    G4double StdDev() const;            // Unbiased (n - 1)
+    G4double Rms() const;               // sqrt(mean of squares)
+};
+
+struct MethodResolution {
+    std::string name;                   // ReconstructionMethod::name
+    ResidualStatistics x, y;
+    G4long failures = 0;                // Attempted entries without a valid x or y residual
+
+    MethodResolution(const std::string& methodName, G4double compression)
+        : name(methodName), x(compression), y(compression) {}
+};
+
+// One accumulable for all methods; register it in every RunAction constructor (master and workers)
+class ResolutionAccumulable : public G4VAccumulable
+{
+public:
+    ResolutionAccumulable();
+
+    // Residuals of one filled record (after FillTree's derived-quantity stage)
+    void Fill(const EventRecord& record);
+
+    void Merge(const G4VAccumulable& other) override;
+    void Reset() override;
+
+    const std::vector<MethodResolution>& GetMethods() const { return fMethods; }
+    G4long GetEntries() const { return fEntries; }
+
+    // End-of-run table (bias, σ, RMS and central quantiles per method and axis, in µm)
+    void PrintSummary() const;
+
+    // Same table as plain text (used when the ROOT output is disabled)
+    G4bool WriteText(const std::string& fileName) const;
+
+private:
+    std::vector<MethodResolution> fMethods;   // EnabledReconstructionMethods() order
+    G4long fEntries;
+};
+
+// Quantiles stored per axis: median and the ±1σ / ±2σ equivalent points of a Gaussian
+const int kNumResolutionQuantiles = 5;
+extern const G4double kResolutionQuantiles[kNumResolutionQuantiles];
+extern const char* const kResolutionQuantileNames[kNumResolutionQuantiles];
+
+#endif // RESOLUTIONSUMMARY_HH
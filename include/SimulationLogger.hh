@@ -87,6 +87,17 @@ public:
     void LogConvergenceStatistics(const std::string& fitType, G4int totalAttempts,
                                  G4int convergences, G4double averageIterations);
     
+    // Lightweight per-model accumulation (no file I/O), summarized at simulation end
+    void RecordFitTiming(const std::string& fitType, G4double fittingTime, G4int numPoints, G4bool converged);
+    void RecordRegionOfInterest(G4int candidatePads, G4int selectedPads);
+    void RecordCoarseToFineStage(const std::string& fitType, G4int stage, G4double fittingTime,
+                                 G4double referenceTime);
+    void RecordSolverStatistics(G4long fits, G4long solves, G4long iterations, G4long fallbacks);
+    void RecordRawFrameReferenceStatistics(G4long fits, G4long solves, G4long iterations, G4long fallbacks);
+    void RecordBatchedFits(G4long fits, G4long converged, G4double fittingTime);
+    void RecordEventAllocations(G4long heapAllocations, G4long arenaBytes, G4long arenaOverflows);
+    void LogFitTimingSummary();
+    
     // Crash and recovery logging
     void LogCrashInfo(const std::string& signal, G4int eventID, const std::string& additionalInfo);
     void LogRecoveryInfo(G4int lastSavedEvent, G4int currentEvent, const std::string& backupFile);
@@ -161,6 +172,48 @@ private:
     std::map<std::string, G4int> fFitTypeCounters;
     std::map<std::string, G4double> fFitTypeTimings;
     std::map<std::string, G4int> fConvergenceCounters;
+    std::map<std::string, G4long> fFitTypePointCounts;
+    
+    // Region of interest statistics
+    G4long fROIEvents;
+    G4long fROICandidatePads;
+    G4long fROISelectedPads;
+    
+    // Coarse-to-fine 3D fit statistics per fit type
+    struct CoarseToFineStats {
+        G4long stageCounts[4] = {0, 0, 0, 0};  // Indexed by CoarseToFineStage
+        G4double totalTime = 0.0;
+        G4long referenceSamples = 0;
+        G4double sampledTime = 0.0;            // Coarse-to-fine time on the sampled events
+        G4double referenceTime = 0.0;          // Plain full-grid time on the same events
+    };
+    std::map<std::string, CoarseToFineStats> fCoarseToFineStats;
+    
+    // Ceres solver work over all fits (solves, minimizer iterations, escalations to expensive configs)
+    G4long fSolverFits;
+    G4long fSolverSolves;
+    G4long fSolverIterations;
+    G4long fSolverFallbacks;
+    
+    // Same counters for the sampled raw-frame reference solves (before/after the normalized frame)
+    G4long fReferenceFits;
+    G4long fReferenceSolves;
+    G4long fReferenceIterations;
+    G4long fReferenceFallbacks;
+
+    // Batched Gaussian row/column fits (fits, converged lanes, summed per-thread fitting time [ms])
+    G4long fBatchedFitBatches;
+    G4long fBatchedFits;
+    G4long fBatchedFitsConverged;
+    G4double fBatchedFitTime;
+    
+    // Per-event heap calls (operator new on the worker thread) and arena use
+    G4long fAllocationEvents;
+    G4long fHeapAllocations;
+    G4long fMaxHeapAllocations;
+    G4long fZeroHeapAllocationEvents;
+    G4long fArenaBytes;
+    G4long fArenaOverflows;
 };
 
 #endif // SIMULATION_LOGGER_HH 
\ No newline at end of file
@@ -1,8 +1,13 @@
 #ifndef STATSUTILS_HH
 #define STATSUTILS_HH
 
+#include "EventArena.hh"
+
 #include <vector>
 #include <cmath>
+#include <cstddef>
+#include <tuple>
+#include <utility>
 
 // Robust statistics for 1D data
 struct RobustStats1D {
@@ -62,4 +67,57 @@ std::tuple<std::vector<double>, std::vector<double>, std::vector<double>> Filter
     double sigma_threshold = 3.0,
     bool verbose = false);
 
+// Robust statistics of one fit dataset, computed once and shared by the parameter guess, every
+// outlier-filter level and every solver configuration. Filtered datasets are index masks over the
+// original arrays, which must outlive the analysis. Charges are the fitted values (y for 1D, z for 3D).
+struct DatasetAnalysis {
+    const std::vector<double>* x_vals;
+    const std::vector<double>* y_vals;   // nullptr for 1D datasets
+    const std::vector<double>* charges;
+    std::vector<size_t> indices;         // Points of this dataset
+    
+    double mean;
+    double median;
+    double std_dev;
+    double mad;  // Median Absolute Deviation (scaled by 1.4826)
+    double q25, q75;  // Quartiles
+    double min_val, max_val;
+    double weighted_mean_x;  // Charge-above-Q1 weighted position
+    double weighted_mean_y;
+    double total_weight;
+    bool valid;
+    
+    DatasetAnalysis() : x_vals(nullptr), y_vals(nullptr), charges(nullptr), mean(0), median(0), std_dev(0),
+                        mad(0), q25(0), q75(0), min_val(0), max_val(0), weighted_mean_x(0),
+                        weighted_mean_y(0), total_weight(0), valid(false) {}
+};
+
+// Analyze all points of a 1D (position, charge) or 3D (x, y, charge) dataset
+DatasetAnalysis AnalyzeDataset(const std::vector<double>& x_vals,
+                               const std::vector<double>& charges);
+DatasetAnalysis AnalyzeDataset(const std::vector<double>& x_vals,
+                               const std::vector<double>& y_vals,
+                               const std::vector<double>& charges);
+
+// Analyze a subset of the parent's points (reuses the parent when the subset is all of it)
+DatasetAnalysis AnalyzeSubset(const DatasetAnalysis& parent, const std::vector<size_t>& indices);
+
+// MAD outlier mask: points with charge within median ± sigma_threshold·MAD. Relaxes to
+// relaxed_threshold if more than half the points would go, and keeps every point if fewer
+// than min_points survive.
+std::vector<size_t> SelectOutlierFreeIndices(const DatasetAnalysis& analysis,
+                                             double sigma_threshold,
+                                             double relaxed_threshold,
+                                             size_t min_points,
+                                             bool verbose = false);
+
+// Copy the dataset's points into contiguous arrays for the solver (per-event arena vectors)
+void GatherDataset(const DatasetAnalysis& analysis,
+                   ArenaDoubleVector& x_out,
+                   ArenaDoubleVector& charge_out);
+void GatherDataset(const DatasetAnalysis& analysis,
+                   ArenaDoubleVector& x_out,
+                   ArenaDoubleVector& y_out,
+                   ArenaDoubleVector& charge_out);
+
 #endif // STATSUTILS_HH 
\ No newline at end of file
@@ -584,6 +584,9 @@ class RandomHitChargeGridGenerator:
         # Find events with energy deposition for charge sharing
         edep = self.data['Edep']
         energy_mask = edep > 0
+        # With sampled grid storage only entries flagged HasGridData carry the neighborhood vectors
+        if 'HasGridData' in self.data:
+            energy_mask &= self.data['HasGridData']
         energy_indices = np.where(energy_mask)[0]
         
         if len(energy_indices) == 0:
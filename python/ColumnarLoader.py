@@ -0,0 +1,111 @@
+#!/usr/bin/env python3
+"""
+Zero-copy loader for the flat columnar output (epicChargeSharingOutput.cols)
+
+Written by the simulation when Constants::ENABLE_COLUMNAR_OUTPUT is true. Every scalar branch of
+the "Hits" and "EventIndex" trees is stored as one uncompressed, contiguous, aligned column in the
+same entry order as "Hits", so each column is returned as a read-only numpy.memmap: nothing is
+read or decompressed until the values are used.
+
+File layout (little-endian):
+    "ECSCOLS1", uint64 header size, uint64 entries, uint32 columns, uint32 metadata pairs
+    metadata pairs:  string key, string value          (string = uint32 length + bytes)
+    columns:         string name, string title, char type ('d', 'i', '?'), uint64 data offset
+
+Usage:
+    from ColumnarLoader import load_columns
+    cols = load_columns("epicChargeSharingOutput.cols")
+    dx = cols["GaussRowDeltaX"]                     # numpy.memmap of float64
+    pixel_size = float(cols.metadata["GridPixelSize_mm"])
+
+    python ColumnarLoader.py [COLS_FILE]           # print the schema and metadata
+"""
+
+import struct
+import sys
+
+import numpy as np
+
+MAGIC = b"ECSCOLS1"
+DTYPES = {b"d": np.dtype("<f8"), b"i": np.dtype("<i4"), b"?": np.dtype("?")}
+
+
+class ColumnarFile:
+    """Columns of one .cols file, mapped on first access (dict-like, keyed by branch name)."""
+
+    def __init__(self, path):
+        self.path = path
+        self.metadata = {}
+        self.titles = {}
+        self._layout = {}
+        self._columns = {}
+
+        with open(path, "rb") as f:
+            if f.read(len(MAGIC)) != MAGIC:
+                raise ValueError(f"{path} is not a columnar output file")
+            header_bytes, self.entries, n_columns, n_metadata = struct.unpack("<QQII", f.read(24))
+            header = f.read(header_bytes - len(MAGIC) - 24)
+
+        pos = 0
+
+        def read_string():
+            nonlocal pos
+            (size,) = struct.unpack_from("<I", header, pos)
+            value = header[pos + 4:pos + 4 + size].decode("utf-8")
+            pos += 4 + size
+            return value
+
+        for _ in range(n_metadata):
+            key = read_string()
+            self.metadata[key] = read_string()
+        for _ in range(n_columns):
+            name = read_string()
+            self.titles[name] = read_string()
+            type_code = header[pos:pos + 1]
+            (offset,) = struct.unpack_from("<Q", header, pos + 1)
+            pos += 9
+            self._layout[name] = (DTYPES[type_code], offset)
+
+    def __getitem__(self, name):
+        if name not in self._columns:
+            dtype, offset = self._layout[name]
+            if self.entries == 0:
+                self._columns[name] = np.empty(0, dtype=dtype)
+            else:
+                self._columns[name] = np.memmap(self.path, dtype=dtype, mode="r",
+                                                offset=offset, shape=(self.entries,))
+        return self._columns[name]
+
+    def __contains__(self, name):
+        return name in self._layout
+
+    def __len__(self):
+        return len(self._layout)
+
+    def __iter__(self):
+        return iter(self._layout)
+
+    def keys(self):
+        return self._layout.keys()
+
+    def dtype(self, name):
+        return self._layout[name][0]
+
+
+def load_columns(path):
+    """Open a .cols file; columns are memory-mapped on access."""
+    return ColumnarFile(path)
+
+
+def main():
+    path = sys.argv[1] if len(sys.argv) > 1 else "../build/epicChargeSharingOutput.cols"
+    cols = load_columns(path)
+    print(f"{path}: {cols.entries} entries, {len(cols)} columns")
+    for key, value in cols.metadata.items():
+        print(f"  {key} = {value}")
+    for name in cols:
+        print(f"  {name:40s} {str(cols.dtype(name)):8s} {cols.titles[name]}")
+
+
+if __name__ == "__main__":
+    main()
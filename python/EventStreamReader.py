@@ -0,0 +1,116 @@
+#!/usr/bin/env python3
+"""
+Live consumer of the binary event stream (Constants::ENABLE_EVENT_STREAM)
+
+Reads the stream header and the length-prefixed per-event records (layout in
+include/EventStream.hh) and prints running resolution numbers per reconstruction method:
+count, bias and RMS of the x/y residuals (reconstructed - true).
+
+Usage:
+    python EventStreamReader.py fifo:epicChargeSharingStream   # named pipe (start before or after the run)
+    python EventStreamReader.py unix:/tmp/ecs.sock              # listens; start before the simulation
+    ./epicChargeSharing ... | python EventStreamReader.py -      # target "stdout"
+"""
+
+import math
+import os
+import socket
+import struct
+import sys
+
+MAGIC = b"ECSSTRM1"
+EVENT_HEADER = struct.Struct("<iiff")
+
+
+def open_source(source):
+    """Binary file object for '-', 'fifo:<path>', 'unix:<path>' or a plain file path."""
+    if source == "-":
+        return sys.stdin.buffer
+    if source.startswith("unix:"):
+        path = source[5:]
+        if os.path.exists(path):
+            os.remove(path)
+        server = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        server.bind(path)
+        server.listen(1)
+        print(f"Listening on {path}", file=sys.stderr)
+        connection, _ = server.accept()
+        return connection.makefile("rb")
+    path = source[5:] if source.startswith("fifo:") else source
+    if source.startswith("fifo:") and not os.path.exists(path):
+        os.mkfifo(path)
+    return open(path, "rb")
+
+
+def read_exact(stream, size):
+    data = stream.read(size)
+    return data if data is not None and len(data) == size else None
+
+
+class RunningResidual:
+    """Count, mean and variance of one residual (Welford)."""
+
+    def __init__(self):
+        self.n = 0
+        self.mean = 0.0
+        self.m2 = 0.0
+
+    def add(self, value):
+        if math.isnan(value):
+            return
+        self.n += 1
+        delta = value - self.mean
+        self.mean += delta / self.n
+        self.m2 += delta * (value - self.mean)
+
+    def rms(self):
+        return math.sqrt(self.m2 / self.n + self.mean ** 2) if self.n > 0 else float("nan")
+
+
+def print_summary(events, methods, residuals):
+    print(f"\n{events} events")
+    print(f"  {'method':24s} {'N':>10s} {'bias X [um]':>12s} {'RMS X [um]':>11s} {'bias Y [um]':>12s} {'RMS Y [um]':>11s}")
+    for name, (rx, ry) in zip(methods, residuals):
+        print(f"  {name:24s} {rx.n:10d} {rx.mean * 1000:12.3f} {rx.rms() * 1000:11.2f} "
+              f"{ry.mean * 1000:12.3f} {ry.rms() * 1000:11.2f}")
+    sys.stdout.flush()
+
+
+def main():
+    source = sys.argv[1] if len(sys.argv) > 1 else "fifo:epicChargeSharingStream"
+    every = int(sys.argv[2]) if len(sys.argv) > 2 else 10000
+    stream = open_source(source)
+
+    if read_exact(stream, len(MAGIC)) != MAGIC:
+        sys.exit("Not an event stream")
+    (n_methods,) = struct.unpack("<I", read_exact(stream, 4))
+    methods = []
+    for _ in range(n_methods):
+        (size,) = struct.unpack("<I", read_exact(stream, 4))
+        methods.append(read_exact(stream, size).decode("utf-8"))
+
+    positions = struct.Struct(f"<{2 * n_methods}f")
+    residuals = [(RunningResidual(), RunningResidual()) for _ in methods]
+    events = 0
+    while True:
+        prefix = read_exact(stream, 4)
+        if prefix is None:
+            break
+        payload = read_exact(stream, struct.unpack("<I", prefix)[0])
+        if payload is None:
+            break
+        _, _, true_x, true_y = EVENT_HEADER.unpack_from(payload)
+        values = positions.unpack_from(payload, EVENT_HEADER.size)
+        for i, (rx, ry) in enumerate(residuals):
+            rx.add(values[2 * i] - true_x)
+            ry.add(values[2 * i + 1] - true_y)
+        events += 1
+        if events % every == 0:
+            print_summary(events, methods, residuals)
+
+    if events % every != 0 or events == 0:
+        print_summary(events, methods, residuals)
+
+
+if __name__ == "__main__":
+    main()
@@ -1,6 +1,11 @@
 #include "2DGaussianFitCeres.hh"
 #include "CeresLoggingInit.hh"
+#include "CeresUtils.hh"
+#include "EventArena.hh"
+#include "EscalationPolicy.hh"
+#include "StatsUtils.hh"
 #include "Constants.hh"
+#include "MixedPrecisionFit.hh"
 #include "G4SystemOfUnits.hh"
 
 #include <cmath>
@@ -117,101 +122,29 @@ struct DataStatistics {
     bool valid;
 };
 
-DataStatistics CalculateRobustStatistics(const std::vector<double>& x_vals, 
-                                        const std::vector<double>& y_vals) {
+// View of the per-dataset analysis (computed once in StatsUtils, no re-sorting here)
+DataStatistics CalculateRobustStatistics(const DatasetAnalysis& analysis) {
     DataStatistics stats;
-    stats.valid = false;
-    
-    if (x_vals.size() != y_vals.size() || x_vals.empty()) {
-        return stats;
-    }
-    
-    // Basic statistics
-    stats.min_val = *std::min_element(y_vals.begin(), y_vals.end());
-    stats.max_val = *std::max_element(y_vals.begin(), y_vals.end());
-    
-    // Mean and standard deviation
-    stats.mean = std::accumulate(y_vals.begin(), y_vals.end(), 0.0) / y_vals.size();
-    
-    double variance = 0.0;
-    for (double val : y_vals) {
-        variance += (val - stats.mean) * (val - stats.mean);
-    }
-    stats.std_dev = std::sqrt(variance / y_vals.size());
-    
-    // Median and quartiles
-    std::vector<double> sorted_y = y_vals;
-    std::sort(sorted_y.begin(), sorted_y.end());
-    
-    size_t n = sorted_y.size();
-    if (n % 2 == 0) {
-        stats.median = (sorted_y[n/2 - 1] + sorted_y[n/2]) / 2.0;
-    } else {
-        stats.median = sorted_y[n/2];
-    }
-    
-    stats.q25 = sorted_y[n/4];
-    stats.q75 = sorted_y[3*n/4];
-    
-    // Fast median-of-absolute-deviations using nth_element (O(n))
-    std::vector<double> abs_deviations;
-    abs_deviations.reserve(y_vals.size());
-    for (double val : y_vals) {
-        abs_deviations.push_back(std::abs(val - stats.median));
-    }
-
-    std::nth_element(abs_deviations.begin(), abs_deviations.begin() + n/2, abs_deviations.end());
-    double mad_raw = abs_deviations[n/2];
-
-    // If even number of elements, average the two central values for better robustness
-    if (n % 2 == 0) {
-        double second_val;
-        std::nth_element(abs_deviations.begin(), abs_deviations.begin() + n/2 - 1, abs_deviations.end());
-        second_val = abs_deviations[n/2 - 1];
-        mad_raw = 0.5 * (mad_raw + second_val);
-    }
-
-    stats.mad = mad_raw * 1.4826; // Consistency factor for normal distribution
-    
-    // ------------------------------------------------------------------------------------
-    // Numerical stability safeguard: ensure MAD is positive and finite
-    // A zero or non-finite MAD leads to divide-by-zero or NaN weights which break the fit.
-    // If MAD is too small (or not finite), fall back to the standard deviation or
-    // a small positive epsilon value.
-    // ------------------------------------------------------------------------------------
-    if (!std::isfinite(stats.mad) || stats.mad < 1e-12) {
-        stats.mad = (std::isfinite(stats.std_dev) && stats.std_dev > 1e-12) ?
-                    stats.std_dev : 1e-12;
-    }
-    
-    // Weighted statistics (weight by charge value for position estimation)
-    stats.weighted_mean = 0.0;
-    stats.total_weight = 0.0;
-    
-    for (size_t i = 0; i < x_vals.size(); ++i) {
-        double weight = std::max(0.0, y_vals[i] - stats.q25); // Use values above Q1 as weights
-        if (weight > 0) {
-            stats.weighted_mean += x_vals[i] * weight;
-            stats.total_weight += weight;
-        }
-    }
-    
-    if (stats.total_weight > 0) {
-        stats.weighted_mean /= stats.total_weight;
-        stats.robust_center = stats.weighted_mean;
-    } else {
-        stats.weighted_mean = std::accumulate(x_vals.begin(), x_vals.end(), 0.0) / x_vals.size();
-        stats.robust_center = stats.weighted_mean;
-    }
-    
-    stats.valid = true;
+    stats.mean = analysis.mean;
+    stats.median = analysis.median;
+    stats.std_dev = analysis.std_dev;
+    stats.mad = analysis.mad;
+    stats.q25 = analysis.q25;
+    stats.q75 = analysis.q75;
+    stats.min_val = analysis.min_val;
+    stats.max_val = analysis.max_val;
+    stats.weighted_mean = analysis.weighted_mean_x;
+    stats.total_weight = analysis.total_weight;
+    stats.robust_center = analysis.weighted_mean_x;
+    stats.valid = analysis.valid;
     return stats;
 }
 
 // Multiple parameter estimation strategies
 ParameterEstimates EstimateGaussianParameters(
-    const std::vector<double>& x_vals,
-    const std::vector<double>& y_vals,
+    const ArenaDoubleVector& x_vals,
+    const ArenaDoubleVector& y_vals,
+    const DatasetAnalysis& analysis,
     double center_estimate,
     double pixel_spacing,
     bool verbose = false) {
@@ -225,7 +158,7 @@ ParameterEstimates EstimateGaussianParameters(
     }
     
     // Calculate robust statistics
-    DataStatistics stats = CalculateRobustStatistics(x_vals, y_vals);
+    DataStatistics stats = CalculateRobustStatistics(analysis);
     if (!stats.valid) {
         return estimates;
     }
@@ -316,78 +249,6 @@ ParameterEstimates EstimateGaussianParameters(
     return estimates;
 }
 
-// Enhanced outlier filtering with multiple strategies
-std::pair<std::vector<double>, std::vector<double>> FilterOutliers(
-    const std::vector<double>& x_vals,
-    const std::vector<double>& y_vals,
-    double sigma_threshold = 2.5,
-    bool verbose = false) {
-    
-    std::vector<double> filtered_x, filtered_y;
-    
-    if (x_vals.size() != y_vals.size() || x_vals.size() < 3) {
-        return std::make_pair(filtered_x, filtered_y);
-    }
-    
-    DataStatistics stats = CalculateRobustStatistics(x_vals, y_vals);
-    if (!stats.valid) {
-        return std::make_pair(x_vals, y_vals); // Return original if stats fail
-    }
-    
-    // Use MAD-based outlier detection (more robust than standard deviation)
-    double outlier_threshold = stats.median + sigma_threshold * stats.mad;
-    double lower_threshold = stats.median - sigma_threshold * stats.mad;
-    
-    int outliers_removed = 0;
-    for (size_t i = 0; i < y_vals.size(); ++i) {
-        // Keep points that are within the robust bounds
-        if (y_vals[i] >= lower_threshold && y_vals[i] <= outlier_threshold) {
-            filtered_x.push_back(x_vals[i]);
-            filtered_y.push_back(y_vals[i]);
-        } else {
-            outliers_removed++;
-        }
-    }
-    
-    // If too many outliers were removed, use a more lenient approach
-    if (filtered_x.size() < x_vals.size() / 2) {
-        if (verbose) {
-            std::cout << "Too many outliers detected (" << outliers_removed 
-                     << "), using lenient filtering" << std::endl;
-        }
-        
-        filtered_x.clear();
-        filtered_y.clear();
-        
-        // Just remove extreme outliers (beyond 4-sigma)
-        double extreme_threshold = stats.median + 4.0 * stats.mad;
-        double extreme_lower = stats.median - 4.0 * stats.mad;
-        
-        for (size_t i = 0; i < y_vals.size(); ++i) {
-            if (y_vals[i] >= extreme_lower && y_vals[i] <= extreme_threshold) {
-                filtered_x.push_back(x_vals[i]);
-                filtered_y.push_back(y_vals[i]);
-            }
-        }
-    }
-    
-    // Ensure we have enough points for fitting
-    if (filtered_x.size() < 4) {
-        if (verbose) {
-            std::cout << "Warning: After outlier filtering, only " << filtered_x.size() 
-                     << " points remain" << std::endl;
-        }
-        return std::make_pair(x_vals, y_vals); // Return original data
-    }
-    
-    if (verbose && outliers_removed > 0) {
-        std::cout << "Removed " << outliers_removed << " outliers, " 
-                 << filtered_x.size() << " points remaining" << std::endl;
-    }
-    
-    return std::make_pair(filtered_x, filtered_y);
-}
-
 
 
 
@@ -437,7 +298,7 @@ std::pair<std::vector<double>, std::vector<double>> FilterOutliers(
 // - Thread-safe implementation with comprehensive error handling
 //
 // Ultra-robust Gaussian fitting with multiple strategies
-bool FitGaussianCeres(
+static bool FitGaussianCeresRaw(
     const std::vector<double>& x_vals,
     const std::vector<double>& y_vals,
     double center_estimate,
@@ -452,7 +313,8 @@ bool FitGaussianCeres(
     double& fit_offset_err,
     double& chi2_reduced,
     bool verbose,
-    bool enable_outlier_filtering) {
+    bool enable_outlier_filtering,
+    const double* initial_params) {
     
     if (x_vals.size() != y_vals.size() || x_vals.size() < 4) {
         if (verbose) {
@@ -461,25 +323,30 @@ bool FitGaussianCeres(
         return false;
     }
     
-    // Multiple outlier filtering strategies (conditional based on user preference)
-    std::vector<std::pair<std::vector<double>, std::vector<double>>> filtered_datasets;
+    // Robust statistics of the input, computed once and shared by every filter level and config
+    DatasetAnalysis full_analysis = AnalyzeDataset(x_vals, y_vals);
+    
+    // Multiple outlier filtering strategies, as index masks over the input
+    std::vector<std::vector<size_t>> filtered_datasets;
     
     if (enable_outlier_filtering) {
-        // Strategy 1: Conservative filtering (2.5-sigma)
-        auto conservative_data = FilterOutliers(x_vals, y_vals, 2.5, verbose);
-        if (conservative_data.first.size() >= 4) {
+        // Conservative filtering (2.5-sigma)
+        std::vector<size_t> conservative_data = SelectOutlierFreeIndices(full_analysis, 2.5, 4.0, 4, verbose);
+        if (conservative_data.size() >= 4) {
             filtered_datasets.push_back(conservative_data);
         }
         
-        // Strategy 2: Lenient filtering (3.0-sigma)
-        auto lenient_data = FilterOutliers(x_vals, y_vals, 3.0, verbose);
-        if (lenient_data.first.size() >= 4) {
+        // Lenient filtering (3.0-sigma)
+        std::vector<size_t> lenient_data = SelectOutlierFreeIndices(full_analysis, 3.0, 4.0, 4, verbose);
+        if (lenient_data.size() >= 4 && lenient_data != conservative_data) {
             filtered_datasets.push_back(lenient_data);
         }
     }
     
-    // Strategy 3: No filtering (use all data) - always available as fallback
-    filtered_datasets.push_back(std::make_pair(x_vals, y_vals));
+    // No filtering (use all data) - always available as fallback, unless a filter kept every point
+    if (filtered_datasets.empty() || filtered_datasets.back() != full_analysis.indices) {
+        filtered_datasets.push_back(full_analysis.indices);
+    }
     
     if (verbose) {
         std::cout << "Outlier filtering " << (enable_outlier_filtering ? "enabled" : "disabled") 
@@ -488,17 +355,19 @@ bool FitGaussianCeres(
     
     // Try each filtered dataset
     for (size_t dataset_idx = 0; dataset_idx < filtered_datasets.size(); ++dataset_idx) {
-        std::vector<double> clean_x = filtered_datasets[dataset_idx].first;
-        std::vector<double> clean_y = filtered_datasets[dataset_idx].second;
+        if (filtered_datasets[dataset_idx].size() < 4) continue;
         
-        if (clean_x.size() < 4) continue;
+        // Statistics of this subset (the unfiltered set reuses the full analysis); solver input gathered once
+        DatasetAnalysis analysis = AnalyzeSubset(full_analysis, filtered_datasets[dataset_idx]);
+        ArenaDoubleVector clean_x(GetEventArena()), clean_y(GetEventArena());
+        GatherDataset(analysis, clean_x, clean_y);
         
         if (verbose) {
             std::cout << "Trying dataset " << dataset_idx << " with " << clean_x.size() << " points" << std::endl;
         }
         
         // Get parameter estimates
-        ParameterEstimates estimates = EstimateGaussianParameters(clean_x, clean_y, center_estimate, pixel_spacing, verbose);
+        ParameterEstimates estimates = EstimateGaussianParameters(clean_x, clean_y, analysis, center_estimate, pixel_spacing, verbose);
         if (!estimates.valid) {
             if (verbose) {
                 std::cout << "Parameter estimation failed for dataset " << dataset_idx << std::endl;
@@ -506,6 +375,21 @@ bool FitGaussianCeres(
             continue;
         }
         
+        // Warm start: seed the base guess with a previous solution (A, m, sigma, B) when one is supplied
+        if (initial_params && initial_params[0] > 0 && initial_params[2] > 0 &&
+            !std::isnan(initial_params[1]) && !std::isnan(initial_params[3])) {
+            estimates.amplitude = initial_params[0];
+            estimates.center = initial_params[1];
+            estimates.sigma = std::max(pixel_spacing * 0.2, std::min(pixel_spacing * 2.0, initial_params[2]));
+            estimates.offset = initial_params[3];
+            
+            if (verbose) {
+                std::cout << "Warm start: A=" << estimates.amplitude 
+                         << ", m=" << estimates.center << ", sigma=" << estimates.sigma 
+                         << ", B=" << estimates.offset << std::endl;
+            }
+        }
+        
         // Calculate uncertainty as 5% of max charge
         double max_charge = *std::max_element(clean_y.begin(), clean_y.end());
         double uncertainty = CalculateUncertainty(max_charge);
@@ -522,19 +406,20 @@ bool FitGaussianCeres(
             int max_iterations;
             std::string loss_function;
             double loss_parameter;
+            bool allow_mixed_precision;  // Base guess may use the mixed-precision solver
         };
         
         // Stage 1: Cheap configuration (as per optimize.md section 4.1)
         FittingConfig cheap_config = {
             ceres::DENSE_NORMAL_CHOLESKY, ceres::LEVENBERG_MARQUARDT, 
-            1e-10, 1e-10, 400, "NONE", 0.0
+            1e-10, 1e-10, 400, "NONE", 0.0, true
         };
         
         // Stage 2: Expensive fallback configurations (only if needed)
         const std::vector<FittingConfig> expensive_configs = {
-            {ceres::DENSE_QR, ceres::LEVENBERG_MARQUARDT, 1e-12, 1e-12, 1500, "HUBER", estimates.amplitude * 0.1},
-            {ceres::DENSE_QR, ceres::LEVENBERG_MARQUARDT, 1e-12, 1e-12, 1500, "CAUCHY", estimates.amplitude * 0.18},
-            {ceres::SPARSE_NORMAL_CHOLESKY, ceres::LEVENBERG_MARQUARDT, 1e-12, 1e-12, 1200, "CAUCHY", estimates.amplitude * 0.25}
+            {ceres::DENSE_QR, ceres::LEVENBERG_MARQUARDT, 1e-12, 1e-12, 1500, "HUBER", estimates.amplitude * 0.1, false},
+            {ceres::DENSE_QR, ceres::LEVENBERG_MARQUARDT, 1e-12, 1e-12, 1500, "CAUCHY", estimates.amplitude * 0.18, false},
+            {ceres::SPARSE_NORMAL_CHOLESKY, ceres::LEVENBERG_MARQUARDT, 1e-12, 1e-12, 1200, "CAUCHY", estimates.amplitude * 0.25, false}
         };
         
         // Try cheap config first
@@ -570,7 +455,7 @@ bool FitGaussianCeres(
             double best_chi2_reduced = std::numeric_limits<double>::max();
             
             // Data characteristics for adaptive bounds
-            DataStatistics data_stats = CalculateRobustStatistics(clean_x, clean_y);
+            DataStatistics data_stats = CalculateRobustStatistics(analysis);
             double data_spread = *std::max_element(clean_x.begin(), clean_x.end()) - 
                                *std::min_element(clean_x.begin(), clean_x.end());
             double outlier_ratio = 0.0;
@@ -591,16 +476,7 @@ bool FitGaussianCeres(
                 parameters[2] = guess.params[2];
                 parameters[3] = guess.params[3];
                 
-                // Build the problem
-                ceres::Problem problem;
-                
-                for (size_t i = 0; i < clean_x.size(); ++i) {
-                    ceres::CostFunction* cost_function = GaussianCostFunction::Create(
-                        clean_x[i], clean_y[i], uncertainty);
-                    problem.AddResidualBlock(cost_function, nullptr, parameters);
-                }
-                
-                // Set adaptive bounds
+                // Adaptive bounds
                 double max_charge_val = *std::max_element(clean_y.begin(), clean_y.end());
                 double min_charge_val = *std::min_element(clean_y.begin(), clean_y.end());
                 
@@ -609,25 +485,61 @@ bool FitGaussianCeres(
                 double physics_amp_max = std::max(max_charge_val * 1.5, std::abs(parameters[0]) * 2.0);
                 double algo_amp_max = std::max(parameters[0] * 100.0, 1e-10);
                 double amp_max = std::max(physics_amp_max, algo_amp_max);
-
-                problem.SetParameterLowerBound(parameters, 0, amp_min);
-                problem.SetParameterUpperBound(parameters, 0, amp_max);
                 
                 double adaptive_center_range = (outlier_ratio > 0.15) ? 
                     std::min(pixel_spacing * 3.0, data_spread * 0.4) : pixel_spacing * 3.0;
-                problem.SetParameterLowerBound(parameters, 1, parameters[1] - adaptive_center_range);
-                problem.SetParameterUpperBound(parameters, 1, parameters[1] + adaptive_center_range);
                 
                 double sigma_min = std::max(pixel_spacing * 0.05, data_spread * 0.01);
                 double sigma_max = std::min(pixel_spacing * 3.0, data_spread * 0.8);
-                problem.SetParameterLowerBound(parameters, 2, sigma_min);
-                problem.SetParameterUpperBound(parameters, 2, sigma_max);
                 
                 double charge_range = std::abs(max_charge_val - min_charge_val);
                 double offset_range = std::max(charge_range * 0.5, 
                                              std::max(std::abs(parameters[3]) * 2.0, 1e-12));
-                problem.SetParameterLowerBound(parameters, 3, parameters[3] - offset_range);
-                problem.SetParameterUpperBound(parameters, 3, parameters[3] + offset_range);
+                
+                const double lower_bounds[4] = {amp_min, parameters[1] - adaptive_center_range,
+                                                sigma_min, parameters[3] - offset_range};
+                const double upper_bounds[4] = {amp_max, parameters[1] + adaptive_center_range,
+                                                sigma_max, parameters[3] + offset_range};
+                
+                // Mixed-precision path: single-precision LM with a double polish, Ceres only as fallback
+                if (config.allow_mixed_precision && Constants::ENABLE_MIXED_PRECISION_FIT) {
+                    MixedPrecisionFitResult mixed_result;
+                    if (FitGaussian1DMixedPrecision(clean_x.data(), clean_y.data(), clean_x.size(), uncertainty, parameters,
+                                                    lower_bounds, upper_bounds, mixed_result)) {
+                        double cost = mixed_result.cost;
+                        int dof = std::max(1, static_cast<int>(clean_x.size()) - 4);
+                        double chi2_red = cost * 2.0 / dof;
+                        
+                        if (cost < best_cost) {
+                            best_cost = cost;
+                            best_chi2_reduced = chi2_red;
+                            std::copy(mixed_result.params, mixed_result.params + 4, best_parameters);
+                            best_description = guess.description + "_mixed_precision";
+                            any_success = true;
+                            
+                            if (verbose) {
+                                std::cout << "Mixed-precision Gaussian fit (" << mixed_result.float_iterations
+                                         << " float + " << mixed_result.double_iterations << " double steps)"
+                                         << " with cost=" << cost << ", χ²ᵣ=" << chi2_red << std::endl;
+                            }
+                        }
+                        continue;
+                    }
+                }
+                
+                // Build the problem
+                ceres::Problem problem;
+                
+                for (size_t i = 0; i < clean_x.size(); ++i) {
+                    ceres::CostFunction* cost_function = GaussianCostFunction::Create(
+                        clean_x[i], clean_y[i], uncertainty);
+                    problem.AddResidualBlock(cost_function, nullptr, parameters);
+                }
+                
+                for (int k = 0; k < 4; ++k) {
+                    problem.SetParameterLowerBound(parameters, k, lower_bounds[k]);
+                    problem.SetParameterUpperBound(parameters, k, upper_bounds[k]);
+                }
                 
                 // Enhanced solver configuration
                 ceres::Solver::Options options;
@@ -648,7 +560,7 @@ bool FitGaussianCeres(
                 
                 // Solve
                 ceres::Solver::Summary summary;
-                ceres::Solve(options, &problem, &summary);
+                SolveFitProblem(options, &problem, &summary);
                 
                 // Validation
                 bool fit_successful = (summary.termination_type == ceres::CONVERGENCE ||
@@ -757,7 +669,7 @@ bool FitGaussianCeres(
                     options.min_trust_region_radius = 1e-4 * pixel_spacing;
                     
                     ceres::Solver::Summary summary;
-                    ceres::Solve(options, &problem, &summary);
+                    SolveFitProblem(options, &problem, &summary);
                     
                     bool fit_successful = (summary.termination_type == ceres::CONVERGENCE ||
                                           summary.termination_type == ceres::USER_SUCCESS) &&
@@ -818,12 +730,18 @@ bool FitGaussianCeres(
             return false;
         };
         
+        // Ladder statistics: which stage produced the accepted fit for this model and neighborhood size
+        const EscalationModel escalation_model = EscalationModel::GAUSSIAN_1D;
+        const int neighborhood_class = GetEscalationNeighborhoodClass(x_vals.size(), false);
+        
         // OPTIMIZED SOLVER ESCALATION: Try cheap config first, escalate only if needed
+        RecordEscalationAttempt(escalation_model, neighborhood_class, 0);
         bool success = try_config(cheap_config, "cheap");
         
         // Early exit quality check (OPTIMIZED - raised threshold for better selectivity)
         // Updated threshold from 0.7 to 1.0 based on resolution analysis
         if (success && chi2_reduced <= 1.0) {
+            RecordEscalationAccepted(escalation_model, neighborhood_class, 0);
             if (verbose) {
                 std::cout << "Early exit: cheap Gaussian config succeeded with χ²ᵣ=" << chi2_reduced << " ≤ 1.0" << std::endl;
             }
@@ -832,14 +750,18 @@ bool FitGaussianCeres(
         
         // Escalate to expensive configs only if cheap failed or quality poor
         if (!success || chi2_reduced > 1.0) {
+            RecordFitFallback();
             if (verbose) {
                 std::cout << "Escalating to expensive configurations (χ²ᵣ=" << chi2_reduced 
                          << ", success=" << success << ")" << std::endl;
             }
             
-            for (size_t i = 0; i < expensive_configs.size(); ++i) {
-                success = try_config(expensive_configs[i], "expensive_" + std::to_string(i+1));
+            const int num_stages = 1 + static_cast<int>(expensive_configs.size());
+            for (int stage : GetEscalationOrder(escalation_model, neighborhood_class, num_stages)) {
+                RecordEscalationAttempt(escalation_model, neighborhood_class, stage);
+                success = try_config(expensive_configs[stage - 1], "expensive_" + std::to_string(stage));
                 if (success && chi2_reduced <= 3.0) {
+                    RecordEscalationAccepted(escalation_model, neighborhood_class, stage);
                     return true;
                 }
             }
@@ -854,6 +776,79 @@ bool FitGaussianCeres(
     return false;
 }
 
+// Gaussian fit in the normalized frame: positions in pitch units around the center estimate and
+// charges divided by their maximum; parameters, uncertainties and χ²ᵣ are transformed back
+bool FitGaussianCeres(
+    const std::vector<double>& x_vals,
+    const std::vector<double>& y_vals,
+    double center_estimate,
+    double pixel_spacing,
+    double& fit_amplitude,
+    double& fit_center,
+    double& fit_sigma,
+    double& fit_offset,
+    double& fit_amplitude_err,
+    double& fit_center_err,
+    double& fit_sigma_err,
+    double& fit_offset_err,
+    double& chi2_reduced,
+    bool verbose,
+    bool enable_outlier_filtering,
+    const double* initial_params = nullptr) {
+    RecordFitStart();
+    if (!Constants::ENABLE_NORMALIZED_FIT_FRAME || x_vals.empty() || y_vals.empty()) {
+        return FitGaussianCeresRaw(
+            x_vals, y_vals, center_estimate, pixel_spacing, fit_amplitude, fit_center, fit_sigma,
+            fit_offset, fit_amplitude_err, fit_center_err, fit_sigma_err, fit_offset_err, chi2_reduced,
+            verbose, enable_outlier_filtering, initial_params);
+    }
+    
+    // Sampled raw-frame solve of the same data, result discarded (see ScopedRawFrameReference)
+    if (ShouldSampleRawFrameReference()) {
+        ScopedRawFrameReference reference_scope;
+        double reference[9];
+        FitGaussianCeresRaw(
+            x_vals, y_vals, center_estimate, pixel_spacing, reference[0], reference[1], reference[2],
+            reference[3], reference[4], reference[5], reference[6], reference[7], reference[8],
+            false, enable_outlier_filtering, initial_params);
+    }
+    
+    NormalizedFitFrame frame = MakeNormalizedFitFrame(center_estimate, 0.0, pixel_spacing, y_vals);
+    ScopedNormalizedFitFrame frame_scope(frame);
+    std::vector<double> frame_x = ToFrameValues(x_vals, frame.origin_x, frame.length_scale);
+    std::vector<double> frame_y = ToFrameValues(y_vals, 0.0, frame.charge_scale);
+    
+    double frame_initial[4];
+    const double* frame_initial_params = nullptr;
+    if (initial_params) {
+        frame_initial[0] = initial_params[0] / frame.charge_scale;
+        frame_initial[1] = (initial_params[1] - frame.origin_x) / frame.length_scale;
+        frame_initial[2] = initial_params[2] / frame.length_scale;
+        frame_initial[3] = initial_params[3] / frame.charge_scale;
+        frame_initial_params = frame_initial;
+    }
+    
+    bool success = FitGaussianCeresRaw(
+        frame_x, frame_y, 0.0, 1.0,
+        fit_amplitude, fit_center, fit_sigma, fit_offset,
+        fit_amplitude_err, fit_center_err, fit_sigma_err, fit_offset_err,
+        chi2_reduced, verbose, enable_outlier_filtering, frame_initial_params);
+    
+    fit_amplitude *= frame.charge_scale;
+    fit_center = fit_center * frame.length_scale + frame.origin_x;
+    fit_sigma *= frame.length_scale;
+    fit_offset *= frame.charge_scale;
+    fit_amplitude_err *= frame.charge_scale;
+    fit_center_err *= frame.length_scale;
+    fit_sigma_err *= frame.length_scale;
+    fit_offset_err *= frame.charge_scale;
+    if (!Constants::ENABLE_VERTICAL_CHARGE_UNCERTAINTIES) {
+        // Unit weights: χ² scales with the squared charge scale
+        chi2_reduced *= frame.charge_scale * frame.charge_scale;
+    }
+    return success;
+}
+
 GaussianFit2DResultsCeres Fit2DGaussianCeres(
     const std::vector<double>& x_coords,
     const std::vector<double>& y_coords, 
@@ -862,10 +857,26 @@ GaussianFit2DResultsCeres Fit2DGaussianCeres(
     double center_y_estimate,
     double pixel_spacing,
     bool verbose,
-    bool enable_outlier_filtering)
+    bool enable_outlier_filtering,
+    const GaussianFit2DResultsCeres* warm_start)
 {
     GaussianFit2DResultsCeres result;
     
+    // Previous row/column solutions used as initial guesses (A, m, sigma, B)
+    const bool use_warm_start = warm_start && warm_start->fit_successful;
+    double x_warm_params[4] = {0, 0, 0, 0};
+    double y_warm_params[4] = {0, 0, 0, 0};
+    if (use_warm_start) {
+        x_warm_params[0] = warm_start->x_amplitude;
+        x_warm_params[1] = warm_start->x_center;
+        x_warm_params[2] = warm_start->x_sigma;
+        x_warm_params[3] = warm_start->x_vertical_offset;
+        y_warm_params[0] = warm_start->y_amplitude;
+        y_warm_params[1] = warm_start->y_center;
+        y_warm_params[2] = warm_start->y_sigma;
+        y_warm_params[3] = warm_start->y_vertical_offset;
+    }
+    
     // Initialize Ceres logging (removed mutex for better parallelization)
     InitializeCeres();
     
@@ -887,9 +898,9 @@ GaussianFit2DResultsCeres Fit2DGaussianCeres(
         std::cout << "Starting 2D Gaussian fit (Ceres) with " << x_coords.size() << " data points" << std::endl;
     }
     
-    // Create maps to group data by rows and columns
-    std::map<double, std::vector<std::pair<double, double>>> rows_data; // y -> [(x, charge), ...]
-    std::map<double, std::vector<std::pair<double, double>>> cols_data; // x -> [(y, charge), ...]
+    // Create maps to group data by rows and columns (on the per-event arena)
+    ArenaPointGroups<double> rows_data(GetEventArena()); // y -> [(x, charge), ...]
+    ArenaPointGroups<double> cols_data(GetEventArena()); // x -> [(y, charge), ...]
     
     // Group data points by rows and columns (within pixel spacing tolerance)
     const double tolerance = pixel_spacing * 0.1; // 10% tolerance for grouping
@@ -974,7 +985,8 @@ GaussianFit2DResultsCeres Fit2DGaussianCeres(
             x_vals, y_vals, center_x_estimate, pixel_spacing,
             result.x_amplitude, result.x_center, result.x_sigma, result.x_vertical_offset,
             result.x_amplitude_err, result.x_center_err, result.x_sigma_err, result.x_vertical_offset_err,
-            result.x_chi2red, verbose, enable_outlier_filtering);
+            result.x_chi2red, verbose, enable_outlier_filtering,
+            use_warm_start ? x_warm_params : nullptr);
         
         // Calculate DOF and p-value
         result.x_dof = std::max(1, static_cast<int>(x_vals.size()) - 4);
@@ -1003,7 +1015,8 @@ GaussianFit2DResultsCeres Fit2DGaussianCeres(
             x_vals, y_vals, center_y_estimate, pixel_spacing,
             result.y_amplitude, result.y_center, result.y_sigma, result.y_vertical_offset,
             result.y_amplitude_err, result.y_center_err, result.y_sigma_err, result.y_vertical_offset_err,
-            result.y_chi2red, verbose, enable_outlier_filtering);
+            result.y_chi2red, verbose, enable_outlier_filtering,
+            use_warm_start ? y_warm_params : nullptr);
         
         // Calculate DOF and p-value
         result.y_dof = std::max(1, static_cast<int>(x_vals.size()) - 4);
@@ -1084,8 +1097,8 @@ DiagonalFitResultsCeres FitDiagonalGaussianCeres(
     const double diag_pixel_spacing = pixel_spacing * 1.41421356237; // √2, no calibration factor
     
     // Maps: binned diagonal coordinate → [(distance_along_diagonal, charge), ...]
-    std::map<int, std::vector<std::pair<double, double>>> main_diagonal_bins; // +45° direction
-    std::map<int, std::vector<std::pair<double, double>>> sec_diagonal_bins;  // -45° direction
+    ArenaPointGroups<int> main_diagonal_bins(GetEventArena()); // +45° direction
+    ArenaPointGroups<int> sec_diagonal_bins(GetEventArena());  // -45° direction
     
     for (size_t i = 0; i < x_coords.size(); ++i) {
         double x = x_coords[i];
@@ -1124,7 +1137,7 @@ DiagonalFitResultsCeres FitDiagonalGaussianCeres(
     }
     
     // Find the best bins (those with most pixels near the center)
-    auto find_best_bin = [&](const std::map<int, std::vector<std::pair<double, double>>>& bins, 
+    auto find_best_bin = [&](const ArenaPointGroups<int>& bins, 
                              const std::string& direction) -> int {
         int best_bin = 0;
         int max_pixels = 0;
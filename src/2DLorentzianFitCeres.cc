@@ -1,5 +1,9 @@
 #include "2DLorentzianFitCeres.hh"
 #include "CeresLoggingInit.hh"
+#include "CeresUtils.hh"
+#include "EventArena.hh"
+#include "EscalationPolicy.hh"
+#include "StatsUtils.hh"
 #include "Constants.hh"
 #include "G4SystemOfUnits.hh"
 
@@ -117,89 +121,29 @@ struct DataStatistics {
     bool valid;
 };
 
-DataStatistics CalculateRobustStatisticsLorentzian(const std::vector<double>& x_vals, 
-                                                   const std::vector<double>& y_vals) {
+// View of the per-dataset analysis (computed once in StatsUtils, no re-sorting here)
+DataStatistics CalculateRobustStatisticsLorentzian(const DatasetAnalysis& analysis) {
     DataStatistics stats;
-    stats.valid = false;
-    
-    if (x_vals.size() != y_vals.size() || x_vals.empty()) {
-        return stats;
-    }
-    
-    // Basic statistics
-    stats.min_val = *std::min_element(y_vals.begin(), y_vals.end());
-    stats.max_val = *std::max_element(y_vals.begin(), y_vals.end());
-    
-    // Mean and standard deviation
-    stats.mean = std::accumulate(y_vals.begin(), y_vals.end(), 0.0) / y_vals.size();
-    
-    double variance = 0.0;
-    for (double val : y_vals) {
-        variance += (val - stats.mean) * (val - stats.mean);
-    }
-    stats.std_dev = std::sqrt(variance / y_vals.size());
-    
-    // Median and quartiles
-    std::vector<double> sorted_y = y_vals;
-    std::sort(sorted_y.begin(), sorted_y.end());
-    
-    size_t n = sorted_y.size();
-    if (n % 2 == 0) {
-        stats.median = (sorted_y[n/2 - 1] + sorted_y[n/2]) / 2.0;
-    } else {
-        stats.median = sorted_y[n/2];
-    }
-    
-    stats.q25 = sorted_y[n/4];
-    stats.q75 = sorted_y[3*n/4];
-    
-    // Median Absolute Deviation
-    std::vector<double> abs_deviations;
-    for (double val : y_vals) {
-        abs_deviations.push_back(std::abs(val - stats.median));
-    }
-    std::sort(abs_deviations.begin(), abs_deviations.end());
-    stats.mad = abs_deviations[n/2] * 1.4826;
-    
-    // ------------------------------------------------------------------------------------
-    // Numerical stability safeguard: ensure MAD is positive and finite.
-    // A zero or non-finite MAD can later produce divide-by-zero errors or NaNs in weighting
-    // and outlier filtering, ultimately destabilising the fit.  When this happens we fall
-    // back to the standard deviation (if sensible) or a small epsilon.
-    // ------------------------------------------------------------------------------------
-    if (!std::isfinite(stats.mad) || stats.mad < 1e-12) {
-        stats.mad = (std::isfinite(stats.std_dev) && stats.std_dev > 1e-12) ?
-                    stats.std_dev : 1e-12;
-    }
-    
-    // Weighted statistics
-    stats.weighted_mean = 0.0;
-    stats.total_weight = 0.0;
-    
-    for (size_t i = 0; i < x_vals.size(); ++i) {
-        double weight = std::max(0.0, y_vals[i] - stats.q25);
-        if (weight > 0) {
-            stats.weighted_mean += x_vals[i] * weight;
-            stats.total_weight += weight;
-        }
-    }
-    
-    if (stats.total_weight > 0) {
-        stats.weighted_mean /= stats.total_weight;
-        stats.robust_center = stats.weighted_mean;
-    } else {
-        stats.weighted_mean = std::accumulate(x_vals.begin(), x_vals.end(), 0.0) / x_vals.size();
-        stats.robust_center = stats.weighted_mean;
-    }
-    
-    stats.valid = true;
+    stats.mean = analysis.mean;
+    stats.median = analysis.median;
+    stats.std_dev = analysis.std_dev;
+    stats.mad = analysis.mad;
+    stats.q25 = analysis.q25;
+    stats.q75 = analysis.q75;
+    stats.min_val = analysis.min_val;
+    stats.max_val = analysis.max_val;
+    stats.weighted_mean = analysis.weighted_mean_x;
+    stats.total_weight = analysis.total_weight;
+    stats.robust_center = analysis.weighted_mean_x;
+    stats.valid = analysis.valid;
     return stats;
-} 
+}
 
 // Parameter estimation for Lorentzian distributions
 LorentzianParameterEstimates EstimateLorentzianParameters(
-    const std::vector<double>& x_vals,
-    const std::vector<double>& y_vals,
+    const ArenaDoubleVector& x_vals,
+    const ArenaDoubleVector& y_vals,
+    const DatasetAnalysis& analysis,
     double center_estimate,
     double pixel_spacing,
     bool verbose = false) {
@@ -212,7 +156,7 @@ LorentzianParameterEstimates EstimateLorentzianParameters(
         return estimates;
     }
     
-    DataStatistics stats = CalculateRobustStatisticsLorentzian(x_vals, y_vals);
+    DataStatistics stats = CalculateRobustStatisticsLorentzian(analysis);
     if (!stats.valid) {
         return estimates;
     }
@@ -306,77 +250,8 @@ LorentzianParameterEstimates EstimateLorentzianParameters(
 
  
 
-// Outlier filtering for Lorentzian fitting (adapted from Gaussian version)
-std::pair<std::vector<double>, std::vector<double>> FilterLorentzianOutliers(
-    const std::vector<double>& x_vals,
-    const std::vector<double>& y_vals,
-    double sigma_threshold = 2.5,
-    bool verbose = false) {
-    
-    std::vector<double> filtered_x, filtered_y;
-    
-    if (x_vals.size() != y_vals.size() || x_vals.size() < 4) {
-        return std::make_pair(filtered_x, filtered_y);
-    }
-    
-    DataStatistics stats = CalculateRobustStatisticsLorentzian(x_vals, y_vals);
-    if (!stats.valid) {
-        return std::make_pair(x_vals, y_vals);
-    }
-    
-    // Use MAD-based outlier detection
-    double outlier_threshold = stats.median + sigma_threshold * stats.mad;
-    double lower_threshold = stats.median - sigma_threshold * stats.mad;
-    
-    int outliers_removed = 0;
-    for (size_t i = 0; i < y_vals.size(); ++i) {
-        if (y_vals[i] >= lower_threshold && y_vals[i] <= outlier_threshold) {
-            filtered_x.push_back(x_vals[i]);
-            filtered_y.push_back(y_vals[i]);
-        } else {
-            outliers_removed++;
-        }
-    }
-    
-    // Use lenient filtering if too many outliers removed
-    if (filtered_x.size() < x_vals.size() / 2) {
-        if (verbose) {
-            std::cout << "Too many Lorentzian outliers detected (" << outliers_removed 
-                     << "), using lenient filtering" << std::endl;
-        }
-        
-        filtered_x.clear();
-        filtered_y.clear();
-        
-        double extreme_threshold = stats.median + 4.0 * stats.mad;
-        double extreme_lower = stats.median - 4.0 * stats.mad;
-        
-        for (size_t i = 0; i < y_vals.size(); ++i) {
-            if (y_vals[i] >= extreme_lower && y_vals[i] <= extreme_threshold) {
-                filtered_x.push_back(x_vals[i]);
-                filtered_y.push_back(y_vals[i]);
-            }
-        }
-    }
-    
-    if (filtered_x.size() < 4) {
-        if (verbose) {
-            std::cout << "Warning: After Lorentzian outlier filtering, only " << filtered_x.size() 
-                     << " points remain" << std::endl;
-        }
-        return std::make_pair(x_vals, y_vals);
-    }
-    
-    if (verbose && outliers_removed > 0) {
-        std::cout << "Removed " << outliers_removed << " Lorentzian outliers, " 
-                 << filtered_x.size() << " points remaining" << std::endl;
-    }
-    
-    return std::make_pair(filtered_x, filtered_y);
-}
-
 // Core Lorentzian fitting function using Ceres Solver
-bool FitLorentzianCeres(
+static bool FitLorentzianCeresRaw(
     const std::vector<double>& x_vals,
     const std::vector<double>& y_vals,
     double center_estimate,
@@ -400,23 +275,30 @@ bool FitLorentzianCeres(
         return false;
     }
     
-    // Multiple outlier filtering strategies
-    std::vector<std::pair<std::vector<double>, std::vector<double>>> filtered_datasets;
+    // Robust statistics of the input, computed once and shared by every filter level and config
+    DatasetAnalysis full_analysis = AnalyzeDataset(x_vals, y_vals);
+    
+    // Multiple outlier filtering strategies, as index masks over the input
+    std::vector<std::vector<size_t>> filtered_datasets;
     
     if (enable_outlier_filtering) {
-        auto conservative_data = FilterLorentzianOutliers(x_vals, y_vals, 2.5, verbose);
-        if (conservative_data.first.size() >= 4) {
+        // Conservative filtering (2.5-sigma)
+        std::vector<size_t> conservative_data = SelectOutlierFreeIndices(full_analysis, 2.5, 4.0, 4, verbose);
+        if (conservative_data.size() >= 4) {
             filtered_datasets.push_back(conservative_data);
         }
         
-        auto lenient_data = FilterLorentzianOutliers(x_vals, y_vals, 3.0, verbose);
-        if (lenient_data.first.size() >= 4) {
+        // Lenient filtering (3.0-sigma)
+        std::vector<size_t> lenient_data = SelectOutlierFreeIndices(full_analysis, 3.0, 4.0, 4, verbose);
+        if (lenient_data.size() >= 4 && lenient_data != conservative_data) {
             filtered_datasets.push_back(lenient_data);
         }
     }
     
-    // Always include original data as fallback
-    filtered_datasets.push_back(std::make_pair(x_vals, y_vals));
+    // No filtering (use all data) - always available as fallback, unless a filter kept every point
+    if (filtered_datasets.empty() || filtered_datasets.back() != full_analysis.indices) {
+        filtered_datasets.push_back(full_analysis.indices);
+    }
     
     if (verbose) {
         std::cout << "Lorentzian outlier filtering " << (enable_outlier_filtering ? "enabled" : "disabled") 
@@ -425,17 +307,19 @@ bool FitLorentzianCeres(
     
     // Try each filtered dataset
     for (size_t dataset_idx = 0; dataset_idx < filtered_datasets.size(); ++dataset_idx) {
-        std::vector<double> clean_x = filtered_datasets[dataset_idx].first;
-        std::vector<double> clean_y = filtered_datasets[dataset_idx].second;
+        if (filtered_datasets[dataset_idx].size() < 4) continue;
         
-        if (clean_x.size() < 4) continue;
+        // Statistics of this subset (the unfiltered set reuses the full analysis); solver input gathered once
+        DatasetAnalysis analysis = AnalyzeSubset(full_analysis, filtered_datasets[dataset_idx]);
+        ArenaDoubleVector clean_x(GetEventArena()), clean_y(GetEventArena());
+        GatherDataset(analysis, clean_x, clean_y);
         
         if (verbose) {
             std::cout << "Trying Lorentzian dataset " << dataset_idx << " with " << clean_x.size() << " points" << std::endl;
         }
         
         // Get parameter estimates
-        LorentzianParameterEstimates estimates = EstimateLorentzianParameters(clean_x, clean_y, center_estimate, pixel_spacing, verbose);
+        LorentzianParameterEstimates estimates = EstimateLorentzianParameters(clean_x, clean_y, analysis, center_estimate, pixel_spacing, verbose);
         if (!estimates.valid) {
             if (verbose) {
                 std::cout << "Lorentzian parameter estimation failed for dataset " << dataset_idx << std::endl;
@@ -503,7 +387,7 @@ bool FitLorentzianCeres(
             double best_chi2_reduced = std::numeric_limits<double>::max();
             
             // Data characteristics for adaptive bounds
-            DataStatistics data_stats = CalculateRobustStatisticsLorentzian(clean_x, clean_y);
+            DataStatistics data_stats = CalculateRobustStatisticsLorentzian(analysis);
             double data_spread = *std::max_element(clean_x.begin(), clean_x.end()) - 
                                *std::min_element(clean_x.begin(), clean_x.end());
             double outlier_ratio = 0.0;
@@ -571,7 +455,7 @@ bool FitLorentzianCeres(
                 options.minimizer_progress_to_stdout = false;
             
                 ceres::Solver::Summary summary;
-                ceres::Solve(options, &problem, &summary);
+                SolveFitProblem(options, &problem, &summary);
                 
                 bool fit_successful = (summary.termination_type == ceres::CONVERGENCE ||
                                       summary.termination_type == ceres::USER_SUCCESS) &&
@@ -672,7 +556,7 @@ bool FitLorentzianCeres(
                     options.minimizer_progress_to_stdout = false;
                     
                     ceres::Solver::Summary summary;
-                    ceres::Solve(options, &problem, &summary);
+                    SolveFitProblem(options, &problem, &summary);
                     
                     bool fit_successful = (summary.termination_type == ceres::CONVERGENCE ||
                                           summary.termination_type == ceres::USER_SUCCESS) &&
@@ -733,12 +617,18 @@ bool FitLorentzianCeres(
             return false;
         };
         
+        // Ladder statistics: which stage produced the accepted fit for this model and neighborhood size
+        const EscalationModel escalation_model = EscalationModel::LORENTZIAN_1D;
+        const int neighborhood_class = GetEscalationNeighborhoodClass(x_vals.size(), false);
+        
         // OPTIMIZED SOLVER ESCALATION: Try cheap config first, escalate only if needed
+        RecordEscalationAttempt(escalation_model, neighborhood_class, 0);
         bool success = try_config(cheap_config, "cheap");
         
         // Early exit quality check (OPTIMIZED - raised threshold for better selectivity)
         // Updated threshold from 0.7 to 1.0 based on resolution analysis
         if (success && chi2_reduced <= 1.0) {
+            RecordEscalationAccepted(escalation_model, neighborhood_class, 0);
             if (verbose) {
                 std::cout << "Early exit: cheap Lorentzian config succeeded with χ²ᵣ=" << chi2_reduced << " ≤ 1.0" << std::endl;
             }
@@ -747,14 +637,18 @@ bool FitLorentzianCeres(
         
         // Escalate to expensive configs only if cheap failed or quality poor
         if (!success || chi2_reduced > 1.0) {
+            RecordFitFallback();
             if (verbose) {
                 std::cout << "Escalating to expensive Lorentzian configurations (χ²ᵣ=" << chi2_reduced 
                          << ", success=" << success << ")" << std::endl;
             }
             
-            for (size_t i = 0; i < expensive_configs.size(); ++i) {
-                success = try_config(expensive_configs[i], "expensive_" + std::to_string(i+1));
+            const int num_stages = 1 + static_cast<int>(expensive_configs.size());
+            for (int stage : GetEscalationOrder(escalation_model, neighborhood_class, num_stages)) {
+                RecordEscalationAttempt(escalation_model, neighborhood_class, stage);
+                success = try_config(expensive_configs[stage - 1], "expensive_" + std::to_string(stage));
                 if (success && chi2_reduced <= 3.0) {
+                    RecordEscalationAccepted(escalation_model, neighborhood_class, stage);
                     return true;
                 }
             }
@@ -769,6 +663,68 @@ bool FitLorentzianCeres(
     return false;
 } 
 
+// Lorentzian fit in the normalized frame: positions in pitch units around the center estimate and
+// charges divided by their maximum; parameters, uncertainties and χ²ᵣ are transformed back
+bool FitLorentzianCeres(
+    const std::vector<double>& x_vals,
+    const std::vector<double>& y_vals,
+    double center_estimate,
+    double pixel_spacing,
+    double& fit_amplitude,
+    double& fit_center,
+    double& fit_gamma,
+    double& fit_vertical_offset,
+    double& fit_amplitude_err,
+    double& fit_center_err,
+    double& fit_gamma_err,
+    double& fit_vertical_offset_err,
+    double& chi2_reduced,
+    bool verbose,
+    bool enable_outlier_filtering) {
+    RecordFitStart();
+    if (!Constants::ENABLE_NORMALIZED_FIT_FRAME || x_vals.empty() || y_vals.empty()) {
+        return FitLorentzianCeresRaw(
+            x_vals, y_vals, center_estimate, pixel_spacing, fit_amplitude, fit_center, fit_gamma,
+            fit_vertical_offset, fit_amplitude_err, fit_center_err, fit_gamma_err, fit_vertical_offset_err,
+            chi2_reduced, verbose, enable_outlier_filtering);
+    }
+    
+    // Sampled raw-frame solve of the same data, result discarded (see ScopedRawFrameReference)
+    if (ShouldSampleRawFrameReference()) {
+        ScopedRawFrameReference reference_scope;
+        double reference[9];
+        FitLorentzianCeresRaw(
+            x_vals, y_vals, center_estimate, pixel_spacing, reference[0], reference[1], reference[2],
+            reference[3], reference[4], reference[5], reference[6], reference[7], reference[8],
+            false, enable_outlier_filtering);
+    }
+    
+    NormalizedFitFrame frame = MakeNormalizedFitFrame(center_estimate, 0.0, pixel_spacing, y_vals);
+    ScopedNormalizedFitFrame frame_scope(frame);
+    std::vector<double> frame_x = ToFrameValues(x_vals, frame.origin_x, frame.length_scale);
+    std::vector<double> frame_y = ToFrameValues(y_vals, 0.0, frame.charge_scale);
+    
+    bool success = FitLorentzianCeresRaw(
+        frame_x, frame_y, 0.0, 1.0,
+        fit_amplitude, fit_center, fit_gamma, fit_vertical_offset,
+        fit_amplitude_err, fit_center_err, fit_gamma_err, fit_vertical_offset_err,
+        chi2_reduced, verbose, enable_outlier_filtering);
+    
+    fit_amplitude *= frame.charge_scale;
+    fit_center = fit_center * frame.length_scale + frame.origin_x;
+    fit_gamma *= frame.length_scale;
+    fit_vertical_offset *= frame.charge_scale;
+    fit_amplitude_err *= frame.charge_scale;
+    fit_center_err *= frame.length_scale;
+    fit_gamma_err *= frame.length_scale;
+    fit_vertical_offset_err *= frame.charge_scale;
+    if (!Constants::ENABLE_VERTICAL_CHARGE_UNCERTAINTIES) {
+        // Unit weights: χ² scales with the squared charge scale
+        chi2_reduced *= frame.charge_scale * frame.charge_scale;
+    }
+    return success;
+}
+
 LorentzianFit2DResultsCeres Fit2DLorentzianCeres(
     const std::vector<double>& x_coords,
     const std::vector<double>& y_coords, 
@@ -802,9 +758,9 @@ LorentzianFit2DResultsCeres Fit2DLorentzianCeres(
         std::cout << "Starting 2D Lorentzian fit (Ceres) with " << x_coords.size() << " data points" << std::endl;
     }
     
-    // Create maps to group data by rows and columns
-    std::map<double, std::vector<std::pair<double, double>>> rows_data; // y -> [(x, charge), ...]
-    std::map<double, std::vector<std::pair<double, double>>> cols_data; // x -> [(y, charge), ...]
+    // Create maps to group data by rows and columns (on the per-event arena)
+    ArenaPointGroups<double> rows_data(GetEventArena()); // y -> [(x, charge), ...]
+    ArenaPointGroups<double> cols_data(GetEventArena()); // x -> [(y, charge), ...]
     
     // Group data points by rows and columns (within pixel spacing tolerance)
     const double tolerance = pixel_spacing * 0.1; // 10% tolerance for grouping
@@ -1015,8 +971,8 @@ DiagonalLorentzianFitResultsCeres FitDiagonalLorentzianCeres(
     const double diag_pixel_spacing = pixel_spacing * 1.41421356237; // √2, no calibration factor
     
     // Maps: binned diagonal coordinate → [(distance_along_diagonal, charge), ...]
-    std::map<int, std::vector<std::pair<double, double>>> main_diagonal_bins; // +45° direction
-    std::map<int, std::vector<std::pair<double, double>>> sec_diagonal_bins;  // -45° direction
+    ArenaPointGroups<int> main_diagonal_bins(GetEventArena()); // +45° direction
+    ArenaPointGroups<int> sec_diagonal_bins(GetEventArena());  // -45° direction
     
     for (size_t i = 0; i < x_coords.size(); ++i) {
         double x = x_coords[i];
@@ -1055,7 +1011,7 @@ DiagonalLorentzianFitResultsCeres FitDiagonalLorentzianCeres(
     }
     
     // Find the best bins (those with most pixels near the center)
-    auto find_best_bin = [&](const std::map<int, std::vector<std::pair<double, double>>>& bins, 
+    auto find_best_bin = [&](const ArenaPointGroups<int>& bins, 
                              const std::string& direction) -> int {
         int best_bin = 0;
         int max_pixels = 0;
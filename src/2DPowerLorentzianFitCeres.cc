@@ -1,5 +1,10 @@
 #include "2DPowerLorentzianFitCeres.hh"
 #include "CeresLoggingInit.hh"
+#include "CeresUtils.hh"
+#include "PowerLorentzianCost.hh"
+#include "EventArena.hh"
+#include "EscalationPolicy.hh"
+#include "StatsUtils.hh"
 #include "Constants.hh"
 #include "G4SystemOfUnits.hh"
 
@@ -36,68 +41,13 @@ double CalculatePowerLorentzianUncertainty(double max_charge_in_line) {
     return uncertainty;
 }
 
-// Power-Law Lorentzian cost function
-// Function form: y(x) = A / (1 + ((x-m)/gamma)^2)^beta + B
-struct PowerLorentzianCostFunction {
-    PowerLorentzianCostFunction(double x, double y, double uncertainty) 
-        : x_(x), y_(y), uncertainty_(uncertainty) {}
-    
-    template <typename T>
-    bool operator()(const T* const params, T* residual) const {
-        // params[0] = A (amplitude)
-        // params[1] = m (center)
-        // params[2] = gamma (width parameter, like HWHM)
-        // params[3] = beta (power exponent)
-        // params[4] = B (baseline)
-        
-        const T& A = params[0];
-        const T& m = params[1];
-        const T& gamma = params[2];
-        const T& beta = params[3];
-        const T& B = params[4];
-        
-        // Robust handling of gamma (prevent division by zero)
-        T safe_gamma = ceres::abs(gamma);
-        if (safe_gamma < T(1e-12)) {
-            safe_gamma = T(1e-12);
-        }
-        
-        // Ensure beta stability (positive values)
-        T safe_beta = ceres::abs(beta);
-        if (safe_beta < T(0.1)) {
-            safe_beta = T(0.1);
-        }
-        
-        // Power-Law Lorentzian function: y(x) = A / (1 + ((x - m) / γ)^2)^β + B
-        T dx = x_ - m;
-        T normalized_dx = dx / safe_gamma;
-        T denominator_base = T(1.0) + normalized_dx * normalized_dx;
-        
-        // Prevent numerical issues with very small denominators
-        if (denominator_base < T(1e-12)) {
-            denominator_base = T(1e-12);
-        }
-        
-        // Apply power exponent
-        T denominator = ceres::pow(denominator_base, safe_beta);
-        T predicted = A / denominator + B;
-        
-        // Residual divided by uncertainty (standard weighted least squares) - same as Lorentzian
-        residual[0] = (predicted - T(y_)) / T(uncertainty_);
-        
-        return true;
+// Cost function for one Power-Law Lorentzian data point (analytic unless disabled)
+static ceres::CostFunction* CreatePowerLorentzianCost(double x, double y, double uncertainty) {
+    if (Constants::ENABLE_ANALYTIC_POWER_LORENTZIAN) {
+        return new PowerLorentzianAnalyticCostFunction(x, y, uncertainty);
     }
-    
-    static ceres::CostFunction* Create(double x, double y, double uncertainty) {
-        return (new ceres::AutoDiffCostFunction<PowerLorentzianCostFunction, 1, 5>(
-            new PowerLorentzianCostFunction(x, y, uncertainty)));
-    }
-    
-private:
-    const double x_;
-    const double y_;
-    const double uncertainty_;
-};
+    return PowerLorentzianCostFunction::Create(x, y, uncertainty);
+}
 
 // Robust statistics calculations with improved outlier detection
 struct DataStatistics {
@@ -113,78 +63,21 @@ struct DataStatistics {
     bool valid;
 };
 
-DataStatistics CalculateRobustStatisticsPowerLorentzian(const std::vector<double>& x_vals, 
-                                                      const std::vector<double>& y_vals) {
+// View of the per-dataset analysis (computed once in StatsUtils, no re-sorting here)
+DataStatistics CalculateRobustStatisticsPowerLorentzian(const DatasetAnalysis& analysis) {
     DataStatistics stats;
-    stats.valid = false;
-    
-    if (x_vals.size() != y_vals.size() || x_vals.empty()) {
-        return stats;
-    }
-    
-    // Basic statistics
-    stats.min_val = *std::min_element(y_vals.begin(), y_vals.end());
-    stats.max_val = *std::max_element(y_vals.begin(), y_vals.end());
-    
-    // Mean and standard deviation
-    stats.mean = std::accumulate(y_vals.begin(), y_vals.end(), 0.0) / y_vals.size();
-    
-    double variance = 0.0;
-    for (double val : y_vals) {
-        variance += (val - stats.mean) * (val - stats.mean);
-    }
-    stats.std_dev = std::sqrt(variance / y_vals.size());
-    
-    // Median and quartiles
-    std::vector<double> sorted_y = y_vals;
-    std::sort(sorted_y.begin(), sorted_y.end());
-    
-    size_t n = sorted_y.size();
-    if (n % 2 == 0) {
-        stats.median = (sorted_y[n/2 - 1] + sorted_y[n/2]) / 2.0;
-    } else {
-        stats.median = sorted_y[n/2];
-    }
-    
-    stats.q25 = sorted_y[n/4];
-    stats.q75 = sorted_y[3*n/4];
-    
-    // Median Absolute Deviation
-    std::vector<double> abs_deviations;
-    for (double val : y_vals) {
-        abs_deviations.push_back(std::abs(val - stats.median));
-    }
-    std::sort(abs_deviations.begin(), abs_deviations.end());
-    stats.mad = abs_deviations[n/2] * 1.4826;
-    
-    // Numerical stability safeguard
-    if (!std::isfinite(stats.mad) || stats.mad < 1e-12) {
-        stats.mad = (std::isfinite(stats.std_dev) && stats.std_dev > 1e-12) ?
-                    stats.std_dev : 1e-12;
-    }
-    
-    // Use same center estimation logic as Lorentzian for consistency
-    stats.weighted_mean = 0.0;
-    stats.total_weight = 0.0;
-    
-    for (size_t i = 0; i < x_vals.size(); ++i) {
-        double weight = std::max(0.0, y_vals[i] - stats.q25);
-        if (weight > 0) {
-            stats.weighted_mean += x_vals[i] * weight;
-            stats.total_weight += weight;
-        }
-    }
-    
-    if (stats.total_weight > 0) {
-        stats.weighted_mean /= stats.total_weight;
-        stats.robust_center = stats.weighted_mean;
-    } else {
-        // Fallback to arithmetic mean
-        stats.weighted_mean = std::accumulate(x_vals.begin(), x_vals.end(), 0.0) / x_vals.size();
-        stats.robust_center = stats.weighted_mean;
-    }
-    
-    stats.valid = true;
+    stats.mean = analysis.mean;
+    stats.median = analysis.median;
+    stats.std_dev = analysis.std_dev;
+    stats.mad = analysis.mad;
+    stats.q25 = analysis.q25;
+    stats.q75 = analysis.q75;
+    stats.min_val = analysis.min_val;
+    stats.max_val = analysis.max_val;
+    stats.weighted_mean = analysis.weighted_mean_x;
+    stats.total_weight = analysis.total_weight;
+    stats.robust_center = analysis.weighted_mean_x;
+    stats.valid = analysis.valid;
     return stats;
 }
 
@@ -206,8 +99,9 @@ struct PowerLorentzianParameterEstimates {
 
 // Parameter estimation for Power-Law Lorentzian distributions
 PowerLorentzianParameterEstimates EstimatePowerLorentzianParameters(
-    const std::vector<double>& x_vals,
-    const std::vector<double>& y_vals,
+    const ArenaDoubleVector& x_vals,
+    const ArenaDoubleVector& y_vals,
+    const DatasetAnalysis& analysis,
     double center_estimate,
     double pixel_spacing,
     bool verbose = false) {
@@ -220,7 +114,7 @@ PowerLorentzianParameterEstimates EstimatePowerLorentzianParameters(
         return estimates;
     }
     
-    DataStatistics stats = CalculateRobustStatisticsPowerLorentzian(x_vals, y_vals);
+    DataStatistics stats = CalculateRobustStatisticsPowerLorentzian(analysis);
     if (!stats.valid) {
         return estimates;
     }
@@ -312,78 +206,9 @@ PowerLorentzianParameterEstimates EstimatePowerLorentzianParameters(
     return estimates;
 }
 
-// Outlier filtering for Power Lorentzian fitting (adapted from Lorentzian version)
-std::pair<std::vector<double>, std::vector<double>> FilterPowerLorentzianOutliers(
-    const std::vector<double>& x_vals,
-    const std::vector<double>& y_vals,
-    double sigma_threshold = 2.5,
-    bool verbose = false) {
-    
-    std::vector<double> filtered_x, filtered_y;
-    
-    if (x_vals.size() != y_vals.size() || x_vals.size() < 5) {
-        return std::make_pair(filtered_x, filtered_y);
-    }
-    
-    DataStatistics stats = CalculateRobustStatisticsPowerLorentzian(x_vals, y_vals);
-    if (!stats.valid) {
-        return std::make_pair(x_vals, y_vals);
-    }
-    
-    // Use MAD-based outlier detection
-    double outlier_threshold = stats.median + sigma_threshold * stats.mad;
-    double lower_threshold = stats.median - sigma_threshold * stats.mad;
-    
-    int outliers_removed = 0;
-    for (size_t i = 0; i < y_vals.size(); ++i) {
-        if (y_vals[i] >= lower_threshold && y_vals[i] <= outlier_threshold) {
-            filtered_x.push_back(x_vals[i]);
-            filtered_y.push_back(y_vals[i]);
-        } else {
-            outliers_removed++;
-        }
-    }
-    
-    // Use lenient filtering if too many outliers removed
-    if (filtered_x.size() < x_vals.size() / 2) {
-        if (verbose) {
-            std::cout << "Too many Power Lorentzian outliers detected (" << outliers_removed 
-                     << "), using lenient filtering" << std::endl;
-        }
-        
-        filtered_x.clear();
-        filtered_y.clear();
-        
-        double extreme_threshold = stats.median + 4.0 * stats.mad;
-        double extreme_lower = stats.median - 4.0 * stats.mad;
-        
-        for (size_t i = 0; i < y_vals.size(); ++i) {
-            if (y_vals[i] >= extreme_lower && y_vals[i] <= extreme_threshold) {
-                filtered_x.push_back(x_vals[i]);
-                filtered_y.push_back(y_vals[i]);
-            }
-        }
-    }
-    
-    if (filtered_x.size() < 5) {
-        if (verbose) {
-            std::cout << "Warning: After Power Lorentzian outlier filtering, only " << filtered_x.size() 
-                     << " points remain" << std::endl;
-        }
-        return std::make_pair(x_vals, y_vals);
-    }
-    
-    if (verbose && outliers_removed > 0) {
-        std::cout << "Removed " << outliers_removed << " Power Lorentzian outliers, " 
-                 << filtered_x.size() << " points remaining" << std::endl;
-    }
-    
-    return std::make_pair(filtered_x, filtered_y);
-}
-
 // Core Power-Law Lorentzian fitting function using Ceres Solver
 // Model: y(x) = A / (1 + ((x-m)/gamma)^2)^beta + B
-bool FitPowerLorentzianCeres(
+static bool FitPowerLorentzianCeresRaw(
     const std::vector<double>& x_vals,
     const std::vector<double>& y_vals,
     double center_estimate,
@@ -409,23 +234,30 @@ bool FitPowerLorentzianCeres(
         return false;
     }
     
-    // Multiple outlier filtering strategies
-    std::vector<std::pair<std::vector<double>, std::vector<double>>> filtered_datasets;
+    // Robust statistics of the input, computed once and shared by every filter level and config
+    DatasetAnalysis full_analysis = AnalyzeDataset(x_vals, y_vals);
+    
+    // Multiple outlier filtering strategies, as index masks over the input
+    std::vector<std::vector<size_t>> filtered_datasets;
     
     if (enable_outlier_filtering) {
-        auto conservative_data = FilterPowerLorentzianOutliers(x_vals, y_vals, 2.5, verbose);
-        if (conservative_data.first.size() >= 5) {
+        // Conservative filtering (2.5-sigma)
+        std::vector<size_t> conservative_data = SelectOutlierFreeIndices(full_analysis, 2.5, 4.0, 5, verbose);
+        if (conservative_data.size() >= 5) {
             filtered_datasets.push_back(conservative_data);
         }
         
-        auto lenient_data = FilterPowerLorentzianOutliers(x_vals, y_vals, 3.0, verbose);
-        if (lenient_data.first.size() >= 5) {
+        // Lenient filtering (3.0-sigma)
+        std::vector<size_t> lenient_data = SelectOutlierFreeIndices(full_analysis, 3.0, 4.0, 5, verbose);
+        if (lenient_data.size() >= 5 && lenient_data != conservative_data) {
             filtered_datasets.push_back(lenient_data);
         }
     }
     
-    // Always include original data as fallback
-    filtered_datasets.push_back(std::make_pair(x_vals, y_vals));
+    // No filtering (use all data) - always available as fallback, unless a filter kept every point
+    if (filtered_datasets.empty() || filtered_datasets.back() != full_analysis.indices) {
+        filtered_datasets.push_back(full_analysis.indices);
+    }
     
     if (verbose) {
         std::cout << "Power Lorentzian outlier filtering " << (enable_outlier_filtering ? "enabled" : "disabled") 
@@ -434,17 +266,19 @@ bool FitPowerLorentzianCeres(
     
     // Try each filtered dataset
     for (size_t dataset_idx = 0; dataset_idx < filtered_datasets.size(); ++dataset_idx) {
-        std::vector<double> clean_x = filtered_datasets[dataset_idx].first;
-        std::vector<double> clean_y = filtered_datasets[dataset_idx].second;
+        if (filtered_datasets[dataset_idx].size() < 5) continue;
         
-        if (clean_x.size() < 5) continue;
+        // Statistics of this subset (the unfiltered set reuses the full analysis); solver input gathered once
+        DatasetAnalysis analysis = AnalyzeSubset(full_analysis, filtered_datasets[dataset_idx]);
+        ArenaDoubleVector clean_x(GetEventArena()), clean_y(GetEventArena());
+        GatherDataset(analysis, clean_x, clean_y);
         
         if (verbose) {
             std::cout << "Trying Power Lorentzian dataset " << dataset_idx << " with " << clean_x.size() << " points" << std::endl;
         }
         
         // Get parameter estimates
-        PowerLorentzianParameterEstimates estimates = EstimatePowerLorentzianParameters(clean_x, clean_y, center_estimate, pixel_spacing, verbose);
+        PowerLorentzianParameterEstimates estimates = EstimatePowerLorentzianParameters(clean_x, clean_y, analysis, center_estimate, pixel_spacing, verbose);
         if (!estimates.valid) {
             if (verbose) {
                 std::cout << "Power Lorentzian parameter estimation failed for dataset " << dataset_idx << std::endl;
@@ -513,7 +347,7 @@ bool FitPowerLorentzianCeres(
             double best_chi2_reduced = std::numeric_limits<double>::max();
             
             // Data characteristics for adaptive bounds
-            DataStatistics data_stats = CalculateRobustStatisticsPowerLorentzian(clean_x, clean_y);
+            DataStatistics data_stats = CalculateRobustStatisticsPowerLorentzian(analysis);
             double data_spread = *std::max_element(clean_x.begin(), clean_x.end()) - 
                                *std::min_element(clean_x.begin(), clean_x.end());
             double outlier_ratio = 0.0;
@@ -538,7 +372,7 @@ bool FitPowerLorentzianCeres(
                 ceres::Problem problem;
                 
                 for (size_t i = 0; i < clean_x.size(); ++i) {
-                    ceres::CostFunction* cost_function = PowerLorentzianCostFunction::Create(
+                    ceres::CostFunction* cost_function = CreatePowerLorentzianCost(
                         clean_x[i], clean_y[i], uncertainty);
                     problem.AddResidualBlock(cost_function, nullptr, parameters);
                 }
@@ -595,7 +429,7 @@ bool FitPowerLorentzianCeres(
                 options.minimizer_progress_to_stdout = false;
                 
                 ceres::Solver::Summary summary_stage1;
-                ceres::Solve(options, &problem, &summary_stage1);
+                SolveFitProblem(options, &problem, &summary_stage1);
                 
                 bool stage1_successful = (summary_stage1.termination_type == ceres::CONVERGENCE ||
                                         summary_stage1.termination_type == ceres::USER_SUCCESS) &&
@@ -615,11 +449,11 @@ bool FitPowerLorentzianCeres(
                     problem.SetParameterLowerBound(parameters, 1, stage1_center - tight_center_range);
                     problem.SetParameterUpperBound(parameters, 1, stage1_center + tight_center_range);
                     
-                    ceres::Solve(options, &problem, &summary);
+                    SolveFitProblem(options, &problem, &summary);
                 } else {
                     problem.SetParameterLowerBound(parameters, 3, 0.2);
                     problem.SetParameterUpperBound(parameters, 3, 4.0);
-                    ceres::Solve(options, &problem, &summary);
+                    SolveFitProblem(options, &problem, &summary);
                 }
                 
                 bool fit_successful = (summary.termination_type == ceres::CONVERGENCE ||
@@ -685,7 +519,7 @@ bool FitPowerLorentzianCeres(
                     ceres::Problem problem;
                     
                     for (size_t j = 0; j < clean_x.size(); ++j) {
-                        ceres::CostFunction* cost_function = PowerLorentzianCostFunction::Create(
+                        ceres::CostFunction* cost_function = CreatePowerLorentzianCost(
                             clean_x[j], clean_y[j], uncertainty);
                         problem.AddResidualBlock(cost_function, nullptr, parameters);
                     }
@@ -741,7 +575,7 @@ bool FitPowerLorentzianCeres(
                     options.minimizer_progress_to_stdout = false;
                     
                     ceres::Solver::Summary summary_stage1;
-                    ceres::Solve(options, &problem, &summary_stage1);
+                    SolveFitProblem(options, &problem, &summary_stage1);
                     
                     bool stage1_successful = (summary_stage1.termination_type == ceres::CONVERGENCE ||
                                             summary_stage1.termination_type == ceres::USER_SUCCESS) &&
@@ -760,11 +594,11 @@ bool FitPowerLorentzianCeres(
                         problem.SetParameterLowerBound(parameters, 1, stage1_center - tight_center_range);
                         problem.SetParameterUpperBound(parameters, 1, stage1_center + tight_center_range);
                         
-                        ceres::Solve(options, &problem, &summary);
+                        SolveFitProblem(options, &problem, &summary);
                     } else {
                         problem.SetParameterLowerBound(parameters, 3, 0.2);
                         problem.SetParameterUpperBound(parameters, 3, 4.0);
-                        ceres::Solve(options, &problem, &summary);
+                        SolveFitProblem(options, &problem, &summary);
                     }
                     
                     bool fit_successful = (summary.termination_type == ceres::CONVERGENCE ||
@@ -831,12 +665,18 @@ bool FitPowerLorentzianCeres(
             return false;
         };
         
+        // Ladder statistics: which stage produced the accepted fit for this model and neighborhood size
+        const EscalationModel escalation_model = EscalationModel::POWER_LORENTZIAN_1D;
+        const int neighborhood_class = GetEscalationNeighborhoodClass(x_vals.size(), false);
+        
         // OPTIMIZED SOLVER ESCALATION: Try cheap config first, escalate only if needed
+        RecordEscalationAttempt(escalation_model, neighborhood_class, 0);
         bool success = try_config(cheap_config, "cheap");
         
         // Early exit quality check (as per optimize.md section 4.1)
         // Updated threshold based on actual data: χ²ᵣ ≤ 0.7 (around P75 of real distribution)
         if (success && chi2_reduced <= 0.7) {
+            RecordEscalationAccepted(escalation_model, neighborhood_class, 0);
             if (verbose) {
                 std::cout << "Early exit: cheap Power Lorentzian config succeeded with χ²ᵣ=" << chi2_reduced << " ≤ 0.7" << std::endl;
             }
@@ -845,14 +685,18 @@ bool FitPowerLorentzianCeres(
         
         // Escalate to expensive configs only if cheap failed or quality poor
         if (!success || chi2_reduced > 0.7) {
+            RecordFitFallback();
             if (verbose) {
                 std::cout << "Escalating to expensive Power Lorentzian configurations (χ²ᵣ=" << chi2_reduced 
                          << ", success=" << success << ")" << std::endl;
             }
             
-            for (size_t i = 0; i < expensive_configs.size(); ++i) {
-                success = try_config(expensive_configs[i], "expensive_" + std::to_string(i+1));
+            const int num_stages = 1 + static_cast<int>(expensive_configs.size());
+            for (int stage : GetEscalationOrder(escalation_model, neighborhood_class, num_stages)) {
+                RecordEscalationAttempt(escalation_model, neighborhood_class, stage);
+                success = try_config(expensive_configs[stage - 1], "expensive_" + std::to_string(stage));
                 if (success && chi2_reduced <= 3.0) {
+                    RecordEscalationAccepted(escalation_model, neighborhood_class, stage);
                     return true;
                 }
             }
@@ -867,6 +711,70 @@ bool FitPowerLorentzianCeres(
     return false;
 }
 
+// Power-Law Lorentzian fit in the normalized frame: positions in pitch units around the center estimate and
+// charges divided by their maximum; parameters, uncertainties and χ²ᵣ are transformed back
+bool FitPowerLorentzianCeres(
+    const std::vector<double>& x_vals,
+    const std::vector<double>& y_vals,
+    double center_estimate,
+    double pixel_spacing,
+    double& fit_amplitude,
+    double& fit_center,
+    double& fit_gamma,
+    double& fit_beta,
+    double& fit_vertical_offset,
+    double& fit_amplitude_err,
+    double& fit_center_err,
+    double& fit_gamma_err,
+    double& fit_beta_err,
+    double& fit_vertical_offset_err,
+    double& chi2_reduced,
+    bool verbose,
+    bool enable_outlier_filtering) {
+    RecordFitStart();
+    if (!Constants::ENABLE_NORMALIZED_FIT_FRAME || x_vals.empty() || y_vals.empty()) {
+        return FitPowerLorentzianCeresRaw(
+            x_vals, y_vals, center_estimate, pixel_spacing, fit_amplitude, fit_center, fit_gamma, fit_beta,
+            fit_vertical_offset, fit_amplitude_err, fit_center_err, fit_gamma_err, fit_beta_err,
+            fit_vertical_offset_err, chi2_reduced, verbose, enable_outlier_filtering);
+    }
+    
+    // Sampled raw-frame solve of the same data, result discarded (see ScopedRawFrameReference)
+    if (ShouldSampleRawFrameReference()) {
+        ScopedRawFrameReference reference_scope;
+        double reference[11];
+        FitPowerLorentzianCeresRaw(
+            x_vals, y_vals, center_estimate, pixel_spacing, reference[0], reference[1], reference[2],
+            reference[3], reference[4], reference[5], reference[6], reference[7], reference[8],
+            reference[9], reference[10], false, enable_outlier_filtering);
+    }
+    
+    NormalizedFitFrame frame = MakeNormalizedFitFrame(center_estimate, 0.0, pixel_spacing, y_vals);
+    ScopedNormalizedFitFrame frame_scope(frame);
+    std::vector<double> frame_x = ToFrameValues(x_vals, frame.origin_x, frame.length_scale);
+    std::vector<double> frame_y = ToFrameValues(y_vals, 0.0, frame.charge_scale);
+    
+    bool success = FitPowerLorentzianCeresRaw(
+        frame_x, frame_y, 0.0, 1.0,
+        fit_amplitude, fit_center, fit_gamma, fit_beta, fit_vertical_offset,
+        fit_amplitude_err, fit_center_err, fit_gamma_err, fit_beta_err, fit_vertical_offset_err,
+        chi2_reduced, verbose, enable_outlier_filtering);
+    
+    fit_amplitude *= frame.charge_scale;
+    fit_center = fit_center * frame.length_scale + frame.origin_x;
+    fit_gamma *= frame.length_scale;
+    fit_vertical_offset *= frame.charge_scale;
+    fit_amplitude_err *= frame.charge_scale;
+    fit_center_err *= frame.length_scale;
+    fit_gamma_err *= frame.length_scale;
+    fit_vertical_offset_err *= frame.charge_scale;
+    if (!Constants::ENABLE_VERTICAL_CHARGE_UNCERTAINTIES) {
+        // Unit weights: χ² scales with the squared charge scale
+        chi2_reduced *= frame.charge_scale * frame.charge_scale;
+    }
+    return success;
+}
+
 PowerLorentzianFit2DResultsCeres Fit2DPowerLorentzianCeres(
     const std::vector<double>& x_coords,
     const std::vector<double>& y_coords, 
@@ -900,9 +808,9 @@ PowerLorentzianFit2DResultsCeres Fit2DPowerLorentzianCeres(
         std::cout << "Starting 2D Power Lorentzian fit (Ceres) with " << x_coords.size() << " data points" << std::endl;
     }
     
-    // Create maps to group data by rows and columns
-    std::map<double, std::vector<std::pair<double, double>>> rows_data; // y -> [(x, charge), ...]
-    std::map<double, std::vector<std::pair<double, double>>> cols_data; // x -> [(y, charge), ...]
+    // Create maps to group data by rows and columns (on the per-event arena)
+    ArenaPointGroups<double> rows_data(GetEventArena()); // y -> [(x, charge), ...]
+    ArenaPointGroups<double> cols_data(GetEventArena()); // x -> [(y, charge), ...]
     
     // Group data points by rows and columns (within pixel spacing tolerance)
     const double tolerance = pixel_spacing * 0.1; // 10% tolerance for grouping
@@ -1116,7 +1024,7 @@ PowerLorentzianOutlierRemovalResult RemovePowerLorentzianOutliers(
     }
     
     // Calculate robust statistics for outlier detection
-    DataStatistics stats = CalculateRobustStatisticsPowerLorentzian(x_coords, charge_values);
+    DataStatistics stats = CalculateRobustStatisticsPowerLorentzian(AnalyzeDataset(x_coords, charge_values));
     if (!stats.valid) {
         // Fall back to original data if statistics calculation fails
         result.filtered_x_coords = x_coords;
@@ -1225,8 +1133,8 @@ DiagonalPowerLorentzianFitResultsCeres FitDiagonalPowerLorentzianCeres(
     const double diag_pixel_spacing = pixel_spacing * 1.41421356237; // √2, no calibration factor
     
     // Maps: binned diagonal coordinate → [(distance_along_diagonal, charge), ...]
-    std::map<int, std::vector<std::pair<double, double>>> main_diagonal_bins; // +45° direction
-    std::map<int, std::vector<std::pair<double, double>>> sec_diagonal_bins;  // -45° direction
+    ArenaPointGroups<int> main_diagonal_bins(GetEventArena()); // +45° direction
+    ArenaPointGroups<int> sec_diagonal_bins(GetEventArena());  // -45° direction
     
     for (size_t i = 0; i < x_coords.size(); ++i) {
         double x = x_coords[i];
@@ -1265,7 +1173,7 @@ DiagonalPowerLorentzianFitResultsCeres FitDiagonalPowerLorentzianCeres(
     }
     
     // Find the best bins (those with most pixels near the center)
-    auto find_best_bin = [&](const std::map<int, std::vector<std::pair<double, double>>>& bins, 
+    auto find_best_bin = [&](const ArenaPointGroups<int>& bins, 
                              const std::string& direction) -> int {
         int best_bin = 0;
         int max_pixels = 0;
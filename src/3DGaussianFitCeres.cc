@@ -1,10 +1,15 @@
 #include "3DGaussianFitCeres.hh"
 #include "CeresLoggingInit.hh"
 #include "Constants.hh"
+#include "CeresUtils.hh"
+#include "EscalationPolicy.hh"
+#include "StatsUtils.hh"
+#include "EventArena.hh"
 #include "G4SystemOfUnits.hh"
 
 #include <cmath>
 #include <algorithm>
+#include <chrono>
 #include <map>
 #include <iostream>
 // Removed mutex include - no longer needed for parallelization
@@ -102,6 +107,106 @@ private:
     const double uncertainty_;
 };
 
+// Grid-structured 3D Gaussian cost function (all pads in one residual block)
+// The axis-aligned model is separable: exp(-dx^2/2σx^2) * exp(-dy^2/2σy^2). The x factor and its
+// derivatives are evaluated once per column and the y factor once per row, so a 9x9 grid needs 9 + 9
+// exponentials instead of 81; residuals and the analytic Jacobian are products of the axis terms.
+class Gaussian3DGridCostFunction : public ceres::CostFunction {
+public:
+    Gaussian3DGridCostFunction(const SurfaceGrid& grid, const double* z_vals, size_t num_points, double uncertainty)
+        : grid_(grid), z_(z_vals, z_vals + num_points), inv_uncertainty_(1.0 / uncertainty),
+          gx_(grid.column_x.size()), dgx_dm_(grid.column_x.size()), dgx_ds_(grid.column_x.size()),
+          gy_(grid.row_y.size()), dgy_dm_(grid.row_y.size()), dgy_ds_(grid.row_y.size()) {
+        set_num_residuals(static_cast<int>(num_points));
+        mutable_parameter_block_sizes()->push_back(6);
+    }
+    
+    bool Evaluate(double const* const* parameters, double* residuals, double** jacobians) const override {
+        const double* params = parameters[0];
+        const double A = params[0];
+        const double B = params[5];
+        
+        EvaluateAxis(grid_.column_x, params[1], params[3], gx_, dgx_dm_, dgx_ds_);
+        EvaluateAxis(grid_.row_y, params[2], params[4], gy_, dgy_dm_, dgy_ds_);
+        
+        double* jacobian = (jacobians && jacobians[0]) ? jacobians[0] : nullptr;
+        
+        for (size_t i = 0; i < z_.size(); ++i) {
+            const int c = grid_.point_column[i];
+            const int r = grid_.point_row[i];
+            const double g = gx_[c] * gy_[r];
+            
+            residuals[i] = (A * g + B - z_[i]) * inv_uncertainty_;
+            
+            if (jacobian) {
+                double* J = jacobian + 6 * i;
+                const double scaled_A = A * inv_uncertainty_;
+                J[0] = g * inv_uncertainty_;
+                J[1] = scaled_A * dgx_dm_[c] * gy_[r];
+                J[2] = scaled_A * gx_[c] * dgy_dm_[r];
+                J[3] = scaled_A * dgx_ds_[c] * gy_[r];
+                J[4] = scaled_A * gx_[c] * dgy_ds_[r];
+                J[5] = inv_uncertainty_;
+            }
+        }
+        
+        return true;
+    }
+    
+private:
+    // exp(-(p - m)^2 / 2σ^2) and its derivatives w.r.t. m and the raw σ parameter
+    // (same |σ| >= 1e-12 and exponent >= -200 guards as Gaussian3DCostFunction)
+    static void EvaluateAxis(const std::vector<double>& positions, double m, double sigma,
+                             std::vector<double>& g, std::vector<double>& dg_dm, std::vector<double>& dg_ds) {
+        double safe_sigma = std::abs(sigma);
+        double sigma_sign = (sigma < 0) ? -1.0 : 1.0;
+        if (safe_sigma < 1e-12) {
+            safe_sigma = 1e-12;
+            sigma_sign = 0.0;
+        }
+        const double inv_sigma2 = 1.0 / (safe_sigma * safe_sigma);
+        
+        for (size_t k = 0; k < positions.size(); ++k) {
+            const double d = positions[k] - m;
+            const double exponent = -0.5 * d * d * inv_sigma2;
+            if (exponent < -200.0) {
+                g[k] = std::exp(-200.0);
+                dg_dm[k] = 0.0;
+                dg_ds[k] = 0.0;
+                continue;
+            }
+            g[k] = std::exp(exponent);
+            dg_dm[k] = g[k] * d * inv_sigma2;
+            dg_ds[k] = sigma_sign * g[k] * d * d * inv_sigma2 / safe_sigma;
+        }
+    }
+    
+    const SurfaceGrid grid_;
+    const std::vector<double> z_;
+    const double inv_uncertainty_;
+    
+    // Per-axis scratch (a Problem evaluates its cost functions from a single thread here)
+    mutable std::vector<double> gx_, dgx_dm_, dgx_ds_;
+    mutable std::vector<double> gy_, dgy_dm_, dgy_ds_;
+};
+
+// Add the 3D Gaussian residuals for a dataset to the problem (grid-structured or per pad)
+static void AddGaussian3DResiduals(ceres::Problem& problem, double* parameters,
+                                   const double* x_vals, const double* y_vals, const double* z_vals,
+                                   size_t num_points, double uncertainty, double pixel_spacing) {
+    if (Constants::ENABLE_SEPARABLE_3D_COST) {
+        SurfaceGrid grid = BuildSurfaceGrid(x_vals, y_vals, num_points, 1e-6 * pixel_spacing);
+        problem.AddResidualBlock(new Gaussian3DGridCostFunction(grid, z_vals, num_points, uncertainty), nullptr, parameters);
+        return;
+    }
+    
+    for (size_t i = 0; i < num_points; ++i) {
+        ceres::CostFunction* cost_function = Gaussian3DCostFunction::Create(
+            x_vals[i], y_vals[i], z_vals[i], uncertainty);
+        problem.AddResidualBlock(cost_function, nullptr, parameters);
+    }
+}
+
 // Parameter estimation structures for 3D Gaussian
 struct Gaussian3DParameterEstimates {
     double amplitude;
@@ -136,92 +241,32 @@ struct Data3DStatistics {
     bool valid;
 };
 
-static Data3DStatistics CalculateRobust3DStatistics(const std::vector<double>& x_vals, 
-                                                    const std::vector<double>& y_vals,
-                                                    const std::vector<double>& z_vals) {
+// View of the per-dataset analysis (computed once in StatsUtils, no re-sorting here)
+static Data3DStatistics CalculateRobust3DStatistics(const DatasetAnalysis& analysis) {
     Data3DStatistics stats;
-    stats.valid = false;
-    
-    if (x_vals.size() != y_vals.size() || x_vals.size() != z_vals.size() || x_vals.empty()) {
-        return stats;
-    }
-    
-    // Basic statistics on Z values (charge)
-    stats.min_val = *std::min_element(z_vals.begin(), z_vals.end());
-    stats.max_val = *std::max_element(z_vals.begin(), z_vals.end());
-    
-    // Mean and standard deviation
-    stats.mean = std::accumulate(z_vals.begin(), z_vals.end(), 0.0) / z_vals.size();
-    
-    double variance = 0.0;
-    for (double val : z_vals) {
-        variance += (val - stats.mean) * (val - stats.mean);
-    }
-    stats.std_dev = std::sqrt(variance / z_vals.size());
-    
-    // Median and quartiles
-    std::vector<double> sorted_z = z_vals;
-    std::sort(sorted_z.begin(), sorted_z.end());
-    
-    size_t n = sorted_z.size();
-    if (n % 2 == 0) {
-        stats.median = (sorted_z[n/2 - 1] + sorted_z[n/2]) / 2.0;
-    } else {
-        stats.median = sorted_z[n/2];
-    }
-    
-    stats.q25 = sorted_z[n/4];
-    stats.q75 = sorted_z[3*n/4];
-    
-    // Median Absolute Deviation
-    std::vector<double> abs_deviations;
-    for (double val : z_vals) {
-        abs_deviations.push_back(std::abs(val - stats.median));
-    }
-    std::sort(abs_deviations.begin(), abs_deviations.end());
-    stats.mad = abs_deviations[n/2] * 1.4826;
-    
-    // Numerical stability safeguard
-    if (!std::isfinite(stats.mad) || stats.mad < 1e-12) {
-        stats.mad = (std::isfinite(stats.std_dev) && stats.std_dev > 1e-12) ?
-                    stats.std_dev : 1e-12;
-    }
-    
-    // Weighted statistics for center estimation (weight by charge value)
-    stats.weighted_mean_x = 0.0;
-    stats.weighted_mean_y = 0.0;
-    stats.total_weight = 0.0;
-    
-    for (size_t i = 0; i < x_vals.size(); ++i) {
-        double weight = std::max(0.0, z_vals[i] - stats.q25);
-        if (weight > 0) {
-            stats.weighted_mean_x += x_vals[i] * weight;
-            stats.weighted_mean_y += y_vals[i] * weight;
-            stats.total_weight += weight;
-        }
-    }
-    
-    if (stats.total_weight > 0) {
-        stats.weighted_mean_x /= stats.total_weight;
-        stats.weighted_mean_y /= stats.total_weight;
-        stats.robust_center_x = stats.weighted_mean_x;
-        stats.robust_center_y = stats.weighted_mean_y;
-    } else {
-        stats.weighted_mean_x = std::accumulate(x_vals.begin(), x_vals.end(), 0.0) / x_vals.size();
-        stats.weighted_mean_y = std::accumulate(y_vals.begin(), y_vals.end(), 0.0) / y_vals.size();
-        stats.robust_center_x = stats.weighted_mean_x;
-        stats.robust_center_y = stats.weighted_mean_y;
-    }
-    
-    stats.valid = true;
+    stats.mean = analysis.mean;
+    stats.median = analysis.median;
+    stats.std_dev = analysis.std_dev;
+    stats.mad = analysis.mad;
+    stats.q25 = analysis.q25;
+    stats.q75 = analysis.q75;
+    stats.min_val = analysis.min_val;
+    stats.max_val = analysis.max_val;
+    stats.weighted_mean_x = analysis.weighted_mean_x;
+    stats.weighted_mean_y = analysis.weighted_mean_y;
+    stats.total_weight = analysis.total_weight;
+    stats.robust_center_x = analysis.weighted_mean_x;
+    stats.robust_center_y = analysis.weighted_mean_y;
+    stats.valid = analysis.valid;
     return stats;
 }
 
 // Parameter estimation for 3D Gaussian distributions
 static Gaussian3DParameterEstimates Estimate3DGaussianParameters(
-    const std::vector<double>& x_vals,
-    const std::vector<double>& y_vals,
-    const std::vector<double>& z_vals,
+    const ArenaDoubleVector& x_vals,
+    const ArenaDoubleVector& y_vals,
+    const ArenaDoubleVector& z_vals,
+    const DatasetAnalysis& analysis,
     double center_x_estimate,
     double center_y_estimate,
     double pixel_spacing,
@@ -235,7 +280,7 @@ static Gaussian3DParameterEstimates Estimate3DGaussianParameters(
         return estimates;
     }
     
-    Data3DStatistics stats = CalculateRobust3DStatistics(x_vals, y_vals, z_vals);
+    Data3DStatistics stats = CalculateRobust3DStatistics(analysis);
     if (!stats.valid) {
         return estimates;
     }
@@ -340,81 +385,8 @@ static Gaussian3DParameterEstimates Estimate3DGaussianParameters(
     return estimates;
 }
 
-// Outlier filtering for 3D Gaussian fitting (adapted from 3D Lorentzian version)
-static std::tuple<std::vector<double>, std::vector<double>, std::vector<double>> Filter3DGaussianOutliers(
-    const std::vector<double>& x_vals,
-    const std::vector<double>& y_vals,
-    const std::vector<double>& z_vals,
-    double sigma_threshold = 2.5,
-    bool verbose = false) {
-    
-    std::vector<double> filtered_x, filtered_y, filtered_z;
-    
-    if (x_vals.size() != y_vals.size() || x_vals.size() != z_vals.size() || x_vals.size() < 6) {
-        return std::make_tuple(filtered_x, filtered_y, filtered_z);
-    }
-    
-    Data3DStatistics stats = CalculateRobust3DStatistics(x_vals, y_vals, z_vals);
-    if (!stats.valid) {
-        return std::make_tuple(x_vals, y_vals, z_vals);
-    }
-    
-    // Use MAD-based outlier detection
-    double outlier_threshold = stats.median + sigma_threshold * stats.mad;
-    double lower_threshold = stats.median - sigma_threshold * stats.mad;
-    
-    int outliers_removed = 0;
-    for (size_t i = 0; i < z_vals.size(); ++i) {
-        if (z_vals[i] >= lower_threshold && z_vals[i] <= outlier_threshold) {
-            filtered_x.push_back(x_vals[i]);
-            filtered_y.push_back(y_vals[i]);
-            filtered_z.push_back(z_vals[i]);
-        } else {
-            outliers_removed++;
-        }
-    }
-    
-    // Use lenient filtering if too many outliers removed
-    if (filtered_x.size() < x_vals.size() / 2) {
-        if (verbose) {
-            std::cout << "Too many 3D Gaussian outliers detected (" << outliers_removed 
-                     << "), using lenient filtering" << std::endl;
-        }
-        
-        filtered_x.clear();
-        filtered_y.clear();
-        filtered_z.clear();
-        
-        double extreme_threshold = stats.median + 5.0 * stats.mad;
-        double extreme_lower = stats.median - 5.0 * stats.mad;
-        
-        for (size_t i = 0; i < z_vals.size(); ++i) {
-            if (z_vals[i] >= extreme_lower && z_vals[i] <= extreme_threshold) {
-                filtered_x.push_back(x_vals[i]);
-                filtered_y.push_back(y_vals[i]);
-                filtered_z.push_back(z_vals[i]);
-            }
-        }
-    }
-    
-    if (filtered_x.size() < 6) {
-        if (verbose) {
-            std::cout << "Warning: After 3D Gaussian outlier filtering, only " << filtered_x.size() 
-                     << " points remain" << std::endl;
-        }
-        return std::make_tuple(x_vals, y_vals, z_vals);
-    }
-    
-    if (verbose && outliers_removed > 0) {
-        std::cout << "Removed " << outliers_removed << " 3D Gaussian outliers, " 
-                 << filtered_x.size() << " points remaining" << std::endl;
-    }
-    
-    return std::make_tuple(filtered_x, filtered_y, filtered_z);
-}
-
 // Core 3D Gaussian fitting function using Ceres Solver
-bool Fit3DGaussianCeres(
+static bool Fit3DGaussianCeresRaw(
     const std::vector<double>& x_vals,
     const std::vector<double>& y_vals,
     const std::vector<double>& z_vals,
@@ -444,23 +416,30 @@ bool Fit3DGaussianCeres(
         return false;
     }
     
-    // Multiple outlier filtering strategies
-    std::vector<std::tuple<std::vector<double>, std::vector<double>, std::vector<double>>> filtered_datasets;
+    // Robust statistics of the input, computed once and shared by every filter level and config
+    DatasetAnalysis full_analysis = AnalyzeDataset(x_vals, y_vals, z_vals);
+    
+    // Multiple outlier filtering strategies, as index masks over the input
+    std::vector<std::vector<size_t>> filtered_datasets;
     
     if (enable_outlier_filtering) {
-        auto conservative_data = Filter3DGaussianOutliers(x_vals, y_vals, z_vals, 2.5, verbose);
-        if (std::get<0>(conservative_data).size() >= 6) {
+        // Conservative filtering (2.5-sigma)
+        std::vector<size_t> conservative_data = SelectOutlierFreeIndices(full_analysis, 2.5, 5.0, 6, verbose);
+        if (conservative_data.size() >= 6) {
             filtered_datasets.push_back(conservative_data);
         }
         
-        auto lenient_data = Filter3DGaussianOutliers(x_vals, y_vals, z_vals, 3.0, verbose);
-        if (std::get<0>(lenient_data).size() >= 6) {
+        // Lenient filtering (3.0-sigma)
+        std::vector<size_t> lenient_data = SelectOutlierFreeIndices(full_analysis, 3.0, 5.0, 6, verbose);
+        if (lenient_data.size() >= 6 && lenient_data != conservative_data) {
             filtered_datasets.push_back(lenient_data);
         }
     }
     
-    // Always include original data as fallback
-    filtered_datasets.push_back(std::make_tuple(x_vals, y_vals, z_vals));
+    // No filtering (use all data) - always available as fallback, unless a filter kept every point
+    if (filtered_datasets.empty() || filtered_datasets.back() != full_analysis.indices) {
+        filtered_datasets.push_back(full_analysis.indices);
+    }
     
     if (verbose) {
         std::cout << "3D Gaussian outlier filtering " << (enable_outlier_filtering ? "enabled" : "disabled") 
@@ -469,18 +448,19 @@ bool Fit3DGaussianCeres(
     
     // Try each filtered dataset
     for (size_t dataset_idx = 0; dataset_idx < filtered_datasets.size(); ++dataset_idx) {
-        std::vector<double> clean_x = std::get<0>(filtered_datasets[dataset_idx]);
-        std::vector<double> clean_y = std::get<1>(filtered_datasets[dataset_idx]);
-        std::vector<double> clean_z = std::get<2>(filtered_datasets[dataset_idx]);
+        if (filtered_datasets[dataset_idx].size() < 6) continue;
         
-        if (clean_x.size() < 6) continue;
+        // Statistics of this subset (the unfiltered set reuses the full analysis); solver input gathered once
+        DatasetAnalysis analysis = AnalyzeSubset(full_analysis, filtered_datasets[dataset_idx]);
+        ArenaDoubleVector clean_x(GetEventArena()), clean_y(GetEventArena()), clean_z(GetEventArena());
+        GatherDataset(analysis, clean_x, clean_y, clean_z);
         
         if (verbose) {
             std::cout << "Trying 3D Gaussian dataset " << dataset_idx << " with " << clean_x.size() << " points" << std::endl;
         }
         
         // Get parameter estimates
-        Gaussian3DParameterEstimates estimates = Estimate3DGaussianParameters(clean_x, clean_y, clean_z, center_x_estimate, center_y_estimate, pixel_spacing, verbose);
+        Gaussian3DParameterEstimates estimates = Estimate3DGaussianParameters(clean_x, clean_y, clean_z, analysis, center_x_estimate, center_y_estimate, pixel_spacing, verbose);
         if (!estimates.valid) {
             if (verbose) {
                 std::cout << "3D Gaussian parameter estimation failed for dataset " << dataset_idx << std::endl;
@@ -549,7 +529,7 @@ bool Fit3DGaussianCeres(
             double best_chi2_reduced = std::numeric_limits<double>::max();
             
             // Data characteristics for adaptive bounds
-            Data3DStatistics data_stats = CalculateRobust3DStatistics(clean_x, clean_y, clean_z);
+            Data3DStatistics data_stats = CalculateRobust3DStatistics(analysis);
             double data_spread_x = *std::max_element(clean_x.begin(), clean_x.end()) - 
                                  *std::min_element(clean_x.begin(), clean_x.end());
             double data_spread_y = *std::max_element(clean_y.begin(), clean_y.end()) - 
@@ -575,12 +555,8 @@ bool Fit3DGaussianCeres(
                 parameters[5] = guess.params[5];
             
                 ceres::Problem problem;
-                
-                for (size_t i = 0; i < clean_x.size(); ++i) {
-                    ceres::CostFunction* cost_function = Gaussian3DCostFunction::Create(
-                        clean_x[i], clean_y[i], clean_z[i], uncertainty);
-                    problem.AddResidualBlock(cost_function, nullptr, parameters);
-                }
+                AddGaussian3DResiduals(problem, parameters, clean_x.data(), clean_y.data(), clean_z.data(), clean_x.size(),
+                                       uncertainty, pixel_spacing);
                 
                 // Set adaptive bounds
                 double max_charge_val = *std::max_element(clean_z.begin(), clean_z.end());
@@ -634,7 +610,7 @@ bool Fit3DGaussianCeres(
                 options.minimizer_progress_to_stdout = false;
             
                 ceres::Solver::Summary summary;
-                ceres::Solve(options, &problem, &summary);
+                SolveFitProblem(options, &problem, &summary);
                 
                 bool fit_successful = (summary.termination_type == ceres::CONVERGENCE ||
                                       summary.termination_type == ceres::USER_SUCCESS) &&
@@ -689,12 +665,8 @@ bool Fit3DGaussianCeres(
                     std::copy(perturbed_set.params, perturbed_set.params + 6, parameters);
                     
                     ceres::Problem problem;
-                    
-                    for (size_t i = 0; i < clean_x.size(); ++i) {
-                        ceres::CostFunction* cost_function = Gaussian3DCostFunction::Create(
-                            clean_x[i], clean_y[i], clean_z[i], uncertainty);
-                        problem.AddResidualBlock(cost_function, nullptr, parameters);
-                    }
+                    AddGaussian3DResiduals(problem, parameters, clean_x.data(), clean_y.data(), clean_z.data(), clean_x.size(),
+                                           uncertainty, pixel_spacing);
                     
                     // Apply same bounds as before (abbreviated)
                     double max_charge_val = *std::max_element(clean_z.begin(), clean_z.end());
@@ -746,7 +718,7 @@ bool Fit3DGaussianCeres(
                     options.minimizer_progress_to_stdout = false;
                     
                     ceres::Solver::Summary summary;
-                    ceres::Solve(options, &problem, &summary);
+                    SolveFitProblem(options, &problem, &summary);
                     
                     bool fit_successful = (summary.termination_type == ceres::CONVERGENCE ||
                                           summary.termination_type == ceres::USER_SUCCESS) &&
@@ -788,7 +760,7 @@ bool Fit3DGaussianCeres(
                 fit_vertical_offset = best_parameters[5];
                 
                 // Simple fallback uncertainty estimation
-                Data3DStatistics data_stats = CalculateRobust3DStatistics(clean_x, clean_y, clean_z);
+                Data3DStatistics data_stats = CalculateRobust3DStatistics(analysis);
                 fit_amplitude_err = std::max(0.02 * fit_amplitude, 0.1 * data_stats.mad);
                 fit_center_x_err = std::max(0.02 * pixel_spacing, fit_sigma_x / 10.0);
                 fit_center_y_err = std::max(0.02 * pixel_spacing, fit_sigma_y / 10.0);
@@ -815,12 +787,18 @@ bool Fit3DGaussianCeres(
             return false;
         };
         
+        // Ladder statistics: which stage produced the accepted fit for this model and neighborhood size
+        const EscalationModel escalation_model = EscalationModel::GAUSSIAN_3D;
+        const int neighborhood_class = GetEscalationNeighborhoodClass(x_vals.size(), true);
+        
         // OPTIMIZED SOLVER ESCALATION: Try cheap config first, escalate only if needed
+        RecordEscalationAttempt(escalation_model, neighborhood_class, 0);
         bool success = try_config(cheap_config, "cheap");
         
         // Early exit quality check (as per optimize.md section 4.1)
         // Updated threshold based on actual data: χ²ᵣ ≤ 0.7 (around P75 of real distribution)
         if (success && chi2_reduced <= 0.7) {
+            RecordEscalationAccepted(escalation_model, neighborhood_class, 0);
             if (verbose) {
                 std::cout << "Early exit: cheap 3D Gaussian config succeeded with χ²ᵣ=" << chi2_reduced << " ≤ 0.7" << std::endl;
             }
@@ -829,14 +807,18 @@ bool Fit3DGaussianCeres(
         
         // Escalate to expensive configs only if cheap failed or quality poor
         if (!success || chi2_reduced > 0.7) {
+            RecordFitFallback();
             if (verbose) {
                 std::cout << "Escalating to expensive 3D Gaussian configurations (χ²ᵣ=" << chi2_reduced 
                          << ", success=" << success << ")" << std::endl;
             }
             
-            for (size_t i = 0; i < expensive_configs.size(); ++i) {
-                success = try_config(expensive_configs[i], "expensive_" + std::to_string(i+1));
+            const int num_stages = 1 + static_cast<int>(expensive_configs.size());
+            for (int stage : GetEscalationOrder(escalation_model, neighborhood_class, num_stages)) {
+                RecordEscalationAttempt(escalation_model, neighborhood_class, stage);
+                success = try_config(expensive_configs[stage - 1], "expensive_" + std::to_string(stage));
                 if (success && chi2_reduced <= 3.0) {
+                    RecordEscalationAccepted(escalation_model, neighborhood_class, stage);
                     return true;
                 }
             }
@@ -851,6 +833,176 @@ bool Fit3DGaussianCeres(
     return false;
 }
 
+// 3D Gaussian fit in the normalized frame: positions in pitch units around the center estimate and
+// charges divided by their maximum; parameters, uncertainties and χ²ᵣ are transformed back
+bool Fit3DGaussianCeres(
+    const std::vector<double>& x_vals,
+    const std::vector<double>& y_vals,
+    const std::vector<double>& z_vals,
+    double center_x_estimate,
+    double center_y_estimate,
+    double pixel_spacing,
+    double& fit_amplitude,
+    double& fit_center_x,
+    double& fit_center_y,
+    double& fit_sigma_x,
+    double& fit_sigma_y,
+    double& fit_vertical_offset,
+    double& fit_amplitude_err,
+    double& fit_center_x_err,
+    double& fit_center_y_err,
+    double& fit_sigma_x_err,
+    double& fit_sigma_y_err,
+    double& fit_vertical_offset_err,
+    double& chi2_reduced,
+    bool verbose,
+    bool enable_outlier_filtering) {
+    RecordFitStart();
+    if (!Constants::ENABLE_NORMALIZED_FIT_FRAME || x_vals.empty() || y_vals.empty()) {
+        return Fit3DGaussianCeresRaw(
+            x_vals, y_vals, z_vals, center_x_estimate, center_y_estimate, pixel_spacing, fit_amplitude,
+            fit_center_x, fit_center_y, fit_sigma_x, fit_sigma_y, fit_vertical_offset, fit_amplitude_err,
+            fit_center_x_err, fit_center_y_err, fit_sigma_x_err, fit_sigma_y_err, fit_vertical_offset_err,
+            chi2_reduced, verbose, enable_outlier_filtering);
+    }
+    
+    // Sampled raw-frame solve of the same data, result discarded (see ScopedRawFrameReference)
+    if (ShouldSampleRawFrameReference()) {
+        ScopedRawFrameReference reference_scope;
+        double reference[13];
+        Fit3DGaussianCeresRaw(
+            x_vals, y_vals, z_vals, center_x_estimate, center_y_estimate, pixel_spacing,
+            reference[0], reference[1], reference[2], reference[3], reference[4], reference[5],
+            reference[6], reference[7], reference[8], reference[9], reference[10], reference[11],
+            reference[12], false, enable_outlier_filtering);
+    }
+    
+    NormalizedFitFrame frame = MakeNormalizedFitFrame(center_x_estimate, center_y_estimate, pixel_spacing, z_vals);
+    ScopedNormalizedFitFrame frame_scope(frame);
+    std::vector<double> frame_x = ToFrameValues(x_vals, frame.origin_x, frame.length_scale);
+    std::vector<double> frame_y = ToFrameValues(y_vals, frame.origin_y, frame.length_scale);
+    std::vector<double> frame_z = ToFrameValues(z_vals, 0.0, frame.charge_scale);
+    
+    bool success = Fit3DGaussianCeresRaw(
+        frame_x, frame_y, frame_z, 0.0, 0.0, 1.0,
+        fit_amplitude, fit_center_x, fit_center_y, fit_sigma_x, fit_sigma_y, fit_vertical_offset,
+        fit_amplitude_err, fit_center_x_err, fit_center_y_err, fit_sigma_x_err, fit_sigma_y_err, fit_vertical_offset_err,
+        chi2_reduced, verbose, enable_outlier_filtering);
+    
+    fit_amplitude *= frame.charge_scale;
+    fit_center_x = fit_center_x * frame.length_scale + frame.origin_x;
+    fit_center_y = fit_center_y * frame.length_scale + frame.origin_y;
+    fit_sigma_x *= frame.length_scale;
+    fit_sigma_y *= frame.length_scale;
+    fit_vertical_offset *= frame.charge_scale;
+    fit_amplitude_err *= frame.charge_scale;
+    fit_center_x_err *= frame.length_scale;
+    fit_center_y_err *= frame.length_scale;
+    fit_sigma_x_err *= frame.length_scale;
+    fit_sigma_y_err *= frame.length_scale;
+    fit_vertical_offset_err *= frame.charge_scale;
+    if (!Constants::ENABLE_VERTICAL_CHARGE_UNCERTAINTIES) {
+        // Unit weights: χ² scales with the squared charge scale
+        chi2_reduced *= frame.charge_scale * frame.charge_scale;
+    }
+    return success;
+}
+
+// Coarse-to-fine 3D Gaussian fit: fit the core around the max-charge pad, then refine briefly on the
+// full grid from that solution (skipped when the core solution already meets the χ²ᵣ criterion there)
+static bool Fit3DGaussianCoarseToFine(
+    const std::vector<double>& x_coords,
+    const std::vector<double>& y_coords,
+    const std::vector<double>& charge_values,
+    double center_x_estimate,
+    double center_y_estimate,
+    double pixel_spacing,
+    GaussianFit3DResultsCeres& result,
+    bool verbose)
+{
+    std::vector<int> core = SelectCorePads(x_coords, y_coords, charge_values, pixel_spacing,
+                                           Constants::COARSE_TO_FINE_CORE_RADIUS);
+    if (core.size() < 6 || core.size() >= x_coords.size()) {
+        return false;
+    }
+    
+    // Core and full grid differ from here on: any failure below sends the fit to the full-grid fallback
+    result.fit_stage = static_cast<int>(CoarseToFineStage::FULL_FALLBACK);
+    
+    std::vector<double> core_x, core_y, core_z;
+    core_x.reserve(core.size());
+    core_y.reserve(core.size());
+    core_z.reserve(core.size());
+    for (int index : core) {
+        core_x.push_back(x_coords[index]);
+        core_y.push_back(y_coords[index]);
+        core_z.push_back(charge_values[index]);
+    }
+    
+    // Stage 1: core fit (no outlier filtering, the core holds the highest-information pads)
+    double core_chi2 = 0.0;
+    if (!Fit3DGaussianCeres(
+            core_x, core_y, core_z, center_x_estimate, center_y_estimate, pixel_spacing,
+            result.amplitude, result.center_x, result.center_y, result.sigma_x, result.sigma_y, result.vertical_offset,
+            result.amplitude_err, result.center_x_err, result.center_y_err, result.sigma_x_err, result.sigma_y_err, result.vertical_offset_err,
+            core_chi2, verbose, false)) {
+        return false;
+    }
+    
+    // Full-grid χ²ᵣ at the core solution decides whether the refinement is needed
+    double parameters[6] = {result.amplitude, result.center_x, result.center_y,
+                             result.sigma_x, result.sigma_y, result.vertical_offset};
+    double max_charge = *std::max_element(charge_values.begin(), charge_values.end());
+    double min_charge = *std::min_element(charge_values.begin(), charge_values.end());
+    int num_points = static_cast<int>(x_coords.size());
+    
+    ceres::Problem problem;
+    AddGaussian3DResiduals(problem, parameters, x_coords.data(), y_coords.data(), charge_values.data(), x_coords.size(),
+                           Calculate3DGaussianUncertainty(max_charge), pixel_spacing);
+    double full_chi2 = EvaluateReducedChi2(problem, num_points, 6);
+    
+    if (full_chi2 <= Constants::COARSE_TO_FINE_SKIP_CHI2) {
+        result.fit_stage = static_cast<int>(CoarseToFineStage::CORE_ONLY);
+        if (verbose) {
+            std::cout << "3D Gaussian core fit (" << core.size() << " pads) accepted on full grid, χ²ᵣ="
+                     << full_chi2 << std::endl;
+        }
+    } else {
+        // Stage 2: short full-grid refinement from the core solution
+        if (!RefineSurfaceFit(problem, parameters, 6, num_points, max_charge - min_charge, pixel_spacing,
+                              Constants::COARSE_TO_FINE_REFINE_ITERATIONS, full_chi2)) {
+            return false;
+        }
+        
+        result.amplitude = parameters[0];
+        result.center_x = parameters[1];
+        result.center_y = parameters[2];
+        result.sigma_x = std::abs(parameters[3]);
+        result.sigma_y = std::abs(parameters[4]);
+        result.vertical_offset = parameters[5];
+        result.fit_stage = static_cast<int>(CoarseToFineStage::CORE_REFINED);
+        if (verbose) {
+            std::cout << "3D Gaussian core fit (" << core.size() << " pads) refined on full grid, χ²ᵣ="
+                     << full_chi2 << std::endl;
+        }
+    }
+    result.chi2red = full_chi2;
+    
+    // Uncertainties of the accepted solution on the full grid (the core fit's only describe the core pads;
+    // they are kept if the full-grid covariance is rank deficient). Unit weights scale by χ²ᵣ
+    double errors[6];
+    const double variance_scale = Constants::ENABLE_VERTICAL_CHARGE_UNCERTAINTIES ? 1.0 : full_chi2;
+    if (ComputeParameterErrors(problem, parameters, 6, variance_scale, errors)) {
+        result.amplitude_err = errors[0];
+        result.center_x_err = errors[1];
+        result.center_y_err = errors[2];
+        result.sigma_x_err = errors[3];
+        result.sigma_y_err = errors[4];
+        result.vertical_offset_err = errors[5];
+    }
+    return true;
+}
+
 GaussianFit3DResultsCeres Fit3DGaussianCeres(
     const std::vector<double>& x_coords,
     const std::vector<double>& y_coords, 
@@ -905,11 +1057,36 @@ GaussianFit3DResultsCeres Fit3DGaussianCeres(
     }
     
     // Perform 3D Gaussian surface fitting
-    bool fit_success = Fit3DGaussianCeres(
-        x_coords, y_coords, charge_values, center_x_estimate, center_y_estimate, pixel_spacing,
-        result.amplitude, result.center_x, result.center_y, result.sigma_x, result.sigma_y, result.vertical_offset,
-        result.amplitude_err, result.center_x_err, result.center_y_err, result.sigma_x_err, result.sigma_y_err, result.vertical_offset_err,
-        result.chi2red, verbose, enable_outlier_filtering);
+    const double raw_reference_start_ms = RawFrameReferenceTimeMs();
+    auto fit_start = std::chrono::steady_clock::now();
+    bool fit_success = false;
+    if (Constants::ENABLE_COARSE_TO_FINE_3D) {
+        fit_success = Fit3DGaussianCoarseToFine(x_coords, y_coords, charge_values, center_x_estimate, center_y_estimate,
+                                                pixel_spacing, result, verbose);
+    }
+    if (!fit_success) {
+        fit_success = Fit3DGaussianCeres(
+            x_coords, y_coords, charge_values, center_x_estimate, center_y_estimate, pixel_spacing,
+            result.amplitude, result.center_x, result.center_y, result.sigma_x, result.sigma_y, result.vertical_offset,
+            result.amplitude_err, result.center_x_err, result.center_y_err, result.sigma_x_err, result.sigma_y_err, result.vertical_offset_err,
+            result.chi2red, verbose, enable_outlier_filtering);
+    }
+    result.fit_time_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - fit_start).count()
+        - (RawFrameReferenceTimeMs() - raw_reference_start_ms);
+    
+    // Time the plain full-grid fit on a sample of events for the coarse-to-fine savings estimate
+    if (Constants::ENABLE_COARSE_TO_FINE_3D && ShouldSampleCoarseToFineReference()) {
+        GaussianFit3DResultsCeres reference;
+        const double raw_reference_before_ms = RawFrameReferenceTimeMs();
+        auto reference_start = std::chrono::steady_clock::now();
+        Fit3DGaussianCeres(
+            x_coords, y_coords, charge_values, center_x_estimate, center_y_estimate, pixel_spacing,
+            reference.amplitude, reference.center_x, reference.center_y, reference.sigma_x, reference.sigma_y, reference.vertical_offset,
+            reference.amplitude_err, reference.center_x_err, reference.center_y_err, reference.sigma_x_err, reference.sigma_y_err, reference.vertical_offset_err,
+            reference.chi2red, false, enable_outlier_filtering);
+        result.reference_time_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - reference_start).count()
+            - (RawFrameReferenceTimeMs() - raw_reference_before_ms);
+    }
     
     // Calculate DOF and p-value
     result.dof = std::max(1, static_cast<int>(x_coords.size()) - 6);
@@ -1,10 +1,15 @@
 #include "3DLorentzianFitCeres.hh"
 #include "CeresLoggingInit.hh"
 #include "Constants.hh"
+#include "CeresUtils.hh"
+#include "EscalationPolicy.hh"
+#include "StatsUtils.hh"
+#include "EventArena.hh"
 #include "G4SystemOfUnits.hh"
 
 #include <cmath>
 #include <algorithm>
+#include <chrono>
 #include <map>
 #include <iostream>
 // Removed mutex include - no longer needed for parallelization
@@ -100,6 +105,99 @@ private:
     const double uncertainty_;
 };
 
+// Grid-structured 3D Lorentzian cost function (all pads in one residual block)
+// The denominator 1 + ((x - mx)/γx)^2 + ((y - my)/γy)^2 is a sum of a column term and a row term,
+// so both terms and their derivatives are evaluated once per column/row; each pad then only combines
+// them. Residuals and the analytic Jacobian match Lorentzian3DCostFunction.
+class Lorentzian3DGridCostFunction : public ceres::CostFunction {
+public:
+    Lorentzian3DGridCostFunction(const SurfaceGrid& grid, const double* z_vals, size_t num_points, double uncertainty)
+        : grid_(grid), z_(z_vals, z_vals + num_points), inv_uncertainty_(1.0 / uncertainty),
+          ux_(grid.column_x.size()), dux_dm_(grid.column_x.size()), dux_dg_(grid.column_x.size()),
+          uy_(grid.row_y.size()), duy_dm_(grid.row_y.size()), duy_dg_(grid.row_y.size()) {
+        set_num_residuals(static_cast<int>(num_points));
+        mutable_parameter_block_sizes()->push_back(6);
+    }
+    
+    bool Evaluate(double const* const* parameters, double* residuals, double** jacobians) const override {
+        const double* params = parameters[0];
+        const double A = params[0];
+        const double B = params[5];
+        
+        EvaluateAxis(grid_.column_x, params[1], params[3], ux_, dux_dm_, dux_dg_);
+        EvaluateAxis(grid_.row_y, params[2], params[4], uy_, duy_dm_, duy_dg_);
+        
+        double* jacobian = (jacobians && jacobians[0]) ? jacobians[0] : nullptr;
+        
+        for (size_t i = 0; i < z_.size(); ++i) {
+            const int c = grid_.point_column[i];
+            const int r = grid_.point_row[i];
+            const double inv_denominator = 1.0 / (1.0 + ux_[c] + uy_[r]);
+            
+            residuals[i] = (A * inv_denominator + B - z_[i]) * inv_uncertainty_;
+            
+            if (jacobian) {
+                double* J = jacobian + 6 * i;
+                // d(A/D)/dD = -A/D^2
+                const double k = -A * inv_denominator * inv_denominator * inv_uncertainty_;
+                J[0] = inv_denominator * inv_uncertainty_;
+                J[1] = k * dux_dm_[c];
+                J[2] = k * duy_dm_[r];
+                J[3] = k * dux_dg_[c];
+                J[4] = k * duy_dg_[r];
+                J[5] = inv_uncertainty_;
+            }
+        }
+        
+        return true;
+    }
+    
+private:
+    // ((p - m)/γ)^2 and its derivatives w.r.t. m and the raw γ parameter (|γ| >= 1e-12 as in the AutoDiff form)
+    static void EvaluateAxis(const std::vector<double>& positions, double m, double gamma,
+                             std::vector<double>& u, std::vector<double>& du_dm, std::vector<double>& du_dg) {
+        double safe_gamma = std::abs(gamma);
+        double gamma_sign = (gamma < 0) ? -1.0 : 1.0;
+        if (safe_gamma < 1e-12) {
+            safe_gamma = 1e-12;
+            gamma_sign = 0.0;
+        }
+        const double inv_gamma2 = 1.0 / (safe_gamma * safe_gamma);
+        
+        for (size_t k = 0; k < positions.size(); ++k) {
+            const double d = positions[k] - m;
+            u[k] = d * d * inv_gamma2;
+            du_dm[k] = -2.0 * d * inv_gamma2;
+            du_dg[k] = -2.0 * gamma_sign * u[k] / safe_gamma;
+        }
+    }
+    
+    const SurfaceGrid grid_;
+    const std::vector<double> z_;
+    const double inv_uncertainty_;
+    
+    // Per-axis scratch (a Problem evaluates its cost functions from a single thread here)
+    mutable std::vector<double> ux_, dux_dm_, dux_dg_;
+    mutable std::vector<double> uy_, duy_dm_, duy_dg_;
+};
+
+// Add the 3D Lorentzian residuals for a dataset to the problem (grid-structured or per pad)
+static void AddLorentzian3DResiduals(ceres::Problem& problem, double* parameters,
+                                     const double* x_vals, const double* y_vals, const double* z_vals,
+                                     size_t num_points, double uncertainty, double pixel_spacing) {
+    if (Constants::ENABLE_SEPARABLE_3D_COST) {
+        SurfaceGrid grid = BuildSurfaceGrid(x_vals, y_vals, num_points, 1e-6 * pixel_spacing);
+        problem.AddResidualBlock(new Lorentzian3DGridCostFunction(grid, z_vals, num_points, uncertainty), nullptr, parameters);
+        return;
+    }
+    
+    for (size_t i = 0; i < num_points; ++i) {
+        ceres::CostFunction* cost_function = Lorentzian3DCostFunction::Create(
+            x_vals[i], y_vals[i], z_vals[i], uncertainty);
+        problem.AddResidualBlock(cost_function, nullptr, parameters);
+    }
+}
+
 // Parameter estimation structures for 3D Lorentzian
 struct Lorentzian3DParameterEstimates {
     double amplitude;
@@ -134,92 +232,32 @@ struct Data3DStatistics {
     bool valid;
 };
 
-Data3DStatistics CalculateRobust3DStatistics(const std::vector<double>& x_vals, 
-                                            const std::vector<double>& y_vals,
-                                            const std::vector<double>& z_vals) {
+// View of the per-dataset analysis (computed once in StatsUtils, no re-sorting here)
+Data3DStatistics CalculateRobust3DStatistics(const DatasetAnalysis& analysis) {
     Data3DStatistics stats;
-    stats.valid = false;
-    
-    if (x_vals.size() != y_vals.size() || x_vals.size() != z_vals.size() || x_vals.empty()) {
-        return stats;
-    }
-    
-    // Basic statistics on Z values (charge)
-    stats.min_val = *std::min_element(z_vals.begin(), z_vals.end());
-    stats.max_val = *std::max_element(z_vals.begin(), z_vals.end());
-    
-    // Mean and standard deviation
-    stats.mean = std::accumulate(z_vals.begin(), z_vals.end(), 0.0) / z_vals.size();
-    
-    double variance = 0.0;
-    for (double val : z_vals) {
-        variance += (val - stats.mean) * (val - stats.mean);
-    }
-    stats.std_dev = std::sqrt(variance / z_vals.size());
-    
-    // Median and quartiles
-    std::vector<double> sorted_z = z_vals;
-    std::sort(sorted_z.begin(), sorted_z.end());
-    
-    size_t n = sorted_z.size();
-    if (n % 2 == 0) {
-        stats.median = (sorted_z[n/2 - 1] + sorted_z[n/2]) / 2.0;
-    } else {
-        stats.median = sorted_z[n/2];
-    }
-    
-    stats.q25 = sorted_z[n/4];
-    stats.q75 = sorted_z[3*n/4];
-    
-    // Median Absolute Deviation
-    std::vector<double> abs_deviations;
-    for (double val : z_vals) {
-        abs_deviations.push_back(std::abs(val - stats.median));
-    }
-    std::sort(abs_deviations.begin(), abs_deviations.end());
-    stats.mad = abs_deviations[n/2] * 1.4826;
-    
-    // Numerical stability safeguard
-    if (!std::isfinite(stats.mad) || stats.mad < 1e-12) {
-        stats.mad = (std::isfinite(stats.std_dev) && stats.std_dev > 1e-12) ?
-                    stats.std_dev : 1e-12;
-    }
-    
-    // Weighted statistics for center estimation (weight by charge value)
-    stats.weighted_mean_x = 0.0;
-    stats.weighted_mean_y = 0.0;
-    stats.total_weight = 0.0;
-    
-    for (size_t i = 0; i < x_vals.size(); ++i) {
-        double weight = std::max(0.0, z_vals[i] - stats.q25);
-        if (weight > 0) {
-            stats.weighted_mean_x += x_vals[i] * weight;
-            stats.weighted_mean_y += y_vals[i] * weight;
-            stats.total_weight += weight;
-        }
-    }
-    
-    if (stats.total_weight > 0) {
-        stats.weighted_mean_x /= stats.total_weight;
-        stats.weighted_mean_y /= stats.total_weight;
-        stats.robust_center_x = stats.weighted_mean_x;
-        stats.robust_center_y = stats.weighted_mean_y;
-    } else {
-        stats.weighted_mean_x = std::accumulate(x_vals.begin(), x_vals.end(), 0.0) / x_vals.size();
-        stats.weighted_mean_y = std::accumulate(y_vals.begin(), y_vals.end(), 0.0) / y_vals.size();
-        stats.robust_center_x = stats.weighted_mean_x;
-        stats.robust_center_y = stats.weighted_mean_y;
-    }
-    
-    stats.valid = true;
+    stats.mean = analysis.mean;
+    stats.median = analysis.median;
+    stats.std_dev = analysis.std_dev;
+    stats.mad = analysis.mad;
+    stats.q25 = analysis.q25;
+    stats.q75 = analysis.q75;
+    stats.min_val = analysis.min_val;
+    stats.max_val = analysis.max_val;
+    stats.weighted_mean_x = analysis.weighted_mean_x;
+    stats.weighted_mean_y = analysis.weighted_mean_y;
+    stats.total_weight = analysis.total_weight;
+    stats.robust_center_x = analysis.weighted_mean_x;
+    stats.robust_center_y = analysis.weighted_mean_y;
+    stats.valid = analysis.valid;
     return stats;
 }
 
 // Parameter estimation for 3D Lorentzian distributions
 Lorentzian3DParameterEstimates Estimate3DLorentzianParameters(
-    const std::vector<double>& x_vals,
-    const std::vector<double>& y_vals,
-    const std::vector<double>& z_vals,
+    const ArenaDoubleVector& x_vals,
+    const ArenaDoubleVector& y_vals,
+    const ArenaDoubleVector& z_vals,
+    const DatasetAnalysis& analysis,
     double center_x_estimate,
     double center_y_estimate,
     double pixel_spacing,
@@ -233,7 +271,7 @@ Lorentzian3DParameterEstimates Estimate3DLorentzianParameters(
         return estimates;
     }
     
-    Data3DStatistics stats = CalculateRobust3DStatistics(x_vals, y_vals, z_vals);
+    Data3DStatistics stats = CalculateRobust3DStatistics(analysis);
     if (!stats.valid) {
         return estimates;
     }
@@ -338,81 +376,8 @@ Lorentzian3DParameterEstimates Estimate3DLorentzianParameters(
     return estimates;
 }
 
-// Outlier filtering for 3D Lorentzian fitting (adapted from 2D version)
-std::tuple<std::vector<double>, std::vector<double>, std::vector<double>> Filter3DLorentzianOutliers(
-    const std::vector<double>& x_vals,
-    const std::vector<double>& y_vals,
-    const std::vector<double>& z_vals,
-    double sigma_threshold = 2.5,
-    bool verbose = false) {
-    
-    std::vector<double> filtered_x, filtered_y, filtered_z;
-    
-    if (x_vals.size() != y_vals.size() || x_vals.size() != z_vals.size() || x_vals.size() < 6) {
-        return std::make_tuple(filtered_x, filtered_y, filtered_z);
-    }
-    
-    Data3DStatistics stats = CalculateRobust3DStatistics(x_vals, y_vals, z_vals);
-    if (!stats.valid) {
-        return std::make_tuple(x_vals, y_vals, z_vals);
-    }
-    
-    // Use MAD-based outlier detection
-    double outlier_threshold = stats.median + sigma_threshold * stats.mad;
-    double lower_threshold = stats.median - sigma_threshold * stats.mad;
-    
-    int outliers_removed = 0;
-    for (size_t i = 0; i < z_vals.size(); ++i) {
-        if (z_vals[i] >= lower_threshold && z_vals[i] <= outlier_threshold) {
-            filtered_x.push_back(x_vals[i]);
-            filtered_y.push_back(y_vals[i]);
-            filtered_z.push_back(z_vals[i]);
-        } else {
-            outliers_removed++;
-        }
-    }
-    
-    // Use lenient filtering if too many outliers removed
-    if (filtered_x.size() < x_vals.size() / 2) {
-        if (verbose) {
-            std::cout << "Too many 3D Lorentzian outliers detected (" << outliers_removed 
-                     << "), using lenient filtering" << std::endl;
-        }
-        
-        filtered_x.clear();
-        filtered_y.clear();
-        filtered_z.clear();
-        
-        double extreme_threshold = stats.median + 5.0 * stats.mad;
-        double extreme_lower = stats.median - 5.0 * stats.mad;
-        
-        for (size_t i = 0; i < z_vals.size(); ++i) {
-            if (z_vals[i] >= extreme_lower && z_vals[i] <= extreme_threshold) {
-                filtered_x.push_back(x_vals[i]);
-                filtered_y.push_back(y_vals[i]);
-                filtered_z.push_back(z_vals[i]);
-            }
-        }
-    }
-    
-    if (filtered_x.size() < 6) {
-        if (verbose) {
-            std::cout << "Warning: After 3D Lorentzian outlier filtering, only " << filtered_x.size() 
-                     << " points remain" << std::endl;
-        }
-        return std::make_tuple(x_vals, y_vals, z_vals);
-    }
-    
-    if (verbose && outliers_removed > 0) {
-        std::cout << "Removed " << outliers_removed << " 3D Lorentzian outliers, " 
-                 << filtered_x.size() << " points remaining" << std::endl;
-    }
-    
-    return std::make_tuple(filtered_x, filtered_y, filtered_z);
-}
-
 // Core 3D Lorentzian fitting function using Ceres Solver
-bool Fit3DLorentzianCeres(
+static bool Fit3DLorentzianCeresRaw(
     const std::vector<double>& x_vals,
     const std::vector<double>& y_vals,
     const std::vector<double>& z_vals,
@@ -442,23 +407,30 @@ bool Fit3DLorentzianCeres(
         return false;
     }
     
-    // Multiple outlier filtering strategies
-    std::vector<std::tuple<std::vector<double>, std::vector<double>, std::vector<double>>> filtered_datasets;
+    // Robust statistics of the input, computed once and shared by every filter level and config
+    DatasetAnalysis full_analysis = AnalyzeDataset(x_vals, y_vals, z_vals);
+    
+    // Multiple outlier filtering strategies, as index masks over the input
+    std::vector<std::vector<size_t>> filtered_datasets;
     
     if (enable_outlier_filtering) {
-        auto conservative_data = Filter3DLorentzianOutliers(x_vals, y_vals, z_vals, 2.5, verbose);
-        if (std::get<0>(conservative_data).size() >= 6) {
+        // Conservative filtering (2.5-sigma)
+        std::vector<size_t> conservative_data = SelectOutlierFreeIndices(full_analysis, 2.5, 5.0, 6, verbose);
+        if (conservative_data.size() >= 6) {
             filtered_datasets.push_back(conservative_data);
         }
         
-        auto lenient_data = Filter3DLorentzianOutliers(x_vals, y_vals, z_vals, 3.0, verbose);
-        if (std::get<0>(lenient_data).size() >= 6) {
+        // Lenient filtering (3.0-sigma)
+        std::vector<size_t> lenient_data = SelectOutlierFreeIndices(full_analysis, 3.0, 5.0, 6, verbose);
+        if (lenient_data.size() >= 6 && lenient_data != conservative_data) {
             filtered_datasets.push_back(lenient_data);
         }
     }
     
-    // Always include original data as fallback
-    filtered_datasets.push_back(std::make_tuple(x_vals, y_vals, z_vals));
+    // No filtering (use all data) - always available as fallback, unless a filter kept every point
+    if (filtered_datasets.empty() || filtered_datasets.back() != full_analysis.indices) {
+        filtered_datasets.push_back(full_analysis.indices);
+    }
     
     if (verbose) {
         std::cout << "3D Lorentzian outlier filtering " << (enable_outlier_filtering ? "enabled" : "disabled") 
@@ -467,18 +439,19 @@ bool Fit3DLorentzianCeres(
     
     // Try each filtered dataset
     for (size_t dataset_idx = 0; dataset_idx < filtered_datasets.size(); ++dataset_idx) {
-        std::vector<double> clean_x = std::get<0>(filtered_datasets[dataset_idx]);
-        std::vector<double> clean_y = std::get<1>(filtered_datasets[dataset_idx]);
-        std::vector<double> clean_z = std::get<2>(filtered_datasets[dataset_idx]);
+        if (filtered_datasets[dataset_idx].size() < 6) continue;
         
-        if (clean_x.size() < 6) continue;
+        // Statistics of this subset (the unfiltered set reuses the full analysis); solver input gathered once
+        DatasetAnalysis analysis = AnalyzeSubset(full_analysis, filtered_datasets[dataset_idx]);
+        ArenaDoubleVector clean_x(GetEventArena()), clean_y(GetEventArena()), clean_z(GetEventArena());
+        GatherDataset(analysis, clean_x, clean_y, clean_z);
         
         if (verbose) {
             std::cout << "Trying 3D Lorentzian dataset " << dataset_idx << " with " << clean_x.size() << " points" << std::endl;
         }
         
         // Get parameter estimates
-        Lorentzian3DParameterEstimates estimates = Estimate3DLorentzianParameters(clean_x, clean_y, clean_z, center_x_estimate, center_y_estimate, pixel_spacing, verbose);
+        Lorentzian3DParameterEstimates estimates = Estimate3DLorentzianParameters(clean_x, clean_y, clean_z, analysis, center_x_estimate, center_y_estimate, pixel_spacing, verbose);
         if (!estimates.valid) {
             if (verbose) {
                 std::cout << "3D Lorentzian parameter estimation failed for dataset " << dataset_idx << std::endl;
@@ -547,7 +520,7 @@ bool Fit3DLorentzianCeres(
             double best_chi2_reduced = std::numeric_limits<double>::max();
             
             // Data characteristics for adaptive bounds
-            Data3DStatistics data_stats = CalculateRobust3DStatistics(clean_x, clean_y, clean_z);
+            Data3DStatistics data_stats = CalculateRobust3DStatistics(analysis);
             double data_spread_x = *std::max_element(clean_x.begin(), clean_x.end()) - 
                                  *std::min_element(clean_x.begin(), clean_x.end());
             double data_spread_y = *std::max_element(clean_y.begin(), clean_y.end()) - 
@@ -573,12 +546,8 @@ bool Fit3DLorentzianCeres(
                 parameters[5] = guess.params[5];
             
                 ceres::Problem problem;
-                
-                for (size_t i = 0; i < clean_x.size(); ++i) {
-                    ceres::CostFunction* cost_function = Lorentzian3DCostFunction::Create(
-                        clean_x[i], clean_y[i], clean_z[i], uncertainty);
-                    problem.AddResidualBlock(cost_function, nullptr, parameters);
-                }
+                AddLorentzian3DResiduals(problem, parameters, clean_x.data(), clean_y.data(), clean_z.data(), clean_x.size(),
+                                         uncertainty, pixel_spacing);
                 
                 // Set adaptive bounds
                 double max_charge_val = *std::max_element(clean_z.begin(), clean_z.end());
@@ -632,7 +601,7 @@ bool Fit3DLorentzianCeres(
                 options.minimizer_progress_to_stdout = false;
             
                 ceres::Solver::Summary summary;
-                ceres::Solve(options, &problem, &summary);
+                SolveFitProblem(options, &problem, &summary);
                 
                 bool fit_successful = (summary.termination_type == ceres::CONVERGENCE ||
                                       summary.termination_type == ceres::USER_SUCCESS) &&
@@ -692,12 +661,8 @@ bool Fit3DLorentzianCeres(
                     parameters[5] = perturbed_set.params[5];
                     
                     ceres::Problem problem;
-                    
-                    for (size_t i = 0; i < clean_x.size(); ++i) {
-                        ceres::CostFunction* cost_function = Lorentzian3DCostFunction::Create(
-                            clean_x[i], clean_y[i], clean_z[i], uncertainty);
-                        problem.AddResidualBlock(cost_function, nullptr, parameters);
-                    }
+                    AddLorentzian3DResiduals(problem, parameters, clean_x.data(), clean_y.data(), clean_z.data(), clean_x.size(),
+                                             uncertainty, pixel_spacing);
                     
                     // Apply same bounds as before
                     double max_charge_val = *std::max_element(clean_z.begin(), clean_z.end());
@@ -751,7 +716,7 @@ bool Fit3DLorentzianCeres(
                     options.minimizer_progress_to_stdout = false;
                     
                     ceres::Solver::Summary summary;
-                    ceres::Solve(options, &problem, &summary);
+                    SolveFitProblem(options, &problem, &summary);
                     
                     bool fit_successful = (summary.termination_type == ceres::CONVERGENCE ||
                                           summary.termination_type == ceres::USER_SUCCESS) &&
@@ -793,7 +758,7 @@ bool Fit3DLorentzianCeres(
                 fit_vertical_offset = best_parameters[5];
                 
                 // Simple fallback uncertainty estimation
-                Data3DStatistics data_stats = CalculateRobust3DStatistics(clean_x, clean_y, clean_z);
+                Data3DStatistics data_stats = CalculateRobust3DStatistics(analysis);
                 fit_amplitude_err = std::max(0.02 * fit_amplitude, 0.1 * data_stats.mad);
                 fit_center_x_err = std::max(0.02 * pixel_spacing, fit_gamma_x / 10.0);
                 fit_center_y_err = std::max(0.02 * pixel_spacing, fit_gamma_y / 10.0);
@@ -820,12 +785,18 @@ bool Fit3DLorentzianCeres(
             return false;
         };
         
+        // Ladder statistics: which stage produced the accepted fit for this model and neighborhood size
+        const EscalationModel escalation_model = EscalationModel::LORENTZIAN_3D;
+        const int neighborhood_class = GetEscalationNeighborhoodClass(x_vals.size(), true);
+        
         // OPTIMIZED SOLVER ESCALATION: Try cheap config first, escalate only if needed
+        RecordEscalationAttempt(escalation_model, neighborhood_class, 0);
         bool success = try_config(cheap_config, "cheap");
         
         // Early exit quality check (as per optimize.md section 4.1)
         // Updated threshold based on actual data: χ²ᵣ ≤ 0.7 (around P75 of real distribution)
         if (success && chi2_reduced <= 0.7) {
+            RecordEscalationAccepted(escalation_model, neighborhood_class, 0);
             if (verbose) {
                 std::cout << "Early exit: cheap 3D Lorentzian config succeeded with χ²ᵣ=" << chi2_reduced << " ≤ 0.7" << std::endl;
             }
@@ -834,14 +805,18 @@ bool Fit3DLorentzianCeres(
         
         // Escalate to expensive configs only if cheap failed or quality poor
         if (!success || chi2_reduced > 0.7) {
+            RecordFitFallback();
             if (verbose) {
                 std::cout << "Escalating to expensive 3D Lorentzian configurations (χ²ᵣ=" << chi2_reduced 
                          << ", success=" << success << ")" << std::endl;
             }
             
-            for (size_t i = 0; i < expensive_configs.size(); ++i) {
-                success = try_config(expensive_configs[i], "expensive_" + std::to_string(i+1));
+            const int num_stages = 1 + static_cast<int>(expensive_configs.size());
+            for (int stage : GetEscalationOrder(escalation_model, neighborhood_class, num_stages)) {
+                RecordEscalationAttempt(escalation_model, neighborhood_class, stage);
+                success = try_config(expensive_configs[stage - 1], "expensive_" + std::to_string(stage));
                 if (success && chi2_reduced <= 3.0) {
+                    RecordEscalationAccepted(escalation_model, neighborhood_class, stage);
                     return true;
                 }
             }
@@ -856,6 +831,176 @@ bool Fit3DLorentzianCeres(
     return false;
 }
 
+// 3D Lorentzian fit in the normalized frame: positions in pitch units around the center estimate and
+// charges divided by their maximum; parameters, uncertainties and χ²ᵣ are transformed back
+bool Fit3DLorentzianCeres(
+    const std::vector<double>& x_vals,
+    const std::vector<double>& y_vals,
+    const std::vector<double>& z_vals,
+    double center_x_estimate,
+    double center_y_estimate,
+    double pixel_spacing,
+    double& fit_amplitude,
+    double& fit_center_x,
+    double& fit_center_y,
+    double& fit_gamma_x,
+    double& fit_gamma_y,
+    double& fit_vertical_offset,
+    double& fit_amplitude_err,
+    double& fit_center_x_err,
+    double& fit_center_y_err,
+    double& fit_gamma_x_err,
+    double& fit_gamma_y_err,
+    double& fit_vertical_offset_err,
+    double& chi2_reduced,
+    bool verbose,
+    bool enable_outlier_filtering) {
+    RecordFitStart();
+    if (!Constants::ENABLE_NORMALIZED_FIT_FRAME || x_vals.empty() || y_vals.empty()) {
+        return Fit3DLorentzianCeresRaw(
+            x_vals, y_vals, z_vals, center_x_estimate, center_y_estimate, pixel_spacing, fit_amplitude,
+            fit_center_x, fit_center_y, fit_gamma_x, fit_gamma_y, fit_vertical_offset, fit_amplitude_err,
+            fit_center_x_err, fit_center_y_err, fit_gamma_x_err, fit_gamma_y_err, fit_vertical_offset_err,
+            chi2_reduced, verbose, enable_outlier_filtering);
+    }
+    
+    // Sampled raw-frame solve of the same data, result discarded (see ScopedRawFrameReference)
+    if (ShouldSampleRawFrameReference()) {
+        ScopedRawFrameReference reference_scope;
+        double reference[13];
+        Fit3DLorentzianCeresRaw(
+            x_vals, y_vals, z_vals, center_x_estimate, center_y_estimate, pixel_spacing,
+            reference[0], reference[1], reference[2], reference[3], reference[4], reference[5],
+            reference[6], reference[7], reference[8], reference[9], reference[10], reference[11],
+            reference[12], false, enable_outlier_filtering);
+    }
+    
+    NormalizedFitFrame frame = MakeNormalizedFitFrame(center_x_estimate, center_y_estimate, pixel_spacing, z_vals);
+    ScopedNormalizedFitFrame frame_scope(frame);
+    std::vector<double> frame_x = ToFrameValues(x_vals, frame.origin_x, frame.length_scale);
+    std::vector<double> frame_y = ToFrameValues(y_vals, frame.origin_y, frame.length_scale);
+    std::vector<double> frame_z = ToFrameValues(z_vals, 0.0, frame.charge_scale);
+    
+    bool success = Fit3DLorentzianCeresRaw(
+        frame_x, frame_y, frame_z, 0.0, 0.0, 1.0,
+        fit_amplitude, fit_center_x, fit_center_y, fit_gamma_x, fit_gamma_y, fit_vertical_offset,
+        fit_amplitude_err, fit_center_x_err, fit_center_y_err, fit_gamma_x_err, fit_gamma_y_err, fit_vertical_offset_err,
+        chi2_reduced, verbose, enable_outlier_filtering);
+    
+    fit_amplitude *= frame.charge_scale;
+    fit_center_x = fit_center_x * frame.length_scale + frame.origin_x;
+    fit_center_y = fit_center_y * frame.length_scale + frame.origin_y;
+    fit_gamma_x *= frame.length_scale;
+    fit_gamma_y *= frame.length_scale;
+    fit_vertical_offset *= frame.charge_scale;
+    fit_amplitude_err *= frame.charge_scale;
+    fit_center_x_err *= frame.length_scale;
+    fit_center_y_err *= frame.length_scale;
+    fit_gamma_x_err *= frame.length_scale;
+    fit_gamma_y_err *= frame.length_scale;
+    fit_vertical_offset_err *= frame.charge_scale;
+    if (!Constants::ENABLE_VERTICAL_CHARGE_UNCERTAINTIES) {
+        // Unit weights: χ² scales with the squared charge scale
+        chi2_reduced *= frame.charge_scale * frame.charge_scale;
+    }
+    return success;
+}
+
+// Coarse-to-fine 3D Lorentzian fit: fit the core around the max-charge pad, then refine briefly on the
+// full grid from that solution (skipped when the core solution already meets the χ²ᵣ criterion there)
+static bool Fit3DLorentzianCoarseToFine(
+    const std::vector<double>& x_coords,
+    const std::vector<double>& y_coords,
+    const std::vector<double>& charge_values,
+    double center_x_estimate,
+    double center_y_estimate,
+    double pixel_spacing,
+    LorentzianFit3DResultsCeres& result,
+    bool verbose)
+{
+    std::vector<int> core = SelectCorePads(x_coords, y_coords, charge_values, pixel_spacing,
+                                           Constants::COARSE_TO_FINE_CORE_RADIUS);
+    if (core.size() < 6 || core.size() >= x_coords.size()) {
+        return false;
+    }
+    
+    // Core and full grid differ from here on: any failure below sends the fit to the full-grid fallback
+    result.fit_stage = static_cast<int>(CoarseToFineStage::FULL_FALLBACK);
+    
+    std::vector<double> core_x, core_y, core_z;
+    core_x.reserve(core.size());
+    core_y.reserve(core.size());
+    core_z.reserve(core.size());
+    for (int index : core) {
+        core_x.push_back(x_coords[index]);
+        core_y.push_back(y_coords[index]);
+        core_z.push_back(charge_values[index]);
+    }
+    
+    // Stage 1: core fit (no outlier filtering, the core holds the highest-information pads)
+    double core_chi2 = 0.0;
+    if (!Fit3DLorentzianCeres(
+            core_x, core_y, core_z, center_x_estimate, center_y_estimate, pixel_spacing,
+            result.amplitude, result.center_x, result.center_y, result.gamma_x, result.gamma_y, result.vertical_offset,
+            result.amplitude_err, result.center_x_err, result.center_y_err, result.gamma_x_err, result.gamma_y_err, result.vertical_offset_err,
+            core_chi2, verbose, false)) {
+        return false;
+    }
+    
+    // Full-grid χ²ᵣ at the core solution decides whether the refinement is needed
+    double parameters[6] = {result.amplitude, result.center_x, result.center_y,
+                             result.gamma_x, result.gamma_y, result.vertical_offset};
+    double max_charge = *std::max_element(charge_values.begin(), charge_values.end());
+    double min_charge = *std::min_element(charge_values.begin(), charge_values.end());
+    int num_points = static_cast<int>(x_coords.size());
+    
+    ceres::Problem problem;
+    AddLorentzian3DResiduals(problem, parameters, x_coords.data(), y_coords.data(), charge_values.data(), x_coords.size(),
+                             Calculate3DLorentzianUncertainty(max_charge), pixel_spacing);
+    double full_chi2 = EvaluateReducedChi2(problem, num_points, 6);
+    
+    if (full_chi2 <= Constants::COARSE_TO_FINE_SKIP_CHI2) {
+        result.fit_stage = static_cast<int>(CoarseToFineStage::CORE_ONLY);
+        if (verbose) {
+            std::cout << "3D Lorentzian core fit (" << core.size() << " pads) accepted on full grid, χ²ᵣ="
+                     << full_chi2 << std::endl;
+        }
+    } else {
+        // Stage 2: short full-grid refinement from the core solution
+        if (!RefineSurfaceFit(problem, parameters, 6, num_points, max_charge - min_charge, pixel_spacing,
+                              Constants::COARSE_TO_FINE_REFINE_ITERATIONS, full_chi2)) {
+            return false;
+        }
+        
+        result.amplitude = parameters[0];
+        result.center_x = parameters[1];
+        result.center_y = parameters[2];
+        result.gamma_x = std::abs(parameters[3]);
+        result.gamma_y = std::abs(parameters[4]);
+        result.vertical_offset = parameters[5];
+        result.fit_stage = static_cast<int>(CoarseToFineStage::CORE_REFINED);
+        if (verbose) {
+            std::cout << "3D Lorentzian core fit (" << core.size() << " pads) refined on full grid, χ²ᵣ="
+                     << full_chi2 << std::endl;
+        }
+    }
+    result.chi2red = full_chi2;
+    
+    // Uncertainties of the accepted solution on the full grid (the core fit's only describe the core pads;
+    // they are kept if the full-grid covariance is rank deficient). Unit weights scale by χ²ᵣ
+    double errors[6];
+    const double variance_scale = Constants::ENABLE_VERTICAL_CHARGE_UNCERTAINTIES ? 1.0 : full_chi2;
+    if (ComputeParameterErrors(problem, parameters, 6, variance_scale, errors)) {
+        result.amplitude_err = errors[0];
+        result.center_x_err = errors[1];
+        result.center_y_err = errors[2];
+        result.gamma_x_err = errors[3];
+        result.gamma_y_err = errors[4];
+        result.vertical_offset_err = errors[5];
+    }
+    return true;
+}
+
 LorentzianFit3DResultsCeres Fit3DLorentzianCeres(
     const std::vector<double>& x_coords,
     const std::vector<double>& y_coords, 
@@ -910,11 +1055,36 @@ LorentzianFit3DResultsCeres Fit3DLorentzianCeres(
     }
     
     // Perform 3D Lorentzian surface fitting
-    bool fit_success = Fit3DLorentzianCeres(
-        x_coords, y_coords, charge_values, center_x_estimate, center_y_estimate, pixel_spacing,
-        result.amplitude, result.center_x, result.center_y, result.gamma_x, result.gamma_y, result.vertical_offset,
-        result.amplitude_err, result.center_x_err, result.center_y_err, result.gamma_x_err, result.gamma_y_err, result.vertical_offset_err,
-        result.chi2red, verbose, enable_outlier_filtering);
+    const double raw_reference_start_ms = RawFrameReferenceTimeMs();
+    auto fit_start = std::chrono::steady_clock::now();
+    bool fit_success = false;
+    if (Constants::ENABLE_COARSE_TO_FINE_3D) {
+        fit_success = Fit3DLorentzianCoarseToFine(x_coords, y_coords, charge_values, center_x_estimate, center_y_estimate,
+                                                  pixel_spacing, result, verbose);
+    }
+    if (!fit_success) {
+        fit_success = Fit3DLorentzianCeres(
+            x_coords, y_coords, charge_values, center_x_estimate, center_y_estimate, pixel_spacing,
+            result.amplitude, result.center_x, result.center_y, result.gamma_x, result.gamma_y, result.vertical_offset,
+            result.amplitude_err, result.center_x_err, result.center_y_err, result.gamma_x_err, result.gamma_y_err, result.vertical_offset_err,
+            result.chi2red, verbose, enable_outlier_filtering);
+    }
+    result.fit_time_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - fit_start).count()
+        - (RawFrameReferenceTimeMs() - raw_reference_start_ms);
+    
+    // Time the plain full-grid fit on a sample of events for the coarse-to-fine savings estimate
+    if (Constants::ENABLE_COARSE_TO_FINE_3D && ShouldSampleCoarseToFineReference()) {
+        LorentzianFit3DResultsCeres reference;
+        const double raw_reference_before_ms = RawFrameReferenceTimeMs();
+        auto reference_start = std::chrono::steady_clock::now();
+        Fit3DLorentzianCeres(
+            x_coords, y_coords, charge_values, center_x_estimate, center_y_estimate, pixel_spacing,
+            reference.amplitude, reference.center_x, reference.center_y, reference.gamma_x, reference.gamma_y, reference.vertical_offset,
+            reference.amplitude_err, reference.center_x_err, reference.center_y_err, reference.gamma_x_err, reference.gamma_y_err, reference.vertical_offset_err,
+            reference.chi2red, false, enable_outlier_filtering);
+        result.reference_time_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - reference_start).count()
+            - (RawFrameReferenceTimeMs() - raw_reference_before_ms);
+    }
     
     // Calculate DOF and p-value
     result.dof = std::max(1, static_cast<int>(x_coords.size()) - 6);
@@ -1,10 +1,13 @@
 #include "3DPowerLorentzianFitCeres.hh"
 #include "CeresLoggingInit.hh"
 #include "Constants.hh"
+#include "CeresUtils.hh"
+#include "EscalationPolicy.hh"
 #include "G4SystemOfUnits.hh"
 
 #include <cmath>
 #include <algorithm>
+#include <chrono>
 #include <iostream>
 // Removed mutex include - no longer needed for parallelization
 #include <atomic>
@@ -96,8 +99,112 @@ private:
     const double uncertainty_;
 };
 
+// Grid-structured 3D Power-Law Lorentzian cost function (all pads in one residual block)
+// As for the Lorentzian, the base 1 + ((x - mx)/γx)^2 + ((y - my)/γy)^2 splits into a column and a row
+// term evaluated once per axis. The power D^(-β) does not factorize, so one log/exp pair per pad remains.
+class PowerLorentzian3DGridCostFunction : public ceres::CostFunction {
+public:
+    PowerLorentzian3DGridCostFunction(const SurfaceGrid& grid, const double* z_vals, size_t num_points, double uncertainty)
+        : grid_(grid), z_(z_vals, z_vals + num_points), inv_uncertainty_(1.0 / uncertainty),
+          ux_(grid.column_x.size()), dux_dm_(grid.column_x.size()), dux_dg_(grid.column_x.size()),
+          uy_(grid.row_y.size()), duy_dm_(grid.row_y.size()), duy_dg_(grid.row_y.size()) {
+        set_num_residuals(static_cast<int>(num_points));
+        mutable_parameter_block_sizes()->push_back(7);
+    }
+    
+    bool Evaluate(double const* const* parameters, double* residuals, double** jacobians) const override {
+        const double* params = parameters[0];
+        const double A = params[0];
+        const double B = params[6];
+        
+        // |β| >= 0.1 as in PowerLorentzian3DCostFunction
+        double beta = std::abs(params[5]);
+        double beta_sign = (params[5] < 0) ? -1.0 : 1.0;
+        if (beta < 0.1) {
+            beta = 0.1;
+            beta_sign = 0.0;
+        }
+        
+        EvaluateAxis(grid_.column_x, params[1], params[3], ux_, dux_dm_, dux_dg_);
+        EvaluateAxis(grid_.row_y, params[2], params[4], uy_, duy_dm_, duy_dg_);
+        
+        double* jacobian = (jacobians && jacobians[0]) ? jacobians[0] : nullptr;
+        
+        for (size_t i = 0; i < z_.size(); ++i) {
+            const int c = grid_.point_column[i];
+            const int r = grid_.point_row[i];
+            const double denominator_base = 1.0 + ux_[c] + uy_[r];
+            const double log_base = std::log(denominator_base);
+            const double power = std::exp(-beta * log_base);  // D^(-β)
+            
+            residuals[i] = (A * power + B - z_[i]) * inv_uncertainty_;
+            
+            if (jacobian) {
+                double* J = jacobian + 7 * i;
+                // d(A D^(-β))/dD = -β A D^(-β) / D
+                const double k = -beta * A * power / denominator_base * inv_uncertainty_;
+                J[0] = power * inv_uncertainty_;
+                J[1] = k * dux_dm_[c];
+                J[2] = k * duy_dm_[r];
+                J[3] = k * dux_dg_[c];
+                J[4] = k * duy_dg_[r];
+                J[5] = -beta_sign * A * power * log_base * inv_uncertainty_;
+                J[6] = inv_uncertainty_;
+            }
+        }
+        
+        return true;
+    }
+    
+private:
+    // ((p - m)/γ)^2 and its derivatives w.r.t. m and the raw γ parameter (|γ| >= 1e-12 as in the AutoDiff form)
+    static void EvaluateAxis(const std::vector<double>& positions, double m, double gamma,
+                             std::vector<double>& u, std::vector<double>& du_dm, std::vector<double>& du_dg) {
+        double safe_gamma = std::abs(gamma);
+        double gamma_sign = (gamma < 0) ? -1.0 : 1.0;
+        if (safe_gamma < 1e-12) {
+            safe_gamma = 1e-12;
+            gamma_sign = 0.0;
+        }
+        const double inv_gamma2 = 1.0 / (safe_gamma * safe_gamma);
+        
+        for (size_t k = 0; k < positions.size(); ++k) {
+            const double d = positions[k] - m;
+            u[k] = d * d * inv_gamma2;
+            du_dm[k] = -2.0 * d * inv_gamma2;
+            du_dg[k] = -2.0 * gamma_sign * u[k] / safe_gamma;
+        }
+    }
+    
+    const SurfaceGrid grid_;
+    const std::vector<double> z_;
+    const double inv_uncertainty_;
+    
+    // Per-axis scratch (a Problem evaluates its cost functions from a single thread here)
+    mutable std::vector<double> ux_, dux_dm_, dux_dg_;
+    mutable std::vector<double> uy_, duy_dm_, duy_dg_;
+};
+
+// Add the 3D Power-Law Lorentzian residuals for a dataset to the problem (grid-structured or per pad)
+static void AddPowerLorentzian3DResiduals(ceres::Problem& problem, double* parameters,
+                                          const std::vector<double>& x_vals, const std::vector<double>& y_vals,
+                                          const std::vector<double>& z_vals, double uncertainty, double pixel_spacing) {
+    if (Constants::ENABLE_SEPARABLE_3D_COST) {
+        SurfaceGrid grid = BuildSurfaceGrid(x_vals.data(), y_vals.data(), x_vals.size(), 1e-6 * pixel_spacing);
+        problem.AddResidualBlock(new PowerLorentzian3DGridCostFunction(grid, z_vals.data(), z_vals.size(), uncertainty),
+                                 nullptr, parameters);
+        return;
+    }
+    
+    for (size_t i = 0; i < x_vals.size(); ++i) {
+        ceres::CostFunction* cost_function = PowerLorentzian3DCostFunction::Create(
+            x_vals[i], y_vals[i], z_vals[i], uncertainty);
+        problem.AddResidualBlock(cost_function, nullptr, parameters);
+    }
+}
+
 // Core 3D Power-Law Lorentzian fitting function using Ceres Solver
-bool Fit3DPowerLorentzianCeres(
+static bool Fit3DPowerLorentzianCeresRaw(
     const std::vector<double>& x_vals,
     const std::vector<double>& y_vals,
     const std::vector<double>& z_vals,
@@ -240,12 +347,7 @@ bool Fit3DPowerLorentzianCeres(
             parameters[6] = guess.params[6];
         
             ceres::Problem problem;
-            
-            for (size_t i = 0; i < x_vals.size(); ++i) {
-                ceres::CostFunction* cost_function = PowerLorentzian3DCostFunction::Create(
-                    x_vals[i], y_vals[i], z_vals[i], uncertainty);
-                problem.AddResidualBlock(cost_function, nullptr, parameters);
-            }
+            AddPowerLorentzian3DResiduals(problem, parameters, x_vals, y_vals, z_vals, uncertainty, pixel_spacing);
             
             // Set adaptive bounds
             double amp_min = std::max(Constants::MIN_UNCERTAINTY_VALUE, 
@@ -302,7 +404,7 @@ bool Fit3DPowerLorentzianCeres(
             options.minimizer_progress_to_stdout = false;
             
             ceres::Solver::Summary summary_stage1;
-            ceres::Solve(options, &problem, &summary_stage1);
+            SolveFitProblem(options, &problem, &summary_stage1);
             
             bool stage1_successful = (summary_stage1.termination_type == ceres::CONVERGENCE ||
                                     summary_stage1.termination_type == ceres::USER_SUCCESS) &&
@@ -326,11 +428,11 @@ bool Fit3DPowerLorentzianCeres(
                 problem.SetParameterLowerBound(parameters, 2, stage1_center_y - tight_center_range);
                 problem.SetParameterUpperBound(parameters, 2, stage1_center_y + tight_center_range);
                 
-                ceres::Solve(options, &problem, &summary);
+                SolveFitProblem(options, &problem, &summary);
             } else {
                 problem.SetParameterLowerBound(parameters, 5, 0.2);
                 problem.SetParameterUpperBound(parameters, 5, 4.0);
-                ceres::Solve(options, &problem, &summary);
+                SolveFitProblem(options, &problem, &summary);
             }
             
             bool fit_successful = (summary.termination_type == ceres::CONVERGENCE ||
@@ -399,12 +501,7 @@ bool Fit3DPowerLorentzianCeres(
                 parameters[6] = perturbed_set.params[6];
                 
                 ceres::Problem problem;
-                
-                for (size_t j = 0; j < x_vals.size(); ++j) {
-                    ceres::CostFunction* cost_function = PowerLorentzian3DCostFunction::Create(
-                        x_vals[j], y_vals[j], z_vals[j], uncertainty);
-                    problem.AddResidualBlock(cost_function, nullptr, parameters);
-                }
+                AddPowerLorentzian3DResiduals(problem, parameters, x_vals, y_vals, z_vals, uncertainty, pixel_spacing);
                 
                 // Apply same bounds as before
                 double amp_min = std::max(Constants::MIN_UNCERTAINTY_VALUE, 
@@ -461,7 +558,7 @@ bool Fit3DPowerLorentzianCeres(
                 options.minimizer_progress_to_stdout = false;
                 
                 ceres::Solver::Summary summary_stage1;
-                ceres::Solve(options, &problem, &summary_stage1);
+                SolveFitProblem(options, &problem, &summary_stage1);
                 
                 bool stage1_successful = (summary_stage1.termination_type == ceres::CONVERGENCE ||
                                         summary_stage1.termination_type == ceres::USER_SUCCESS) &&
@@ -484,11 +581,11 @@ bool Fit3DPowerLorentzianCeres(
                     problem.SetParameterLowerBound(parameters, 2, stage1_center_y - tight_center_range);
                     problem.SetParameterUpperBound(parameters, 2, stage1_center_y + tight_center_range);
                     
-                    ceres::Solve(options, &problem, &summary);
+                    SolveFitProblem(options, &problem, &summary);
                 } else {
                     problem.SetParameterLowerBound(parameters, 5, 0.2);
                     problem.SetParameterUpperBound(parameters, 5, 4.0);
-                    ceres::Solve(options, &problem, &summary);
+                    SolveFitProblem(options, &problem, &summary);
                 }
                 
                 bool fit_successful = (summary.termination_type == ceres::CONVERGENCE ||
@@ -558,12 +655,18 @@ bool Fit3DPowerLorentzianCeres(
         return false;
     };
     
+    // Ladder statistics: which stage produced the accepted fit for this model and neighborhood size
+    const EscalationModel escalation_model = EscalationModel::POWER_LORENTZIAN_3D;
+    const int neighborhood_class = GetEscalationNeighborhoodClass(x_vals.size(), true);
+    
     // OPTIMIZED SOLVER ESCALATION: Try cheap config first, escalate only if needed
+    RecordEscalationAttempt(escalation_model, neighborhood_class, 0);
     bool success = try_config(cheap_config, "cheap");
     
     // Early exit quality check (as per optimize.md section 4.1)
     // Updated threshold based on actual data: χ²ᵣ ≤ 0.7 (around P75 of real distribution)
     if (success && chi2_reduced <= 0.7) {
+        RecordEscalationAccepted(escalation_model, neighborhood_class, 0);
         if (verbose) {
             std::cout << "Early exit: cheap 3D Power Lorentzian config succeeded with χ²ᵣ=" << chi2_reduced << " ≤ 0.7" << std::endl;
         }
@@ -572,14 +675,18 @@ bool Fit3DPowerLorentzianCeres(
     
     // Escalate to expensive configs only if cheap failed or quality poor
     if (!success || chi2_reduced > 0.7) {
+        RecordFitFallback();
         if (verbose) {
             std::cout << "Escalating to expensive 3D Power Lorentzian configurations (χ²ᵣ=" << chi2_reduced 
                      << ", success=" << success << ")" << std::endl;
         }
         
-        for (size_t i = 0; i < expensive_configs.size(); ++i) {
-            success = try_config(expensive_configs[i], "expensive_" + std::to_string(i+1));
+        const int num_stages = 1 + static_cast<int>(expensive_configs.size());
+        for (int stage : GetEscalationOrder(escalation_model, neighborhood_class, num_stages)) {
+            RecordEscalationAttempt(escalation_model, neighborhood_class, stage);
+            success = try_config(expensive_configs[stage - 1], "expensive_" + std::to_string(stage));
             if (success && chi2_reduced <= 3.0) {
+                RecordEscalationAccepted(escalation_model, neighborhood_class, stage);
                 return true;
             }
         }
@@ -593,6 +700,180 @@ bool Fit3DPowerLorentzianCeres(
     return false;
 }
 
+// 3D Power-Law Lorentzian fit in the normalized frame: positions in pitch units around the center estimate and
+// charges divided by their maximum; parameters, uncertainties and χ²ᵣ are transformed back
+bool Fit3DPowerLorentzianCeres(
+    const std::vector<double>& x_vals,
+    const std::vector<double>& y_vals,
+    const std::vector<double>& z_vals,
+    double center_x_estimate,
+    double center_y_estimate,
+    double pixel_spacing,
+    double& fit_amplitude,
+    double& fit_center_x,
+    double& fit_center_y,
+    double& fit_gamma_x,
+    double& fit_gamma_y,
+    double& fit_beta,
+    double& fit_vertical_offset,
+    double& fit_amplitude_err,
+    double& fit_center_x_err,
+    double& fit_center_y_err,
+    double& fit_gamma_x_err,
+    double& fit_gamma_y_err,
+    double& fit_beta_err,
+    double& fit_vertical_offset_err,
+    double& chi2_reduced,
+    bool verbose,
+    bool enable_outlier_filtering) {
+    RecordFitStart();
+    if (!Constants::ENABLE_NORMALIZED_FIT_FRAME || x_vals.empty() || y_vals.empty()) {
+        return Fit3DPowerLorentzianCeresRaw(
+            x_vals, y_vals, z_vals, center_x_estimate, center_y_estimate, pixel_spacing, fit_amplitude,
+            fit_center_x, fit_center_y, fit_gamma_x, fit_gamma_y, fit_beta, fit_vertical_offset,
+            fit_amplitude_err, fit_center_x_err, fit_center_y_err, fit_gamma_x_err, fit_gamma_y_err,
+            fit_beta_err, fit_vertical_offset_err, chi2_reduced, verbose, enable_outlier_filtering);
+    }
+    
+    // Sampled raw-frame solve of the same data, result discarded (see ScopedRawFrameReference)
+    if (ShouldSampleRawFrameReference()) {
+        ScopedRawFrameReference reference_scope;
+        double reference[15];
+        Fit3DPowerLorentzianCeresRaw(
+            x_vals, y_vals, z_vals, center_x_estimate, center_y_estimate, pixel_spacing,
+            reference[0], reference[1], reference[2], reference[3], reference[4], reference[5],
+            reference[6], reference[7], reference[8], reference[9], reference[10], reference[11],
+            reference[12], reference[13], reference[14], false, enable_outlier_filtering);
+    }
+    
+    NormalizedFitFrame frame = MakeNormalizedFitFrame(center_x_estimate, center_y_estimate, pixel_spacing, z_vals);
+    ScopedNormalizedFitFrame frame_scope(frame);
+    std::vector<double> frame_x = ToFrameValues(x_vals, frame.origin_x, frame.length_scale);
+    std::vector<double> frame_y = ToFrameValues(y_vals, frame.origin_y, frame.length_scale);
+    std::vector<double> frame_z = ToFrameValues(z_vals, 0.0, frame.charge_scale);
+    
+    bool success = Fit3DPowerLorentzianCeresRaw(
+        frame_x, frame_y, frame_z, 0.0, 0.0, 1.0,
+        fit_amplitude, fit_center_x, fit_center_y, fit_gamma_x, fit_gamma_y, fit_beta, fit_vertical_offset,
+        fit_amplitude_err, fit_center_x_err, fit_center_y_err, fit_gamma_x_err, fit_gamma_y_err, fit_beta_err, fit_vertical_offset_err,
+        chi2_reduced, verbose, enable_outlier_filtering);
+    
+    fit_amplitude *= frame.charge_scale;
+    fit_center_x = fit_center_x * frame.length_scale + frame.origin_x;
+    fit_center_y = fit_center_y * frame.length_scale + frame.origin_y;
+    fit_gamma_x *= frame.length_scale;
+    fit_gamma_y *= frame.length_scale;
+    fit_vertical_offset *= frame.charge_scale;
+    fit_amplitude_err *= frame.charge_scale;
+    fit_center_x_err *= frame.length_scale;
+    fit_center_y_err *= frame.length_scale;
+    fit_gamma_x_err *= frame.length_scale;
+    fit_gamma_y_err *= frame.length_scale;
+    fit_vertical_offset_err *= frame.charge_scale;
+    if (!Constants::ENABLE_VERTICAL_CHARGE_UNCERTAINTIES) {
+        // Unit weights: χ² scales with the squared charge scale
+        chi2_reduced *= frame.charge_scale * frame.charge_scale;
+    }
+    return success;
+}
+
+// Coarse-to-fine 3D Power-Law Lorentzian fit: fit the core around the max-charge pad, then refine briefly on the
+// full grid from that solution (skipped when the core solution already meets the χ²ᵣ criterion there)
+static bool Fit3DPowerLorentzianCoarseToFine(
+    const std::vector<double>& x_coords,
+    const std::vector<double>& y_coords,
+    const std::vector<double>& charge_values,
+    double center_x_estimate,
+    double center_y_estimate,
+    double pixel_spacing,
+    PowerLorentzianFit3DResultsCeres& result,
+    bool verbose)
+{
+    std::vector<int> core = SelectCorePads(x_coords, y_coords, charge_values, pixel_spacing,
+                                           Constants::COARSE_TO_FINE_CORE_RADIUS);
+    if (core.size() < 7 || core.size() >= x_coords.size()) {
+        return false;
+    }
+    
+    // Core and full grid differ from here on: any failure below sends the fit to the full-grid fallback
+    result.fit_stage = static_cast<int>(CoarseToFineStage::FULL_FALLBACK);
+    
+    std::vector<double> core_x, core_y, core_z;
+    core_x.reserve(core.size());
+    core_y.reserve(core.size());
+    core_z.reserve(core.size());
+    for (int index : core) {
+        core_x.push_back(x_coords[index]);
+        core_y.push_back(y_coords[index]);
+        core_z.push_back(charge_values[index]);
+    }
+    
+    // Stage 1: core fit (no outlier filtering, the core holds the highest-information pads)
+    double core_chi2 = 0.0;
+    if (!Fit3DPowerLorentzianCeres(
+            core_x, core_y, core_z, center_x_estimate, center_y_estimate, pixel_spacing,
+            result.amplitude, result.center_x, result.center_y, result.gamma_x, result.gamma_y, result.beta, result.vertical_offset,
+            result.amplitude_err, result.center_x_err, result.center_y_err, result.gamma_x_err, result.gamma_y_err, result.beta_err, result.vertical_offset_err,
+            core_chi2, verbose, false)) {
+        return false;
+    }
+    
+    // Full-grid χ²ᵣ at the core solution decides whether the refinement is needed
+    double parameters[7] = {result.amplitude, result.center_x, result.center_y,
+                             result.gamma_x, result.gamma_y, result.beta, result.vertical_offset};
+    double max_charge = *std::max_element(charge_values.begin(), charge_values.end());
+    double min_charge = *std::min_element(charge_values.begin(), charge_values.end());
+    int num_points = static_cast<int>(x_coords.size());
+    
+    ceres::Problem problem;
+    AddPowerLorentzian3DResiduals(problem, parameters, x_coords, y_coords, charge_values,
+                                  Calculate3DPowerLorentzianUncertainty(max_charge), pixel_spacing);
+    double full_chi2 = EvaluateReducedChi2(problem, num_points, 7);
+    
+    if (full_chi2 <= Constants::COARSE_TO_FINE_SKIP_CHI2) {
+        result.fit_stage = static_cast<int>(CoarseToFineStage::CORE_ONLY);
+        if (verbose) {
+            std::cout << "3D Power-Law Lorentzian core fit (" << core.size() << " pads) accepted on full grid, χ²ᵣ="
+                     << full_chi2 << std::endl;
+        }
+    } else {
+        // Stage 2: short full-grid refinement from the core solution
+        if (!RefineSurfaceFit(problem, parameters, 7, num_points, max_charge - min_charge, pixel_spacing,
+                              Constants::COARSE_TO_FINE_REFINE_ITERATIONS, full_chi2)) {
+            return false;
+        }
+        
+        result.amplitude = parameters[0];
+        result.center_x = parameters[1];
+        result.center_y = parameters[2];
+        result.gamma_x = std::abs(parameters[3]);
+        result.gamma_y = std::abs(parameters[4]);
+        result.beta = parameters[5];
+        result.vertical_offset = parameters[6];
+        result.fit_stage = static_cast<int>(CoarseToFineStage::CORE_REFINED);
+        if (verbose) {
+            std::cout << "3D Power-Law Lorentzian core fit (" << core.size() << " pads) refined on full grid, χ²ᵣ="
+                     << full_chi2 << std::endl;
+        }
+    }
+    result.chi2red = full_chi2;
+    
+    // Uncertainties of the accepted solution on the full grid (the core fit's only describe the core pads;
+    // they are kept if the full-grid covariance is rank deficient). Unit weights scale by χ²ᵣ
+    double errors[7];
+    const double variance_scale = Constants::ENABLE_VERTICAL_CHARGE_UNCERTAINTIES ? 1.0 : full_chi2;
+    if (ComputeParameterErrors(problem, parameters, 7, variance_scale, errors)) {
+        result.amplitude_err = errors[0];
+        result.center_x_err = errors[1];
+        result.center_y_err = errors[2];
+        result.gamma_x_err = errors[3];
+        result.gamma_y_err = errors[4];
+        result.beta_err = errors[5];
+        result.vertical_offset_err = errors[6];
+    }
+    return true;
+}
+
 PowerLorentzianFit3DResultsCeres Fit3DPowerLorentzianCeres(
     const std::vector<double>& x_coords,
     const std::vector<double>& y_coords, 
@@ -646,11 +927,36 @@ PowerLorentzianFit3DResultsCeres Fit3DPowerLorentzianCeres(
     }
     
     // Perform 3D Power-Law Lorentzian surface fitting
-    bool fit_success = Fit3DPowerLorentzianCeres(
-        x_coords, y_coords, charge_values, center_x_estimate, center_y_estimate, pixel_spacing,
-        result.amplitude, result.center_x, result.center_y, result.gamma_x, result.gamma_y, result.beta, result.vertical_offset,
-        result.amplitude_err, result.center_x_err, result.center_y_err, result.gamma_x_err, result.gamma_y_err, result.beta_err, result.vertical_offset_err,
-        result.chi2red, verbose, enable_outlier_filtering);
+    const double raw_reference_start_ms = RawFrameReferenceTimeMs();
+    auto fit_start = std::chrono::steady_clock::now();
+    bool fit_success = false;
+    if (Constants::ENABLE_COARSE_TO_FINE_3D) {
+        fit_success = Fit3DPowerLorentzianCoarseToFine(x_coords, y_coords, charge_values, center_x_estimate, center_y_estimate,
+                                                       pixel_spacing, result, verbose);
+    }
+    if (!fit_success) {
+        fit_success = Fit3DPowerLorentzianCeres(
+            x_coords, y_coords, charge_values, center_x_estimate, center_y_estimate, pixel_spacing,
+            result.amplitude, result.center_x, result.center_y, result.gamma_x, result.gamma_y, result.beta, result.vertical_offset,
+            result.amplitude_err, result.center_x_err, result.center_y_err, result.gamma_x_err, result.gamma_y_err, result.beta_err, result.vertical_offset_err,
+            result.chi2red, verbose, enable_outlier_filtering);
+    }
+    result.fit_time_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - fit_start).count()
+        - (RawFrameReferenceTimeMs() - raw_reference_start_ms);
+    
+    // Time the plain full-grid fit on a sample of events for the coarse-to-fine savings estimate
+    if (Constants::ENABLE_COARSE_TO_FINE_3D && ShouldSampleCoarseToFineReference()) {
+        PowerLorentzianFit3DResultsCeres reference;
+        const double raw_reference_before_ms = RawFrameReferenceTimeMs();
+        auto reference_start = std::chrono::steady_clock::now();
+        Fit3DPowerLorentzianCeres(
+            x_coords, y_coords, charge_values, center_x_estimate, center_y_estimate, pixel_spacing,
+            reference.amplitude, reference.center_x, reference.center_y, reference.gamma_x, reference.gamma_y, reference.beta, reference.vertical_offset,
+            reference.amplitude_err, reference.center_x_err, reference.center_y_err, reference.gamma_x_err, reference.gamma_y_err, reference.beta_err, reference.vertical_offset_err,
+            reference.chi2red, false, enable_outlier_filtering);
+        result.reference_time_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - reference_start).count()
+            - (RawFrameReferenceTimeMs() - raw_reference_before_ms);
+    }
     
     // Calculate DOF and p-value
     result.dof = std::max(1, static_cast<int>(x_coords.size()) - 7);
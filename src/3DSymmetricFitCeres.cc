@@ -0,0 +1,342 @@
+#include "3DSymmetricFitCeres.hh"
+#include "CeresLoggingInit.hh"
+#include "CeresUtils.hh"
+#include "Constants.hh"
+
+#include <cmath>
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <utility>
+
+// Ceres Solver includes
+#include "ceres/ceres.h"
+#include "glog/logging.h"
+
+// Per-pad residual of a symmetric model; the model only depends on the squared distance to the center
+template <Symmetric3DModel Model>
+struct Symmetric3DCostFunction {
+    static constexpr int kNumParameters =
+        (Model == Symmetric3DModel::ISOTROPIC_POWER_LORENTZIAN) ? 6 :
+        (Model == Symmetric3DModel::RADIAL_CHARGE_SHARING) ? 4 : 5;
+    
+    Symmetric3DCostFunction(double x, double y, double z, double uncertainty, double pixel_size, double d0)
+        : x_(x), y_(y), z_(z), uncertainty_(uncertainty),
+          alpha_numerator_((pixel_size / 2.0) * std::sqrt(2.0)), d0_(d0),
+          min_distance_(std::max(pixel_size / 2.0, 2.0 * d0)) {}
+    
+    template <typename T>
+    bool operator()(const T* const params, T* residual) const {
+        const T& A = params[0];
+        T dx = T(x_) - params[1];
+        T dy = T(y_) - params[2];
+        T r2 = dx * dx + dy * dy;
+        
+        T shape;
+        if (Model == Symmetric3DModel::RADIAL_CHARGE_SHARING) {
+            // Charge sharing weight α/ln(r/d0); r never drops below the pad half-size for gap hits
+            T min_r2 = T(min_distance_ * min_distance_);
+            T r = ceres::sqrt(r2 < min_r2 ? min_r2 : r2);
+            T alpha = ceres::atan(T(alpha_numerator_) / (T(alpha_numerator_) + r));
+            shape = alpha / ceres::log(r / T(d0_));
+        } else {
+            T safe_width = ceres::abs(params[3]);
+            if (safe_width < T(Constants::MIN_SAFE_PARAMETER)) {
+                safe_width = T(Constants::MIN_SAFE_PARAMETER);
+            }
+            T u = r2 / (safe_width * safe_width);
+            if (Model == Symmetric3DModel::ISOTROPIC_GAUSSIAN) {
+                T exponent = -u / T(2.0);
+                if (exponent < T(-200.0)) {
+                    exponent = T(-200.0);
+                }
+                shape = ceres::exp(exponent);
+            } else if (Model == Symmetric3DModel::ISOTROPIC_LORENTZIAN) {
+                shape = T(1.0) / (T(1.0) + u);
+            } else {
+                shape = ceres::pow(T(1.0) + u, -params[4]);
+            }
+        }
+        
+        T predicted = A * shape + params[kNumParameters - 1];
+        residual[0] = (predicted - T(z_)) / T(uncertainty_);
+        return true;
+    }
+    
+    static ceres::CostFunction* Create(double x, double y, double z, double uncertainty, double pixel_size, double d0) {
+        return (new ceres::AutoDiffCostFunction<Symmetric3DCostFunction, 1, kNumParameters>(
+            new Symmetric3DCostFunction(x, y, z, uncertainty, pixel_size, d0)));
+    }
+    
+private:
+    const double x_;
+    const double y_;
+    const double z_;
+    const double uncertainty_;
+    const double alpha_numerator_;
+    const double d0_;
+    const double min_distance_;
+};
+
+template <Symmetric3DModel Model>
+static void AddSymmetric3DResiduals(ceres::Problem& problem, double* parameters,
+                                    const std::vector<double>& x_vals, const std::vector<double>& y_vals,
+                                    const std::vector<double>& z_vals, double uncertainty,
+                                    double pixel_size, double d0) {
+    for (size_t i = 0; i < x_vals.size(); ++i) {
+        problem.AddResidualBlock(Symmetric3DCostFunction<Model>::Create(
+            x_vals[i], y_vals[i], z_vals[i], uncertainty, pixel_size, d0), nullptr, parameters);
+    }
+}
+
+int GetSymmetric3DParameterCount(Symmetric3DModel model) {
+    switch (model) {
+        case Symmetric3DModel::ISOTROPIC_GAUSSIAN:
+            return Symmetric3DCostFunction<Symmetric3DModel::ISOTROPIC_GAUSSIAN>::kNumParameters;
+        case Symmetric3DModel::ISOTROPIC_LORENTZIAN:
+            return Symmetric3DCostFunction<Symmetric3DModel::ISOTROPIC_LORENTZIAN>::kNumParameters;
+        case Symmetric3DModel::ISOTROPIC_POWER_LORENTZIAN:
+            return Symmetric3DCostFunction<Symmetric3DModel::ISOTROPIC_POWER_LORENTZIAN>::kNumParameters;
+        case Symmetric3DModel::RADIAL_CHARGE_SHARING:
+            return Symmetric3DCostFunction<Symmetric3DModel::RADIAL_CHARGE_SHARING>::kNumParameters;
+    }
+    return 0;
+}
+
+static const char* GetSymmetric3DModelName(Symmetric3DModel model) {
+    switch (model) {
+        case Symmetric3DModel::ISOTROPIC_GAUSSIAN: return "isotropic 3D Gaussian";
+        case Symmetric3DModel::ISOTROPIC_LORENTZIAN: return "isotropic 3D Lorentzian";
+        case Symmetric3DModel::ISOTROPIC_POWER_LORENTZIAN: return "isotropic 3D Power-Law Lorentzian";
+        case Symmetric3DModel::RADIAL_CHARGE_SHARING: return "radial charge sharing";
+    }
+    return "symmetric 3D";
+}
+
+static SymmetricFit3DResultsCeres Fit3DSymmetricCeresRaw(
+    Symmetric3DModel model,
+    const std::vector<double>& x_coords,
+    const std::vector<double>& y_coords,
+    const std::vector<double>& charge_values,
+    double center_x_estimate,
+    double center_y_estimate,
+    double pixel_spacing,
+    double pixel_size,
+    double d0,
+    bool verbose)
+{
+    SymmetricFit3DResultsCeres result;
+    
+    CeresLoggingInitializer::InitializeOnce();
+    
+    const int num_parameters = GetSymmetric3DParameterCount(model);
+    const bool has_width = (model != Symmetric3DModel::RADIAL_CHARGE_SHARING);
+    const bool has_beta = (model == Symmetric3DModel::ISOTROPIC_POWER_LORENTZIAN);
+    result.num_parameters = num_parameters;
+    
+    if (x_coords.size() != y_coords.size() || x_coords.size() != charge_values.size() ||
+        static_cast<int>(x_coords.size()) <= num_parameters) {
+        if (verbose) {
+            std::cout << "Fit3DSymmetricCeres: insufficient data points for " << GetSymmetric3DModelName(model) << " fit" << std::endl;
+        }
+        return result;
+    }
+    
+    // Parameter estimates: charge-weighted centroid above the minimum, amplitude from the charge range
+    double max_charge = *std::max_element(charge_values.begin(), charge_values.end());
+    double min_charge = *std::min_element(charge_values.begin(), charge_values.end());
+    double weighted_x = 0.0, weighted_y = 0.0, total_weight = 0.0;
+    for (size_t i = 0; i < x_coords.size(); ++i) {
+        double weight = charge_values[i] - min_charge;
+        if (weight > 0) {
+            weighted_x += x_coords[i] * weight;
+            weighted_y += y_coords[i] * weight;
+            total_weight += weight;
+        }
+    }
+    double start_x = (total_weight > 0) ? weighted_x / total_weight : center_x_estimate;
+    double start_y = (total_weight > 0) ? weighted_y / total_weight : center_y_estimate;
+    double charge_range = std::max(max_charge - min_charge, Constants::MIN_UNCERTAINTY_VALUE);
+    
+    double amplitude = charge_range;
+    if (model == Symmetric3DModel::RADIAL_CHARGE_SHARING) {
+        // Scale the amplitude so the peak weight (nearest pad, r at the clamp) matches the charge range
+        double min_distance = std::max(pixel_size / 2.0, 2.0 * d0);
+        double alpha_numerator = (pixel_size / 2.0) * std::sqrt(2.0);
+        double peak_weight = std::atan(alpha_numerator / (alpha_numerator + min_distance)) / std::log(min_distance / d0);
+        amplitude = charge_range / std::max(peak_weight, Constants::MIN_SAFE_PARAMETER);
+    }
+    
+    double uncertainty = 1.0;
+    if (Constants::ENABLE_VERTICAL_CHARGE_UNCERTAINTIES) {
+        uncertainty = std::max(0.05 * max_charge, Constants::MIN_UNCERTAINTY_VALUE);
+    }
+    result.charge_uncertainty = uncertainty;
+    
+    double parameters[6] = {amplitude, start_x, start_y, 0.0, 0.0, 0.0};
+    if (has_width) {
+        parameters[3] = pixel_spacing * 0.5;
+    }
+    if (has_beta) {
+        parameters[4] = 1.0;
+    }
+    const int baseline_index = num_parameters - 1;
+    parameters[baseline_index] = min_charge;
+    
+    ceres::Problem problem;
+    switch (model) {
+        case Symmetric3DModel::ISOTROPIC_GAUSSIAN:
+            AddSymmetric3DResiduals<Symmetric3DModel::ISOTROPIC_GAUSSIAN>(problem, parameters, x_coords, y_coords, charge_values, uncertainty, pixel_size, d0);
+            break;
+        case Symmetric3DModel::ISOTROPIC_LORENTZIAN:
+            AddSymmetric3DResiduals<Symmetric3DModel::ISOTROPIC_LORENTZIAN>(problem, parameters, x_coords, y_coords, charge_values, uncertainty, pixel_size, d0);
+            break;
+        case Symmetric3DModel::ISOTROPIC_POWER_LORENTZIAN:
+            AddSymmetric3DResiduals<Symmetric3DModel::ISOTROPIC_POWER_LORENTZIAN>(problem, parameters, x_coords, y_coords, charge_values, uncertainty, pixel_size, d0);
+            break;
+        case Symmetric3DModel::RADIAL_CHARGE_SHARING:
+            AddSymmetric3DResiduals<Symmetric3DModel::RADIAL_CHARGE_SHARING>(problem, parameters, x_coords, y_coords, charge_values, uncertainty, pixel_size, d0);
+            break;
+    }
+    
+    // Bounds (same ranges as the anisotropic 3D fits)
+    problem.SetParameterLowerBound(parameters, 0, std::max(Constants::MIN_UNCERTAINTY_VALUE, amplitude * 0.01));
+    problem.SetParameterUpperBound(parameters, 0, std::max(amplitude * 100.0, 1e-10));
+    problem.SetParameterLowerBound(parameters, 1, start_x - pixel_spacing * 3.0);
+    problem.SetParameterUpperBound(parameters, 1, start_x + pixel_spacing * 3.0);
+    problem.SetParameterLowerBound(parameters, 2, start_y - pixel_spacing * 3.0);
+    problem.SetParameterUpperBound(parameters, 2, start_y + pixel_spacing * 3.0);
+    if (has_width) {
+        problem.SetParameterLowerBound(parameters, 3, pixel_spacing * 0.05);
+        problem.SetParameterUpperBound(parameters, 3, pixel_spacing * 4.0);
+    }
+    if (has_beta) {
+        problem.SetParameterLowerBound(parameters, 4, 0.2);
+        problem.SetParameterUpperBound(parameters, 4, 4.0);
+    }
+    double baseline_range = std::max(charge_range * 0.5, std::max(std::abs(min_charge) * 2.0, 1e-12));
+    problem.SetParameterLowerBound(parameters, baseline_index, min_charge - baseline_range);
+    problem.SetParameterUpperBound(parameters, baseline_index, min_charge + baseline_range);
+    
+    ceres::Solver::Options options;
+    options.linear_solver_type = ceres::DENSE_NORMAL_CHOLESKY;
+    options.minimizer_type = ceres::TRUST_REGION;
+    options.trust_region_strategy_type = ceres::LEVENBERG_MARQUARDT;
+    options.function_tolerance = 1e-10;
+    options.gradient_tolerance = 1e-10;
+    options.parameter_tolerance = 1e-15;
+    options.max_num_iterations = 400;
+    options.max_num_consecutive_invalid_steps = 50;
+    options.use_nonmonotonic_steps = true;
+    options.minimizer_progress_to_stdout = false;
+    
+    ceres::Solver::Summary summary;
+    SolveFitProblem(options, &problem, &summary);
+    
+    bool converged = (summary.termination_type == ceres::CONVERGENCE ||
+                      summary.termination_type == ceres::USER_SUCCESS) && parameters[0] > 0;
+    for (int i = 0; i < num_parameters && converged; ++i) {
+        converged = !std::isnan(parameters[i]);
+    }
+    if (!converged) {
+        if (verbose) {
+            std::cout << GetSymmetric3DModelName(model) << " fit did not converge" << std::endl;
+        }
+        return result;
+    }
+    
+    result.amplitude = parameters[0];
+    result.center_x = parameters[1];
+    result.center_y = parameters[2];
+    result.width = has_width ? std::abs(parameters[3]) : 0.0;
+    result.beta = has_beta ? parameters[4] : 0.0;
+    result.vertical_offset = parameters[baseline_index];
+    
+    result.dof = static_cast<int>(x_coords.size()) - num_parameters;
+    result.chi2red = summary.final_cost * 2.0 / result.dof;
+    result.pp = (result.chi2red > 0) ? 1.0 - std::min(1.0, result.chi2red / 10.0) : 0.0;
+    
+    // Center and width uncertainties from the (small) parameter covariance
+    ceres::Covariance::Options covariance_options;
+    covariance_options.algorithm_type = ceres::DENSE_SVD;
+    ceres::Covariance covariance(covariance_options);
+    std::vector<std::pair<const double*, const double*>> covariance_blocks;
+    covariance_blocks.emplace_back(parameters, parameters);
+    
+    double covariance_matrix[36];
+    if (covariance.Compute(covariance_blocks, &problem) &&
+        covariance.GetCovarianceBlock(parameters, parameters, covariance_matrix)) {
+        result.center_x_err = std::sqrt(std::max(0.0, covariance_matrix[1 * num_parameters + 1]));
+        result.center_y_err = std::sqrt(std::max(0.0, covariance_matrix[2 * num_parameters + 2]));
+        if (has_width) {
+            result.width_err = std::sqrt(std::max(0.0, covariance_matrix[3 * num_parameters + 3]));
+        }
+    } else {
+        result.center_x_err = std::max(0.02 * pixel_spacing, result.width / 10.0);
+        result.center_y_err = result.center_x_err;
+        result.width_err = std::max(0.05 * result.width, 0.01 * pixel_spacing);
+    }
+    
+    result.fit_successful = true;
+    
+    if (verbose) {
+        std::cout << GetSymmetric3DModelName(model) << " fit (Ceres, " << num_parameters << " parameters): mx="
+                 << result.center_x << "±" << result.center_x_err << ", my=" << result.center_y << "±" << result.center_y_err
+                 << ", w=" << result.width << ", chi2red=" << result.chi2red << std::endl;
+    }
+    
+    return result;
+}
+
+SymmetricFit3DResultsCeres Fit3DSymmetricCeres(
+    Symmetric3DModel model,
+    const std::vector<double>& x_coords,
+    const std::vector<double>& y_coords,
+    const std::vector<double>& charge_values,
+    double center_x_estimate,
+    double center_y_estimate,
+    double pixel_spacing,
+    double pixel_size,
+    double d0,
+    bool verbose)
+{
+    RecordFitStart();
+    if (!Constants::ENABLE_NORMALIZED_FIT_FRAME || charge_values.empty()) {
+        return Fit3DSymmetricCeresRaw(model, x_coords, y_coords, charge_values, center_x_estimate,
+                                      center_y_estimate, pixel_spacing, pixel_size, d0, verbose);
+    }
+    
+    // Sampled raw-frame solve of the same data, result discarded (see ScopedRawFrameReference)
+    if (ShouldSampleRawFrameReference()) {
+        ScopedRawFrameReference reference_scope;
+        Fit3DSymmetricCeresRaw(model, x_coords, y_coords, charge_values, center_x_estimate,
+                               center_y_estimate, pixel_spacing, pixel_size, d0, false);
+    }
+    
+    // Pad size and d0 are lengths, so the radial model is unchanged by the rescaling
+    NormalizedFitFrame frame = MakeNormalizedFitFrame(center_x_estimate, center_y_estimate, pixel_spacing, charge_values);
+    ScopedNormalizedFitFrame frame_scope(frame);
+    const double ls = frame.length_scale;
+    const double qs = frame.charge_scale;
+    SymmetricFit3DResultsCeres result = Fit3DSymmetricCeresRaw(
+        model,
+        ToFrameValues(x_coords, frame.origin_x, ls),
+        ToFrameValues(y_coords, frame.origin_y, ls),
+        ToFrameValues(charge_values, 0.0, qs),
+        0.0, 0.0, 1.0, pixel_size / ls, d0 / ls, verbose);
+    
+    result.amplitude *= qs;
+    result.center_x = result.center_x * ls + frame.origin_x;
+    result.center_y = result.center_y * ls + frame.origin_y;
+    result.width *= ls;
+    result.vertical_offset *= qs;
+    result.center_x_err *= ls;
+    result.center_y_err *= ls;
+    result.width_err *= ls;
+    result.charge_uncertainty *= qs;
+    if (!Constants::ENABLE_VERTICAL_CHARGE_UNCERTAINTIES) {
+        result.chi2red *= qs * qs;
+        result.pp = (result.chi2red > 0) ? 1.0 - std::min(1.0, result.chi2red / 10.0) : 0.0;
+    }
+    return result;
+}
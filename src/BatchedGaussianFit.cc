@@ -0,0 +1,402 @@
+#include "BatchedGaussianFit.hh"
+#include "Constants.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+void GaussianFitBatch::Clear() {
+    x_vals.clear();
+    y_vals.clear();
+    lane_offset.clear();
+    lane_size.clear();
+    center_estimate.clear();
+    pixel_spacing.clear();
+    amplitude.clear();
+    center.clear();
+    sigma.clear();
+    offset.clear();
+    amplitude_err.clear();
+    center_err.clear();
+    sigma_err.clear();
+    offset_err.clear();
+    chi2_reduced.clear();
+    iterations.clear();
+    converged.clear();
+}
+
+int AddGaussianFitLane(GaussianFitBatch& batch,
+                       const std::vector<double>& x_vals,
+                       const std::vector<double>& y_vals,
+                       double center_estimate,
+                       double pixel_spacing) {
+    if (x_vals.size() < 4 || y_vals.size() != x_vals.size() || pixel_spacing <= 0) {
+        return -1;
+    }
+
+    const int lane = static_cast<int>(batch.NumLanes());
+    batch.lane_offset.push_back(batch.x_vals.size());
+    batch.lane_size.push_back(static_cast<int>(x_vals.size()));
+    batch.x_vals.insert(batch.x_vals.end(), x_vals.begin(), x_vals.end());
+    batch.y_vals.insert(batch.y_vals.end(), y_vals.begin(), y_vals.end());
+    batch.center_estimate.push_back(center_estimate);
+    batch.pixel_spacing.push_back(pixel_spacing);
+    return lane;
+}
+
+namespace {
+
+// Per-lane normal equations in SoA form: h[k][l] is the k-th upper-triangle entry of lane l
+struct LaneNormalEquations {
+    std::vector<double> h[10];  // 00 01 02 03 11 12 13 22 23 33
+    std::vector<double> g[4];
+    std::vector<double> cost;
+
+    explicit LaneNormalEquations(size_t lanes) : cost(lanes) {
+        for (auto& v : h) v.assign(lanes, 0.0);
+        for (auto& v : g) v.assign(lanes, 0.0);
+    }
+
+    void Unpack(size_t l, double JtJ[4][4], double Jtr[4]) const {
+        JtJ[0][0] = h[0][l]; JtJ[0][1] = h[1][l]; JtJ[0][2] = h[2][l]; JtJ[0][3] = h[3][l];
+        JtJ[1][1] = h[4][l]; JtJ[1][2] = h[5][l]; JtJ[1][3] = h[6][l];
+        JtJ[2][2] = h[7][l]; JtJ[2][3] = h[8][l];
+        JtJ[3][3] = h[9][l];
+        for (int i = 0; i < 4; ++i) {
+            for (int j = 0; j < i; ++j) JtJ[i][j] = JtJ[j][i];
+            Jtr[i] = g[i][l];
+        }
+    }
+};
+
+// One pass over the point-major layout accumulating every lane at once; padded points have w = 0
+void AccumulateBatchNormalEquations(const std::vector<double>& x, const std::vector<double>& y,
+                                    const std::vector<double>& w, size_t lanes, size_t max_points,
+                                    const std::vector<double> p[4], LaneNormalEquations& ne) {
+    for (auto& v : ne.h) std::fill(v.begin(), v.end(), 0.0);
+    for (auto& v : ne.g) std::fill(v.begin(), v.end(), 0.0);
+    std::fill(ne.cost.begin(), ne.cost.end(), 0.0);
+
+    const double* A = p[0].data();
+    const double* m = p[1].data();
+    const double* s = p[2].data();
+    const double* B = p[3].data();
+
+    for (size_t i = 0; i < max_points; ++i) {
+        const double* xi = x.data() + i * lanes;
+        const double* yi = y.data() + i * lanes;
+        const double* wi = w.data() + i * lanes;
+        for (size_t l = 0; l < lanes; ++l) {
+            const double inv_sigma = 1.0 / s[l];
+            const double inv_sigma2 = inv_sigma * inv_sigma;
+            const double dx = xi[l] - m[l];
+            const double e = std::exp(-0.5 * dx * dx * inv_sigma2);
+            const double r = wi[l] * (A[l] * e + B[l] - yi[l]);
+            const double j0 = wi[l] * e;
+            const double j1 = wi[l] * A[l] * e * dx * inv_sigma2;
+            const double j2 = j1 * dx * inv_sigma;
+            const double j3 = wi[l];
+
+            ne.h[0][l] += j0 * j0; ne.h[1][l] += j0 * j1; ne.h[2][l] += j0 * j2; ne.h[3][l] += j0 * j3;
+            ne.h[4][l] += j1 * j1; ne.h[5][l] += j1 * j2; ne.h[6][l] += j1 * j3;
+            ne.h[7][l] += j2 * j2; ne.h[8][l] += j2 * j3;
+            ne.h[9][l] += j3 * j3;
+            ne.g[0][l] += j0 * r; ne.g[1][l] += j1 * r; ne.g[2][l] += j2 * r; ne.g[3][l] += j3 * r;
+            ne.cost[l] += r * r;
+        }
+    }
+    for (size_t l = 0; l < lanes; ++l) {
+        ne.cost[l] *= 0.5;
+    }
+}
+
+void EvaluateBatchCost(const std::vector<double>& x, const std::vector<double>& y,
+                       const std::vector<double>& w, size_t lanes, size_t max_points,
+                       const std::vector<double> p[4], std::vector<double>& cost) {
+    std::fill(cost.begin(), cost.end(), 0.0);
+    const double* A = p[0].data();
+    const double* m = p[1].data();
+    const double* s = p[2].data();
+    const double* B = p[3].data();
+
+    for (size_t i = 0; i < max_points; ++i) {
+        const double* xi = x.data() + i * lanes;
+        const double* yi = y.data() + i * lanes;
+        const double* wi = w.data() + i * lanes;
+        for (size_t l = 0; l < lanes; ++l) {
+            const double dx = xi[l] - m[l];
+            const double r = wi[l] * (A[l] * std::exp(-0.5 * dx * dx / (s[l] * s[l])) + B[l] - yi[l]);
+            cost[l] += r * r;
+        }
+    }
+    for (size_t l = 0; l < lanes; ++l) {
+        cost[l] *= 0.5;
+    }
+}
+
+// Cholesky factorization of (JtJ + lambda * diag(JtJ)); returns false if not positive definite
+bool FactorDampedSystem(const double JtJ[4][4], double lambda, double L[4][4]) {
+    for (int i = 0; i < 4; ++i) {
+        for (int j = 0; j <= i; ++j) {
+            double sum = (i == j) ? JtJ[i][i] + lambda * std::max(JtJ[i][i], 1e-6) : JtJ[j][i];
+            for (int k = 0; k < j; ++k) {
+                sum -= L[i][k] * L[j][k];
+            }
+            if (i == j) {
+                if (!(sum > 0.0)) {
+                    return false;
+                }
+                L[i][i] = std::sqrt(sum);
+            } else {
+                L[i][j] = sum / L[j][j];
+            }
+        }
+    }
+    return true;
+}
+
+// Projected gradient test for a stalled lane: every component not pushing into an active bound must be
+// small against its Cauchy-Schwarz bound |J_k^T r| <= |J_k| |r| (scale-free, as in MixedPrecisionFit)
+bool IsStationary(const double JtJ[4][4], const double Jtr[4], const double p[4],
+                  const double lower[4], const double upper[4], double cost, double tolerance) {
+    for (int k = 0; k < 4; ++k) {
+        const bool blocked = (p[k] <= lower[k] && Jtr[k] > 0) || (p[k] >= upper[k] && Jtr[k] < 0);
+        if (!blocked && std::abs(Jtr[k]) > tolerance * std::sqrt(JtJ[k][k] * 2.0 * cost)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void SolveFactored(const double L[4][4], const double rhs[4], double out[4]) {
+    double z[4];
+    for (int i = 0; i < 4; ++i) {
+        double sum = rhs[i];
+        for (int k = 0; k < i; ++k) sum -= L[i][k] * z[k];
+        z[i] = sum / L[i][i];
+    }
+    for (int i = 3; i >= 0; --i) {
+        double sum = z[i];
+        for (int k = i + 1; k < 4; ++k) sum -= L[k][i] * out[k];
+        out[i] = sum / L[i][i];
+    }
+}
+
+} // namespace
+
+void FitGaussianBatch(GaussianFitBatch& batch, int max_iterations) {
+    const size_t lanes = batch.NumLanes();
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    batch.amplitude.assign(lanes, nan);
+    batch.center.assign(lanes, nan);
+    batch.sigma.assign(lanes, nan);
+    batch.offset.assign(lanes, nan);
+    batch.amplitude_err.assign(lanes, 0.0);
+    batch.center_err.assign(lanes, 0.0);
+    batch.sigma_err.assign(lanes, 0.0);
+    batch.offset_err.assign(lanes, 0.0);
+    batch.chi2_reduced.assign(lanes, 0.0);
+    batch.iterations.assign(lanes, 0);
+    batch.converged.assign(lanes, 0);
+    if (lanes == 0) {
+        return;
+    }
+
+    size_t max_points = 0;
+    for (int n : batch.lane_size) {
+        max_points = std::max(max_points, static_cast<size_t>(n));
+    }
+
+    // Per-lane normalization x' = (x - x_ref) / pitch, y' = y / q_scale; residuals in the
+    // normalized frame are multiplied by weight = q_scale / uncertainty for chi2 and errors
+    std::vector<double> x_ref(lanes), x_scale(lanes), q_scale(lanes), weight(lanes);
+    std::vector<double> p[4], lower[4], upper[4], trial[4];
+    for (int k = 0; k < 4; ++k) {
+        p[k].assign(lanes, 0.0);
+        lower[k].assign(lanes, 0.0);
+        upper[k].assign(lanes, 0.0);
+        trial[k].assign(lanes, 0.0);
+    }
+
+    std::vector<double> xs(max_points * lanes, 0.0), ys(max_points * lanes, 0.0), ws(max_points * lanes, 0.0);
+
+    for (size_t l = 0; l < lanes; ++l) {
+        const double* x = batch.x_vals.data() + batch.lane_offset[l];
+        const double* y = batch.y_vals.data() + batch.lane_offset[l];
+        const int n = batch.lane_size[l];
+        const double pitch = batch.pixel_spacing[l];
+
+        double y_min = y[0], y_max = y[0], x_min = x[0], x_max = x[0];
+        for (int i = 1; i < n; ++i) {
+            y_min = std::min(y_min, y[i]);
+            y_max = std::max(y_max, y[i]);
+            x_min = std::min(x_min, x[i]);
+            x_max = std::max(x_max, x[i]);
+        }
+
+        // Initial guess: baseline at the minimum, centroid and RMS width above it
+        double weight_sum = 0.0, centroid = 0.0;
+        for (int i = 0; i < n; ++i) {
+            weight_sum += y[i] - y_min;
+            centroid += (y[i] - y_min) * x[i];
+        }
+        centroid = (weight_sum > 0) ? centroid / weight_sum : batch.center_estimate[l];
+        double spread2 = 0.0;
+        for (int i = 0; i < n; ++i) {
+            spread2 += (y[i] - y_min) * (x[i] - centroid) * (x[i] - centroid);
+        }
+        double sigma0 = (weight_sum > 0) ? std::sqrt(spread2 / weight_sum) : 0.5 * pitch;
+        sigma0 = std::max(pitch * 0.2, std::min(pitch * 2.0, sigma0));
+        const double amp0 = std::max(y_max - y_min, Constants::MIN_UNCERTAINTY_VALUE);
+        const double offset0 = y_min;
+
+        // Same adaptive bounds as the per-event Gaussian row/column fit
+        const double data_spread = x_max - x_min;
+        const double initial[4] = {amp0, centroid, sigma0, offset0};
+        const double lo[4] = {
+            std::max(Constants::MIN_UNCERTAINTY_VALUE, std::max(amp0 * 0.01, std::abs(y_min) * 0.1)),
+            centroid - pitch * 3.0,
+            std::max(pitch * 0.05, data_spread * 0.01),
+            offset0 - std::max(std::abs(y_max - y_min) * 0.5, std::max(std::abs(offset0) * 2.0, 1e-12))};
+        const double hi[4] = {
+            std::max(std::max(y_max * 1.5, amp0 * 2.0), std::max(amp0 * 100.0, 1e-10)),
+            centroid + pitch * 3.0,
+            std::max(lo[2], std::min(pitch * 3.0, data_spread * 0.8)),
+            offset0 + std::max(std::abs(y_max - y_min) * 0.5, std::max(std::abs(offset0) * 2.0, 1e-12))};
+
+        double uncertainty = 1.0;
+        if (Constants::ENABLE_VERTICAL_CHARGE_UNCERTAINTIES) {
+            uncertainty = std::max(0.05 * y_max, Constants::MIN_UNCERTAINTY_VALUE);
+        }
+        x_ref[l] = centroid;
+        x_scale[l] = pitch;
+        q_scale[l] = std::max(std::max(std::abs(y_max), std::abs(y_min)), Constants::MIN_UNCERTAINTY_VALUE);
+        weight[l] = q_scale[l] / uncertainty;
+
+        const double to_param[4] = {1.0 / q_scale[l], 1.0 / x_scale[l], 1.0 / x_scale[l], 1.0 / q_scale[l]};
+        const double param_offset[4] = {0.0, x_ref[l], 0.0, 0.0};
+        for (int k = 0; k < 4; ++k) {
+            p[k][l] = (initial[k] - param_offset[k]) * to_param[k];
+            lower[k][l] = (lo[k] - param_offset[k]) * to_param[k];
+            upper[k][l] = (hi[k] - param_offset[k]) * to_param[k];
+            p[k][l] = std::min(upper[k][l], std::max(lower[k][l], p[k][l]));
+        }
+
+        for (int i = 0; i < n; ++i) {
+            xs[i * lanes + l] = (x[i] - x_ref[l]) / x_scale[l];
+            ys[i * lanes + l] = y[i] / q_scale[l];
+            ws[i * lanes + l] = 1.0;
+        }
+        // Padded points sit at the reference position with zero weight
+    }
+
+    // Lockstep projected Levenberg-Marquardt
+    const double kStallGradientTolerance = 1e-6;
+    LaneNormalEquations ne(lanes);
+    std::vector<double> trial_cost(lanes, 0.0);
+    std::vector<double> lambda(lanes, 1e-3);
+    std::vector<unsigned char> active(lanes, 1);
+    std::vector<unsigned char> has_trial(lanes, 0);
+    size_t num_active = lanes;
+
+    AccumulateBatchNormalEquations(xs, ys, ws, lanes, max_points, p, ne);
+
+    for (int round = 0; round < max_iterations && num_active > 0; ++round) {
+        // Damped step for every active lane
+        for (size_t l = 0; l < lanes; ++l) {
+            has_trial[l] = 0;
+            for (int k = 0; k < 4; ++k) trial[k][l] = p[k][l];
+            if (!active[l]) continue;
+
+            double JtJ[4][4], Jtr[4], L[4][4], delta[4];
+            ne.Unpack(l, JtJ, Jtr);
+            if (FactorDampedSystem(JtJ, lambda[l], L)) {
+                SolveFactored(L, Jtr, delta);
+                for (int k = 0; k < 4; ++k) {
+                    trial[k][l] = std::min(upper[k][l], std::max(lower[k][l], p[k][l] - delta[k]));
+                }
+                has_trial[l] = 1;
+            }
+        }
+
+        EvaluateBatchCost(xs, ys, ws, lanes, max_points, trial, trial_cost);
+
+        // Accept or reject per lane and update the convergence mask
+        bool any_accepted = false;
+        for (size_t l = 0; l < lanes; ++l) {
+            if (!active[l]) continue;
+
+            const double cost = ne.cost[l];
+            if (has_trial[l] && std::isfinite(trial_cost[l]) && trial_cost[l] <= cost) {
+                double step = 0.0;
+                for (int k = 0; k < 4; ++k) {
+                    step = std::max(step, std::abs(trial[k][l] - p[k][l]));
+                    p[k][l] = trial[k][l];
+                }
+                batch.iterations[l]++;
+                any_accepted = true;
+                lambda[l] = std::max(lambda[l] * 0.3, 1e-9);
+
+                if (cost - trial_cost[l] <= 1e-10 * cost || step <= 1e-10) {
+                    active[l] = 0;
+                    batch.converged[l] = 1;
+                    num_active--;
+                }
+            } else {
+                lambda[l] *= 10.0;
+                if (lambda[l] >= 1e10) {
+                    // No damped step decreases the cost. Converged only if the lane moved off its
+                    // starting point and the projected gradient vanishes there
+                    double JtJ[4][4], Jtr[4], pl[4], lo[4], hi[4];
+                    ne.Unpack(l, JtJ, Jtr);
+                    for (int k = 0; k < 4; ++k) {
+                        pl[k] = p[k][l];
+                        lo[k] = lower[k][l];
+                        hi[k] = upper[k][l];
+                    }
+                    active[l] = 0;
+                    batch.converged[l] = batch.iterations[l] > 0 &&
+                                         IsStationary(JtJ, Jtr, pl, lo, hi, cost, kStallGradientTolerance);
+                    num_active--;
+                }
+            }
+        }
+
+        if (any_accepted) {
+            AccumulateBatchNormalEquations(xs, ys, ws, lanes, max_points, p, ne);
+        }
+    }
+
+    // Write back parameters, covariance errors and chi2 per lane
+    for (size_t l = 0; l < lanes; ++l) {
+        const double w2 = weight[l] * weight[l];
+        const int dof = std::max(1, batch.lane_size[l] - 4);
+
+        batch.amplitude[l] = p[0][l] * q_scale[l];
+        batch.center[l] = p[1][l] * x_scale[l] + x_ref[l];
+        batch.sigma[l] = p[2][l] * x_scale[l];
+        batch.offset[l] = p[3][l] * q_scale[l];
+        batch.chi2_reduced[l] = 2.0 * ne.cost[l] * w2 / dof;
+
+        double JtJ[4][4], Jtr[4], L[4][4];
+        ne.Unpack(l, JtJ, Jtr);
+        double diag[4] = {0.0, 0.0, 0.0, 0.0};
+        if (FactorDampedSystem(JtJ, 0.0, L)) {
+            for (int k = 0; k < 4; ++k) {
+                double unit[4] = {0.0, 0.0, 0.0, 0.0};
+                double column[4];
+                unit[k] = 1.0;
+                SolveFactored(L, unit, column);
+                diag[k] = column[k] / w2;
+            }
+        }
+        batch.amplitude_err[l] = std::sqrt(std::max(0.0, diag[0])) * q_scale[l];
+        batch.center_err[l] = std::sqrt(std::max(0.0, diag[1])) * x_scale[l];
+        batch.sigma_err[l] = std::sqrt(std::max(0.0, diag[2])) * x_scale[l];
+        batch.offset_err[l] = std::sqrt(std::max(0.0, diag[3])) * q_scale[l];
+
+        if (!std::isfinite(batch.chi2_reduced[l]) || !(batch.amplitude[l] > 0) || !(batch.sigma[l] > 0)) {
+            batch.converged[l] = 0;
+        }
+    }
+}
@@ -1,6 +1,9 @@
 #include "CeresUtils.hh"
 #include "Constants.hh"
 #include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
 
 ceres::Solver::Options MakeSolverOptions(SolverPreset preset, double pixel_spacing) {
     ceres::Solver::Options options;
@@ -98,4 +101,240 @@ void SetStandardBounds(ceres::Problem& problem, double* parameters,
             problem.SetParameterUpperBound(parameters, 3, parameters[3] + baseline_range);
         }
     }
-} 
\ No newline at end of file
+} 
+// Index of the axis position matching value, appending a new one if none is within tolerance
+static int FindOrAddAxisPosition(std::vector<double>& positions, double value, double tolerance) {
+    for (size_t k = 0; k < positions.size(); ++k) {
+        if (std::abs(positions[k] - value) <= tolerance) {
+            return static_cast<int>(k);
+        }
+    }
+    positions.push_back(value);
+    return static_cast<int>(positions.size()) - 1;
+}
+
+SurfaceGrid BuildSurfaceGrid(const double* x_vals, const double* y_vals, size_t num_points,
+                             double tolerance) {
+    SurfaceGrid grid;
+    grid.point_column.reserve(num_points);
+    grid.point_row.reserve(num_points);
+    
+    for (size_t i = 0; i < num_points; ++i) {
+        grid.point_column.push_back(FindOrAddAxisPosition(grid.column_x, x_vals[i], tolerance));
+        grid.point_row.push_back(FindOrAddAxisPosition(grid.row_y, y_vals[i], tolerance));
+    }
+    
+    return grid;
+}
+
+std::vector<int> SelectCorePads(const std::vector<double>& x_vals, const std::vector<double>& y_vals,
+                                const std::vector<double>& z_vals, double pixel_spacing, int core_radius) {
+    std::vector<int> core;
+    if (z_vals.empty()) {
+        return core;
+    }
+    
+    size_t max_index = std::max_element(z_vals.begin(), z_vals.end()) - z_vals.begin();
+    double reach = (core_radius + 0.5) * pixel_spacing;
+    
+    core.reserve((2 * core_radius + 1) * (2 * core_radius + 1));
+    for (size_t i = 0; i < x_vals.size(); ++i) {
+        if (std::abs(x_vals[i] - x_vals[max_index]) < reach && std::abs(y_vals[i] - y_vals[max_index]) < reach) {
+            core.push_back(static_cast<int>(i));
+        }
+    }
+    return core;
+}
+
+double EvaluateReducedChi2(ceres::Problem& problem, int num_points, int num_parameters) {
+    double cost = 0.0;
+    if (!problem.Evaluate(ceres::Problem::EvaluateOptions(), &cost, nullptr, nullptr, nullptr)) {
+        return std::numeric_limits<double>::max();
+    }
+    return cost * 2.0 / std::max(1, num_points - num_parameters);
+}
+
+bool RefineSurfaceFit(ceres::Problem& problem, double* parameters, int num_parameters, int num_points,
+                      double charge_range, double pixel_spacing, int max_iterations, double& chi2_reduced) {
+    const bool has_beta = (num_parameters == 7);
+    const int baseline_index = num_parameters - 1;
+    
+    // Bounds around the previous solution, no tighter than the full-grid fits use
+    problem.SetParameterLowerBound(parameters, 0, std::max(Constants::MIN_UNCERTAINTY_VALUE, parameters[0] * 0.01));
+    problem.SetParameterUpperBound(parameters, 0, std::max(parameters[0] * 100.0, 1e-10));
+    for (int axis = 1; axis <= 2; ++axis) {
+        problem.SetParameterLowerBound(parameters, axis, parameters[axis] - pixel_spacing);
+        problem.SetParameterUpperBound(parameters, axis, parameters[axis] + pixel_spacing);
+    }
+    for (int axis = 3; axis <= 4; ++axis) {
+        problem.SetParameterLowerBound(parameters, axis, std::min(pixel_spacing * 0.05, parameters[axis]));
+        problem.SetParameterUpperBound(parameters, axis, std::max(pixel_spacing * 4.0, parameters[axis]));
+    }
+    if (has_beta) {
+        problem.SetParameterLowerBound(parameters, 5, std::min(0.2, parameters[5]));
+        problem.SetParameterUpperBound(parameters, 5, std::max(4.0, parameters[5]));
+    }
+    double baseline_range = std::max(charge_range * 0.5, std::max(std::abs(parameters[baseline_index]) * 2.0, 1e-12));
+    problem.SetParameterLowerBound(parameters, baseline_index, parameters[baseline_index] - baseline_range);
+    problem.SetParameterUpperBound(parameters, baseline_index, parameters[baseline_index] + baseline_range);
+    
+    ceres::Solver::Options options = MakeSolverOptions(SolverPreset::FAST, pixel_spacing);
+    options.linear_solver_type = ceres::DENSE_NORMAL_CHOLESKY;
+    options.max_num_iterations = max_iterations;
+    
+    ceres::Solver::Summary summary;
+    SolveFitProblem(options, &problem, &summary);
+    
+    // The iteration cap is part of the design, so NO_CONVERGENCE with a usable solution is accepted
+    bool usable = summary.IsSolutionUsable() && summary.final_cost <= summary.initial_cost;
+    for (int i = 0; i < num_parameters && usable; ++i) {
+        usable = std::isfinite(parameters[i]);
+    }
+    if (!usable || parameters[0] <= 0 || parameters[3] <= 0 || parameters[4] <= 0) {
+        return false;
+    }
+    
+    chi2_reduced = summary.final_cost * 2.0 / std::max(1, num_points - num_parameters);
+    return true;
+}
+
+bool ShouldSampleCoarseToFineReference() {
+    if (Constants::COARSE_TO_FINE_REFERENCE_INTERVAL <= 0) {
+        return false;
+    }
+    static thread_local int call_count = 0;
+    return (++call_count % Constants::COARSE_TO_FINE_REFERENCE_INTERVAL) == 0;
+}
+
+bool ComputeParameterErrors(ceres::Problem& problem, const double* parameters, int num_parameters,
+                            double variance_scale, double* errors) {
+    ceres::Covariance::Options covariance_options;
+    covariance_options.algorithm_type = ceres::DENSE_SVD;
+    ceres::Covariance covariance(covariance_options);
+    std::vector<std::pair<const double*, const double*>> covariance_blocks;
+    covariance_blocks.emplace_back(parameters, parameters);
+    
+    std::vector<double> covariance_matrix(num_parameters * num_parameters);
+    if (!covariance.Compute(covariance_blocks, &problem) ||
+        !covariance.GetCovarianceBlock(parameters, parameters, covariance_matrix.data())) {
+        return false;
+    }
+    
+    for (int i = 0; i < num_parameters; ++i) {
+        const double variance = variance_scale * covariance_matrix[i * num_parameters + i];
+        if (!(variance >= 0.0) || !std::isfinite(variance)) {
+            return false;
+        }
+        errors[i] = std::sqrt(variance);
+    }
+    return true;
+}
+
+NormalizedFitFrame MakeNormalizedFitFrame(double origin_x, double origin_y, double pixel_spacing,
+                                          const std::vector<double>& charge_values) {
+    NormalizedFitFrame frame;
+    frame.origin_x = origin_x;
+    frame.origin_y = origin_y;
+    frame.length_scale = (pixel_spacing > 0) ? pixel_spacing : 1.0;
+    
+    double max_abs_charge = 0.0;
+    for (double charge : charge_values) {
+        max_abs_charge = std::max(max_abs_charge, std::abs(charge));
+    }
+    frame.charge_scale = (max_abs_charge > 0) ? max_abs_charge : 1.0;
+    return frame;
+}
+
+std::vector<double> ToFrameValues(const std::vector<double>& values, double origin, double scale) {
+    std::vector<double> frame_values(values.size());
+    const double inverse_scale = 1.0 / scale;
+    for (size_t i = 0; i < values.size(); ++i) {
+        frame_values[i] = (values[i] - origin) * inverse_scale;
+    }
+    return frame_values;
+}
+
+static thread_local const NormalizedFitFrame* gActiveFitFrame = nullptr;
+static thread_local FitSolveStatistics gFitSolveStatistics;
+static thread_local FitSolveStatistics gRawFrameReferenceStatistics;
+static thread_local bool gRawFrameReferenceActive = false;
+static thread_local long long gNormalizedFitCount = 0;
+static thread_local double gRawFrameReferenceTimeMs = 0.0;
+
+// Counts fits with the active statistics: the raw-frame reference while one is in scope
+static FitSolveStatistics& ActiveFitSolveStatistics() {
+    return gRawFrameReferenceActive ? gRawFrameReferenceStatistics : gFitSolveStatistics;
+}
+
+ScopedNormalizedFitFrame::ScopedNormalizedFitFrame(const NormalizedFitFrame& frame)
+    : previous_(gActiveFitFrame) {
+    gActiveFitFrame = &frame;
+}
+
+ScopedNormalizedFitFrame::~ScopedNormalizedFitFrame() {
+    gActiveFitFrame = previous_;
+}
+
+void SolveFitProblem(ceres::Solver::Options options, ceres::Problem* problem, ceres::Solver::Summary* summary) {
+    if (gActiveFitFrame) {
+        // Stop once steps are a tenth of the requested resolution (parameters are O(1) in pitch units);
+        // cost and gradient are O(N) and O(1) in the normalized frame, so fixed relative limits suffice
+        options.parameter_tolerance = 0.1 * Constants::FIT_POSITION_RESOLUTION / gActiveFitFrame->length_scale;
+        options.function_tolerance = Constants::NORMALIZED_FUNCTION_TOLERANCE;
+        options.gradient_tolerance = Constants::NORMALIZED_GRADIENT_TOLERANCE;
+    }
+    
+    ceres::Solve(options, problem, summary);
+    
+    FitSolveStatistics& statistics = ActiveFitSolveStatistics();
+    statistics.solves++;
+    statistics.iterations += summary->num_successful_steps + summary->num_unsuccessful_steps;
+}
+
+void RecordFitStart() {
+    ActiveFitSolveStatistics().fits++;
+}
+
+void RecordFitFallback() {
+    ActiveFitSolveStatistics().fallbacks++;
+}
+
+FitSolveStatistics TakeFitSolveStatistics() {
+    FitSolveStatistics statistics = gFitSolveStatistics;
+    gFitSolveStatistics = FitSolveStatistics();
+    return statistics;
+}
+
+bool ShouldSampleRawFrameReference() {
+    if (Constants::NORMALIZED_FRAME_REFERENCE_INTERVAL <= 0 || gRawFrameReferenceActive) {
+        return false;
+    }
+    return ++gNormalizedFitCount % Constants::NORMALIZED_FRAME_REFERENCE_INTERVAL == 0;
+}
+
+ScopedRawFrameReference::ScopedRawFrameReference()
+    : previous_frame_(gActiveFitFrame), start_(std::chrono::steady_clock::now()) {
+    gActiveFitFrame = nullptr;
+    gRawFrameReferenceActive = true;
+    gRawFrameReferenceStatistics.fits++;
+}
+
+ScopedRawFrameReference::~ScopedRawFrameReference() {
+    gRawFrameReferenceActive = false;
+    gActiveFitFrame = previous_frame_;
+    gRawFrameReferenceTimeMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_).count();
+}
+
+bool IsRawFrameReferenceActive() {
+    return gRawFrameReferenceActive;
+}
+
+FitSolveStatistics TakeRawFrameReferenceStatistics() {
+    FitSolveStatistics statistics = gRawFrameReferenceStatistics;
+    gRawFrameReferenceStatistics = FitSolveStatistics();
+    return statistics;
+}
+
+double RawFrameReferenceTimeMs() {
+    return gRawFrameReferenceTimeMs;
+}
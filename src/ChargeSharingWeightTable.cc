@@ -0,0 +1,72 @@
+#include "ChargeSharingWeightTable.hh"
+#include "Constants.hh"
+
+#include <algorithm>
+#include <cmath>
+
+ChargeSharingWeightTable::ChargeSharingWeightTable()
+    : fPixelSize(0),
+      fD0(0),
+      fStep(0),
+      fInverseStep(0),
+      fMinDistance(0),
+      fMaxDistance(0)
+{
+}
+
+G4double ChargeSharingWeightTable::EvaluateAlpha(G4double distance, G4double pixelSize)
+{
+    // α = tan^(-1) [(l/2 * √2) / (l/2 * √2 + d)]
+    G4double numerator = (pixelSize/2.0) * std::sqrt(2.0);
+    G4double denominator = numerator + distance;
+    
+    if (denominator < Constants::MIN_DENOMINATOR_VALUE) {
+        return CLHEP::pi/2.0;  // Maximum possible angle (90 degrees)
+    }
+    return std::atan(numerator / denominator);
+}
+
+G4double ChargeSharingWeightTable::EvaluateWeight(G4double distance, G4double alpha, G4double d0)
+{
+    // Handle the case where distance might be very small or zero
+    if (distance > d0) {
+        // Clamp log value to avoid division by very small numbers when d ≈ d0
+        G4double logValue = std::max(std::log(distance / d0), Constants::MIN_LOG_VALUE);
+        return alpha * (1.0 / logValue);
+    }
+    
+    // For very small or zero distances (hit on pixel center), use a large weight
+    return alpha * Constants::ALPHA_WEIGHT_MULTIPLIER;
+}
+
+void ChargeSharingWeightTable::Build(G4double pixelSize, G4double d0, G4double maxDistance, G4double step)
+{
+    fPixelSize = pixelSize;
+    fD0 = d0;
+    fStep = step;
+    fInverseStep = 1.0 / step;
+    
+    // One extra node so interpolation at maxDistance stays in range
+    size_t numEntries = static_cast<size_t>(std::ceil(maxDistance * fInverseStep)) + 2;
+    fAlpha.resize(numEntries);
+    fWeight.resize(numEntries);
+    
+    for (size_t i = 0; i < numEntries; ++i) {
+        G4double distance = i * step;
+        fAlpha[i] = EvaluateAlpha(distance, pixelSize);
+        fWeight[i] = EvaluateWeight(distance, fAlpha[i], d0);
+    }
+    
+    fMaxDistance = (numEntries - 2) * step;
+    
+    // Non-pixel hits are at least half a pad from the nearest pad center; stay clear of d0 as well
+    fMinDistance = std::max(0.5 * pixelSize, 2.0 * d0);
+}
+
+G4bool ChargeSharingWeightTable::Covers(G4double pixelSize, G4double d0, G4double maxDistance) const
+{
+    return !fWeight.empty() &&
+           fPixelSize == pixelSize &&
+           fD0 == d0 &&
+           maxDistance <= fMaxDistance;
+}
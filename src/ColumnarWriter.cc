@@ -0,0 +1,377 @@
+#include "ColumnarWriter.hh"
+#include "Constants.hh"
+
+#include "globals.hh"
+
+#include <algorithm>
+#include <cstring>
+
+// ROOT includes
+#include "TTree.h"
+#include "TBranch.h"
+#include "TLeaf.h"
+#include "TObjArray.h"
+
+namespace {
+
+const char kMagic[8] = {'E', 'C', 'S', 'C', 'O', 'L', 'S', '1'};
+
+struct ColumnHeader {
+    std::string name;
+    std::string title;
+    char type;
+    std::uint64_t offset;
+};
+
+struct FileHeader {
+    std::uint64_t headerBytes = 0;
+    std::uint64_t entries = 0;
+    ColumnarMetadata metadata;
+    std::vector<ColumnHeader> columns;
+};
+
+std::uint32_t TypeWidth(char type) {
+    switch (type) {
+        case 'd': return 8;
+        case 'i': return 4;
+        default:  return 1;
+    }
+}
+
+std::uint64_t Align(std::uint64_t offset) {
+    const std::uint64_t alignment = static_cast<std::uint64_t>(Constants::COLUMNAR_ALIGNMENT);
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+// =============================================
+// HEADER SERIALIZATION
+// =============================================
+
+template <typename T>
+void Append(std::vector<unsigned char>& bytes, T value) {
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(&value);
+    bytes.insert(bytes.end(), p, p + sizeof(T));
+}
+
+void AppendString(std::vector<unsigned char>& bytes, const std::string& s) {
+    Append<std::uint32_t>(bytes, static_cast<std::uint32_t>(s.size()));
+    bytes.insert(bytes.end(), s.begin(), s.end());
+}
+
+// Serialized header padded to the column alignment; the column offsets follow from its size,
+// so it is built once to measure and once with the final offsets
+std::vector<unsigned char> SerializeHeader(FileHeader& header) {
+    for (G4int pass = 0; pass < 2; ++pass) {
+        std::vector<unsigned char> bytes(kMagic, kMagic + sizeof(kMagic));
+        Append<std::uint64_t>(bytes, header.headerBytes);
+        Append<std::uint64_t>(bytes, header.entries);
+        Append<std::uint32_t>(bytes, static_cast<std::uint32_t>(header.columns.size()));
+        Append<std::uint32_t>(bytes, static_cast<std::uint32_t>(header.metadata.size()));
+        for (const auto& entry : header.metadata) {
+            AppendString(bytes, entry.first);
+            AppendString(bytes, entry.second);
+        }
+        for (const auto& column : header.columns) {
+            AppendString(bytes, column.name);
+            AppendString(bytes, column.title);
+            bytes.push_back(static_cast<unsigned char>(column.type));
+            Append<std::uint64_t>(bytes, column.offset);
+        }
+        bytes.resize(Align(bytes.size()), 0);
+
+        if (pass == 0) {
+            header.headerBytes = bytes.size();
+            std::uint64_t offset = header.headerBytes;
+            for (auto& column : header.columns) {
+                column.offset = offset;
+                offset = Align(offset + header.entries * TypeWidth(column.type));
+            }
+        } else {
+            return bytes;
+        }
+    }
+    return {};
+}
+
+template <typename T>
+bool Read(std::FILE* file, T& value) {
+    return std::fread(&value, sizeof(T), 1, file) == 1;
+}
+
+bool ReadString(std::FILE* file, std::string& s) {
+    std::uint32_t size = 0;
+    if (!Read(file, size)) return false;
+    s.resize(size);
+    return size == 0 || std::fread(&s[0], 1, size, file) == size;
+}
+
+bool ReadHeader(const std::string& path, FileHeader& header) {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+    char magic[sizeof(kMagic)];
+    std::uint32_t numColumns = 0, numMetadata = 0;
+    bool ok = std::fread(magic, 1, sizeof(magic), file) == sizeof(magic) &&
+              std::memcmp(magic, kMagic, sizeof(kMagic)) == 0 &&
+              Read(file, header.headerBytes) && Read(file, header.entries) &&
+              Read(file, numColumns) && Read(file, numMetadata);
+    for (std::uint32_t i = 0; ok && i < numMetadata; ++i) {
+        std::pair<std::string, std::string> entry;
+        ok = ReadString(file, entry.first) && ReadString(file, entry.second);
+        header.metadata.push_back(entry);
+    }
+    for (std::uint32_t i = 0; ok && i < numColumns; ++i) {
+        ColumnHeader column;
+        ok = ReadString(file, column.name) && ReadString(file, column.title) &&
+             Read(file, column.type) && Read(file, column.offset);
+        header.columns.push_back(column);
+    }
+    std::fclose(file);
+    return ok;
+}
+
+// Zero bytes up to the next column boundary
+bool PadTo(std::FILE* file, std::uint64_t offset) {
+    static const unsigned char zeros[256] = {};
+    long position = std::ftell(file);
+    while (position >= 0 && static_cast<std::uint64_t>(position) < offset) {
+        size_t n = std::min<std::uint64_t>(sizeof(zeros), offset - position);
+        if (std::fwrite(zeros, 1, n, file) != n) return false;
+        position += static_cast<long>(n);
+    }
+    return position >= 0;
+}
+
+} // namespace
+
+ColumnarWriter::ColumnarWriter()
+    : fBlockCapacity(static_cast<std::uint64_t>(Constants::COLUMNAR_BLOCK_ENTRIES)),
+      fBlockEntries(0),
+      fEntries(0),
+      fEntryBytes(0),
+      fSpool(nullptr)
+{
+}
+
+ColumnarWriter::~ColumnarWriter()
+{
+    if (fSpool) {
+        std::fclose(fSpool);
+        std::remove(fSpoolPath.c_str());
+    }
+}
+
+std::string ColumnarWriter::FileNameFor(const std::string& rootFileName)
+{
+    const std::string suffix = ".root";
+    if (rootFileName.size() >= suffix.size() &&
+        rootFileName.compare(rootFileName.size() - suffix.size(), suffix.size(), suffix) == 0) {
+        return rootFileName.substr(0, rootFileName.size() - suffix.size()) + ".cols";
+    }
+    return rootFileName + ".cols";
+}
+
+void ColumnarWriter::AddTreeColumns(TTree* tree)
+{
+    if (!tree) {
+        return;
+    }
+
+    TObjArray* branches = tree->GetListOfBranches();
+    for (Int_t i = 0; i < branches->GetEntriesFast(); ++i) {
+        TBranch* branch = static_cast<TBranch*>(branches->At(i));
+        // Leaf-list branches only: std::vector branches are TBranchElements
+        if (!branch || branch->IsA() != TBranch::Class() || branch->GetListOfLeaves()->GetEntriesFast() != 1) {
+            continue;
+        }
+        TLeaf* leaf = static_cast<TLeaf*>(branch->GetListOfLeaves()->At(0));
+        if (leaf->GetLen() != 1 || leaf->GetLeafCount() || !branch->GetAddress()) {
+            continue;
+        }
+
+        const std::string typeName = leaf->GetTypeName();
+        char type = 0;
+        if (typeName == "Double_t") type = 'd';
+        else if (typeName == "Int_t") type = 'i';
+        else if (typeName == "Bool_t") type = '?';
+        else continue;
+
+        Column column;
+        column.name = branch->GetName();
+        column.title = branch->GetTitle();
+        column.type = type;
+        column.width = TypeWidth(type);
+        column.address = branch->GetAddress();
+        column.blockOffset = fEntryBytes * fBlockCapacity;
+        fEntryBytes += column.width;
+        fColumns.push_back(column);
+    }
+    fBlock.assign(fEntryBytes * fBlockCapacity, 0);
+}
+
+bool ColumnarWriter::Open(const std::string& path)
+{
+    fPath = path;
+    fSpoolPath = path + ".spool";
+    fSpool = std::fopen(fSpoolPath.c_str(), "wb+");
+    if (!fSpool) {
+        G4cerr << "ColumnarWriter: Cannot create spool file " << fSpoolPath << G4endl;
+        return false;
+    }
+    fEntries = 0;
+    fBlockEntries = 0;
+    return true;
+}
+
+void ColumnarWriter::Fill()
+{
+    if (!fSpool) {
+        return;
+    }
+    for (const Column& column : fColumns) {
+        std::memcpy(fBlock.data() + column.blockOffset + fBlockEntries * column.width, column.address, column.width);
+    }
+    ++fEntries;
+    if (++fBlockEntries == fBlockCapacity) {
+        FlushBlock();
+    }
+}
+
+void ColumnarWriter::FlushBlock()
+{
+    // Column slices of the filled entries, back to back
+    for (const Column& column : fColumns) {
+        std::fwrite(fBlock.data() + column.blockOffset, column.width, fBlockEntries, fSpool);
+    }
+    fBlockEntries = 0;
+}
+
+bool ColumnarWriter::Finish(const ColumnarMetadata& metadata)
+{
+    if (!fSpool) {
+        return false;
+    }
+    if (fBlockEntries > 0) {
+        FlushBlock();
+    }
+
+    FileHeader header;
+    header.entries = fEntries;
+    header.metadata = metadata;
+    for (const Column& column : fColumns) {
+        header.columns.push_back({column.name, column.title, column.type, 0});
+    }
+    const std::vector<unsigned char> headerBytes = SerializeHeader(header);
+
+    std::FILE* output = std::fopen(fPath.c_str(), "wb");
+    bool ok = output && std::fwrite(headerBytes.data(), 1, headerBytes.size(), output) == headerBytes.size();
+
+    // Scatter the spooled blocks into their column ranges
+    std::rewind(fSpool);
+    std::vector<unsigned char> block(fEntryBytes * fBlockCapacity);
+    for (std::uint64_t first = 0; ok && first < fEntries; first += fBlockCapacity) {
+        const std::uint64_t n = std::min(fBlockCapacity, fEntries - first);
+        ok = std::fread(block.data(), fEntryBytes, n, fSpool) == n;
+        size_t position = 0;
+        for (size_t c = 0; ok && c < fColumns.size(); ++c) {
+            const size_t bytes = n * fColumns[c].width;
+            ok = std::fseek(output, static_cast<long>(header.columns[c].offset + first * fColumns[c].width), SEEK_SET) == 0 &&
+                 std::fwrite(block.data() + position, 1, bytes, output) == bytes;
+            position += bytes;
+        }
+    }
+
+    // Trailing padding of the last column
+    if (ok && !header.columns.empty()) {
+        const ColumnHeader& last = header.columns.back();
+        ok = std::fseek(output, 0, SEEK_END) == 0 &&
+             PadTo(output, Align(last.offset + fEntries * TypeWidth(last.type)));
+    }
+
+    if (output) {
+        ok = std::fclose(output) == 0 && ok;
+    }
+    std::fclose(fSpool);
+    fSpool = nullptr;
+    std::remove(fSpoolPath.c_str());
+
+    if (!ok) {
+        G4cerr << "ColumnarWriter: Failed to write " << fPath << G4endl;
+    }
+    return ok;
+}
+
+bool ColumnarWriter::Merge(const std::vector<std::string>& inputs, const std::string& output,
+                           const ColumnarMetadata& metadata)
+{
+    std::vector<FileHeader> headers(inputs.size());
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        if (!ReadHeader(inputs[i], headers[i])) {
+            G4cerr << "ColumnarWriter: Cannot read columnar file " << inputs[i] << G4endl;
+            return false;
+        }
+    }
+    if (headers.empty()) {
+        return false;
+    }
+
+    // Schema of the first input; all others must match it column by column
+    FileHeader merged;
+    merged.metadata = metadata.empty() ? headers[0].metadata : metadata;
+    for (const ColumnHeader& column : headers[0].columns) {
+        merged.columns.push_back({column.name, column.title, column.type, 0});
+    }
+    for (size_t i = 0; i < headers.size(); ++i) {
+        const std::vector<ColumnHeader>& columns = headers[i].columns;
+        G4bool same = columns.size() == merged.columns.size();
+        for (size_t c = 0; same && c < columns.size(); ++c) {
+            same = columns[c].name == merged.columns[c].name && columns[c].type == merged.columns[c].type;
+        }
+        if (!same) {
+            G4cerr << "ColumnarWriter: Column layout of " << inputs[i] << " differs from " << inputs[0] << G4endl;
+            return false;
+        }
+        merged.entries += headers[i].entries;
+    }
+    const std::vector<unsigned char> headerBytes = SerializeHeader(merged);
+
+    std::FILE* out = std::fopen(output.c_str(), "wb");
+    std::vector<std::FILE*> in;
+    for (const std::string& input : inputs) {
+        in.push_back(std::fopen(input.c_str(), "rb"));
+    }
+    bool ok = out && std::fwrite(headerBytes.data(), 1, headerBytes.size(), out) == headerBytes.size() &&
+              std::find(in.begin(), in.end(), nullptr) == in.end();
+
+    // Column by column, the inputs' ranges back to back
+    std::vector<unsigned char> buffer(1 << 20);
+    for (size_t c = 0; ok && c < merged.columns.size(); ++c) {
+        const std::uint32_t width = TypeWidth(merged.columns[c].type);
+        ok = PadTo(out, merged.columns[c].offset);
+        for (size_t i = 0; ok && i < in.size(); ++i) {
+            std::uint64_t remaining = headers[i].entries * width;
+            ok = std::fseek(in[i], static_cast<long>(headers[i].columns[c].offset), SEEK_SET) == 0;
+            while (ok && remaining > 0) {
+                const size_t n = std::min<std::uint64_t>(buffer.size(), remaining);
+                ok = std::fread(buffer.data(), 1, n, in[i]) == n && std::fwrite(buffer.data(), 1, n, out) == n;
+                remaining -= n;
+            }
+        }
+    }
+    if (ok && !merged.columns.empty()) {
+        const ColumnHeader& last = merged.columns.back();
+        ok = PadTo(out, Align(last.offset + merged.entries * TypeWidth(last.type)));
+    }
+
+    for (std::FILE* file : in) {
+        if (file) std::fclose(file);
+    }
+    if (out) {
+        ok = std::fclose(out) == 0 && ok;
+    }
+    if (!ok) {
+        G4cerr << "ColumnarWriter: Failed to merge columnar files into " << output << G4endl;
+    }
+    return ok;
+}
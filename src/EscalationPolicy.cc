@@ -0,0 +1,176 @@
+#include "EscalationPolicy.hh"
+#include "Constants.hh"
+#include "CeresUtils.hh"
+
+#include <cmath>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+
+namespace {
+
+struct EscalationCounts {
+    long long attempts[kNumEscalationModels][kNumNeighborhoodClasses][kMaxEscalationStages] = {};
+    long long accepted[kNumEscalationModels][kNumNeighborhoodClasses][kMaxEscalationStages] = {};
+};
+
+// Live counters of this thread (learning happens per thread, no locking on the fit path).
+// They persist across runs, so later runs in the same process keep the learned order.
+thread_local EscalationCounts tThreadCounts;
+
+// Part of tThreadCounts already folded into the run totals by an earlier merge
+thread_local EscalationCounts tMergedCounts;
+
+// Run totals merged from all threads at end of run
+EscalationCounts gRunCounts;
+std::mutex gRunCountsMutex;
+
+// Frozen policy from a previous run, loaded once
+EscalationCounts gFrozenCounts;
+std::once_flag gFrozenLoadFlag;
+
+bool IsValidIndex(EscalationModel model, int neighborhood_class, int stage) {
+    int m = static_cast<int>(model);
+    return m >= 0 && m < kNumEscalationModels &&
+           neighborhood_class >= 0 && neighborhood_class < kNumNeighborhoodClasses &&
+           stage >= 0 && stage < kMaxEscalationStages;
+}
+
+void LoadFrozenPolicy() {
+    std::ifstream in(Constants::ESCALATION_POLICY_FILE);
+    if (!in.is_open()) {
+        std::cerr << "EscalationPolicy: cannot open " << Constants::ESCALATION_POLICY_FILE
+                  << ", using the default escalation order" << std::endl;
+        return;
+    }
+
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream fields(line);
+        int m = -1, c = -1, s = -1;
+        long long attempts = 0, accepted = 0;
+        if (!(fields >> m >> c >> s >> attempts >> accepted)) continue;
+        if (!IsValidIndex(static_cast<EscalationModel>(m), c, s)) continue;
+        gFrozenCounts.attempts[m][c][s] = attempts;
+        gFrozenCounts.accepted[m][c][s] = accepted;
+    }
+}
+
+} // namespace
+
+int GetEscalationNeighborhoodClass(size_t num_points, bool surface_fit) {
+    double points_per_axis = surface_fit ? std::sqrt(static_cast<double>(num_points))
+                                         : static_cast<double>(num_points);
+    if (points_per_axis <= 3.0) return 0;
+    if (points_per_axis <= 5.0) return 1;
+    return 2;
+}
+
+std::vector<int> GetEscalationOrder(EscalationModel model, int neighborhood_class, int num_stages) {
+    num_stages = std::min(num_stages, kMaxEscalationStages);
+    std::vector<int> order;
+    for (int stage = 1; stage < num_stages; ++stage) {
+        order.push_back(stage);
+    }
+    if (order.size() < 2 || !IsValidIndex(model, neighborhood_class, 0)) {
+        return order;
+    }
+
+    // A frozen policy applies on its own; live learning needs ENABLE_ADAPTIVE_ESCALATION
+    const EscalationCounts* counts = nullptr;
+    if (Constants::ESCALATION_POLICY_USE_FROZEN) {
+        std::call_once(gFrozenLoadFlag, LoadFrozenPolicy);
+        counts = &gFrozenCounts;
+    } else if (Constants::ENABLE_ADAPTIVE_ESCALATION) {
+        counts = &tThreadCounts;
+    } else {
+        return order;
+    }
+    const int m = static_cast<int>(model);
+    const long long* attempts = counts->attempts[m][neighborhood_class];
+    const long long* accepted = counts->accepted[m][neighborhood_class];
+
+    // Escalations seen so far for this model and class (every escalation tries the first stage)
+    long long escalations = 0;
+    for (int stage : order) {
+        escalations = std::max(escalations, attempts[stage]);
+    }
+    if (escalations < Constants::ESCALATION_MIN_SAMPLES) {
+        return order;
+    }
+
+    // Smoothed win rate, so a stage that was never tried is not ranked last by default
+    auto win_rate = [&](int stage) {
+        return (accepted[stage] + 1.0) / (attempts[stage] + 2.0);
+    };
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        return win_rate(a) > win_rate(b);
+    });
+
+    // Prune stages that almost never produce the accepted fit; the best-ranked one always stays
+    std::vector<int> pruned;
+    for (size_t i = 0; i < order.size(); ++i) {
+        int stage = order[i];
+        bool rarely_wins = attempts[stage] >= Constants::ESCALATION_MIN_SAMPLES &&
+                           accepted[stage] < Constants::ESCALATION_PRUNE_FRACTION * attempts[stage];
+        if (i == 0 || !rarely_wins) {
+            pruned.push_back(stage);
+        }
+    }
+    return pruned;
+}
+
+void RecordEscalationAttempt(EscalationModel model, int neighborhood_class, int stage) {
+    if (!IsValidIndex(model, neighborhood_class, stage) || IsRawFrameReferenceActive()) return;
+    tThreadCounts.attempts[static_cast<int>(model)][neighborhood_class][stage]++;
+}
+
+void RecordEscalationAccepted(EscalationModel model, int neighborhood_class, int stage) {
+    if (!IsValidIndex(model, neighborhood_class, stage) || IsRawFrameReferenceActive()) return;
+    tThreadCounts.accepted[static_cast<int>(model)][neighborhood_class][stage]++;
+}
+
+void ResetEscalationStatistics() {
+    std::lock_guard<std::mutex> lock(gRunCountsMutex);
+    gRunCounts = EscalationCounts();
+}
+
+void MergeEscalationStatistics() {
+    std::lock_guard<std::mutex> lock(gRunCountsMutex);
+    for (int m = 0; m < kNumEscalationModels; ++m) {
+        for (int c = 0; c < kNumNeighborhoodClasses; ++c) {
+            for (int s = 0; s < kMaxEscalationStages; ++s) {
+                // Only what this thread counted since its last merge; the live counters are kept
+                gRunCounts.attempts[m][c][s] += tThreadCounts.attempts[m][c][s] - tMergedCounts.attempts[m][c][s];
+                gRunCounts.accepted[m][c][s] += tThreadCounts.accepted[m][c][s] - tMergedCounts.accepted[m][c][s];
+            }
+        }
+    }
+    tMergedCounts = tThreadCounts;
+}
+
+bool WriteEscalationPolicy(const std::string& filename) {
+    std::lock_guard<std::mutex> lock(gRunCountsMutex);
+    std::ofstream out(filename);
+    if (!out.is_open()) {
+        std::cerr << "EscalationPolicy: cannot write " << filename << std::endl;
+        return false;
+    }
+
+    out << "# Escalation policy: accepted-fit counts per solver stage\n";
+    out << "# model (0-2: 1D Gauss/Lorentz/PowerLorentz, 3-5: 3D) class (points per axis <=3, <=5, more) "
+        << "stage (0 = cheap) attempts accepted\n";
+    for (int m = 0; m < kNumEscalationModels; ++m) {
+        for (int c = 0; c < kNumNeighborhoodClasses; ++c) {
+            for (int s = 0; s < kMaxEscalationStages; ++s) {
+                if (gRunCounts.attempts[m][c][s] == 0) continue;
+                out << m << " " << c << " " << s << " "
+                    << gRunCounts.attempts[m][c][s] << " " << gRunCounts.accepted[m][c][s] << "\n";
+            }
+        }
+    }
+    return out.good();
+}
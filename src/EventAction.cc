@@ -10,6 +10,10 @@
 #include "3DGaussianFitCeres.hh"
 #include "3DLorentzianFitCeres.hh"
 #include "3DPowerLorentzianFitCeres.hh"
+#include "JointProfileFitCeres.hh"
+#include "3DSymmetricFitCeres.hh"
+#include "CeresUtils.hh"
+#include "EventArena.hh"
 
 #include "G4Event.hh"
 #include "G4SystemOfUnits.hh"
@@ -19,7 +23,10 @@
 #include <cmath>
 #include <vector>
 #include <algorithm>
+#include <functional>
 #include <limits>
+#include <chrono>
+#include <cstdint>
 
 // Alpha calculation method: ANALYTICAL
 // This implementation uses the analytical formula for calculating the alpha angle:
@@ -29,6 +36,262 @@
 //   d = distance from event hit to center of pixel pad
 // See Page 9: https://indico.cern.ch/event/813597/contributions/3727782/attachments/1989546/3540780/TREDI_Cartiglia.pdf
 
+// Start of a timed fit window; raw-frame reference fits inside the window are not fit time
+struct FitWindowStart {
+  std::chrono::steady_clock::time_point time;
+  G4double rawReferenceMs;
+};
+
+static FitWindowStart StartFitWindow()
+{
+  return {std::chrono::steady_clock::now(), RawFrameReferenceTimeMs()};
+}
+
+// Accumulate per-model fit wall time in the SimulationLogger statistics
+// excludedMs: time spent inside the window on work that is not part of the fit (coarse-to-fine reference fits)
+static void RecordFitTiming(const std::string& fitType, const FitWindowStart& start,
+                            size_t numPoints, G4bool converged, G4double excludedMs = 0.0)
+{
+  G4double elapsedMs = std::chrono::duration<G4double, std::milli>(std::chrono::steady_clock::now() - start.time).count();
+  elapsedMs -= RawFrameReferenceTimeMs() - start.rawReferenceMs;
+  elapsedMs = std::max(0.0, elapsedMs - excludedMs);
+  SimulationLogger* logger = SimulationLogger::GetInstance();
+  if (logger) {
+    logger->RecordFitTiming(fitType, elapsedMs, static_cast<G4int>(numPoints), converged);
+  }
+}
+
+// Accumulate coarse-to-fine stage counts and sampled full-grid reference times for a 3D fit
+template <typename Fit3DResults>
+static void RecordCoarseToFineStage(const std::string& fitType, const Fit3DResults& results)
+{
+  if (!Constants::ENABLE_COARSE_TO_FINE_3D) {
+    return;
+  }
+  SimulationLogger* logger = SimulationLogger::GetInstance();
+  if (logger) {
+    logger->RecordCoarseToFineStage(fitType, results.fit_stage, results.fit_time_ms, results.reference_time_ms);
+  }
+}
+
+// =============================================
+// EVENT RECORD FILLING
+// =============================================
+
+// Copy one projection of a Ceres profile fit result (fields <p>center, <p><W>, <p><W>_err, ...) into its block
+#define FILL_PROFILE_FIT(block, res, p, W) \
+  do { \
+    (block).amplitude = (res).p##amplitude; \
+    (block).amplitude_err = (res).p##amplitude_err; \
+    (block).width = (res).p##W; \
+    (block).width_err = (res).p##W##_err; \
+    (block).vertical_offset = (res).p##vertical_offset; \
+    (block).vertical_offset_err = (res).p##vertical_offset_err; \
+    (block).center = (res).p##center; \
+    (block).center_err = (res).p##center_err; \
+    (block).chi2red = (res).p##chi2red; \
+    (block).pp = (res).p##pp; \
+    (block).dof = (res).p##dof; \
+  } while (0)
+
+#define FILL_PROFILE_BETA(block, res, p) \
+  do { \
+    (block).beta = (res).p##beta; \
+    (block).beta_err = (res).p##beta_err; \
+  } while (0)
+
+#define FILL_DIAGONAL_FITS(model, res, W) \
+  do { \
+    FILL_PROFILE_FIT((model).main_diag_x, res, main_diag_x_, W); \
+    FILL_PROFILE_FIT((model).main_diag_y, res, main_diag_y_, W); \
+    FILL_PROFILE_FIT((model).second_diag_x, res, sec_diag_x_, W); \
+    FILL_PROFILE_FIT((model).second_diag_y, res, sec_diag_y_, W); \
+  } while (0)
+
+#define FILL_SURFACE_FIT(surface, res, W) \
+  do { \
+    (surface).center_x = (res).center_x; \
+    (surface).center_y = (res).center_y; \
+    (surface).width_x = (res).W##_x; \
+    (surface).width_y = (res).W##_y; \
+    (surface).amplitude = (res).amplitude; \
+    (surface).vertical_offset = (res).vertical_offset; \
+    (surface).center_x_err = (res).center_x_err; \
+    (surface).center_y_err = (res).center_y_err; \
+    (surface).width_x_err = (res).W##_x_err; \
+    (surface).width_y_err = (res).W##_y_err; \
+    (surface).amplitude_err = (res).amplitude_err; \
+    (surface).vertical_offset_err = (res).vertical_offset_err; \
+    (surface).chi2red = (res).chi2red; \
+    (surface).pp = (res).pp; \
+    (surface).dof = (res).dof; \
+    (surface).successful = (res).fit_successful; \
+  } while (0)
+
+// Charge uncertainties (5% of max charge) are only stored if the feature is enabled
+static void FillRowColumnStatus(ProfileModelRecord& model, G4double x_charge_uncertainty,
+                                G4double y_charge_uncertainty, G4bool fit_successful)
+{
+  if (Constants::ENABLE_VERTICAL_CHARGE_UNCERTAINTIES) {
+    model.row.charge_uncertainty = x_charge_uncertainty;
+    model.column.charge_uncertainty = y_charge_uncertainty;
+  }
+  model.row_column_successful = fit_successful;
+}
+
+static void FillRowColumnFits(ProfileModelRecord& model, const GaussianFit2DResultsCeres& res)
+{
+  FILL_PROFILE_FIT(model.row, res, x_, sigma);
+  FILL_PROFILE_FIT(model.column, res, y_, sigma);
+  FillRowColumnStatus(model, res.x_charge_uncertainty, res.y_charge_uncertainty, res.fit_successful);
+}
+
+static void FillRowColumnFits(ProfileModelRecord& model, const LorentzianFit2DResultsCeres& res)
+{
+  FILL_PROFILE_FIT(model.row, res, x_, gamma);
+  FILL_PROFILE_FIT(model.column, res, y_, gamma);
+  FillRowColumnStatus(model, res.x_charge_uncertainty, res.y_charge_uncertainty, res.fit_successful);
+}
+
+static void FillRowColumnFits(ProfileModelRecord& model, const PowerLorentzianFit2DResultsCeres& res)
+{
+  FILL_PROFILE_FIT(model.row, res, x_, gamma);
+  FILL_PROFILE_FIT(model.column, res, y_, gamma);
+  FILL_PROFILE_BETA(model.row, res, x_);
+  FILL_PROFILE_BETA(model.column, res, y_);
+  FillRowColumnStatus(model, res.x_charge_uncertainty, res.y_charge_uncertainty, res.fit_successful);
+}
+
+static void FillDiagonalFits(ProfileModelRecord& model, const DiagonalFitResultsCeres& res)
+{
+  FILL_DIAGONAL_FITS(model, res, sigma);
+}
+
+static void FillDiagonalFits(ProfileModelRecord& model, const DiagonalLorentzianFitResultsCeres& res)
+{
+  FILL_DIAGONAL_FITS(model, res, gamma);
+}
+
+static void FillDiagonalFits(ProfileModelRecord& model, const DiagonalPowerLorentzianFitResultsCeres& res)
+{
+  FILL_DIAGONAL_FITS(model, res, gamma);
+  FILL_PROFILE_BETA(model.main_diag_x, res, main_diag_x_);
+  FILL_PROFILE_BETA(model.main_diag_y, res, main_diag_y_);
+  FILL_PROFILE_BETA(model.second_diag_x, res, sec_diag_x_);
+  FILL_PROFILE_BETA(model.second_diag_y, res, sec_diag_y_);
+}
+
+template <typename Fit3DResults>
+static void FillSurfaceChargeUncertainty(SurfaceFitRecord& surface, const Fit3DResults& res)
+{
+  if (Constants::ENABLE_VERTICAL_CHARGE_UNCERTAINTIES) {
+    surface.charge_uncertainty = res.charge_uncertainty;
+  }
+}
+
+static void FillSurfaceFit(SurfaceFitRecord& surface, const GaussianFit3DResultsCeres& res)
+{
+  FILL_SURFACE_FIT(surface, res, sigma);
+  FillSurfaceChargeUncertainty(surface, res);
+}
+
+static void FillSurfaceFit(SurfaceFitRecord& surface, const LorentzianFit3DResultsCeres& res)
+{
+  FILL_SURFACE_FIT(surface, res, gamma);
+  FillSurfaceChargeUncertainty(surface, res);
+}
+
+static void FillSurfaceFit(SurfaceFitRecord& surface, const PowerLorentzianFit3DResultsCeres& res)
+{
+  FILL_SURFACE_FIT(surface, res, gamma);
+  surface.beta = res.beta;
+  surface.beta_err = res.beta_err;
+  FillSurfaceChargeUncertainty(surface, res);
+}
+
+#undef FILL_PROFILE_FIT
+#undef FILL_PROFILE_BETA
+#undef FILL_DIAGONAL_FITS
+#undef FILL_SURFACE_FIT
+
+static void FillJointFit(JointFitRecord& joint, const GaussianJointFitResultsCeres& res)
+{
+  joint.center_x = res.center_x;
+  joint.center_y = res.center_y;
+  joint.center_x_err = res.center_x_err;
+  joint.center_y_err = res.center_y_err;
+  joint.center_xy_cov = res.center_xy_cov;
+  joint.sigma = res.sigma;
+  joint.sigma_err = res.sigma_err;
+  joint.diag_sigma = res.diag_sigma;
+  joint.diag_sigma_err = res.diag_sigma_err;
+  joint.num_profiles = res.num_profiles;
+  joint.chi2red = res.chi2red;
+  joint.pp = res.pp;
+  joint.dof = res.dof;
+  joint.successful = res.fit_successful;
+}
+
+// Row/column or 3D fit of an enabled model that failed or has χ²ᵣ above the grid sampling cut
+static G4bool HasPoorFit(const EventRecord& record)
+{
+  auto poor = [](G4bool successful, G4double chi2red) {
+    return !successful || chi2red > Constants::GRID_SAMPLING_MAX_CHI2RED;
+  };
+  auto poorRowColumn = [&](const ProfileModelRecord& model) {
+    return poor(model.row_column_successful, std::max(model.row.chi2red, model.column.chi2red));
+  };
+  
+  if (Constants::ENABLE_2D_FITTING) {
+    if (Constants::ENABLE_GAUSSIAN_FITTING && poorRowColumn(record.gauss)) return true;
+    if (Constants::ENABLE_LORENTZIAN_FITTING && poorRowColumn(record.lorentz)) return true;
+    if (Constants::ENABLE_POWER_LORENTZIAN_FITTING && poorRowColumn(record.power_lorentz)) return true;
+  }
+  if (Constants::ENABLE_3D_GAUSSIAN_FITTING && poor(record.gauss_3d.successful, record.gauss_3d.chi2red)) return true;
+  if (Constants::ENABLE_3D_LORENTZIAN_FITTING && poor(record.lorentz_3d.successful, record.lorentz_3d.chi2red)) return true;
+  if (Constants::ENABLE_3D_POWER_LORENTZIAN_FITTING &&
+      poor(record.power_lorentz_3d.successful, record.power_lorentz_3d.chi2red)) return true;
+  return false;
+}
+
+// Uniform [0, 1) from the event ID (splitmix64): reproducible and independent of the Geant4 engine
+static G4double EventSamplingUniform(G4int eventID)
+{
+  std::uint64_t z = static_cast<std::uint64_t>(eventID) + 0x9E3779B97F4A7C15ULL;
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  z ^= z >> 31;
+  return static_cast<G4double>(z >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// Whether the neighborhood grid vectors of this event are stored (Constants::GRID_SAMPLING_MODE)
+static G4bool SampleGridData(G4int eventID, const EventRecord& record)
+{
+  switch (Constants::GRID_SAMPLING_MODE) {
+    case Constants::GRID_SAMPLE_EVERY_NTH:
+      return Constants::GRID_SAMPLING_INTERVAL <= 1 || eventID % Constants::GRID_SAMPLING_INTERVAL == 0;
+    case Constants::GRID_SAMPLE_RANDOM:
+      return EventSamplingUniform(eventID) < Constants::GRID_SAMPLING_FRACTION;
+    case Constants::GRID_SAMPLE_POOR_FIT:
+      return HasPoorFit(record);
+    default:
+      return true;
+  }
+}
+
+static void FillSymmetricFit(SymmetricFitRecord& symmetric, const SymmetricFit3DResultsCeres& res)
+{
+  symmetric.center_x = res.center_x;
+  symmetric.center_y = res.center_y;
+  symmetric.center_x_err = res.center_x_err;
+  symmetric.center_y_err = res.center_y_err;
+  symmetric.width = res.width;
+  symmetric.width_err = res.width_err;
+  symmetric.chi2red = res.chi2red;
+  symmetric.dof = res.dof;
+  symmetric.successful = res.fit_successful;
+}
+
 EventAction::EventAction(RunAction* runAction, DetectorConstruction* detector)
 : G4UserEventAction(),
   fRunAction(runAction),
@@ -54,6 +317,20 @@ EventAction::EventAction(RunAction* runAction, DetectorConstruction* detector)
   fD0(Constants::D0_CHARGE_SHARING),
   fElementaryCharge(Constants::ELEMENTARY_CHARGE)
 { 
+  // Size every per-event grid and fit buffer for the largest specialized radius up front, so the
+  // per-event path only clears and refills them (a larger runtime radius grows them once)
+  const size_t maxGridPixels = static_cast<size_t>(2 * Constants::MAX_AUTO_RADIUS + 1) * (2 * Constants::MAX_AUTO_RADIUS + 1);
+  fNonPixel_GridNeighborhoodAngles.reserve(maxGridPixels);
+  fNonPixel_GridNeighborhoodChargeFractions.reserve(maxGridPixels);
+  fNonPixel_GridNeighborhoodDistances.reserve(maxGridPixels);
+  fNonPixel_GridNeighborhoodCharge.reserve(maxGridPixels);
+  fKernelDistances.reserve(maxGridPixels);
+  fKernelAlphas.reserve(maxGridPixels);
+  fFitXCoords.reserve(maxGridPixels);
+  fFitYCoords.reserve(maxGridPixels);
+  fFitChargeValues.reserve(maxGridPixels);
+  fAutoRadiusWeights.reserve(maxGridPixels);
+  
   G4cout << "EventAction: Using 2D Gaussian fitting for central row and column" << G4endl;
 }
 
@@ -89,14 +366,23 @@ void EventAction::BeginOfEventAction(const G4Event* event)
   // Reset neighborhood (9x9) grid angle data
   fNonPixel_GridNeighborhoodAngles.clear();
   
+  // Release the per-event temporaries of the previous event
+  ResetEventArena();
+  
   // Reset neighborhood (9x9) grid charge sharing data
   fNonPixel_GridNeighborhoodChargeFractions.clear();
   fNonPixel_GridNeighborhoodDistances.clear();
   fNonPixel_GridNeighborhoodCharge.clear();
+  
+  // Fits that are skipped this event keep the sentinel values
+  fRunAction->ResetEventRecord();
 }
 
 void EventAction::EndOfEventAction(const G4Event* event)
 {
+  // Filled in place below (reset to sentinels in BeginOfEventAction)
+  EventRecord& record = fRunAction->GetEventRecord();
+  
   // Get the primary vertex position and energy from the event
   if (event->GetPrimaryVertex()) {
     G4ThreeVector primaryPos = event->GetPrimaryVertex()->GetPosition();
@@ -107,9 +393,8 @@ void EventAction::EndOfEventAction(const G4Event* event)
     G4PrimaryParticle* primaryParticle = event->GetPrimaryVertex()->GetPrimary();
     if (primaryParticle) {
       G4double initialKineticEnergy = primaryParticle->GetKineticEnergy();
-      // Store the initial energy in the RunAction for ROOT output
-      // Convert from Geant4 internal units (MeV) to MeV for storage
-      fRunAction->SetInitialEnergy(initialKineticEnergy);
+      // Store the initial energy for ROOT output (Geant4 internal energy unit is MeV)
+      record.hit.initial_energy = initialKineticEnergy;
     }
   }
   
@@ -136,16 +421,21 @@ void EventAction::EndOfEventAction(const G4Event* event)
     //        << " MeV for non-pixel hit (event " << eventID << ")" << G4endl;
   }
   
-  // Pass classification data to RunAction
-  fRunAction->SetPixelClassification(isPixelHit, fPixelTrueDeltaX, fPixelTrueDeltaY);
-  fRunAction->SetPixelHitStatus(isPixelHit);
-  
-  // Update the event data with the corrected energy deposition
-  fRunAction->SetEventData(finalEdep, fPosition.x(), fPosition.y(), fPosition.z());
-  fRunAction->SetInitialPosition(fInitialPosition.x(), fInitialPosition.y(), fInitialPosition.z());
-  
-  // Set nearest pixel position in RunAction
-  fRunAction->SetNearestPixelPosition(nearestPixel.x(), nearestPixel.y(), nearestPixel.z());
+  // Classification, corrected energy deposition and positions [mm]
+  HitRecord& hit = record.hit;
+  hit.is_pixel_hit = isPixelHit;
+  hit.pixel_true_delta_x = fPixelTrueDeltaX;
+  hit.pixel_true_delta_y = fPixelTrueDeltaY;
+  hit.edep = finalEdep;
+  hit.true_x = fPosition.x();
+  hit.true_y = fPosition.y();
+  hit.true_z = fPosition.z();
+  hit.init_x = fInitialPosition.x();
+  hit.init_y = fInitialPosition.y();
+  hit.init_z = fInitialPosition.z();
+  hit.pixel_x = nearestPixel.x();
+  hit.pixel_y = nearestPixel.y();
+  hit.pixel_z = nearestPixel.z();
   
   // Only calculate and store pixel-specific data for pixel hits (on pixel surface)
   if (isPixelHit) {
@@ -170,55 +460,81 @@ void EventAction::EndOfEventAction(const G4Event* event)
       fSelectedFitQuality = 0.0; // Not evaluated
     }
     
-    // Calculate neighborhood grid data with selected radius
-    CalculateNeighborhoodGridAngles(fPosition, fPixelIndexI, fPixelIndexJ);
-    CalculateNeighborhoodChargeSharing();
+    // Calculate neighborhood grid data (angles, distances, charge sharing) with selected radius
+    CalculateNeighborhoodGrid(fPosition, fPixelIndexI, fPixelIndexJ);
   }
   
-  // Pass neighborhood grid data to RunAction (will be empty for pixel hits)
-  fRunAction->SetNeighborhoodGridData(fNonPixel_GridNeighborhoodAngles);
-  fRunAction->SetNeighborhoodChargeData(fNonPixel_GridNeighborhoodChargeFractions, fNonPixel_GridNeighborhoodDistances, fNonPixel_GridNeighborhoodCharge, fNonPixel_GridNeighborhoodCharge);
-  
-  // Pass automatic radius selection results to RunAction
-  fRunAction->SetAutoRadiusResults(fSelectedRadius);
+  // Store automatic radius selection results
+  hit.selected_radius = fSelectedRadius;
   
   // Perform 2D Gaussian fitting on charge distribution data (central row and column)
   // Only fit for non-pixel hits (not on pixel surface)
   G4bool shouldPerformFit = !isPixelHit && !fNonPixel_GridNeighborhoodChargeFractions.empty();
   
   if (shouldPerformFit) {
-    // Extract coordinates and charge values for fitting
-    std::vector<double> x_coords, y_coords, charge_values;
+    // Extract coordinates and charge values for fitting (member buffers keep their capacity across events)
+    std::vector<double>& x_coords = fFitXCoords;
+    std::vector<double>& y_coords = fFitYCoords;
+    std::vector<double>& charge_values = fFitChargeValues;
+    x_coords.clear();
+    y_coords.clear();
+    charge_values.clear();
     
     // Get detector parameters for coordinate calculation
     G4double pixelSpacing = fDetector->GetPixelSpacing();
     
     // Convert grid indices to actual coordinates
-    // The neighborhood grid is a systematic 9x9 grid around the center pixel
+    // The grid is stored in column-major order: i = col * gridSize + row
+    // because di (X) is outer loop, dj (Y) is inner loop in charge calculation
     G4int gridSize = 2 * fNeighborhoodRadius + 1; // Should be 9 for radius 4
-    for (size_t i = 0; i < fNonPixel_GridNeighborhoodChargeFractions.size(); ++i) {
-      if (fNonPixel_GridNeighborhoodChargeFractions[i] > 0) { // Only include pixels with charge
-        // Calculate grid position from array index
-        // The grid is stored in column-major order: i = col * gridSize + row
-        // because di (X) is outer loop, dj (Y) is inner loop in charge calculation
-        G4int col = i / gridSize;  // di (X) was outer loop
-        G4int row = i % gridSize;  // dj (Y) was inner loop
-        
-        // Convert grid position to pixel offset from center
-        G4int offsetI = col - fNeighborhoodRadius; // -4 to +4 for 9x9 grid (X offset)
-        G4int offsetJ = row - fNeighborhoodRadius; // -4 to +4 for 9x9 grid (Y offset)
-        
-        // Calculate actual position
-        G4double x_pos = nearestPixel.x() + offsetI * pixelSpacing;
-        G4double y_pos = nearestPixel.y() + offsetJ * pixelSpacing;
-        
-        x_coords.push_back(x_pos);
-        y_coords.push_back(y_pos);
-        // Use actual charge values (in Coulombs) instead of fractions for fitting
-        charge_values.push_back(fNonPixel_GridNeighborhoodCharge[i]);
+    for (G4int col = 0; col < gridSize; ++col) {
+      // Convert grid position to pixel offset from center
+      G4int offsetI = col - fNeighborhoodRadius; // -4 to +4 for 9x9 grid (X offset)
+      G4double x_pos = nearestPixel.x() + offsetI * pixelSpacing;
+      
+      for (G4int row = 0; row < gridSize; ++row) {
+        size_t i = static_cast<size_t>(col) * gridSize + row;
+        if (fNonPixel_GridNeighborhoodChargeFractions[i] > 0) { // Only include pixels with charge
+          G4int offsetJ = row - fNeighborhoodRadius; // -4 to +4 for 9x9 grid (Y offset)
+          G4double y_pos = nearestPixel.y() + offsetJ * pixelSpacing;
+          
+          x_coords.push_back(x_pos);
+          y_coords.push_back(y_pos);
+          // Use actual charge values (in Coulombs) instead of fractions for fitting
+          charge_values.push_back(fNonPixel_GridNeighborhoodCharge[i]);
+        }
       }
     }
     
+    // Restrict the fits to the adaptive region of interest (no-op unless enabled)
+    G4int candidatePads = static_cast<G4int>(x_coords.size());
+    G4int selectedPads = SelectRegionOfInterest(x_coords, y_coords, charge_values);
+    record.hit.roi_candidate_pads = candidatePads;
+    record.hit.roi_selected_pads = selectedPads;
+    SimulationLogger* roiLogger = SimulationLogger::GetInstance();
+    if (roiLogger) {
+      roiLogger->RecordRegionOfInterest(candidatePads, selectedPads);
+    }
+
+    // Central row and column for the deferred batched Gaussian fit (fitted when RunAction flushes its queue)
+    if (Constants::ENABLE_BATCHED_GAUSSIAN_FITTING) {
+      const G4double tolerance = 0.1 * pixelSpacing;
+      ArenaDoubleVector rowX(GetEventArena()), rowCharges(GetEventArena());
+      ArenaDoubleVector colY(GetEventArena()), colCharges(GetEventArena());
+      for (size_t i = 0; i < x_coords.size(); ++i) {
+        if (std::abs(y_coords[i] - nearestPixel.y()) < tolerance) {
+          rowX.push_back(x_coords[i]);
+          rowCharges.push_back(charge_values[i]);
+        }
+        if (std::abs(x_coords[i] - nearestPixel.x()) < tolerance) {
+          colY.push_back(y_coords[i]);
+          colCharges.push_back(charge_values[i]);
+        }
+      }
+      fRunAction->SetBatchedGaussianFitInput(rowX, rowCharges, colY, colCharges,
+                                             nearestPixel.x(), nearestPixel.y(), pixelSpacing);
+    }
+
     // ===============================================
     // GAUSSIAN FITTING (conditionally enabled)
     // ===============================================
@@ -226,29 +542,21 @@ void EventAction::EndOfEventAction(const G4Event* event)
     // Perform 2D fitting if we have enough data points and Gaussian fitting is enabled
     if (x_coords.size() >= 3 && Constants::ENABLE_GAUSSIAN_FITTING && Constants::ENABLE_2D_FITTING) { // Need at least 3 points for 1D Gaussian fit
       // Perform 2D Gaussian fitting using the Ceres Solver implementation
+      auto gauss2DStart = StartFitWindow();
       GaussianFit2DResultsCeres fitResults = Fit2DGaussianCeres(
         x_coords, y_coords, charge_values,
         nearestPixel.x(), nearestPixel.y(),
         pixelSpacing, 
         false, // verbose=false for production
         false); // enable_outlier_filtering
+      RecordFitTiming("Gaussian2D", gauss2DStart, x_coords.size(), fitResults.fit_successful);
       
       if (fitResults.fit_successful) {
         // Removed verbose debug output for cleaner simulation logs
       }
       
-      // Pass 2D fit results to RunAction
-      fRunAction->Set2DGaussianFitResults(
-        fitResults.x_center, fitResults.x_sigma, fitResults.x_amplitude,
-        fitResults.x_center_err, fitResults.x_sigma_err, fitResults.x_amplitude_err,
-        fitResults.x_vertical_offset, fitResults.x_vertical_offset_err,
-        fitResults.x_chi2red, fitResults.x_pp, fitResults.x_dof,
-        fitResults.y_center, fitResults.y_sigma, fitResults.y_amplitude,
-        fitResults.y_center_err, fitResults.y_sigma_err, fitResults.y_amplitude_err,
-        fitResults.y_vertical_offset, fitResults.y_vertical_offset_err,
-        fitResults.y_chi2red, fitResults.y_pp, fitResults.y_dof,
-        fitResults.x_charge_uncertainty, fitResults.y_charge_uncertainty,
-        fitResults.fit_successful);
+      // Store 2D fit results in the event record
+      FillRowColumnFits(record.gauss, fitResults);
       
       // Log Gaussian fitting results to SimulationLogger
       SimulationLogger* logger = SimulationLogger::GetInstance();
@@ -259,44 +567,34 @@ void EventAction::EndOfEventAction(const G4Event* event)
         // Perform diagonal fitting if 2D fitting was performed and successful and diagonal fitting is enabled
         if (fitResults.fit_successful && Constants::ENABLE_DIAGONAL_FITTING) {
           // Perform diagonal Gaussian fitting using the Ceres Solver implementation
+          auto gaussDiagStart = StartFitWindow();
           DiagonalFitResultsCeres diagResults = FitDiagonalGaussianCeres(
           x_coords, y_coords, charge_values,
           nearestPixel.x(), nearestPixel.y(),
           pixelSpacing, 
           false, // verbose=false for production
           false); // enable_outlier_filtering
+          RecordFitTiming("GaussianDiagonal", gaussDiagStart, x_coords.size(), diagResults.fit_successful);
         
         if (diagResults.fit_successful) {
           // Removed verbose debug output for cleaner simulation logs
         }
         
-        // Pass diagonal fit results to RunAction
-        fRunAction->SetDiagonalGaussianFitResults(
-          diagResults.main_diag_x_center, diagResults.main_diag_x_sigma, diagResults.main_diag_x_amplitude,
-          diagResults.main_diag_x_center_err, diagResults.main_diag_x_sigma_err, diagResults.main_diag_x_amplitude_err,
-          diagResults.main_diag_x_vertical_offset, diagResults.main_diag_x_vertical_offset_err,
-          diagResults.main_diag_x_chi2red, diagResults.main_diag_x_pp, diagResults.main_diag_x_dof, diagResults.main_diag_x_fit_successful,
-          diagResults.main_diag_y_center, diagResults.main_diag_y_sigma, diagResults.main_diag_y_amplitude,
-          diagResults.main_diag_y_center_err, diagResults.main_diag_y_sigma_err, diagResults.main_diag_y_amplitude_err,
-          diagResults.main_diag_y_vertical_offset, diagResults.main_diag_y_vertical_offset_err,
-          diagResults.main_diag_y_chi2red, diagResults.main_diag_y_pp, diagResults.main_diag_y_dof, diagResults.main_diag_y_fit_successful,
-          diagResults.sec_diag_x_center, diagResults.sec_diag_x_sigma, diagResults.sec_diag_x_amplitude,
-          diagResults.sec_diag_x_center_err, diagResults.sec_diag_x_sigma_err, diagResults.sec_diag_x_amplitude_err,
-          diagResults.sec_diag_x_vertical_offset, diagResults.sec_diag_x_vertical_offset_err,
-          diagResults.sec_diag_x_chi2red, diagResults.sec_diag_x_pp, diagResults.sec_diag_x_dof, diagResults.sec_diag_x_fit_successful,
-          diagResults.sec_diag_y_center, diagResults.sec_diag_y_sigma, diagResults.sec_diag_y_amplitude,
-          diagResults.sec_diag_y_center_err, diagResults.sec_diag_y_sigma_err, diagResults.sec_diag_y_amplitude_err,
-          diagResults.sec_diag_y_vertical_offset, diagResults.sec_diag_y_vertical_offset_err,
-          diagResults.sec_diag_y_chi2red, diagResults.sec_diag_y_pp, diagResults.sec_diag_y_dof, diagResults.sec_diag_y_fit_successful,
-          diagResults.fit_successful);
-      } else {
-        // Set default diagonal fit values when 2D fitting failed
-        fRunAction->SetDiagonalGaussianFitResults(
-          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, false,  // Main diagonal X parameters (center, sigma, amplitude, center_err, sigma_err, amplitude_err, vertical_offset, vertical_offset_err, chi2red, pp, dof, fit_successful)
-          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, false,  // Main diagonal Y parameters
-          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, false,  // Secondary diagonal X parameters
-          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, false,  // Secondary diagonal Y parameters
-          false); // fit_successful = false
+        // Store diagonal fit results in the event record
+        FillDiagonalFits(record.gauss, diagResults);
+      }
+      
+      // Joint row/column/diagonal fit: one solve with shared center and widths
+      if (Constants::ENABLE_JOINT_PROFILE_FITTING) {
+        auto gaussJointStart = StartFitWindow();
+        GaussianJointFitResultsCeres jointResults = FitJointGaussianProfilesCeres(
+          x_coords, y_coords, charge_values,
+          nearestPixel.x(), nearestPixel.y(),
+          pixelSpacing,
+          false); // verbose=false for production
+        RecordFitTiming("GaussianJoint", gaussJointStart, x_coords.size(), jointResults.fit_successful);
+        
+        FillJointFit(record.joint, jointResults);
       }
       
       // ===============================================
@@ -306,29 +604,21 @@ void EventAction::EndOfEventAction(const G4Event* event)
       // Perform 2D Lorentzian fitting if we have enough data points and Lorentzian fitting is enabled
       if (x_coords.size() >= 3 && Constants::ENABLE_LORENTZIAN_FITTING && Constants::ENABLE_2D_FITTING) { // Need at least 3 points for 1D Lorentzian fit
         // Perform 2D Lorentzian fitting using the Ceres Solver implementation
+        auto lorentz2DStart = StartFitWindow();
         LorentzianFit2DResultsCeres lorentzFitResults = Fit2DLorentzianCeres(
           x_coords, y_coords, charge_values,
           nearestPixel.x(), nearestPixel.y(),
           pixelSpacing, 
           false, // verbose=false for production
           false); // enable_outlier_filtering
+        RecordFitTiming("Lorentzian2D", lorentz2DStart, x_coords.size(), lorentzFitResults.fit_successful);
         
         if (lorentzFitResults.fit_successful) {
           // Removed verbose debug output for cleaner simulation logs
         }
         
-        // Pass 2D Lorentzian fit results to RunAction
-        fRunAction->Set2DLorentzianFitResults(
-          lorentzFitResults.x_center, lorentzFitResults.x_gamma, lorentzFitResults.x_amplitude,
-          lorentzFitResults.x_center_err, lorentzFitResults.x_gamma_err, lorentzFitResults.x_amplitude_err,
-          lorentzFitResults.x_vertical_offset, lorentzFitResults.x_vertical_offset_err,
-          lorentzFitResults.x_chi2red, lorentzFitResults.x_pp, lorentzFitResults.x_dof,
-          lorentzFitResults.y_center, lorentzFitResults.y_gamma, lorentzFitResults.y_amplitude,
-          lorentzFitResults.y_center_err, lorentzFitResults.y_gamma_err, lorentzFitResults.y_amplitude_err,
-          lorentzFitResults.y_vertical_offset, lorentzFitResults.y_vertical_offset_err,
-          lorentzFitResults.y_chi2red, lorentzFitResults.y_pp, lorentzFitResults.y_dof,
-          lorentzFitResults.x_charge_uncertainty, lorentzFitResults.y_charge_uncertainty,
-          lorentzFitResults.fit_successful);
+        // Store 2D Lorentzian fit results in the event record
+        FillRowColumnFits(record.lorentz, lorentzFitResults);
         
         // Log Lorentzian fitting results to SimulationLogger
         SimulationLogger* logger = SimulationLogger::GetInstance();
@@ -341,65 +631,25 @@ void EventAction::EndOfEventAction(const G4Event* event)
         // Perform diagonal Lorentzian fitting if 2D fitting was performed and successful and diagonal fitting is enabled
         if (lorentzFitResults.fit_successful && Constants::ENABLE_DIAGONAL_FITTING) {
           // Perform diagonal Lorentzian fitting using the Ceres Solver implementation
+          auto lorentzDiagStart = StartFitWindow();
           DiagonalLorentzianFitResultsCeres lorentzDiagResults = FitDiagonalLorentzianCeres(
           x_coords, y_coords, charge_values,
           nearestPixel.x(), nearestPixel.y(),
           pixelSpacing, 
           false, // verbose=false for production
           false); // enable_outlier_filtering
+          RecordFitTiming("LorentzianDiagonal", lorentzDiagStart, x_coords.size(), lorentzDiagResults.fit_successful);
         
         if (lorentzDiagResults.fit_successful) {
           // Removed verbose debug output for cleaner simulation logs
         }
         
-        // Pass diagonal Lorentzian fit results to RunAction
-        fRunAction->SetDiagonalLorentzianFitResults(
-          lorentzDiagResults.main_diag_x_center, lorentzDiagResults.main_diag_x_gamma, lorentzDiagResults.main_diag_x_amplitude,
-          lorentzDiagResults.main_diag_x_center_err, lorentzDiagResults.main_diag_x_gamma_err, lorentzDiagResults.main_diag_x_amplitude_err,
-          lorentzDiagResults.main_diag_x_vertical_offset, lorentzDiagResults.main_diag_x_vertical_offset_err,
-          lorentzDiagResults.main_diag_x_chi2red, lorentzDiagResults.main_diag_x_pp, lorentzDiagResults.main_diag_x_dof, lorentzDiagResults.main_diag_x_fit_successful,
-          lorentzDiagResults.main_diag_y_center, lorentzDiagResults.main_diag_y_gamma, lorentzDiagResults.main_diag_y_amplitude,
-          lorentzDiagResults.main_diag_y_center_err, lorentzDiagResults.main_diag_y_gamma_err, lorentzDiagResults.main_diag_y_amplitude_err,
-          lorentzDiagResults.main_diag_y_vertical_offset, lorentzDiagResults.main_diag_y_vertical_offset_err,
-          lorentzDiagResults.main_diag_y_chi2red, lorentzDiagResults.main_diag_y_pp, lorentzDiagResults.main_diag_y_dof, lorentzDiagResults.main_diag_y_fit_successful,
-          lorentzDiagResults.sec_diag_x_center, lorentzDiagResults.sec_diag_x_gamma, lorentzDiagResults.sec_diag_x_amplitude,
-          lorentzDiagResults.sec_diag_x_center_err, lorentzDiagResults.sec_diag_x_gamma_err, lorentzDiagResults.sec_diag_x_amplitude_err,
-          lorentzDiagResults.sec_diag_x_vertical_offset, lorentzDiagResults.sec_diag_x_vertical_offset_err,
-          lorentzDiagResults.sec_diag_x_chi2red, lorentzDiagResults.sec_diag_x_pp, lorentzDiagResults.sec_diag_x_dof, lorentzDiagResults.sec_diag_x_fit_successful,
-          lorentzDiagResults.sec_diag_y_center, lorentzDiagResults.sec_diag_y_gamma, lorentzDiagResults.sec_diag_y_amplitude,
-          lorentzDiagResults.sec_diag_y_center_err, lorentzDiagResults.sec_diag_y_gamma_err, lorentzDiagResults.sec_diag_y_amplitude_err,
-          lorentzDiagResults.sec_diag_y_vertical_offset, lorentzDiagResults.sec_diag_y_vertical_offset_err,
-          lorentzDiagResults.sec_diag_y_chi2red, lorentzDiagResults.sec_diag_y_pp, lorentzDiagResults.sec_diag_y_dof, lorentzDiagResults.sec_diag_y_fit_successful,
-          lorentzDiagResults.fit_successful);
+        // Store diagonal Lorentzian fit results in the event record
+        FillDiagonalFits(record.lorentz, lorentzDiagResults);
           
         // Note: Diagonal Lorentzian charge error data was removed as per user request
-      } else {
-        // Set default diagonal Lorentzian fit values when 2D fitting failed
-        fRunAction->SetDiagonalLorentzianFitResults(
-          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, false,  // Main diagonal X parameters (center, gamma, amplitude, center_err, gamma_err, amplitude_err, vertical_offset, vertical_offset_err, chi2red, pp, dof, fit_successful)
-          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, false,  // Main diagonal Y parameters
-          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, false,  // Secondary diagonal X parameters
-          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, false,  // Secondary diagonal Y parameters
-          false); // fit_successful = false
       }
         
-    } else {
-      // Not enough data points for Lorentzian fitting or Lorentzian fitting is disabled
-      if (Constants::ENABLE_LORENTZIAN_FITTING) {
-        fRunAction->Set2DLorentzianFitResults(
-          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  // X fit parameters (center, gamma, amplitude, center_err, gamma_err, amplitude_err, vertical_offset, vertical_offset_err, chi2red, pp, dof)
-          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  // Y fit parameters
-          0, 0,  // charge uncertainties (x_charge_uncertainty, y_charge_uncertainty)
-          false); // fit_successful = false
-        
-        // Set default diagonal Lorentzian fit values when not enough data points
-        fRunAction->SetDiagonalLorentzianFitResults(
-          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, false,  // Main diagonal X parameters (center, gamma, amplitude, center_err, gamma_err, amplitude_err, vertical_offset, vertical_offset_err, chi2red, pp, dof, fit_successful)
-          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, false,  // Main diagonal Y parameters
-          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, false,  // Secondary diagonal X parameters
-          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, false,  // Secondary diagonal Y parameters
-          false); // fit_successful = false
-      }
     }
       
       // ===============================================
@@ -409,29 +659,21 @@ void EventAction::EndOfEventAction(const G4Event* event)
       // Perform 2D Power-Law Lorentzian fitting if we have enough data points and Power-Law Lorentzian fitting is enabled
       if (x_coords.size() >= 3 && Constants::ENABLE_POWER_LORENTZIAN_FITTING && Constants::ENABLE_2D_FITTING) { // Need at least 3 points for Power-Law Lorentzian fit
         // Perform 2D Power-Law Lorentzian fitting using the Ceres Solver implementation
+        auto powerLorentz2DStart = StartFitWindow();
         PowerLorentzianFit2DResultsCeres powerLorentzFitResults = Fit2DPowerLorentzianCeres(
           x_coords, y_coords, charge_values,
           nearestPixel.x(), nearestPixel.y(),
           pixelSpacing, 
           false, // verbose=false for production
           false); // enable_outlier_filtering
+        RecordFitTiming("PowerLorentzian2D", powerLorentz2DStart, x_coords.size(), powerLorentzFitResults.fit_successful);
         
         if (powerLorentzFitResults.fit_successful) {
           // Removed verbose debug output for cleaner simulation logs
         }
         
-        // Pass 2D Power-Law Lorentzian fit results to RunAction
-        fRunAction->Set2DPowerLorentzianFitResults(
-          powerLorentzFitResults.x_center, powerLorentzFitResults.x_gamma, powerLorentzFitResults.x_beta, powerLorentzFitResults.x_amplitude,
-          powerLorentzFitResults.x_center_err, powerLorentzFitResults.x_gamma_err, powerLorentzFitResults.x_beta_err, powerLorentzFitResults.x_amplitude_err,
-          powerLorentzFitResults.x_vertical_offset, powerLorentzFitResults.x_vertical_offset_err,
-          powerLorentzFitResults.x_chi2red, powerLorentzFitResults.x_pp, powerLorentzFitResults.x_dof,
-          powerLorentzFitResults.y_center, powerLorentzFitResults.y_gamma, powerLorentzFitResults.y_beta, powerLorentzFitResults.y_amplitude,
-          powerLorentzFitResults.y_center_err, powerLorentzFitResults.y_gamma_err, powerLorentzFitResults.y_beta_err, powerLorentzFitResults.y_amplitude_err,
-          powerLorentzFitResults.y_vertical_offset, powerLorentzFitResults.y_vertical_offset_err,
-          powerLorentzFitResults.y_chi2red, powerLorentzFitResults.y_pp, powerLorentzFitResults.y_dof,
-          powerLorentzFitResults.x_charge_uncertainty, powerLorentzFitResults.y_charge_uncertainty,
-          powerLorentzFitResults.fit_successful);
+        // Store 2D Power-Law Lorentzian fit results in the event record
+        FillRowColumnFits(record.power_lorentz, powerLorentzFitResults);
         
         // Log Power Lorentzian fitting results to SimulationLogger
         SimulationLogger* logger = SimulationLogger::GetInstance();
@@ -442,64 +684,24 @@ void EventAction::EndOfEventAction(const G4Event* event)
         // Perform diagonal Power-Law Lorentzian fitting if 2D fitting was performed and successful and diagonal fitting is enabled
         if (powerLorentzFitResults.fit_successful && Constants::ENABLE_DIAGONAL_FITTING) {
           // Perform diagonal Power-Law Lorentzian fitting using the Ceres Solver implementation
+          auto powerLorentzDiagStart = StartFitWindow();
           DiagonalPowerLorentzianFitResultsCeres powerLorentzDiagResults = FitDiagonalPowerLorentzianCeres(
           x_coords, y_coords, charge_values,
           nearestPixel.x(), nearestPixel.y(),
           pixelSpacing, 
           false, // verbose=false for production
           false); // enable_outlier_filtering
+          RecordFitTiming("PowerLorentzianDiagonal", powerLorentzDiagStart, x_coords.size(), powerLorentzDiagResults.fit_successful);
         
         if (powerLorentzDiagResults.fit_successful) {
           // Removed verbose debug output for cleaner simulation logs
         }
         
-        // Pass diagonal Power-Law Lorentzian fit results to RunAction
-        fRunAction->SetDiagonalPowerLorentzianFitResults(
-          powerLorentzDiagResults.main_diag_x_center, powerLorentzDiagResults.main_diag_x_gamma, powerLorentzDiagResults.main_diag_x_beta, powerLorentzDiagResults.main_diag_x_amplitude,
-          powerLorentzDiagResults.main_diag_x_center_err, powerLorentzDiagResults.main_diag_x_gamma_err, powerLorentzDiagResults.main_diag_x_beta_err, powerLorentzDiagResults.main_diag_x_amplitude_err,
-          powerLorentzDiagResults.main_diag_x_vertical_offset, powerLorentzDiagResults.main_diag_x_vertical_offset_err,
-          powerLorentzDiagResults.main_diag_x_chi2red, powerLorentzDiagResults.main_diag_x_pp, powerLorentzDiagResults.main_diag_x_dof, powerLorentzDiagResults.main_diag_x_fit_successful,
-          powerLorentzDiagResults.main_diag_y_center, powerLorentzDiagResults.main_diag_y_gamma, powerLorentzDiagResults.main_diag_y_beta, powerLorentzDiagResults.main_diag_y_amplitude,
-          powerLorentzDiagResults.main_diag_y_center_err, powerLorentzDiagResults.main_diag_y_gamma_err, powerLorentzDiagResults.main_diag_y_beta_err, powerLorentzDiagResults.main_diag_y_amplitude_err,
-          powerLorentzDiagResults.main_diag_y_vertical_offset, powerLorentzDiagResults.main_diag_y_vertical_offset_err,
-          powerLorentzDiagResults.main_diag_y_chi2red, powerLorentzDiagResults.main_diag_y_pp, powerLorentzDiagResults.main_diag_y_dof, powerLorentzDiagResults.main_diag_y_fit_successful,
-          powerLorentzDiagResults.sec_diag_x_center, powerLorentzDiagResults.sec_diag_x_gamma, powerLorentzDiagResults.sec_diag_x_beta, powerLorentzDiagResults.sec_diag_x_amplitude,
-          powerLorentzDiagResults.sec_diag_x_center_err, powerLorentzDiagResults.sec_diag_x_gamma_err, powerLorentzDiagResults.sec_diag_x_beta_err, powerLorentzDiagResults.sec_diag_x_amplitude_err,
-          powerLorentzDiagResults.sec_diag_x_vertical_offset, powerLorentzDiagResults.sec_diag_x_vertical_offset_err,
-          powerLorentzDiagResults.sec_diag_x_chi2red, powerLorentzDiagResults.sec_diag_x_pp, powerLorentzDiagResults.sec_diag_x_dof, powerLorentzDiagResults.sec_diag_x_fit_successful,
-          powerLorentzDiagResults.sec_diag_y_center, powerLorentzDiagResults.sec_diag_y_gamma, powerLorentzDiagResults.sec_diag_y_beta, powerLorentzDiagResults.sec_diag_y_amplitude,
-          powerLorentzDiagResults.sec_diag_y_center_err, powerLorentzDiagResults.sec_diag_y_gamma_err, powerLorentzDiagResults.sec_diag_y_beta_err, powerLorentzDiagResults.sec_diag_y_amplitude_err,
-          powerLorentzDiagResults.sec_diag_y_vertical_offset, powerLorentzDiagResults.sec_diag_y_vertical_offset_err,
-          powerLorentzDiagResults.sec_diag_y_chi2red, powerLorentzDiagResults.sec_diag_y_pp, powerLorentzDiagResults.sec_diag_y_dof, powerLorentzDiagResults.sec_diag_y_fit_successful,
-          powerLorentzDiagResults.fit_successful);
+        // Store diagonal Power-Law Lorentzian fit results in the event record
+        FillDiagonalFits(record.power_lorentz, powerLorentzDiagResults);
 
-      } else {
-        // Set default diagonal Power-Law Lorentzian fit values when 2D fitting failed
-        fRunAction->SetDiagonalPowerLorentzianFitResults(
-          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, false,  // Main diagonal X parameters (center, gamma, beta, amplitude, center_err, gamma_err, beta_err, amplitude_err, vertical_offset, vertical_offset_err, chi2red, pp, dof, fit_successful)
-          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, false,  // Main diagonal Y parameters
-          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, false,  // Secondary diagonal X parameters
-          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, false,  // Secondary diagonal Y parameters
-          false); // fit_successful = false
       }
         
-    } else {
-      // Not enough data points for Power-Law Lorentzian fitting or Power-Law Lorentzian fitting is disabled
-      if (Constants::ENABLE_POWER_LORENTZIAN_FITTING) {
-        fRunAction->Set2DPowerLorentzianFitResults(
-          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  // X fit parameters (center, gamma, beta, amplitude, center_err, gamma_err, beta_err, amplitude_err, vertical_offset, vertical_offset_err, chi2red, pp, dof)
-          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  // Y fit parameters
-          0, 0,  // charge uncertainties (x_charge_uncertainty, y_charge_uncertainty)
-          false); // fit_successful = false
-        
-        // Set default diagonal Power-Law Lorentzian fit values when not enough data points
-        fRunAction->SetDiagonalPowerLorentzianFitResults(
-          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, false,  // Main diagonal X parameters (center, gamma, beta, amplitude, center_err, gamma_err, beta_err, amplitude_err, vertical_offset, vertical_offset_err, chi2red, pp, dof, fit_successful)
-          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, false,  // Main diagonal Y parameters
-          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, false,  // Secondary diagonal X parameters
-          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, false,  // Secondary diagonal Y parameters
-          false); // fit_successful = false
-      }
     }
       
       // ===============================================
@@ -509,28 +711,23 @@ void EventAction::EndOfEventAction(const G4Event* event)
       // Perform 3D Lorentzian fitting if we have enough data points and 3D Lorentzian fitting is enabled
       if (x_coords.size() >= 6 && Constants::ENABLE_3D_LORENTZIAN_FITTING) { // Need at least 6 points for 3D Lorentzian fit
         // Perform 3D Lorentzian fitting using the Ceres Solver implementation
+        auto lorentz3DStart = StartFitWindow();
         LorentzianFit3DResultsCeres lorentz3DFitResults = Fit3DLorentzianCeres(
           x_coords, y_coords, charge_values,
           nearestPixel.x(), nearestPixel.y(),
           pixelSpacing, 
           false, // verbose=false for production
           false); // enable_outlier_filtering
+        RecordFitTiming("Lorentzian3D", lorentz3DStart, x_coords.size(), lorentz3DFitResults.fit_successful,
+                        std::max(0.0, lorentz3DFitResults.reference_time_ms));
+        RecordCoarseToFineStage("Lorentzian3D", lorentz3DFitResults);
         
         if (lorentz3DFitResults.fit_successful) {
           // Removed verbose debug output for cleaner simulation logs
         }
         
-        // Pass 3D Lorentzian fit results to RunAction
-        fRunAction->Set3DLorentzianFitResults(
-          lorentz3DFitResults.center_x, lorentz3DFitResults.center_y, 
-          lorentz3DFitResults.gamma_x, lorentz3DFitResults.gamma_y, 
-          lorentz3DFitResults.amplitude, lorentz3DFitResults.vertical_offset,
-          lorentz3DFitResults.center_x_err, lorentz3DFitResults.center_y_err,
-          lorentz3DFitResults.gamma_x_err, lorentz3DFitResults.gamma_y_err,
-          lorentz3DFitResults.amplitude_err, lorentz3DFitResults.vertical_offset_err,
-          lorentz3DFitResults.chi2red, lorentz3DFitResults.pp, lorentz3DFitResults.dof,
-          lorentz3DFitResults.charge_uncertainty,
-          lorentz3DFitResults.fit_successful);
+        // Store 3D Lorentzian fit results in the event record
+        FillSurfaceFit(record.lorentz_3d, lorentz3DFitResults);
         
         // Log 3D Lorentzian fitting results to SimulationLogger
         SimulationLogger* logger = SimulationLogger::GetInstance();
@@ -538,16 +735,6 @@ void EventAction::EndOfEventAction(const G4Event* event)
           logger->Log3DLorentzianFitResults(event->GetEventID(), lorentz3DFitResults);
         }
         
-    } else {
-      // Not enough data points for 3D Lorentzian fitting or 3D Lorentzian fitting is disabled
-      if (Constants::ENABLE_3D_LORENTZIAN_FITTING) {
-        fRunAction->Set3DLorentzianFitResults(
-          0, 0, 0, 0, 0, 0,  // center_x, center_y, gamma_x, gamma_y, amplitude, vertical_offset
-          0, 0, 0, 0, 0, 0,  // center_x_err, center_y_err, gamma_x_err, gamma_y_err, amplitude_err, vertical_offset_err
-          0, 0, 0,           // chi2red, pp, dof
-          0,                 // charge_uncertainty
-          false);            // fit_successful = false
-      }
     }
       
       // ===============================================
@@ -557,28 +744,23 @@ void EventAction::EndOfEventAction(const G4Event* event)
       // Perform 3D Gaussian fitting if we have enough data points and 3D Gaussian fitting is enabled
       if (x_coords.size() >= 6 && Constants::ENABLE_3D_GAUSSIAN_FITTING) { // Need at least 6 points for 3D Gaussian fit
         // Perform 3D Gaussian fitting using the Ceres Solver implementation
+        auto gauss3DStart = StartFitWindow();
         GaussianFit3DResultsCeres gauss3DFitResults = Fit3DGaussianCeres(
           x_coords, y_coords, charge_values,
           nearestPixel.x(), nearestPixel.y(),
           pixelSpacing, 
           false, // verbose=false for production
           false); // enable_outlier_filtering
+        RecordFitTiming("Gaussian3D", gauss3DStart, x_coords.size(), gauss3DFitResults.fit_successful,
+                        std::max(0.0, gauss3DFitResults.reference_time_ms));
+        RecordCoarseToFineStage("Gaussian3D", gauss3DFitResults);
         
         if (gauss3DFitResults.fit_successful) {
           // Removed verbose debug output for cleaner simulation logs
         }
         
-        // Pass 3D Gaussian fit results to RunAction
-        fRunAction->Set3DGaussianFitResults(
-          gauss3DFitResults.center_x, gauss3DFitResults.center_y, 
-          gauss3DFitResults.sigma_x, gauss3DFitResults.sigma_y, 
-          gauss3DFitResults.amplitude, gauss3DFitResults.vertical_offset,
-          gauss3DFitResults.center_x_err, gauss3DFitResults.center_y_err,
-          gauss3DFitResults.sigma_x_err, gauss3DFitResults.sigma_y_err,
-          gauss3DFitResults.amplitude_err, gauss3DFitResults.vertical_offset_err,
-          gauss3DFitResults.chi2red, gauss3DFitResults.pp, gauss3DFitResults.dof,
-          gauss3DFitResults.charge_uncertainty,
-          gauss3DFitResults.fit_successful);
+        // Store 3D Gaussian fit results in the event record
+        FillSurfaceFit(record.gauss_3d, gauss3DFitResults);
         
         // Log 3D Gaussian fitting results to SimulationLogger
         SimulationLogger* logger = SimulationLogger::GetInstance();
@@ -586,16 +768,6 @@ void EventAction::EndOfEventAction(const G4Event* event)
           logger->Log3DGaussianFitResults(event->GetEventID(), gauss3DFitResults);
         }
         
-    } else {
-      // Not enough data points for 3D Gaussian fitting or 3D Gaussian fitting is disabled
-      if (Constants::ENABLE_3D_GAUSSIAN_FITTING) {
-        fRunAction->Set3DGaussianFitResults(
-          0, 0, 0, 0, 0, 0,  // center_x, center_y, sigma_x, sigma_y, amplitude, vertical_offset
-          0, 0, 0, 0, 0, 0,  // center_x_err, center_y_err, sigma_x_err, sigma_y_err, amplitude_err, vertical_offset_err
-          0, 0, 0,           // chi2red, pp, dof
-          0,                 // charge_uncertainty
-          false);            // fit_successful = false
-      }
     }
       
       // ===============================================
@@ -605,30 +777,23 @@ void EventAction::EndOfEventAction(const G4Event* event)
       // Perform 3D Power-Law Lorentzian fitting if we have enough data points and 3D Power-Law Lorentzian fitting is enabled
       if (x_coords.size() >= 7 && Constants::ENABLE_3D_POWER_LORENTZIAN_FITTING) { // Need at least 7 points for 3D Power-Law Lorentzian fit
         // Perform 3D Power-Law Lorentzian fitting using the Ceres Solver implementation
+        auto powerLorentz3DStart = StartFitWindow();
         PowerLorentzianFit3DResultsCeres powerLorentz3DFitResults = Fit3DPowerLorentzianCeres(
           x_coords, y_coords, charge_values,
           nearestPixel.x(), nearestPixel.y(),
           pixelSpacing, 
           false, // verbose=false for production
           false); // enable_outlier_filtering
+        RecordFitTiming("PowerLorentzian3D", powerLorentz3DStart, x_coords.size(), powerLorentz3DFitResults.fit_successful,
+                        std::max(0.0, powerLorentz3DFitResults.reference_time_ms));
+        RecordCoarseToFineStage("PowerLorentzian3D", powerLorentz3DFitResults);
         
         if (powerLorentz3DFitResults.fit_successful) {
           // Removed verbose debug output for cleaner simulation logs
         }
         
-        // Pass 3D Power-Law Lorentzian fit results to RunAction
-        fRunAction->Set3DPowerLorentzianFitResults(
-          powerLorentz3DFitResults.center_x, powerLorentz3DFitResults.center_y,
-          powerLorentz3DFitResults.gamma_x, powerLorentz3DFitResults.gamma_y,
-          powerLorentz3DFitResults.beta, powerLorentz3DFitResults.amplitude, 
-          powerLorentz3DFitResults.vertical_offset,
-          powerLorentz3DFitResults.center_x_err, powerLorentz3DFitResults.center_y_err,
-          powerLorentz3DFitResults.gamma_x_err, powerLorentz3DFitResults.gamma_y_err,
-          powerLorentz3DFitResults.beta_err, powerLorentz3DFitResults.amplitude_err, 
-          powerLorentz3DFitResults.vertical_offset_err,
-          powerLorentz3DFitResults.chi2red, powerLorentz3DFitResults.pp, powerLorentz3DFitResults.dof,
-          powerLorentz3DFitResults.charge_uncertainty,
-          powerLorentz3DFitResults.fit_successful);
+        // Store 3D Power-Law Lorentzian fit results in the event record
+        FillSurfaceFit(record.power_lorentz_3d, powerLorentz3DFitResults);
         
         // Log 3D Power Lorentzian fitting results to SimulationLogger
         SimulationLogger* logger = SimulationLogger::GetInstance();
@@ -636,152 +801,74 @@ void EventAction::EndOfEventAction(const G4Event* event)
           logger->Log3DPowerLorentzianFitResults(event->GetEventID(), powerLorentz3DFitResults);
         }
         
-    } else {
-      // Not enough data points for 3D Power-Law Lorentzian fitting or 3D Power-Law Lorentzian fitting is disabled
-      if (Constants::ENABLE_3D_POWER_LORENTZIAN_FITTING) {
-        fRunAction->Set3DPowerLorentzianFitResults(
-          0, 0, 0, 0, 0, 0, 0,  // center_x, center_y, gamma_x, gamma_y, beta, amplitude, vertical_offset
-          0, 0, 0, 0, 0, 0, 0,  // center_x_err, center_y_err, gamma_x_err, gamma_y_err, beta_err, amplitude_err, vertical_offset_err
-          0, 0, 0,              // chi2red, pp, dof
-          0,                    // charge_uncertainty
-          false);               // fit_successful = false
-      }
     }
-
+      
+      // ===============================================
+      // SYMMETRIC 3D FITTING (isotropic and radial variants, conditionally enabled)
+      // ===============================================
+      
+      // Fewer parameters than the anisotropic fits; resolution of both is compared in the run summary
+      for (G4int model = 0; model < kNumSymmetric3DModels; ++model) {
+        Symmetric3DModel symmetricModel = static_cast<Symmetric3DModel>(model);
+        if (!IsSymmetric3DModelEnabled(symmetricModel)) continue;
         
-    } else {
-      // Not enough data points for fitting or Gaussian fitting is disabled
-      if (Constants::ENABLE_GAUSSIAN_FITTING) {
-        fRunAction->Set2DGaussianFitResults(
-          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  // X fit parameters (center, sigma, amplitude, center_err, sigma_err, amplitude_err, vertical_offset, vertical_offset_err, chi2red, pp, dof)
-          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  // Y fit parameters
-          0, 0,  // charge uncertainties (x_charge_uncertainty, y_charge_uncertainty)
-          false); // fit_successful = false
+        const std::string label = GetSymmetric3DModelLabel(symmetricModel);
+        auto symmetric3DStart = StartFitWindow();
+        SymmetricFit3DResultsCeres symmetricResults = Fit3DSymmetricCeres(
+          symmetricModel, x_coords, y_coords, charge_values,
+          nearestPixel.x(), nearestPixel.y(),
+          pixelSpacing, fDetector->GetPixelSize(), fD0 * micrometer,
+          false); // verbose=false for production
+        RecordFitTiming(label, symmetric3DStart, x_coords.size(), symmetricResults.fit_successful);
         
-        // Set default diagonal fit values when not enough data points
-        fRunAction->SetDiagonalGaussianFitResults(
-          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, false,  // Main diagonal X parameters (center, sigma, amplitude, center_err, sigma_err, amplitude_err, vertical_offset, vertical_offset_err, chi2red, pp, dof, fit_successful)
-          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, false,  // Main diagonal Y parameters
-          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, false,  // Secondary diagonal X parameters
-          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, false,  // Secondary diagonal Y parameters
-          false); // fit_successful = false
+        FillSymmetricFit(record.symmetric[model], symmetricResults);
       }
-      
-      // Not enough data points for Lorentzian fitting or Lorentzian fitting is disabled
-      if (Constants::ENABLE_LORENTZIAN_FITTING) {
-        fRunAction->Set2DLorentzianFitResults(
-          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  // X fit parameters (center, gamma, amplitude, center_err, gamma_err, amplitude_err, vertical_offset, vertical_offset_err, chi2red, pp, dof)
-          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  // Y fit parameters
-          0, 0,  // charge uncertainties (x_charge_uncertainty, y_charge_uncertainty)
-          false); // fit_successful = false
+
         
-        // Set default diagonal Lorentzian fit values when not enough data points
-        fRunAction->SetDiagonalLorentzianFitResults(
-          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, false,  // Main diagonal X parameters (center, gamma, amplitude, center_err, gamma_err, amplitude_err, vertical_offset, vertical_offset_err, chi2red, pp, dof, fit_successful)
-          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, false,  // Main diagonal Y parameters
-          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, false,  // Secondary diagonal X parameters
-          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, false,  // Secondary diagonal Y parameters
-          false); // fit_successful = false
-      }
-    }
-  } else {
-    // Skip fitting due to conditions not met
-    if (isPixelHit) {
-      // Removed verbose debug output for cleaner simulation logs
-    } else if (fNonPixel_GridNeighborhoodChargeFractions.empty()) {
-      // Removed verbose debug output for cleaner simulation logs
     }
-    
-    // Set default values (no fitting performed or fitting is disabled)
-    if (Constants::ENABLE_GAUSSIAN_FITTING) {
-      fRunAction->Set2DGaussianFitResults(
-        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  // X fit parameters (center, sigma, amplitude, center_err, sigma_err, amplitude_err, vertical_offset, vertical_offset_err, chi2red, pp, dof)
-        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  // Y fit parameters
-        0, 0,  // charge uncertainties (x_charge_uncertainty, y_charge_uncertainty)
-        false); // fit_successful = false
-      
-      // Set default diagonal fit values when fitting is skipped
-      fRunAction->SetDiagonalGaussianFitResults(
-        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, false,  // Main diagonal X parameters (center, sigma, amplitude, center_err, sigma_err, amplitude_err, vertical_offset, vertical_offset_err, chi2red, pp, dof, fit_successful)
-        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, false,  // Main diagonal Y parameters
-        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, false,  // Secondary diagonal X parameters
-        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, false,  // Secondary diagonal Y parameters
-        false); // fit_successful = false
-    }
-    
-    // Set default Lorentzian values (no fitting performed or Lorentzian fitting is disabled)
-    if (Constants::ENABLE_LORENTZIAN_FITTING) {
-      fRunAction->Set2DLorentzianFitResults(
-        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  // X fit parameters (center, gamma, amplitude, center_err, gamma_err, amplitude_err, vertical_offset, vertical_offset_err, chi2red, pp, dof)
-        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  // Y fit parameters
-        0, 0,  // charge uncertainties (x_charge_uncertainty, y_charge_uncertainty)
-        false); // fit_successful = false
-      
-      // Set default diagonal Lorentzian fit values when fitting is skipped
-      fRunAction->SetDiagonalLorentzianFitResults(
-        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, false,  // Main diagonal X parameters (center, gamma, amplitude, center_err, gamma_err, amplitude_err, vertical_offset, vertical_offset_err, chi2red, pp, dof, fit_successful)
-        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, false,  // Main diagonal Y parameters
-        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, false,  // Secondary diagonal X parameters
-        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, false,  // Secondary diagonal Y parameters
-        false); // fit_successful = false
-    }
-    
-    // Set default Power-Law Lorentzian values (no fitting performed or Power-Law Lorentzian fitting is disabled)
-    if (Constants::ENABLE_POWER_LORENTZIAN_FITTING) {
-      fRunAction->Set2DPowerLorentzianFitResults(
-        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  // X fit parameters (center, gamma, beta, amplitude, center_err, gamma_err, beta_err, amplitude_err, vertical_offset, vertical_offset_err, chi2red, pp, dof)
-        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  // Y fit parameters
-        0, 0,  // charge uncertainties (x_charge_uncertainty, y_charge_uncertainty)
-        false); // fit_successful = false
-      
-      // Set default diagonal Power-Law Lorentzian fit values when fitting is skipped
-      fRunAction->SetDiagonalPowerLorentzianFitResults(
-        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, false,  // Main diagonal X parameters (center, gamma, beta, amplitude, center_err, gamma_err, beta_err, amplitude_err, vertical_offset, vertical_offset_err, chi2red, pp, dof, fit_successful)
-        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, false,  // Main diagonal Y parameters
-        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, false,  // Secondary diagonal X parameters
-        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, false,  // Secondary diagonal Y parameters
-        false); // fit_successful = false
-    }
-    
-    // Set default 3D Lorentzian values (no fitting performed or 3D Lorentzian fitting is disabled)
-    if (Constants::ENABLE_3D_LORENTZIAN_FITTING) {
-      fRunAction->Set3DLorentzianFitResults(
-        0, 0, 0, 0, 0, 0,  // center_x, center_y, gamma_x, gamma_y, amplitude, vertical_offset
-        0, 0, 0, 0, 0, 0,  // center_x_err, center_y_err, gamma_x_err, gamma_y_err, amplitude_err, vertical_offset_err
-        0, 0, 0,           // chi2red, pp, dof
-        0,                 // charge_uncertainty
-        false);            // fit_successful = false
-    }
-    
-    // Set default 3D Gaussian values (no fitting performed or 3D Gaussian fitting is disabled)
-    if (Constants::ENABLE_3D_GAUSSIAN_FITTING) {
-      fRunAction->Set3DGaussianFitResults(
-        0, 0, 0, 0, 0, 0,  // center_x, center_y, sigma_x, sigma_y, amplitude, vertical_offset
-        0, 0, 0, 0, 0, 0,  // center_x_err, center_y_err, sigma_x_err, sigma_y_err, amplitude_err, vertical_offset_err
-        0, 0, 0,           // chi2red, pp, dof
-        0,                 // charge_uncertainty
-        false);            // fit_successful = false
+  }
+  
+  // Flush this thread's solver counters for the event
+  FitSolveStatistics solveStats = TakeFitSolveStatistics();
+  if (solveStats.fits > 0) {
+    SimulationLogger* statsLogger = SimulationLogger::GetInstance();
+    if (statsLogger) {
+      statsLogger->RecordSolverStatistics(solveStats.fits, solveStats.solves, solveStats.iterations,
+                                          solveStats.fallbacks);
     }
-    
-    // Set default 3D Power-Law Lorentzian values (no fitting performed or 3D Power-Law Lorentzian fitting is disabled)
-    if (Constants::ENABLE_3D_POWER_LORENTZIAN_FITTING) {
-      fRunAction->Set3DPowerLorentzianFitResults(
-        0, 0, 0, 0, 0, 0, 0,  // center_x, center_y, gamma_x, gamma_y, beta, amplitude, vertical_offset
-        0, 0, 0, 0, 0, 0, 0,  // center_x_err, center_y_err, gamma_x_err, gamma_y_err, beta_err, amplitude_err, vertical_offset_err
-        0, 0, 0,              // chi2red, pp, dof
-        0,                    // charge_uncertainty
-        false);               // fit_successful = false
+  }
+  FitSolveStatistics referenceStats = TakeRawFrameReferenceStatistics();
+  if (referenceStats.fits > 0) {
+    SimulationLogger* statsLogger = SimulationLogger::GetInstance();
+    if (statsLogger) {
+      statsLogger->RecordRawFrameReferenceStatistics(referenceStats.fits, referenceStats.solves,
+                                                     referenceStats.iterations, referenceStats.fallbacks);
     }
-
   }
   
+  // Pass neighborhood grid data to RunAction only for sampled entries (always empty for pixel hits)
+  G4int eventID = event->GetEventID();
+  record.index.event_id = eventID;
+  hit.has_grid_data = !fNonPixel_GridNeighborhoodChargeFractions.empty() && SampleGridData(eventID, record);
+  if (hit.has_grid_data) {
+    fRunAction->SetNeighborhoodGridData(fNonPixel_GridNeighborhoodAngles);
+    fRunAction->SetNeighborhoodChargeData(fNonPixel_GridNeighborhoodChargeFractions, fNonPixel_GridNeighborhoodDistances, fNonPixel_GridNeighborhoodCharge, fNonPixel_GridNeighborhoodCharge);
+  } else {
+    fRunAction->ClearNeighborhoodData();
+  }
+  
+  // Write the record (derived quantities are computed once inside FillTree)
   fRunAction->FillTree();
   
   // Log event end
-  G4int eventID = event->GetEventID();
   SimulationLogger* logger = SimulationLogger::GetInstance();
   if (logger) {
     logger->LogEventEnd(eventID);
+    
+    // Heap calls and arena use of this thread since BeginOfEventAction
+    EventAllocationStatistics allocationStats = TakeEventAllocationStatistics();
+    logger->RecordEventAllocations(allocationStats.heap_allocations, allocationStats.arena_bytes,
+                                   allocationStats.arena_overflows);
   }
   
   // Update crash recovery progress tracking - only every 100 events to reduce mutex contention
@@ -1114,11 +1201,11 @@ void EventAction::CalculateNeighborhoodChargeSharing()
   
   // Proceed with charge sharing calculation for non-pixel hits
   // First pass: collect valid pixels and calculate weights
-  std::vector<G4double> weights;
-  std::vector<G4double> distances;
-  std::vector<G4double> angles;
-  std::vector<G4int> validPixelI;
-  std::vector<G4int> validPixelJ;
+  ArenaDoubleVector weights(GetEventArena());
+  ArenaDoubleVector distances(GetEventArena());
+  ArenaDoubleVector angles(GetEventArena());
+  std::pmr::vector<G4int> validPixelI(GetEventArena());
+  std::pmr::vector<G4int> validPixelJ(GetEventArena());
   
   // Define the neighborhood grid: fNeighborhoodRadius pixels in each direction from the center
   for (G4int di = -fNeighborhoodRadius; di <= fNeighborhoodRadius; di++) {
@@ -1127,13 +1214,9 @@ void EventAction::CalculateNeighborhoodChargeSharing()
       G4int gridPixelI = fPixelIndexI + di;
       G4int gridPixelJ = fPixelIndexJ + dj;
       
-      // Check if this pixel is within the detector bounds
+      // Check if this pixel is within the detector bounds (invalid markers are stored in the second pass)
       if (gridPixelI < 0 || gridPixelI >= numBlocksPerSide || 
           gridPixelJ < 0 || gridPixelJ >= numBlocksPerSide) {
-        // Store invalid data for out-of-bounds pixels
-        fNonPixel_GridNeighborhoodChargeFractions.push_back(-999.0); // Invalid marker
-        fNonPixel_GridNeighborhoodDistances.push_back(-999.0);
-        fNonPixel_GridNeighborhoodCharge.push_back(0.0);
         continue;
       }
       
@@ -1158,24 +1241,7 @@ void EventAction::CalculateNeighborhoodChargeSharing()
       validPixelJ.push_back(gridPixelJ);
       
       // Calculate weight according to formula: α_i * ln(d_i/d_0)^(-1)
-      // Handle the case where distance might be very small or zero
-      G4double weight = 0.0;
-      if (distance > d0_mm) {
-        // Clamp the logarithm to avoid infinite weights when d ≈ d0
-        G4double logArg = distance / d0_mm;
-        G4double logValue = std::log(logArg);
-        // Clamp log value to avoid division by very small numbers
-        logValue = std::max(logValue, Constants::MIN_LOG_VALUE);
-        weight = alpha * (1.0 / logValue);
-      } else if (distance > 0) {
-        // For very small distances, use a large weight
-        weight = alpha * Constants::ALPHA_WEIGHT_MULTIPLIER; // Large weight for very close pixels
-      } else {
-        // Distance is zero (hit exactly on pixel center), give maximum weight
-        weight = alpha * Constants::ALPHA_WEIGHT_MULTIPLIER;
-      }
-      
-      weights.push_back(weight);
+      weights.push_back(CalculateChargeSharingWeight(distance, alpha, d0_mm));
     }
   }
   
@@ -1196,7 +1262,10 @@ void EventAction::CalculateNeighborhoodChargeSharing()
       // Check if this pixel is within bounds
       if (gridPixelI < 0 || gridPixelI >= numBlocksPerSide || 
           gridPixelJ < 0 || gridPixelJ >= numBlocksPerSide) {
-        // Already stored invalid data in first pass
+        // Store invalid data in grid order so all grid vectors share the same indexing
+        fNonPixel_GridNeighborhoodChargeFractions.push_back(-999.0); // Invalid marker
+        fNonPixel_GridNeighborhoodDistances.push_back(-999.0);
+        fNonPixel_GridNeighborhoodCharge.push_back(0.0);
         continue;
       }
       
@@ -1218,19 +1287,193 @@ void EventAction::CalculateNeighborhoodChargeSharing()
   }
 }
 
+// Charge sharing weight for a single pixel: α_i * ln(d_i/d_0)^(-1)
+G4double EventAction::CalculateChargeSharingWeight(G4double distance, G4double alpha, G4double d0) const
+{
+  return ChargeSharingWeightTable::EvaluateWeight(distance, alpha, d0);
+}
+
+// Fused neighborhood kernel core (NeighborhoodKernel) with this detector's geometry
+void EventAction::ComputeNeighborhoodKernel(G4double hitX, G4double hitY, G4int hitPixelI, G4int hitPixelJ,
+                                            G4int radius, G4double* distances, G4double* alphas, G4double* weights)
+{
+  NeighborhoodKernelGeometry geometry;
+  geometry.pixelSize = fDetector->GetPixelSize();
+  geometry.pixelSpacing = fDetector->GetPixelSpacing();
+  geometry.pixelCornerOffset = fDetector->GetPixelCornerOffset();
+  geometry.detSize = fDetector->GetDetSize();
+  geometry.numBlocksPerSide = fDetector->GetNumBlocksPerSide();
+  geometry.d0 = fD0 * micrometer;
+  geometry.tableRadius = fAutoRadiusEnabled ? fMaxAutoRadius : fNeighborhoodRadius;
+  
+  fKernel.Compute(geometry, hitX, hitY, hitPixelI, hitPixelJ, radius, distances, alphas, weights);
+}
+
+// Calculate unnormalized charge sharing weights for a neighborhood grid around the hit pixel
+// Layout matches the stored grids (column-major: di outer, dj inner); out-of-bounds pixels get -1
+void EventAction::CalculateNeighborhoodWeights(const G4ThreeVector& hitPosition, G4int hitPixelI, G4int hitPixelJ,
+                                               G4int radius, std::vector<G4double>& weights)
+{
+  const size_t numPixels = static_cast<size_t>(2 * radius + 1) * (2 * radius + 1);
+  weights.resize(numPixels);
+  fKernelDistances.resize(numPixels);
+  fKernelAlphas.resize(numPixels);
+  
+  ComputeNeighborhoodKernel(hitPosition.x(), hitPosition.y(), hitPixelI, hitPixelJ, radius,
+                            fKernelDistances.data(), fKernelAlphas.data(), weights.data());
+}
+
+// Fused calculation of angles, distances, charge fractions and charges for the neighborhood grid
+// Writes straight into the (reused) member vectors: one kernel pass, then one normalization pass.
+// Degenerate cases (no energy, hit on a pixel) keep the reference implementations.
+void EventAction::CalculateNeighborhoodGrid(const G4ThreeVector& hitPosition, G4int hitPixelI, G4int hitPixelJ)
+{
+  if (fEdep <= 0 || fDetector->IsPositionOnPixel(hitPosition)) {
+    CalculateNeighborhoodGridAngles(hitPosition, hitPixelI, hitPixelJ);
+    CalculateNeighborhoodChargeSharing();
+    return;
+  }
+  
+  const G4int radius = fNeighborhoodRadius;
+  const size_t numPixels = static_cast<size_t>(2 * radius + 1) * (2 * radius + 1);
+  
+  // resize() keeps capacity, so after the first event no allocation happens here
+  fNonPixel_GridNeighborhoodAngles.resize(numPixels);
+  fNonPixel_GridNeighborhoodDistances.resize(numPixels);
+  fNonPixel_GridNeighborhoodChargeFractions.resize(numPixels);
+  fNonPixel_GridNeighborhoodCharge.resize(numPixels);
+  
+  G4double* angles = fNonPixel_GridNeighborhoodAngles.data();
+  G4double* distances = fNonPixel_GridNeighborhoodDistances.data();
+  G4double* fractions = fNonPixel_GridNeighborhoodChargeFractions.data();
+  G4double* charges = fNonPixel_GridNeighborhoodCharge.data();
+  
+  // Pass 1: distance, α and raw weight (stored in the fraction array)
+  ComputeNeighborhoodKernel(hitPosition.x(), hitPosition.y(), hitPixelI, hitPixelJ, radius,
+                            distances, angles, fractions);
+  
+  G4double totalWeight = 0.0;
+  for (size_t i = 0; i < numPixels; i++) {
+    totalWeight += std::max(fractions[i], 0.0);
+  }
+  
+  // Total charge: electrons from Edep, times AC-LGAD amplification, in Coulombs
+  const G4double edepInEV = fEdep * MeV / eV;
+  const G4double totalCharge = edepInEV / fIonizationEnergy * fAmplificationFactor;
+  const G4double invTotalWeight = (totalWeight > 0) ? 1.0 / totalWeight : 0.0;
+  const G4double chargeScale = totalCharge * fElementaryCharge;
+  const G4double radToDeg = 180.0 / CLHEP::pi;
+  
+  // Pass 2: normalize and apply invalid markers for out-of-bounds pixels
+  for (size_t i = 0; i < numPixels; i++) {
+    const G4bool valid = fractions[i] >= 0.0;
+    const G4double chargeFraction = fractions[i] * invTotalWeight;
+    fractions[i] = valid ? chargeFraction : -999.0;
+    charges[i] = valid ? chargeFraction * chargeScale : 0.0;
+    distances[i] = valid ? distances[i] : -999.0;
+    angles[i] = valid ? angles[i] * radToDeg : -999.0;
+  }
+}
+
+// Select the pads passed to the fits (adaptive region of interest)
+// Keeps pads with charge >= ROI_RELATIVE_CHARGE_THRESHOLD * max charge, or the ROI_TOP_K_PADS
+// highest-charge pads (ties at the cut are kept). If fewer than ROI_MIN_PADS would survive, all
+// pads are kept. Order is preserved so row/column/diagonal grouping in the fitters is unchanged.
+G4int EventAction::SelectRegionOfInterest(std::vector<double>& x_coords, std::vector<double>& y_coords,
+                                          std::vector<double>& charge_values) const
+{
+  const G4int numPads = static_cast<G4int>(charge_values.size());
+  if (!Constants::ENABLE_ADAPTIVE_ROI || numPads == 0) {
+    return numPads;
+  }
+  
+  G4double chargeCut = 0.0;
+  if (Constants::ROI_TOP_K_PADS > 0) {
+    if (numPads <= Constants::ROI_TOP_K_PADS) {
+      return numPads;
+    }
+    // K-th largest charge without a full sort
+    ArenaDoubleVector sortedCharges(charge_values.begin(), charge_values.end(), GetEventArena());
+    std::nth_element(sortedCharges.begin(), sortedCharges.begin() + (Constants::ROI_TOP_K_PADS - 1),
+                     sortedCharges.end(), std::greater<double>());
+    chargeCut = sortedCharges[Constants::ROI_TOP_K_PADS - 1];
+  } else {
+    G4double maxCharge = *std::max_element(charge_values.begin(), charge_values.end());
+    chargeCut = Constants::ROI_RELATIVE_CHARGE_THRESHOLD * maxCharge;
+  }
+  
+  G4int keptPads = static_cast<G4int>(std::count_if(charge_values.begin(), charge_values.end(),
+                                                   [chargeCut](double q) { return q >= chargeCut; }));
+  if (keptPads < Constants::ROI_MIN_PADS || keptPads == numPads) {
+    return numPads;
+  }
+  
+  // Compact in place, preserving grid order
+  size_t out = 0;
+  for (size_t i = 0; i < charge_values.size(); ++i) {
+    if (charge_values[i] >= chargeCut) {
+      x_coords[out] = x_coords[i];
+      y_coords[out] = y_coords[i];
+      charge_values[out] = charge_values[i];
+      out++;
+    }
+  }
+  x_coords.resize(out);
+  y_coords.resize(out);
+  charge_values.resize(out);
+  
+  return keptPads;
+}
+
 // Perform automatic radius selection based on fit quality
+// The largest grid is computed once and every smaller radius is a centered view into it
+// (fractions are re-normalized over the view, as CalculateNeighborhoodChargeSharing would).
+// Each radius is warm-started from the previous radius's fit, and the scan stops once
+// quality has not improved for AUTO_RADIUS_PATIENCE consecutive radii.
 G4int EventAction::SelectOptimalRadius(const G4ThreeVector& hitPosition, G4int hitPixelI, G4int hitPixelJ)
 {
   G4double bestFitQuality = -1.0;
   G4int bestRadius = fNeighborhoodRadius; // Default fallback
   
-  // Test different radii from min to max
+  if (fEdep <= 0 || fMaxAutoRadius < fMinAutoRadius) {
+    fSelectedFitQuality = 0.0;
+    return bestRadius;
+  }
+  
+  // Raw weights for the largest neighborhood, shared by all radii
+  std::vector<G4double>& maxRadiusWeights = fAutoRadiusWeights;
+  CalculateNeighborhoodWeights(hitPosition, hitPixelI, hitPixelJ, fMaxAutoRadius, maxRadiusWeights);
+  
+  // Center of the hit pixel (same as CalculateNearestPixel for in-range indices)
+  G4double pixelSize = fDetector->GetPixelSize();
+  G4double pixelSpacing = fDetector->GetPixelSpacing();
+  G4double firstPixelPos = -fDetector->GetDetSize()/2 + fDetector->GetPixelCornerOffset() + pixelSize/2;
+  G4double centerX = firstPixelPos + hitPixelI * pixelSpacing;
+  G4double centerY = firstPixelPos + hitPixelJ * pixelSpacing;
+  
+  GaussianFit2DResultsCeres previousFit;
+  G4bool hasPreviousFit = false;
+  G4int radiiWithoutImprovement = 0;
+  
+  // Test growing radii from min to max
   for (G4int testRadius = fMinAutoRadius; testRadius <= fMaxAutoRadius; testRadius++) {
-    G4double fitQuality = EvaluateFitQuality(testRadius, hitPosition, hitPixelI, hitPixelJ);
+    GaussianFit2DResultsCeres fitResults;
+    G4double fitQuality = EvaluateFitQuality(testRadius, fMaxAutoRadius, maxRadiusWeights,
+                                             centerX, centerY,
+                                             hasPreviousFit ? &previousFit : nullptr,
+                                             fitResults);
+    
+    if (fitResults.fit_successful) {
+      previousFit = fitResults;
+      hasPreviousFit = true;
+    }
     
     if (fitQuality > bestFitQuality) {
       bestFitQuality = fitQuality;
       bestRadius = testRadius;
+      radiiWithoutImprovement = 0;
+    } else if (++radiiWithoutImprovement >= Constants::AUTO_RADIUS_PATIENCE) {
+      break; // Quality stopped improving
     }
   }
   
@@ -1240,99 +1483,87 @@ G4int EventAction::SelectOptimalRadius(const G4ThreeVector& hitPosition, G4int h
   return bestRadius;
 }
 
-// Evaluate fit quality for a given radius
-G4double EventAction::EvaluateFitQuality(G4int radius, const G4ThreeVector& hitPosition, G4int hitPixelI, G4int hitPixelJ)
+// Evaluate fit quality for a given radius using a view into the largest-radius weight grid
+G4double EventAction::EvaluateFitQuality(G4int radius, G4int maxRadius, const std::vector<G4double>& maxRadiusWeights,
+                                         G4double centerX, G4double centerY,
+                                         const GaussianFit2DResultsCeres* warmStart,
+                                         GaussianFit2DResultsCeres& fitResults)
 {
-  // Temporarily save current radius
-  G4int originalRadius = fNeighborhoodRadius;
-  fNeighborhoodRadius = radius;
-  
-  // Clear and recalculate neighborhood data with test radius
-  std::vector<G4double> tempAngles = fNonPixel_GridNeighborhoodAngles;
-  std::vector<G4double> tempChargeFractions = fNonPixel_GridNeighborhoodChargeFractions;
-  std::vector<G4double> tempDistances = fNonPixel_GridNeighborhoodDistances;
-  std::vector<G4double> tempCharge = fNonPixel_GridNeighborhoodCharge;
-  
-  // Calculate neighborhood data with test radius
-  CalculateNeighborhoodGridAngles(hitPosition, hitPixelI, hitPixelJ);
-  CalculateNeighborhoodChargeSharing();
-  
-  // Check if we have enough data points for fitting
-  G4int validPoints = 0;
-  for (size_t i = 0; i < fNonPixel_GridNeighborhoodChargeFractions.size(); ++i) {
-    if (fNonPixel_GridNeighborhoodChargeFractions[i] > 0) {
-      validPoints++;
+  G4int maxGridSize = 2 * maxRadius + 1;
+  
+  // Normalize over the sub-grid only: fractions depend on which pixels share the charge
+  G4double totalWeight = 0.0;
+  for (G4int di = -radius; di <= radius; di++) {
+    for (G4int dj = -radius; dj <= radius; dj++) {
+      G4double weight = maxRadiusWeights[(di + maxRadius) * maxGridSize + (dj + maxRadius)];
+      if (weight >= 0) {
+        totalWeight += weight;
+      }
     }
   }
   
-  if (validPoints < Constants::MIN_POINTS_FOR_FIT) {
-    // Restore original data and radius
-    fNeighborhoodRadius = originalRadius;
-    fNonPixel_GridNeighborhoodAngles = tempAngles;
-    fNonPixel_GridNeighborhoodChargeFractions = tempChargeFractions;
-    fNonPixel_GridNeighborhoodDistances = tempDistances;
-    fNonPixel_GridNeighborhoodCharge = tempCharge;
-    return 0.0; // Poor quality due to insufficient data
+  if (totalWeight <= 0) {
+    return 0.0;
   }
   
+  // Total charge in the same units as CalculateNeighborhoodChargeSharing
+  G4double edepInEV = fEdep * MeV / eV;
+  G4double totalCharge = edepInEV / fIonizationEnergy * fAmplificationFactor;
+  
   // Extract data for fitting
-  std::vector<double> x_coords, y_coords, charge_values;
+  std::vector<double>& x_coords = fFitXCoords;
+  std::vector<double>& y_coords = fFitYCoords;
+  std::vector<double>& charge_values = fFitChargeValues;
+  x_coords.clear();
+  y_coords.clear();
+  charge_values.clear();
   G4double pixelSpacing = fDetector->GetPixelSpacing();
-  G4int gridSize = 2 * radius + 1;
-  G4ThreeVector nearestPixel = CalculateNearestPixel(hitPosition);
   
-  for (size_t i = 0; i < fNonPixel_GridNeighborhoodChargeFractions.size(); ++i) {
-    if (fNonPixel_GridNeighborhoodChargeFractions[i] > 0) {
-      G4int col = i / gridSize;  // di (X) was outer loop
-      G4int row = i % gridSize;  // dj (Y) was inner loop
-      
-      G4int offsetI = col - radius; // X offset from center pixel
-      G4int offsetJ = row - radius; // Y offset from center pixel
-      
-      G4double x_pos = nearestPixel.x() + offsetI * pixelSpacing;
-      G4double y_pos = nearestPixel.y() + offsetJ * pixelSpacing;
+  for (G4int di = -radius; di <= radius; di++) {
+    for (G4int dj = -radius; dj <= radius; dj++) {
+      G4double weight = maxRadiusWeights[(di + maxRadius) * maxGridSize + (dj + maxRadius)];
+      G4double chargeFraction = weight / totalWeight;
+      if (weight < 0 || chargeFraction <= 0) {
+        continue;
+      }
       
-      x_coords.push_back(x_pos);
-      y_coords.push_back(y_pos);
-      charge_values.push_back(fNonPixel_GridNeighborhoodCharge[i]);
+      x_coords.push_back(centerX + di * pixelSpacing);
+      y_coords.push_back(centerY + dj * pixelSpacing);
+      charge_values.push_back(chargeFraction * totalCharge * fElementaryCharge);
     }
   }
   
+  if (x_coords.size() < static_cast<size_t>(Constants::MIN_POINTS_FOR_FIT)) {
+    return 0.0; // Poor quality due to insufficient data
+  }
+  
+  // Perform quick Gaussian fit evaluation, seeded by the previous radius when available
+  fitResults = Fit2DGaussianCeres(
+    x_coords, y_coords, charge_values,
+    centerX, centerY,
+    pixelSpacing, 
+    false, // verbose=false
+    false, // enable_outlier_filtering
+    warmStart);
+  
   G4double fitQuality = 0.0;
   
-  if (x_coords.size() >= Constants::MIN_POINTS_FOR_FIT) {
-    // Perform quick Gaussian fit evaluation
-    GaussianFit2DResultsCeres fitResults = Fit2DGaussianCeres(
-      x_coords, y_coords, charge_values,
-      nearestPixel.x(), nearestPixel.y(),
-      pixelSpacing, 
-      false, // verbose=false
-      false); // enable_outlier_filtering
+  if (fitResults.fit_successful) {
+    // Calculate fit quality based on residuals and fit parameters
+    // Use reduced chi-squared values and goodness of fit metrics
+    G4double rowQuality = (fitResults.x_chi2red > 0) ? 1.0 / (1.0 + fitResults.x_chi2red) : 0.0;
+    G4double colQuality = (fitResults.y_chi2red > 0) ? 1.0 / (1.0 + fitResults.y_chi2red) : 0.0;
     
-    if (fitResults.fit_successful) {
-      // Calculate fit quality based on residuals and fit parameters
-      // Use reduced chi-squared values and goodness of fit metrics
-      G4double rowQuality = (fitResults.x_chi2red > 0) ? 1.0 / (1.0 + fitResults.x_chi2red) : 0.0;
-      G4double colQuality = (fitResults.y_chi2red > 0) ? 1.0 / (1.0 + fitResults.y_chi2red) : 0.0;
-      
-      // Average the quality from row and column fits
-      fitQuality = (rowQuality + colQuality) / 2.0;
-      
-      // Apply penalty for outliers based on fit probability
-      G4double probPenalty = (fitResults.x_pp + fitResults.y_pp) / 2.0;
-      fitQuality *= probPenalty;
-      
-      // Clamp to [0, 1] range
-      fitQuality = std::max(0.0, std::min(1.0, fitQuality));
-    }
+    // Average the quality from row and column fits
+    fitQuality = (rowQuality + colQuality) / 2.0;
+    
+    // Apply penalty for outliers based on fit probability
+    G4double probPenalty = (fitResults.x_pp + fitResults.y_pp) / 2.0;
+    fitQuality *= probPenalty;
+    
+    // Clamp to [0, 1] range
+    fitQuality = std::max(0.0, std::min(1.0, fitQuality));
   }
   
-  // Restore original data and radius
-  fNeighborhoodRadius = originalRadius;
-  fNonPixel_GridNeighborhoodAngles = tempAngles;
-  fNonPixel_GridNeighborhoodChargeFractions = tempChargeFractions;
-  fNonPixel_GridNeighborhoodDistances = tempDistances;
-  fNonPixel_GridNeighborhoodCharge = tempCharge;
-  
   return fitQuality;
-}
\ No newline at end of file
+}
@@ -0,0 +1,183 @@
+#include "EventArena.hh"
+#include "Constants.hh"
+
+#include <cstdlib>
+#include <new>
+#include <optional>
+
+namespace {
+
+#ifdef COUNT_HEAP_ALLOCATIONS
+// Global operator new calls of this thread (counted by the replacements at the end of this file)
+thread_local long long tHeapAllocations = 0;
+#endif
+
+// Upstream of the arena: the global heap, counting the chunks requested beyond the arena buffer
+class OverflowCountingResource : public std::pmr::memory_resource {
+public:
+    long long chunks = 0;
+    std::size_t bytes = 0;
+
+private:
+    void* do_allocate(std::size_t size, std::size_t alignment) override {
+        ++chunks;
+        bytes += size;
+        return std::pmr::new_delete_resource()->allocate(size, alignment);
+    }
+    void do_deallocate(void* p, std::size_t size, std::size_t alignment) override {
+        std::pmr::new_delete_resource()->deallocate(p, size, alignment);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+// Monotonic arena over a reusable per-thread buffer that grows to the largest event seen
+class EventArenaResource : public std::pmr::memory_resource {
+public:
+    EventArenaResource()
+        : fBuffer(static_cast<std::size_t>(Constants::EVENT_ARENA_INITIAL_BYTES)) {
+        fArena.emplace(fBuffer.data(), fBuffer.size(), &fOverflow);
+    }
+
+    void Reset() {
+        fArena->release();
+        if (fOverflow.bytes > 0) {
+            // The last event did not fit: grow the buffer so the next ones do
+            const std::size_t size = fBuffer.size() + fOverflow.bytes;
+            fArena.reset();
+            fBuffer = std::vector<unsigned char>(size);
+            fArena.emplace(fBuffer.data(), fBuffer.size(), &fOverflow);
+            fOverflow.bytes = 0;
+        }
+    }
+
+    long long TakeBytes() {
+        long long bytes = fBytes;
+        fBytes = 0;
+        return bytes;
+    }
+
+    long long TakeOverflows() {
+        long long chunks = fOverflow.chunks;
+        fOverflow.chunks = 0;
+        return chunks;
+    }
+
+private:
+    void* do_allocate(std::size_t size, std::size_t alignment) override {
+        fBytes += static_cast<long long>(size);
+        return fArena->allocate(size, alignment);
+    }
+    void do_deallocate(void*, std::size_t, std::size_t) override {
+        // Monotonic: memory is reclaimed by Reset()
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    std::vector<unsigned char> fBuffer;
+    OverflowCountingResource fOverflow;
+    std::optional<std::pmr::monotonic_buffer_resource> fArena;  // Declared last: released before fOverflow
+    long long fBytes = 0;
+};
+
+EventArenaResource& ThreadEventArena() {
+    static thread_local EventArenaResource arena;
+    return arena;
+}
+
+} // namespace
+
+std::pmr::memory_resource* GetEventArena() {
+    if (!Constants::ENABLE_EVENT_ARENA) {
+        return std::pmr::new_delete_resource();
+    }
+    return &ThreadEventArena();
+}
+
+void ResetEventArena() {
+    if (Constants::ENABLE_EVENT_ARENA) {
+        ThreadEventArena().Reset();
+    }
+    TakeEventAllocationStatistics();
+}
+
+EventAllocationStatistics TakeEventAllocationStatistics() {
+    EventAllocationStatistics statistics;
+#ifdef COUNT_HEAP_ALLOCATIONS
+    statistics.heap_allocations = tHeapAllocations;
+    tHeapAllocations = 0;
+#endif
+    if (Constants::ENABLE_EVENT_ARENA) {
+        EventArenaResource& arena = ThreadEventArena();
+        statistics.arena_bytes = arena.TakeBytes();
+        statistics.arena_overflows = arena.TakeOverflows();
+    }
+    return statistics;
+}
+
+bool HeapAllocationsCounted() {
+#ifdef COUNT_HEAP_ALLOCATIONS
+    return true;
+#else
+    return false;
+#endif
+}
+
+#ifdef COUNT_HEAP_ALLOCATIONS
+// =============================================
+// COUNTING GLOBAL ALLOCATION FUNCTIONS
+// =============================================
+// Debug builds only (CMake option COUNT_HEAP_ALLOCATIONS): these replace the allocation functions of
+// the whole process. Plain malloc/free with a per-thread call counter; the array and nothrow forms
+// of the standard library forward to these
+
+static void* CountedAllocate(std::size_t size, std::size_t alignment) {
+    ++tHeapAllocations;
+    if (size == 0) {
+        size = 1;
+    }
+    while (true) {
+        void* p = nullptr;
+        if (alignment > alignof(std::max_align_t)) {
+            const std::size_t padded = (size + alignment - 1) / alignment * alignment;
+            p = std::aligned_alloc(alignment, padded);
+        } else {
+            p = std::malloc(size);
+        }
+        if (p) {
+            return p;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void* operator new(std::size_t size) {
+    return CountedAllocate(size, alignof(std::max_align_t));
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return CountedAllocate(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept {
+    std::free(p);
+}
+#endif // COUNT_HEAP_ALLOCATIONS
@@ -0,0 +1,361 @@
+#include "EventRecord.hh"
+#include "Constants.hh"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+void SetProfileModelSentinels(ProfileModelRecord& model, G4double nan) {
+    model.row_delta_x = nan;
+    model.column_delta_y = nan;
+    model.main_diag_transformed_x = nan;
+    model.main_diag_transformed_y = nan;
+    model.main_diag_transformed_delta_x = nan;
+    model.main_diag_transformed_delta_y = nan;
+    model.second_diag_transformed_x = nan;
+    model.second_diag_transformed_y = nan;
+    model.second_diag_transformed_delta_x = nan;
+    model.second_diag_transformed_delta_y = nan;
+    model.mean_true_delta_x = nan;
+    model.mean_true_delta_y = nan;
+}
+
+EventRecord MakeEventRecordTemplate() {
+    EventRecord record;
+    std::memset(&record, 0, sizeof(record));
+
+    const G4double nan = std::numeric_limits<G4double>::quiet_NaN();
+    record.hit.selected_radius = 4;
+
+    SetProfileModelSentinels(record.gauss, nan);
+    SetProfileModelSentinels(record.lorentz, nan);
+    SetProfileModelSentinels(record.power_lorentz, nan);
+
+    for (SurfaceFitRecord* surface : {&record.gauss_3d, &record.lorentz_3d, &record.power_lorentz_3d}) {
+        surface->delta_x = nan;
+        surface->delta_y = nan;
+    }
+    record.joint.delta_x = nan;
+    record.joint.delta_y = nan;
+    for (SymmetricFitRecord& symmetric : record.symmetric) {
+        symmetric.delta_x = nan;
+        symmetric.delta_y = nan;
+    }
+    return record;
+}
+
+} // namespace
+
+const EventRecord& GetEventRecordTemplate() {
+    static const EventRecord kTemplate = MakeEventRecordTemplate();
+    return kTemplate;
+}
+
+G4int FitStatusMask(const EventRecord& record) {
+    G4int mask = 0;
+    if (record.gauss.row_column_successful) mask |= FIT_STATUS_GAUSS_ROW_COLUMN;
+    if (record.lorentz.row_column_successful) mask |= FIT_STATUS_LORENTZ_ROW_COLUMN;
+    if (record.power_lorentz.row_column_successful) mask |= FIT_STATUS_POWER_LORENTZ_ROW_COLUMN;
+    if (record.gauss_3d.successful) mask |= FIT_STATUS_GAUSS_3D;
+    if (record.lorentz_3d.successful) mask |= FIT_STATUS_LORENTZ_3D;
+    if (record.power_lorentz_3d.successful) mask |= FIT_STATUS_POWER_LORENTZ_3D;
+    if (record.joint.successful) mask |= FIT_STATUS_JOINT;
+    for (G4int model = 0; model < kNumSymmetric3DModels; ++model) {
+        if (record.symmetric[model].successful) mask |= FIT_STATUS_SYMMETRIC_FIRST << model;
+    }
+    if (record.hit.is_pixel_hit) mask |= FIT_STATUS_PIXEL_HIT;
+    if (record.hit.has_grid_data) mask |= FIT_STATUS_GRID_DATA;
+    return mask;
+}
+
+G4int EnabledFitStatusMask() {
+    G4int mask = 0;
+    if (Constants::ENABLE_2D_FITTING) {
+        if (Constants::ENABLE_GAUSSIAN_FITTING) mask |= FIT_STATUS_GAUSS_ROW_COLUMN;
+        if (Constants::ENABLE_LORENTZIAN_FITTING) mask |= FIT_STATUS_LORENTZ_ROW_COLUMN;
+        if (Constants::ENABLE_POWER_LORENTZIAN_FITTING) mask |= FIT_STATUS_POWER_LORENTZ_ROW_COLUMN;
+    }
+    if (Constants::ENABLE_3D_GAUSSIAN_FITTING) mask |= FIT_STATUS_GAUSS_3D;
+    if (Constants::ENABLE_3D_LORENTZIAN_FITTING) mask |= FIT_STATUS_LORENTZ_3D;
+    if (Constants::ENABLE_3D_POWER_LORENTZIAN_FITTING) mask |= FIT_STATUS_POWER_LORENTZ_3D;
+    if (Constants::ENABLE_JOINT_PROFILE_FITTING) mask |= FIT_STATUS_JOINT;
+    for (G4int model = 0; model < kNumSymmetric3DModels; ++model) {
+        if (IsSymmetric3DModelEnabled(static_cast<Symmetric3DModel>(model))) {
+            mask |= FIT_STATUS_SYMMETRIC_FIRST << model;
+        }
+    }
+    return mask;
+}
+
+namespace {
+
+// Running mean of the valid estimates of one coordinate (fixed size, no allocation)
+struct EstimateMean {
+    G4double sum = 0.0;
+    G4int count = 0;
+    
+    void Add(G4double estimate) {
+        if (!std::isnan(estimate)) {
+            sum += estimate;
+            ++count;
+        }
+    }
+    
+    // Mean estimate minus true position (NaN without any estimate)
+    G4double DeltaTo(G4double truth) const {
+        return count > 0 ? sum / count - truth : std::numeric_limits<G4double>::quiet_NaN();
+    }
+};
+
+// Diagonal centers of one model rotated back to x/y (needs both true coordinates)
+void CalculateTransformedDiagonalCoordinates(const HitRecord& hit, ProfileModelRecord& model) {
+    const double NaN = std::numeric_limits<G4double>::quiet_NaN();
+    const double invSqrt2 = 1.0 / 1.4142135623730951; // 1/√2
+
+    auto setXY = [&](double xPred, double yPred,
+                     double &outX, double &outY,
+                     double &deltaX, double &deltaY)
+    {
+        outX   = xPred;
+        outY   = yPred;
+        deltaX = std::isnan(xPred) ? NaN : (xPred - hit.true_x);
+        deltaY = std::isnan(yPred) ? NaN : (yPred - hit.true_y);
+    };
+
+    // Diagonal fits return the position along the diagonal; prefer the X projection, fall back to Y
+    auto diagonalPosition = [&](const ProfileFitRecord& xFit, const ProfileFitRecord& yFit) {
+        if (xFit.dof > 0) return xFit.center;
+        if (yFit.dof > 0) return yFit.center;
+        return NaN;
+    };
+
+    // Main diagonal (θ = 45°)
+    double sMain = diagonalPosition(model.main_diag_x, model.main_diag_y);
+    if (!std::isnan(sMain)) {
+        setXY(hit.pixel_x + sMain*invSqrt2, hit.pixel_y + sMain*invSqrt2,
+              model.main_diag_transformed_x, model.main_diag_transformed_y,
+              model.main_diag_transformed_delta_x, model.main_diag_transformed_delta_y);
+    } else {
+        setXY(NaN, NaN,
+              model.main_diag_transformed_x, model.main_diag_transformed_y,
+              model.main_diag_transformed_delta_x, model.main_diag_transformed_delta_y);
+    }
+
+    // Secondary diagonal (θ = -45°)
+    double sSec = diagonalPosition(model.second_diag_x, model.second_diag_y);
+    if (!std::isnan(sSec)) {
+        setXY(hit.pixel_x + sSec*invSqrt2, hit.pixel_y - sSec*invSqrt2,
+              model.second_diag_transformed_x, model.second_diag_transformed_y,
+              model.second_diag_transformed_delta_x, model.second_diag_transformed_delta_y);
+    } else {
+        setXY(NaN, NaN,
+              model.second_diag_transformed_x, model.second_diag_transformed_y,
+              model.second_diag_transformed_delta_x, model.second_diag_transformed_delta_y);
+    }
+}
+
+// Mean estimation of one model from its transformed diagonals and its 3D fit
+void CalculateMeanEstimations(const HitRecord& hit, ProfileModelRecord& model, const SurfaceFitRecord& surface) {
+    // ONLY use transformed diagonal coordinates (exclude row/column fits) and the matching 3D fit,
+    // accumulated in this fixed order
+    EstimateMean meanX, meanY;
+    meanX.Add(model.main_diag_transformed_x);
+    meanX.Add(model.second_diag_transformed_x);
+    meanY.Add(model.main_diag_transformed_y);
+    meanY.Add(model.second_diag_transformed_y);
+    if (surface.successful) {
+        meanX.Add(surface.center_x);
+        meanY.Add(surface.center_y);
+    }
+    
+    model.mean_true_delta_x = meanX.DeltaTo(hit.true_x);
+    model.mean_true_delta_y = meanY.DeltaTo(hit.true_y);
+}
+
+// Fit - true deltas, transformed diagonals and mean estimator of one 1D model and its 3D fit
+void ComputeModelDerivedQuantities(const HitRecord& hit, ProfileModelRecord& model, SurfaceFitRecord& surface,
+                                   G4bool profileEnabled, G4bool surfaceEnabled, G4bool validTruth) {
+    const G4double NaN = std::numeric_limits<G4double>::quiet_NaN();
+    
+    if (profileEnabled) {
+        // Row and column deltas vs true position: overall fit successful and the projection has dof
+        model.row_delta_x = (model.row_column_successful && model.row.dof > 0)
+                            ? model.row.center - hit.true_x : NaN;
+        model.column_delta_y = (model.row_column_successful && model.column.dof > 0)
+                               ? model.column.center - hit.true_y : NaN;
+        
+        // Diagonal centers rotated back to x/y
+        if (Constants::ENABLE_DIAGONAL_FITTING && validTruth) {
+            CalculateTransformedDiagonalCoordinates(hit, model);
+        }
+    }
+    
+    if (surfaceEnabled) {
+        const G4bool valid = surface.successful && surface.dof > 0;
+        surface.delta_x = valid ? surface.center_x - hit.true_x : NaN;
+        surface.delta_y = valid ? surface.center_y - hit.true_y : NaN;
+    }
+    
+    // The mean estimator combines both, so it exists as soon as either fit is enabled
+    if ((profileEnabled || surfaceEnabled) && validTruth) {
+        CalculateMeanEstimations(hit, model, surface);
+    }
+}
+
+} // namespace
+
+void ComputeDerivedQuantities(EventRecord& record) {
+    const HitRecord& hit = record.hit;
+    const G4double NaN = std::numeric_limits<G4double>::quiet_NaN();
+    
+    // Transformed diagonals and mean estimators need both true coordinates; they keep the NaN sentinels
+    const G4bool validTruth = !std::isnan(hit.true_x) && !std::isnan(hit.true_y);
+    if (!validTruth) {
+        G4cerr << "EventRecord: Warning - Invalid true position data, cannot calculate transformed coordinates and mean estimations" << G4endl;
+    }
+    
+    // Only models enabled in Constants are touched; disabled ones keep the sentinels of the reset
+    ComputeModelDerivedQuantities(hit, record.gauss, record.gauss_3d,
+                                  Constants::ENABLE_GAUSSIAN_FITTING, Constants::ENABLE_3D_GAUSSIAN_FITTING,
+                                  validTruth);
+    ComputeModelDerivedQuantities(hit, record.lorentz, record.lorentz_3d,
+                                  Constants::ENABLE_LORENTZIAN_FITTING, Constants::ENABLE_3D_LORENTZIAN_FITTING,
+                                  validTruth);
+    ComputeModelDerivedQuantities(hit, record.power_lorentz, record.power_lorentz_3d,
+                                  Constants::ENABLE_POWER_LORENTZIAN_FITTING,
+                                  Constants::ENABLE_3D_POWER_LORENTZIAN_FITTING, validTruth);
+    
+    // Joint and symmetric fit deltas (NaN for failed fits)
+    if (Constants::ENABLE_JOINT_PROFILE_FITTING) {
+        JointFitRecord& joint = record.joint;
+        const G4bool jointValid = joint.successful && joint.dof > 0;
+        joint.delta_x = jointValid ? joint.center_x - hit.true_x : NaN;
+        joint.delta_y = jointValid ? joint.center_y - hit.true_y : NaN;
+    }
+    
+    for (G4int model = 0; model < kNumSymmetric3DModels; ++model) {
+        if (!IsSymmetric3DModelEnabled(static_cast<Symmetric3DModel>(model))) continue;
+        SymmetricFitRecord& symmetric = record.symmetric[model];
+        const G4bool valid = symmetric.successful && symmetric.dof > 0;
+        symmetric.delta_x = valid ? symmetric.center_x - hit.true_x : NaN;
+        symmetric.delta_y = valid ? symmetric.center_y - hit.true_y : NaN;
+    }
+}
+
+namespace {
+
+const G4double kNaN = std::numeric_limits<G4double>::quiet_NaN();
+
+// Row/column, diagonals and mean estimator of one 1D model
+void AddProfileMethods(std::vector<ReconstructionMethod>& methods, const std::string& prefix,
+                       ProfileModelRecord EventRecord::* model, G4bool diagonals) {
+    methods.push_back({prefix + "RowColumn",
+        [model](const EventRecord& r) {
+            const ProfileModelRecord& m = r.*model;
+            const G4bool ok = m.row_column_successful;
+            return PositionXY{ok && m.row.dof > 0 ? m.row.center : kNaN,
+                              ok && m.column.dof > 0 ? m.column.center : kNaN};
+        },
+        [model](const EventRecord& r) { return PositionXY{(r.*model).row_delta_x, (r.*model).column_delta_y}; }});
+    if (diagonals) {
+        methods.push_back({prefix + "MainDiag",
+            [model](const EventRecord& r) {
+                return PositionXY{(r.*model).main_diag_transformed_x, (r.*model).main_diag_transformed_y};
+            },
+            [model](const EventRecord& r) {
+                return PositionXY{(r.*model).main_diag_transformed_delta_x, (r.*model).main_diag_transformed_delta_y};
+            }});
+        methods.push_back({prefix + "SecondDiag",
+            [model](const EventRecord& r) {
+                return PositionXY{(r.*model).second_diag_transformed_x, (r.*model).second_diag_transformed_y};
+            },
+            [model](const EventRecord& r) {
+                return PositionXY{(r.*model).second_diag_transformed_delta_x, (r.*model).second_diag_transformed_delta_y};
+            }});
+    }
+}
+
+// The mean estimator only stores its delta
+void AddMeanMethod(std::vector<ReconstructionMethod>& methods, const std::string& prefix,
+                   ProfileModelRecord EventRecord::* model) {
+    methods.push_back({prefix + "Mean",
+        [model](const EventRecord& r) {
+            return PositionXY{r.hit.true_x + (r.*model).mean_true_delta_x, r.hit.true_y + (r.*model).mean_true_delta_y};
+        },
+        [model](const EventRecord& r) { return PositionXY{(r.*model).mean_true_delta_x, (r.*model).mean_true_delta_y}; }});
+}
+
+void AddSurfaceMethod(std::vector<ReconstructionMethod>& methods, const std::string& name,
+                      SurfaceFitRecord EventRecord::* surface) {
+    methods.push_back({name,
+        [surface](const EventRecord& r) {
+            const SurfaceFitRecord& s = r.*surface;
+            const G4bool ok = s.successful && s.dof > 0;
+            return PositionXY{ok ? s.center_x : kNaN, ok ? s.center_y : kNaN};
+        },
+        [surface](const EventRecord& r) { return PositionXY{(r.*surface).delta_x, (r.*surface).delta_y}; }});
+}
+
+std::vector<ReconstructionMethod> MakeEnabledReconstructionMethods() {
+    std::vector<ReconstructionMethod> methods;
+    methods.push_back({"Pixel",
+        [](const EventRecord& r) { return PositionXY{r.hit.pixel_x, r.hit.pixel_y}; },
+        [](const EventRecord& r) { return PositionXY{r.hit.pixel_true_delta_x, r.hit.pixel_true_delta_y}; },
+        false});
+    
+    struct ModelPair {
+        const char* prefix;
+        const char* surfaceName;
+        ProfileModelRecord EventRecord::* profile;
+        SurfaceFitRecord EventRecord::* surface;
+        G4bool profileEnabled, surfaceEnabled;
+    };
+    const ModelPair models[] = {
+        {"Gauss", "3DGaussian", &EventRecord::gauss, &EventRecord::gauss_3d,
+         Constants::ENABLE_GAUSSIAN_FITTING, Constants::ENABLE_3D_GAUSSIAN_FITTING},
+        {"Lorentz", "3DLorentzian", &EventRecord::lorentz, &EventRecord::lorentz_3d,
+         Constants::ENABLE_LORENTZIAN_FITTING, Constants::ENABLE_3D_LORENTZIAN_FITTING},
+        {"PowerLorentz", "3DPowerLorentzian", &EventRecord::power_lorentz, &EventRecord::power_lorentz_3d,
+         Constants::ENABLE_POWER_LORENTZIAN_FITTING, Constants::ENABLE_3D_POWER_LORENTZIAN_FITTING},
+    };
+    for (const ModelPair& model : models) {
+        if (model.profileEnabled) {
+            AddProfileMethods(methods, model.prefix, model.profile, Constants::ENABLE_DIAGONAL_FITTING);
+        }
+        if (model.surfaceEnabled) {
+            AddSurfaceMethod(methods, model.surfaceName, model.surface);
+        }
+        if (model.profileEnabled || model.surfaceEnabled) {
+            AddMeanMethod(methods, model.prefix, model.profile);
+        }
+    }
+    
+    if (Constants::ENABLE_JOINT_PROFILE_FITTING) {
+        methods.push_back({"JointGauss",
+            [](const EventRecord& r) {
+                const G4bool ok = r.joint.successful && r.joint.dof > 0;
+                return PositionXY{ok ? r.joint.center_x : kNaN, ok ? r.joint.center_y : kNaN};
+            },
+            [](const EventRecord& r) { return PositionXY{r.joint.delta_x, r.joint.delta_y}; }});
+    }
+    for (G4int model = 0; model < kNumSymmetric3DModels; ++model) {
+        if (!IsSymmetric3DModelEnabled(static_cast<Symmetric3DModel>(model))) continue;
+        methods.push_back({GetSymmetric3DModelLabel(static_cast<Symmetric3DModel>(model)),
+            [model](const EventRecord& r) {
+                const SymmetricFitRecord& s = r.symmetric[model];
+                const G4bool ok = s.successful && s.dof > 0;
+                return PositionXY{ok ? s.center_x : kNaN, ok ? s.center_y : kNaN};
+            },
+            [model](const EventRecord& r) { return PositionXY{r.symmetric[model].delta_x, r.symmetric[model].delta_y}; }});
+    }
+    return methods;
+}
+
+} // namespace
+
+const std::vector<ReconstructionMethod>& EnabledReconstructionMethods() {
+    static const std::vector<ReconstructionMethod> methods = MakeEnabledReconstructionMethods();
+    return methods;
+}
@@ -0,0 +1,214 @@
+#include "EventStream.hh"
+#include "Constants.hh"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+const char kStreamMagic[8] = {'E', 'C', 'S', 'S', 'T', 'R', 'M', '1'};
+
+// Original stdout, taken by ReserveStdoutForEventStream() for the "stdout" target
+int gStdoutStreamFd = -1;
+
+template <typename T>
+void AppendValue(std::vector<unsigned char>& bytes, T value) {
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(&value);
+    bytes.insert(bytes.end(), p, p + sizeof(T));
+}
+
+G4bool WriteAll(int fd, const unsigned char* data, size_t size) {
+    while (size > 0) {
+        ssize_t written = ::write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+} // namespace
+
+void ReserveStdoutForEventStream()
+{
+    if (std::string(Constants::EVENT_STREAM_TARGET) != "stdout" || gStdoutStreamFd >= 0) {
+        return;
+    }
+    // Keep the original stdout for the stream and send all text output to stderr
+    std::cout.flush();
+    std::fflush(stdout);
+    gStdoutStreamFd = ::dup(STDOUT_FILENO);
+    if (gStdoutStreamFd >= 0) {
+        ::dup2(STDERR_FILENO, STDOUT_FILENO);
+    }
+}
+
+// =============================================
+// SHARED SINK
+// =============================================
+
+EventStream& EventStream::Instance()
+{
+    static EventStream stream;
+    return stream;
+}
+
+EventStream::EventStream()
+    : fFd(-1),
+      fOpen(false)
+{
+    Open(Constants::EVENT_STREAM_TARGET);
+}
+
+EventStream::~EventStream()
+{
+    Close();
+}
+
+G4bool EventStream::Open(const std::string& target)
+{
+    if (target == "stdout") {
+        // Reserved by main() before any text output, so the stream starts with its header
+        if (gStdoutStreamFd < 0) {
+            G4cerr << "EventStream: stdout was not reserved for the stream (ReserveStdoutForEventStream)" << G4endl;
+            return false;
+        }
+        fFd = gStdoutStreamFd;
+        gStdoutStreamFd = -1;
+    } else if (target.compare(0, 5, "fifo:") == 0) {
+        const std::string path = target.substr(5);
+        if (::mkfifo(path.c_str(), 0644) != 0 && errno != EEXIST) {
+            G4cerr << "EventStream: Cannot create named pipe " << path << ": " << std::strerror(errno) << G4endl;
+            return false;
+        }
+        G4cout << "EventStream: Waiting for a reader on " << path << G4endl;
+        fFd = ::open(path.c_str(), O_WRONLY);
+    } else if (target.compare(0, 5, "unix:") == 0) {
+        const std::string path = target.substr(5);
+        sockaddr_un address;
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path)) {
+            G4cerr << "EventStream: Socket path too long: " << path << G4endl;
+            return false;
+        }
+        std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+        fFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fFd >= 0 && ::connect(fFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            ::close(fFd);
+            fFd = -1;
+        }
+    } else {
+        G4cerr << "EventStream: Unknown target '" << target << "' (use stdout, fifo:<path> or unix:<path>)" << G4endl;
+        return false;
+    }
+
+    if (fFd < 0) {
+        G4cerr << "EventStream: Cannot open " << target << ": " << std::strerror(errno) << G4endl;
+        return false;
+    }
+
+    // Stream header: method names of the per-event positions
+    const std::vector<ReconstructionMethod>& methods = EnabledReconstructionMethods();
+    std::vector<unsigned char> header(kStreamMagic, kStreamMagic + sizeof(kStreamMagic));
+    AppendValue<std::uint32_t>(header, static_cast<std::uint32_t>(methods.size()));
+    for (const ReconstructionMethod& method : methods) {
+        AppendValue<std::uint32_t>(header, static_cast<std::uint32_t>(method.name.size()));
+        header.insert(header.end(), method.name.begin(), method.name.end());
+    }
+    if (!WriteAll(fFd, header.data(), header.size())) {
+        G4cerr << "EventStream: Failed to write the stream header to " << target << G4endl;
+        ::close(fFd);
+        fFd = -1;
+        return false;
+    }
+
+    fOpen = true;
+    G4cout << "EventStream: Streaming " << methods.size() << " methods per event to " << target << G4endl;
+    return true;
+}
+
+void EventStream::Close()
+{
+    std::lock_guard<std::mutex> lock(fMutex);
+    if (fFd >= 0) {
+        ::close(fFd);
+        fFd = -1;
+    }
+    fOpen = false;
+}
+
+void EventStream::Write(const unsigned char* data, size_t size)
+{
+    std::lock_guard<std::mutex> lock(fMutex);
+    if (fFd < 0) {
+        return;
+    }
+    if (!WriteAll(fFd, data, size)) {
+        G4cerr << "EventStream: Write failed (" << std::strerror(errno) << "), stream closed" << G4endl;
+        ::close(fFd);
+        fFd = -1;
+        fOpen = false;
+    }
+}
+
+// =============================================
+// PER-THREAD ENCODER
+// =============================================
+
+EventStreamWriter::EventStreamWriter()
+    : fPending(0)
+{
+    const size_t methods = EnabledReconstructionMethods().size();
+    fBuffer.reserve(Constants::EVENT_STREAM_FLUSH_EVENTS * (4 + 16 + 8 * methods));
+}
+
+EventStreamWriter::~EventStreamWriter()
+{
+    Flush();
+}
+
+void EventStreamWriter::Append(const EventRecord& record)
+{
+    const std::vector<ReconstructionMethod>& methods = EnabledReconstructionMethods();
+    const std::uint32_t payload = static_cast<std::uint32_t>(16 + 8 * methods.size());
+
+    AppendValue<std::uint32_t>(fBuffer, payload);
+    AppendValue<std::int32_t>(fBuffer, record.index.event_id);
+    AppendValue<std::int32_t>(fBuffer, record.index.fit_status);
+    AppendValue<float>(fBuffer, static_cast<float>(record.hit.true_x));
+    AppendValue<float>(fBuffer, static_cast<float>(record.hit.true_y));
+    for (const ReconstructionMethod& method : methods) {
+        const PositionXY position = method.position(record);
+        AppendValue<float>(fBuffer, static_cast<float>(position.x));
+        AppendValue<float>(fBuffer, static_cast<float>(position.y));
+    }
+
+    if (++fPending >= Constants::EVENT_STREAM_FLUSH_EVENTS) {
+        Flush();
+    }
+}
+
+void EventStreamWriter::Flush()
+{
+    if (fPending > 0) {
+        EventStream& stream = EventStream::Instance();
+        if (stream.IsOpen()) {
+            stream.Write(fBuffer.data(), fBuffer.size());
+        }
+    }
+    fBuffer.clear();
+    fPending = 0;
+}
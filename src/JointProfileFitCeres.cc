@@ -0,0 +1,330 @@
+#include "JointProfileFitCeres.hh"
+#include "CeresLoggingInit.hh"
+#include "CeresUtils.hh"
+#include "Constants.hh"
+
+#include <cmath>
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <utility>
+
+// Ceres Solver includes
+#include "ceres/ceres.h"
+#include "glog/logging.h"
+
+// Profile directions: row (+x), column (+y), main diagonal (+45°), secondary diagonal (-45°)
+static const int kNumProfiles = 4;
+static const double kInvSqrt2 = 0.70710678118654752;
+static const double kProfileDirection[kNumProfiles][2] = {
+    {1.0, 0.0}, {0.0, 1.0}, {kInvSqrt2, kInvSqrt2}, {kInvSqrt2, -kInvSqrt2}
+};
+
+// Residual for one pad of one profile
+// Parameter blocks: shared center (x0, y0), the profile's width σ, and the profile's (A, B)
+struct JointProfileGaussianCostFunction {
+    JointProfileGaussianCostFunction(double s, double ux, double uy, double cx, double cy,
+                                     double charge, double uncertainty)
+        : s_(s), ux_(ux), uy_(uy), cx_(cx), cy_(cy), charge_(charge), uncertainty_(uncertainty) {}
+    
+    template <typename T>
+    bool operator()(const T* const center, const T* const width, const T* const amp_offset, T* residual) const {
+        // Center projected onto the profile direction
+        T s0 = (center[0] - T(cx_)) * T(ux_) + (center[1] - T(cy_)) * T(uy_);
+        
+        T safe_sigma = ceres::abs(width[0]);
+        if (safe_sigma < T(Constants::MIN_SAFE_PARAMETER)) {
+            safe_sigma = T(Constants::MIN_SAFE_PARAMETER);
+        }
+        
+        T ds = T(s_) - s0;
+        T predicted = amp_offset[0] * ceres::exp(-(ds * ds) / (T(2.0) * safe_sigma * safe_sigma)) + amp_offset[1];
+        
+        residual[0] = (predicted - T(charge_)) / T(uncertainty_);
+        return true;
+    }
+    
+    static ceres::CostFunction* Create(double s, double ux, double uy, double cx, double cy,
+                                       double charge, double uncertainty) {
+        return (new ceres::AutoDiffCostFunction<JointProfileGaussianCostFunction, 1, 2, 1, 2>(
+            new JointProfileGaussianCostFunction(s, ux, uy, cx, cy, charge, uncertainty)));
+    }
+    
+private:
+    const double s_;
+    const double ux_;
+    const double uy_;
+    const double cx_;
+    const double cy_;
+    const double charge_;
+    const double uncertainty_;
+};
+
+static GaussianJointFitResultsCeres FitJointGaussianProfilesCeresRaw(
+    const std::vector<double>& x_coords,
+    const std::vector<double>& y_coords,
+    const std::vector<double>& charge_values,
+    double center_x_estimate,
+    double center_y_estimate,
+    double pixel_spacing,
+    bool verbose)
+{
+    GaussianJointFitResultsCeres result;
+    
+    CeresLoggingInitializer::InitializeOnce();
+    
+    if (x_coords.size() != y_coords.size() || x_coords.size() != charge_values.size() || x_coords.empty()) {
+        if (verbose) {
+            std::cout << "Joint Gaussian profile fit: invalid input data size" << std::endl;
+        }
+        return result;
+    }
+    
+    // Collect the central profiles: pads on the line through the center pixel (10% of pitch tolerance)
+    const double tolerance = pixel_spacing * 0.1;
+    std::vector<std::pair<double, double>> profiles[kNumProfiles]; // (position along profile, charge)
+    std::vector<size_t> profile_pads[kNumProfiles];                // Index of each profile point's pad
+    double max_charge = 0.0;
+    
+    for (size_t i = 0; i < x_coords.size(); ++i) {
+        double charge = charge_values[i];
+        if (charge <= 0) continue;
+        
+        double dx = x_coords[i] - center_x_estimate;
+        double dy = y_coords[i] - center_y_estimate;
+        const double offsets[kNumProfiles] = {dy, dx, dy - dx, dy + dx};  // Perpendicular offsets
+        
+        for (int k = 0; k < kNumProfiles; ++k) {
+            if (std::abs(offsets[k]) < tolerance) {
+                double s = dx * kProfileDirection[k][0] + dy * kProfileDirection[k][1];
+                profiles[k].emplace_back(s, charge);
+                profile_pads[k].push_back(i);
+                max_charge = std::max(max_charge, charge);
+            }
+        }
+    }
+    
+    // Uncertainty as 5% of max charge (same convention as the separate fits)
+    double uncertainty = 1.0;
+    if (Constants::ENABLE_VERTICAL_CHARGE_UNCERTAINTIES) {
+        uncertainty = std::max(0.05 * max_charge, Constants::MIN_UNCERTAINTY_VALUE);
+    }
+    result.charge_uncertainty = uncertainty;
+    
+    // Parameter blocks
+    double center[2] = {center_x_estimate, center_y_estimate};
+    double width[1] = {pixel_spacing * 0.5};
+    double diag_width[1] = {pixel_spacing * 0.5 * std::sqrt(2.0)};
+    double amp_offset[kNumProfiles][2];
+    
+    // A pad on several used profiles (the center pad lies on all of them) enters each with weight
+    // 1/multiplicity, so every pad carries unit weight in χ² and the covariance, and counts once in the DOF
+    std::vector<int> pad_multiplicity(x_coords.size(), 0);
+    for (int k = 0; k < kNumProfiles; ++k) {
+        if (profiles[k].size() < 4) continue;
+        for (size_t pad : profile_pads[k]) {
+            pad_multiplicity[pad]++;
+        }
+    }
+    const int num_points = static_cast<int>(
+        std::count_if(pad_multiplicity.begin(), pad_multiplicity.end(), [](int m) { return m > 0; }));
+    
+    ceres::Problem problem;
+    
+    for (int k = 0; k < kNumProfiles; ++k) {
+        if (profiles[k].size() < 4) continue;
+        
+        double profile_max = 0.0;
+        double profile_min = std::numeric_limits<double>::max();
+        for (const auto& point : profiles[k]) {
+            profile_max = std::max(profile_max, point.second);
+            profile_min = std::min(profile_min, point.second);
+        }
+        amp_offset[k][0] = std::max(profile_max - profile_min, Constants::MIN_UNCERTAINTY_VALUE);
+        amp_offset[k][1] = profile_min;
+        
+        double* profile_width = (k < 2) ? width : diag_width;
+        for (size_t p = 0; p < profiles[k].size(); ++p) {
+            const double weighted_uncertainty = uncertainty * std::sqrt(static_cast<double>(pad_multiplicity[profile_pads[k][p]]));
+            ceres::CostFunction* cost_function = JointProfileGaussianCostFunction::Create(
+                profiles[k][p].first, kProfileDirection[k][0], kProfileDirection[k][1],
+                center_x_estimate, center_y_estimate, profiles[k][p].second, weighted_uncertainty);
+            problem.AddResidualBlock(cost_function, nullptr, center, profile_width, amp_offset[k]);
+        }
+        
+        // Per-profile amplitude and offset bounds
+        double charge_range = profile_max - profile_min;
+        problem.SetParameterLowerBound(amp_offset[k], 0, std::max(Constants::MIN_UNCERTAINTY_VALUE, amp_offset[k][0] * 0.01));
+        problem.SetParameterUpperBound(amp_offset[k], 0, std::max(profile_max * 1.5, amp_offset[k][0] * 100.0));
+        problem.SetParameterLowerBound(amp_offset[k], 1, profile_min - std::max(charge_range * 0.5, 1e-12));
+        problem.SetParameterUpperBound(amp_offset[k], 1, profile_min + std::max(charge_range * 0.5, 1e-12));
+        
+        result.profile_used[k] = true;
+        result.num_profiles++;
+    }
+    
+    // Row or column is needed to pin each center coordinate alone; diagonals only constrain x0 ± y0
+    const bool has_row_or_column = result.profile_used[0] || result.profile_used[1];
+    const int num_parameters = 2 + (has_row_or_column ? 1 : 0) +
+                               (result.profile_used[2] || result.profile_used[3] ? 1 : 0) +
+                               2 * result.num_profiles;
+    
+    if (!has_row_or_column || result.num_profiles < 2 || num_points <= num_parameters) {
+        if (verbose) {
+            std::cout << "Joint Gaussian profile fit: insufficient profiles (" << result.num_profiles
+                     << ") or data points (" << num_points << ")" << std::endl;
+        }
+        return result;
+    }
+    
+    // Shared parameter bounds: hit lies within one pitch of the center pixel
+    problem.SetParameterLowerBound(center, 0, center_x_estimate - pixel_spacing);
+    problem.SetParameterUpperBound(center, 0, center_x_estimate + pixel_spacing);
+    problem.SetParameterLowerBound(center, 1, center_y_estimate - pixel_spacing);
+    problem.SetParameterUpperBound(center, 1, center_y_estimate + pixel_spacing);
+    if (has_row_or_column) {
+        problem.SetParameterLowerBound(width, 0, pixel_spacing * 0.05);
+        problem.SetParameterUpperBound(width, 0, pixel_spacing * 3.0);
+    }
+    if (result.profile_used[2] || result.profile_used[3]) {
+        problem.SetParameterLowerBound(diag_width, 0, pixel_spacing * 0.05 * std::sqrt(2.0));
+        problem.SetParameterUpperBound(diag_width, 0, pixel_spacing * 3.0 * std::sqrt(2.0));
+    }
+    
+    ceres::Solver::Options options;
+    options.linear_solver_type = ceres::DENSE_QR;
+    options.minimizer_type = ceres::TRUST_REGION;
+    options.trust_region_strategy_type = ceres::LEVENBERG_MARQUARDT;
+    options.function_tolerance = 1e-10;
+    options.gradient_tolerance = 1e-10;
+    options.parameter_tolerance = 1e-15;
+    options.max_num_iterations = 400;
+    options.minimizer_progress_to_stdout = false;
+    
+    ceres::Solver::Summary summary;
+    SolveFitProblem(options, &problem, &summary);
+    
+    bool converged = (summary.termination_type == ceres::CONVERGENCE ||
+                      summary.termination_type == ceres::USER_SUCCESS) &&
+                     !std::isnan(center[0]) && !std::isnan(center[1]);
+    if (!converged) {
+        if (verbose) {
+            std::cout << "Joint Gaussian profile fit did not converge" << std::endl;
+        }
+        return result;
+    }
+    
+    result.center_x = center[0];
+    result.center_y = center[1];
+    result.sigma = std::abs(width[0]);
+    result.diag_sigma = std::abs(diag_width[0]);
+    for (int k = 0; k < kNumProfiles; ++k) {
+        if (result.profile_used[k]) {
+            result.amplitude[k] = amp_offset[k][0];
+            result.vertical_offset[k] = amp_offset[k][1];
+        }
+    }
+    
+    result.dof = num_points - num_parameters;
+    result.chi2red = summary.final_cost * 2.0 / result.dof;
+    result.pp = (result.chi2red > 0) ? 1.0 - std::min(1.0, result.chi2red / 10.0) : 0.0; // Simple p-value approximation
+    
+    // Coherent uncertainties: covariance of the shared blocks from the single solve
+    ceres::Covariance::Options covariance_options;
+    covariance_options.algorithm_type = ceres::DENSE_SVD;
+    ceres::Covariance covariance(covariance_options);
+    
+    std::vector<std::pair<const double*, const double*>> covariance_blocks;
+    covariance_blocks.emplace_back(center, center);
+    if (has_row_or_column) covariance_blocks.emplace_back(width, width);
+    if (result.profile_used[2] || result.profile_used[3]) covariance_blocks.emplace_back(diag_width, diag_width);
+    
+    if (covariance.Compute(covariance_blocks, &problem)) {
+        double center_cov[4] = {0, 0, 0, 0};
+        covariance.GetCovarianceBlock(center, center, center_cov);
+        result.center_x_err = std::sqrt(std::max(0.0, center_cov[0]));
+        result.center_y_err = std::sqrt(std::max(0.0, center_cov[3]));
+        result.center_xy_cov = center_cov[1];
+        
+        double width_var = 0.0;
+        if (has_row_or_column) {
+            covariance.GetCovarianceBlock(width, width, &width_var);
+            result.sigma_err = std::sqrt(std::max(0.0, width_var));
+        }
+        if (result.profile_used[2] || result.profile_used[3]) {
+            covariance.GetCovarianceBlock(diag_width, diag_width, &width_var);
+            result.diag_sigma_err = std::sqrt(std::max(0.0, width_var));
+        }
+    } else {
+        // Fallback uncertainty estimation, as in the separate fits
+        result.center_x_err = std::max(0.02 * pixel_spacing, result.sigma / 10.0);
+        result.center_y_err = result.center_x_err;
+        result.sigma_err = std::max(0.05 * result.sigma, 0.01 * pixel_spacing);
+        result.diag_sigma_err = std::max(0.05 * result.diag_sigma, 0.01 * pixel_spacing);
+    }
+    
+    result.fit_successful = true;
+    
+    if (verbose) {
+        std::cout << "Joint Gaussian profile fit (" << result.num_profiles << " profiles, "
+                 << num_points << " points): x0=" << result.center_x << "±" << result.center_x_err
+                 << ", y0=" << result.center_y << "±" << result.center_y_err
+                 << ", sigma=" << result.sigma << ", diag_sigma=" << result.diag_sigma
+                 << ", chi2red=" << result.chi2red << std::endl;
+    }
+    
+    return result;
+}
+
+GaussianJointFitResultsCeres FitJointGaussianProfilesCeres(
+    const std::vector<double>& x_coords,
+    const std::vector<double>& y_coords,
+    const std::vector<double>& charge_values,
+    double center_x_estimate,
+    double center_y_estimate,
+    double pixel_spacing,
+    bool verbose)
+{
+    RecordFitStart();
+    if (!Constants::ENABLE_NORMALIZED_FIT_FRAME || charge_values.empty()) {
+        return FitJointGaussianProfilesCeresRaw(x_coords, y_coords, charge_values,
+                                                center_x_estimate, center_y_estimate, pixel_spacing, verbose);
+    }
+    
+    // Sampled raw-frame solve of the same data, result discarded (see ScopedRawFrameReference)
+    if (ShouldSampleRawFrameReference()) {
+        ScopedRawFrameReference reference_scope;
+        FitJointGaussianProfilesCeresRaw(x_coords, y_coords, charge_values,
+                                         center_x_estimate, center_y_estimate, pixel_spacing, false);
+    }
+    
+    NormalizedFitFrame frame = MakeNormalizedFitFrame(center_x_estimate, center_y_estimate, pixel_spacing, charge_values);
+    ScopedNormalizedFitFrame frame_scope(frame);
+    GaussianJointFitResultsCeres result = FitJointGaussianProfilesCeresRaw(
+        ToFrameValues(x_coords, frame.origin_x, frame.length_scale),
+        ToFrameValues(y_coords, frame.origin_y, frame.length_scale),
+        ToFrameValues(charge_values, 0.0, frame.charge_scale),
+        0.0, 0.0, 1.0, verbose);
+    
+    const double ls = frame.length_scale;
+    const double qs = frame.charge_scale;
+    result.center_x = result.center_x * ls + frame.origin_x;
+    result.center_y = result.center_y * ls + frame.origin_y;
+    result.sigma *= ls;
+    result.diag_sigma *= ls;
+    result.center_x_err *= ls;
+    result.center_y_err *= ls;
+    result.center_xy_cov *= ls * ls;
+    result.sigma_err *= ls;
+    result.diag_sigma_err *= ls;
+    for (int k = 0; k < kNumProfiles; ++k) {
+        result.amplitude[k] *= qs;
+        result.vertical_offset[k] *= qs;
+    }
+    result.charge_uncertainty *= qs;
+    if (!Constants::ENABLE_VERTICAL_CHARGE_UNCERTAINTIES) {
+        result.chi2red *= qs * qs;
+        result.pp = (result.chi2red > 0) ? 1.0 - std::min(1.0, result.chi2red / 10.0) : 0.0;
+    }
+    return result;
+}
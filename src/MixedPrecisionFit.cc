@@ -0,0 +1,240 @@
+#include "MixedPrecisionFit.hh"
+#include "Constants.hh"
+#include "EventArena.hh"
+
+#include <algorithm>
+#include <cmath>
+
+// Accumulate J^T J (upper triangle), J^T r and the cost for the Gaussian model
+// Plain reductions over contiguous arrays so -O3 -march=native -ffast-math vectorizes the loop
+// (8 float or 4 double lanes with AVX2).
+template <typename Scalar>
+static Scalar AccumulateNormalEquations(const Scalar* x, const Scalar* y, size_t n, const Scalar p[4],
+                                        Scalar JtJ[4][4], Scalar Jtr[4]) {
+    const Scalar A = p[0];
+    const Scalar m = p[1];
+    const Scalar inv_sigma = Scalar(1) / p[2];
+    const Scalar inv_sigma2 = inv_sigma * inv_sigma;
+    const Scalar B = p[3];
+    
+    Scalar h00 = 0, h01 = 0, h02 = 0, h03 = 0, h11 = 0, h12 = 0, h13 = 0, h22 = 0, h23 = 0, h33 = 0;
+    Scalar g0 = 0, g1 = 0, g2 = 0, g3 = 0;
+    Scalar cost = 0;
+    
+    for (size_t i = 0; i < n; ++i) {
+        const Scalar dx = x[i] - m;
+        const Scalar e = std::exp(Scalar(-0.5) * dx * dx * inv_sigma2);
+        const Scalar r = A * e + B - y[i];
+        const Scalar j0 = e;
+        const Scalar j1 = A * e * dx * inv_sigma2;
+        const Scalar j2 = j1 * dx * inv_sigma;
+        
+        h00 += j0 * j0; h01 += j0 * j1; h02 += j0 * j2; h03 += j0;
+        h11 += j1 * j1; h12 += j1 * j2; h13 += j1;
+        h22 += j2 * j2; h23 += j2;
+        h33 += Scalar(1);
+        g0 += j0 * r; g1 += j1 * r; g2 += j2 * r; g3 += r;
+        cost += r * r;
+    }
+    
+    JtJ[0][0] = h00; JtJ[0][1] = h01; JtJ[0][2] = h02; JtJ[0][3] = h03;
+    JtJ[1][1] = h11; JtJ[1][2] = h12; JtJ[1][3] = h13;
+    JtJ[2][2] = h22; JtJ[2][3] = h23;
+    JtJ[3][3] = h33;
+    Jtr[0] = g0; Jtr[1] = g1; Jtr[2] = g2; Jtr[3] = g3;
+    
+    return Scalar(0.5) * cost;
+}
+
+template <typename Scalar>
+static Scalar EvaluateCost(const Scalar* x, const Scalar* y, size_t n, const Scalar p[4]) {
+    const Scalar inv_sigma2 = Scalar(1) / (p[2] * p[2]);
+    Scalar cost = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const Scalar dx = x[i] - p[1];
+        const Scalar r = p[0] * std::exp(Scalar(-0.5) * dx * dx * inv_sigma2) + p[3] - y[i];
+        cost += r * r;
+    }
+    return Scalar(0.5) * cost;
+}
+
+// Solve (JtJ + lambda * diag(JtJ)) delta = Jtr by Cholesky; returns false if not positive definite
+template <typename Scalar>
+static bool SolveDampedSystem(const Scalar JtJ[4][4], const Scalar Jtr[4], Scalar lambda, Scalar delta[4]) {
+    Scalar L[4][4] = {};
+    for (int i = 0; i < 4; ++i) {
+        for (int j = 0; j <= i; ++j) {
+            Scalar sum = (i == j) ? JtJ[i][i] + lambda * std::max(JtJ[i][i], Scalar(1e-6)) : JtJ[j][i];
+            for (int k = 0; k < j; ++k) {
+                sum -= L[i][k] * L[j][k];
+            }
+            if (i == j) {
+                if (!(sum > Scalar(0))) {
+                    return false;
+                }
+                L[i][i] = std::sqrt(sum);
+            } else {
+                L[i][j] = sum / L[j][j];
+            }
+        }
+    }
+    
+    Scalar z[4];
+    for (int i = 0; i < 4; ++i) {
+        Scalar sum = Jtr[i];
+        for (int k = 0; k < i; ++k) sum -= L[i][k] * z[k];
+        z[i] = sum / L[i][i];
+    }
+    for (int i = 3; i >= 0; --i) {
+        Scalar sum = z[i];
+        for (int k = i + 1; k < 4; ++k) sum -= L[k][i] * delta[k];
+        delta[i] = sum / L[i][i];
+    }
+    return true;
+}
+
+// Stationarity test on the projected gradient: every component not pushing into an active bound must be
+// small against its Cauchy-Schwarz bound |J_k^T r| <= |J_k| |r|, i.e. the residual is (nearly) orthogonal
+// to each free Jacobian column. Scale-free, so one tolerance covers any charge and pitch.
+template <typename Scalar>
+static bool IsStationary(const Scalar JtJ[4][4], const Scalar Jtr[4], const Scalar p[4],
+                         const Scalar lower[4], const Scalar upper[4], Scalar cost, Scalar tolerance) {
+    for (int k = 0; k < 4; ++k) {
+        const bool blocked = (p[k] <= lower[k] && Jtr[k] > 0) || (p[k] >= upper[k] && Jtr[k] < 0);
+        if (!blocked && std::abs(Jtr[k]) > tolerance * std::sqrt(JtJ[k][k] * Scalar(2) * cost)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Projected Levenberg-Marquardt in the given precision; returns the number of accepted steps
+// Converged on a small relative cost decrease, or on a stall (no damped step decreases the cost) after
+// at least one accepted step at a stationary point. A stall at the starting point is not
+// convergence: the caller must not report an unmoved initial guess as a fit.
+template <typename Scalar>
+static int RunLevenbergMarquardt(const Scalar* x, const Scalar* y, size_t n,
+                                 const Scalar lower[4], const Scalar upper[4], Scalar p[4],
+                                 Scalar& cost, int max_iterations, Scalar initial_lambda,
+                                 Scalar function_tolerance, Scalar gradient_tolerance, bool& converged) {
+    Scalar lambda = initial_lambda;
+    Scalar JtJ[4][4];
+    Scalar Jtr[4];
+    int accepted = 0;
+    converged = false;
+    
+    cost = AccumulateNormalEquations(x, y, n, p, JtJ, Jtr);
+    
+    for (int iteration = 0; iteration < max_iterations; ++iteration) {
+        Scalar delta[4];
+        Scalar trial[4];
+        Scalar trial_cost = cost;
+        bool step_accepted = false;
+        
+        while (lambda < Scalar(1e10)) {
+            if (SolveDampedSystem(JtJ, Jtr, lambda, delta)) {
+                for (int k = 0; k < 4; ++k) {
+                    trial[k] = std::min(upper[k], std::max(lower[k], p[k] - delta[k]));
+                }
+                trial_cost = EvaluateCost(x, y, n, trial);
+                if (trial_cost <= cost) {
+                    step_accepted = true;
+                    break;
+                }
+            }
+            lambda *= Scalar(10);
+        }
+        
+        if (!step_accepted) {
+            // No descent direction left at this precision: stationary only if the gradient agrees
+            converged = accepted > 0 && IsStationary(JtJ, Jtr, p, lower, upper, cost, gradient_tolerance);
+            break;
+        }
+        
+        const Scalar decrease = cost - trial_cost;
+        std::copy(trial, trial + 4, p);
+        accepted++;
+        lambda = std::max(lambda * Scalar(0.3), Scalar(1e-9));
+        
+        if (decrease <= function_tolerance * cost) {
+            cost = trial_cost;
+            converged = true;
+            break;
+        }
+        cost = AccumulateNormalEquations(x, y, n, p, JtJ, Jtr);
+    }
+    
+    return accepted;
+}
+
+bool FitGaussian1DMixedPrecision(const double* x_vals,
+                                 const double* y_vals,
+                                 size_t num_points,
+                                 double uncertainty,
+                                 const double initial[4],
+                                 const double lower[4],
+                                 const double upper[4],
+                                 MixedPrecisionFitResult& result) {
+    const size_t n = num_points;
+    if (n < 4 || uncertainty <= 0 || initial[2] <= 0) {
+        return false;
+    }
+    
+    // Normalize so every quantity is O(1) in single precision:
+    // x' = (x - m0) / s0, y' = y / u  =>  A' = A / u, m' = (m - m0) / s0, sigma' = sigma / s0, B' = B / u
+    const double x_ref = initial[1];
+    const double x_scale = initial[2];
+    const double to_param[4] = {1.0 / uncertainty, 1.0 / x_scale, 1.0 / x_scale, 1.0 / uncertainty};
+    const double param_offset[4] = {0.0, x_ref, 0.0, 0.0};
+    
+    ArenaDoubleVector x_norm(n, GetEventArena()), y_norm(n, GetEventArena());
+    for (size_t i = 0; i < n; ++i) {
+        x_norm[i] = (x_vals[i] - x_ref) / x_scale;
+        y_norm[i] = y_vals[i] / uncertainty;
+    }
+    
+    double p[4], lo[4], hi[4];
+    for (int k = 0; k < 4; ++k) {
+        p[k] = (initial[k] - param_offset[k]) * to_param[k];
+        lo[k] = (lower[k] - param_offset[k]) * to_param[k];
+        hi[k] = (upper[k] - param_offset[k]) * to_param[k];
+    }
+    
+    // Stage 1: single precision
+    std::pmr::vector<float> x_float(x_norm.begin(), x_norm.end(), GetEventArena());
+    std::pmr::vector<float> y_float(y_norm.begin(), y_norm.end(), GetEventArena());
+    float p_float[4], lo_float[4], hi_float[4];
+    for (int k = 0; k < 4; ++k) {
+        p_float[k] = static_cast<float>(p[k]);
+        lo_float[k] = static_cast<float>(lo[k]);
+        hi_float[k] = static_cast<float>(hi[k]);
+    }
+    
+    float cost_float = 0;
+    bool float_converged = false;
+    result.float_iterations = RunLevenbergMarquardt(x_float.data(), y_float.data(), n, lo_float, hi_float,
+                                                    p_float, cost_float,
+                                                    Constants::MIXED_PRECISION_MAX_FLOAT_ITERATIONS,
+                                                    1e-3f, 1e-6f, 1e-2f, float_converged);
+    if (!float_converged || !std::isfinite(cost_float)) {
+        return false;
+    }
+    
+    // Stage 2: double-precision polish from the single-precision solution
+    for (int k = 0; k < 4; ++k) {
+        p[k] = p_float[k];
+    }
+    double cost = 0;
+    bool polish_converged = false;
+    result.double_iterations = RunLevenbergMarquardt(x_norm.data(), y_norm.data(), n, lo, hi, p, cost,
+                                                     Constants::MIXED_PRECISION_POLISH_ITERATIONS,
+                                                     1e-6, 1e-12, 1e-6, polish_converged);
+    
+    for (int k = 0; k < 4; ++k) {
+        result.params[k] = p[k] / to_param[k] + param_offset[k];
+    }
+    result.cost = cost;  // Residuals were already divided by the uncertainty
+    result.converged = std::isfinite(cost) && result.params[0] > 0 && result.params[2] > 0;
+    
+    return result.converged;
+}
@@ -0,0 +1,171 @@
+#include "NeighborhoodKernel.hh"
+#include "Constants.hh"
+
+#include "G4SystemOfUnits.hh"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+// Dispatches to a compile-time grid size for the supported radii (4 to 10) so the per-axis scratch
+// lives on the stack and the row loops have constant trip counts; other radii use the runtime path.
+void NeighborhoodKernel::Compute(const NeighborhoodKernelGeometry& geometry, G4double hitX, G4double hitY,
+                                 G4int hitPixelI, G4int hitPixelJ, G4int radius,
+                                 G4double* distances, G4double* alphas, G4double* weights)
+{
+    switch (radius) {
+        case 4:  ComputeFixed<4>(geometry, hitX, hitY, hitPixelI, hitPixelJ, distances, alphas, weights); return;
+        case 5:  ComputeFixed<5>(geometry, hitX, hitY, hitPixelI, hitPixelJ, distances, alphas, weights); return;
+        case 6:  ComputeFixed<6>(geometry, hitX, hitY, hitPixelI, hitPixelJ, distances, alphas, weights); return;
+        case 7:  ComputeFixed<7>(geometry, hitX, hitY, hitPixelI, hitPixelJ, distances, alphas, weights); return;
+        case 8:  ComputeFixed<8>(geometry, hitX, hitY, hitPixelI, hitPixelJ, distances, alphas, weights); return;
+        case 9:  ComputeFixed<9>(geometry, hitX, hitY, hitPixelI, hitPixelJ, distances, alphas, weights); return;
+        case 10: ComputeFixed<10>(geometry, hitX, hitY, hitPixelI, hitPixelJ, distances, alphas, weights); return;
+        default: break;
+    }
+    ComputeRuntime(geometry, hitX, hitY, hitPixelI, hitPixelJ, radius, distances, alphas, weights);
+}
+
+// Runtime grid size: per-axis scratch in (reused) member vectors
+void NeighborhoodKernel::ComputeRuntime(const NeighborhoodKernelGeometry& geometry, G4double hitX, G4double hitY,
+                                        G4int hitPixelI, G4int hitPixelJ, G4int radius,
+                                        G4double* distances, G4double* alphas, G4double* weights)
+{
+    const G4int gridSize = 2 * radius + 1;
+    fColumnDX.resize(gridSize);
+    fRowDY.resize(gridSize);
+    fColumnValid.resize(gridSize);
+    fRowValid.resize(gridSize);
+
+    Evaluate<0>(geometry, hitX, hitY, hitPixelI, hitPixelJ, radius,
+                fColumnDX.data(), fRowDY.data(), fColumnValid.data(), fRowValid.data(),
+                distances, alphas, weights);
+}
+
+// Fixed-radius instantiation: per-axis scratch in std::array, no heap access
+template <G4int Radius>
+void NeighborhoodKernel::ComputeFixed(const NeighborhoodKernelGeometry& geometry, G4double hitX, G4double hitY,
+                                      G4int hitPixelI, G4int hitPixelJ,
+                                      G4double* distances, G4double* alphas, G4double* weights)
+{
+    constexpr G4int gridSize = 2 * Radius + 1;
+    std::array<G4double, gridSize> columnDX, rowDY, columnValid, rowValid;
+
+    Evaluate<gridSize>(geometry, hitX, hitY, hitPixelI, hitPixelJ, Radius,
+                       columnDX.data(), rowDY.data(), columnValid.data(), rowValid.data(),
+                       distances, alphas, weights);
+}
+
+// Kernel body, shared by the fixed (GridSize > 0) and runtime (GridSize == 0) paths
+// The grid geometry is separable: the x offset depends only on the column and the y offset only on the row,
+// so both are computed once per axis. The inner loop over rows is then branch-free (selects only) over
+// contiguous arrays, which -O3 -march=native -ffast-math vectorizes (sqrt, atan and log via libmvec).
+template <G4int GridSize>
+void NeighborhoodKernel::Evaluate(const NeighborhoodKernelGeometry& geometry, G4double hitX, G4double hitY,
+                                  G4int hitPixelI, G4int hitPixelJ, G4int radius,
+                                  G4double* columnDX, G4double* rowDY, G4double* columnValid, G4double* rowValid,
+                                  G4double* distances, G4double* alphas, G4double* weights)
+{
+    // Compile-time constant for fixed instantiations, so loops below have known trip counts
+    const G4int gridSize = (GridSize > 0) ? GridSize : 2 * radius + 1;
+
+    // Get detector parameters
+    const G4double pixelSize = geometry.pixelSize;
+    const G4double pixelSpacing = geometry.pixelSpacing;
+    const G4double pixelCornerOffset = geometry.pixelCornerOffset;
+    const G4double detSize = geometry.detSize;
+    const G4int numBlocksPerSide = geometry.numBlocksPerSide;
+
+    const G4double firstPixelPos = -detSize/2 + pixelCornerOffset + pixelSize/2;
+    const G4double d0_mm = geometry.d0 / mm;
+    const G4double invD0 = 1.0 / d0_mm;
+
+    // α = atan(n / (n + d)) with n = l/2 * √2 (same as CalculatePixelAlphaSubtended)
+    const G4double alphaNumerator = (pixelSize/2.0) * std::sqrt(2.0);
+
+    // Per-axis offsets and bounds masks
+    for (G4int k = 0; k < gridSize; k++) {
+        G4int gridPixelI = hitPixelI + k - radius;
+        G4int gridPixelJ = hitPixelJ + k - radius;
+        columnDX[k] = hitX - (firstPixelPos + gridPixelI * pixelSpacing);
+        rowDY[k] = hitY - (firstPixelPos + gridPixelJ * pixelSpacing);
+        columnValid[k] = (gridPixelI >= 0 && gridPixelI < numBlocksPerSide) ? 1.0 : 0.0;
+        rowValid[k] = (gridPixelJ >= 0 && gridPixelJ < numBlocksPerSide) ? 1.0 : 0.0;
+    }
+
+    // Table path: only when every grid distance lies in the accurately tabulated range
+    if (Constants::ENABLE_WEIGHT_TABLE) {
+        G4double minDX = std::abs(columnDX[0]), maxDX = minDX;
+        G4double minDY = std::abs(rowDY[0]), maxDY = minDY;
+        for (G4int k = 1; k < gridSize; k++) {
+            minDX = std::min(minDX, std::abs(columnDX[k]));
+            maxDX = std::max(maxDX, std::abs(columnDX[k]));
+            minDY = std::min(minDY, std::abs(rowDY[k]));
+            maxDY = std::max(maxDY, std::abs(rowDY[k]));
+        }
+        const G4double minDistance = std::sqrt(minDX*minDX + minDY*minDY);
+        const G4double maxDistance = std::sqrt(maxDX*maxDX + maxDY*maxDY);
+
+        if (!fWeightTable.Covers(pixelSize, d0_mm, maxDistance)) {
+            // Size for the largest radius in use, with half a pitch of margin for hits off the cell center
+            G4int tableRadius = std::max(radius, geometry.tableRadius);
+            G4double tableRange = std::max(maxDistance, (tableRadius + 1) * pixelSpacing * std::sqrt(2.0));
+            fWeightTable.Build(pixelSize, d0_mm, tableRange, Constants::WEIGHT_TABLE_STEP);
+            G4cout << "NeighborhoodKernel: Built charge sharing weight table with " << fWeightTable.GetSize()
+                          << " entries up to " << fWeightTable.GetMaxDistance()/mm << " mm" << G4endl;
+        }
+
+        if (minDistance >= fWeightTable.GetMinDistance()) {
+            const G4double* tableAlpha = fWeightTable.GetAlphaData();
+            const G4double* tableWeight = fWeightTable.GetWeightData();
+            const G4double inverseStep = fWeightTable.GetInverseStep();
+
+            for (G4int col = 0; col < gridSize; col++) {
+                const G4double dx = columnDX[col];
+                const G4double dx2 = dx * dx;
+                const G4double colValid = columnValid[col];
+                G4double* __restrict__ d = distances + col * gridSize;
+                G4double* __restrict__ a = alphas + col * gridSize;
+                G4double* __restrict__ w = weights + col * gridSize;
+
+                for (G4int row = 0; row < gridSize; row++) {
+                    const G4double distance = std::sqrt(dx2 + rowDY[row] * rowDY[row]);
+                    const G4double x = distance * inverseStep;
+                    const G4int node = static_cast<G4int>(x);
+                    const G4double t = x - node;
+                    const G4double alpha = tableAlpha[node] + t * (tableAlpha[node + 1] - tableAlpha[node]);
+                    const G4double weight = tableWeight[node] + t * (tableWeight[node + 1] - tableWeight[node]);
+
+                    d[row] = distance;
+                    a[row] = alpha;
+                    w[row] = (colValid * rowValid[row] > 0.0) ? weight : -1.0;
+                }
+            }
+            return;
+        }
+    }
+
+    for (G4int col = 0; col < gridSize; col++) {
+        const G4double dx = columnDX[col];
+        const G4double dx2 = dx * dx;
+        const G4double colValid = columnValid[col];
+        G4double* __restrict__ d = distances + col * gridSize;
+        G4double* __restrict__ a = alphas + col * gridSize;
+        G4double* __restrict__ w = weights + col * gridSize;
+
+        for (G4int row = 0; row < gridSize; row++) {
+            const G4double distance = std::sqrt(dx2 + rowDY[row] * rowDY[row]);
+            const G4double alpha = std::atan(alphaNumerator / (alphaNumerator + distance));
+
+            // Weight α * ln(d/d0)^(-1) with the log clamped; close pixels get α * ALPHA_WEIGHT_MULTIPLIER
+            // (log argument is kept positive so the unused lane stays finite under -ffast-math)
+            const G4double logValue = std::max(std::log(std::max(distance * invD0, Constants::MIN_DENOMINATOR_VALUE)),
+                                                                                  Constants::MIN_LOG_VALUE);
+            const G4double weight = (distance > d0_mm) ? alpha / logValue : alpha * Constants::ALPHA_WEIGHT_MULTIPLIER;
+
+            d[row] = distance;
+            a[row] = alpha;
+            w[row] = (colValid * rowValid[row] > 0.0) ? weight : -1.0;
+        }
+    }
+}
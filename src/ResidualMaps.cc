@@ -0,0 +1,116 @@
+#include "ResidualMaps.hh"
+#include "Constants.hh"
+
+#include <cmath>
+
+// ROOT includes
+#include "TDirectory.h"
+#include "TH2D.h"
+#include "TProfile2D.h"
+
+ResidualMapAccumulable::ResidualMapAccumulable()
+    : G4VAccumulable("ResidualMaps")
+{
+}
+
+ResidualMapAccumulable::~ResidualMapAccumulable() = default;
+
+void ResidualMapAccumulable::Book(G4double pixelSpacing)
+{
+    fMaps.clear();
+    if (pixelSpacing <= 0) {
+        return;
+    }
+
+    // Workers book concurrently: create the maps with no current directory so the constructor
+    // never registers them in the shared gDirectory
+    TDirectory::TContext context(nullptr);
+    const G4int bins = Constants::RESIDUAL_MAP_BINS;
+    const G4double half = pixelSpacing / 2.0;
+    const char* axisNames[2] = {"X", "Y"};
+    for (const ReconstructionMethod& method : EnabledReconstructionMethods()) {
+        for (const char* axis : axisNames) {
+            // Spread option: the bin error is the RMS spread of the residuals, not the error on the mean
+            auto map = std::make_unique<TProfile2D>(
+                (method.name + "Delta" + axis + "Map").c_str(),
+                (method.name + " " + axis + " residual vs true sub-pixel position").c_str(),
+                bins, -half, half, bins, -half, half, "s");
+            map->SetDirectory(nullptr);
+            map->SetXTitle("True X - Pixel X [mm]");
+            map->SetYTitle("True Y - Pixel Y [mm]");
+            map->SetZTitle((std::string("Mean ") + axis + " residual (reconstructed - true) [mm]").c_str());
+            fMaps.push_back(std::move(map));
+        }
+    }
+}
+
+void ResidualMapAccumulable::Fill(const EventRecord& record)
+{
+    if (fMaps.empty()) {
+        return;
+    }
+    const G4double u = record.hit.true_x - record.hit.pixel_x;
+    const G4double v = record.hit.true_y - record.hit.pixel_y;
+    if (std::isnan(u) || std::isnan(v)) {
+        return;
+    }
+
+    const std::vector<ReconstructionMethod>& methods = EnabledReconstructionMethods();
+    for (size_t i = 0; i < methods.size(); ++i) {
+        const PositionXY delta = methods[i].delta(record);
+        if (!std::isnan(delta.x)) fMaps[2 * i]->Fill(u, v, delta.x);
+        if (!std::isnan(delta.y)) fMaps[2 * i + 1]->Fill(u, v, delta.y);
+    }
+}
+
+void ResidualMapAccumulable::Merge(const G4VAccumulable& other)
+{
+    const ResidualMapAccumulable& worker = static_cast<const ResidualMapAccumulable&>(other);
+    if (worker.fMaps.size() != fMaps.size()) {
+        G4cerr << "ResidualMaps: Cannot merge maps booked with a different layout" << G4endl;
+        return;
+    }
+    for (size_t i = 0; i < fMaps.size(); ++i) {
+        fMaps[i]->Add(worker.fMaps[i].get());
+    }
+}
+
+void ResidualMapAccumulable::Reset()
+{
+    for (auto& map : fMaps) {
+        map->Reset();
+    }
+}
+
+void ResidualMapAccumulable::Write(TDirectory* directory) const
+{
+    if (!directory) {
+        return;
+    }
+    directory->cd();
+    for (const auto& map : fMaps) {
+        map->Write();
+
+        // RMS about zero per bin: sqrt(mean^2 + spread^2), empty bins left at 0
+        const G4int nx = map->GetNbinsX();
+        const G4int ny = map->GetNbinsY();
+        const std::string name = std::string(map->GetName());
+        TH2D rms((name.substr(0, name.size() - 3) + "RMSMap").c_str(),
+                 (std::string(map->GetTitle()) + " (RMS)").c_str(),
+                 nx, map->GetXaxis()->GetXmin(), map->GetXaxis()->GetXmax(),
+                 ny, map->GetYaxis()->GetXmin(), map->GetYaxis()->GetXmax());
+        rms.SetDirectory(nullptr);
+        rms.SetXTitle(map->GetXaxis()->GetTitle());
+        rms.SetYTitle(map->GetYaxis()->GetTitle());
+        rms.SetZTitle("Residual RMS [mm]");
+        for (G4int i = 1; i <= nx; ++i) {
+            for (G4int j = 1; j <= ny; ++j) {
+                if (map->GetBinEntries(map->GetBin(i, j)) <= 0) continue;
+                const G4double mean = map->GetBinContent(i, j);
+                const G4double spread = map->GetBinError(i, j);
+                rms.SetBinContent(i, j, std::sqrt(mean * mean + spread * spread));
+            }
+        }
+        rms.Write();
+    }
+}
@@ -0,0 +1,284 @@
+#include "ResolutionSummary.hh"
+#include "Constants.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+
+const G4double kResolutionQuantiles[kNumResolutionQuantiles] = {0.02275, 0.15866, 0.5, 0.84134, 0.97725};
+const char* const kResolutionQuantileNames[kNumResolutionQuantiles] = {"Q02", "Q16", "Median", "Q84", "Q98"};
+
+// =============================================
+// T-DIGEST
+// =============================================
+
+namespace {
+
+const G4double kPi = 3.14159265358979323846;
+const size_t kDigestBufferSize = 512;
+
+// Scale function k1: small centroids at the tails, where the quantiles of interest sit
+G4double ScaleK(G4double q, G4double compression) {
+    return compression / (2.0 * kPi) * std::asin(2.0 * q - 1.0);
+}
+
+// Largest cumulative fraction a centroid starting at q0 may reach
+G4double ScaleLimit(G4double q0, G4double compression) {
+    const G4double k = ScaleK(q0, compression) + 1.0;
+    if (k >= compression / 4.0) {
+        return 1.0;
+    }
+    return (std::sin(k * 2.0 * kPi / compression) + 1.0) / 2.0;
+}
+
+} // namespace
+
+TDigest::TDigest(G4double compression)
+    : fCompression(compression),
+      fTotal(0.0),
+      fMin(std::numeric_limits<G4double>::infinity()),
+      fMax(-std::numeric_limits<G4double>::infinity())
+{
+}
+
+void TDigest::Add(G4double value, G4double weight)
+{
+    fBuffer.push_back({value, weight});
+    fTotal += weight;
+    fMin = std::min(fMin, value);
+    fMax = std::max(fMax, value);
+    if (fBuffer.size() >= kDigestBufferSize) {
+        Compress();
+    }
+}
+
+void TDigest::Merge(const TDigest& other)
+{
+    fBuffer.insert(fBuffer.end(), other.fCentroids.begin(), other.fCentroids.end());
+    fBuffer.insert(fBuffer.end(), other.fBuffer.begin(), other.fBuffer.end());
+    fTotal += other.fTotal;
+    fMin = std::min(fMin, other.fMin);
+    fMax = std::max(fMax, other.fMax);
+    Compress();
+}
+
+void TDigest::Reset()
+{
+    fCentroids.clear();
+    fBuffer.clear();
+    fTotal = 0.0;
+    fMin = std::numeric_limits<G4double>::infinity();
+    fMax = -std::numeric_limits<G4double>::infinity();
+}
+
+void TDigest::Compress()
+{
+    if (fBuffer.empty()) {
+        return;
+    }
+    fBuffer.insert(fBuffer.end(), fCentroids.begin(), fCentroids.end());
+    std::sort(fBuffer.begin(), fBuffer.end(),
+              [](const Centroid& a, const Centroid& b) { return a.mean < b.mean; });
+    fCentroids.clear();
+
+    // Greedy merge of neighbours while the centroid stays within one unit of the scale function
+    G4double soFar = 0.0;
+    Centroid current = fBuffer[0];
+    G4double limit = ScaleLimit(0.0, fCompression);
+    for (size_t i = 1; i < fBuffer.size(); ++i) {
+        const Centroid& next = fBuffer[i];
+        if ((soFar + current.weight + next.weight) / fTotal <= limit) {
+            current.weight += next.weight;
+            current.mean += (next.mean - current.mean) * next.weight / current.weight;
+        } else {
+            soFar += current.weight;
+            fCentroids.push_back(current);
+            current = next;
+            limit = ScaleLimit(soFar / fTotal, fCompression);
+        }
+    }
+    fCentroids.push_back(current);
+    fBuffer.clear();
+}
+
+G4double TDigest::Quantile(G4double q) const
+{
+    if (fTotal <= 0.0) {
+        return std::numeric_limits<G4double>::quiet_NaN();
+    }
+    TDigest digest(*this);
+    digest.Compress();
+    const std::vector<Centroid>& centroids = digest.fCentroids;
+    if (centroids.size() == 1) {
+        return centroids[0].mean;
+    }
+
+    // Interpolate between centroid centres; the extremes anchor both ends
+    const G4double target = std::min(std::max(q, 0.0), 1.0) * fTotal;
+    G4double cumulative = 0.0;
+    G4double previousCentre = 0.0;
+    G4double previousMean = fMin;
+    for (const Centroid& centroid : centroids) {
+        const G4double centre = cumulative + centroid.weight / 2.0;
+        if (target < centre) {
+            const G4double span = centre - previousCentre;
+            const G4double t = span > 0.0 ? (target - previousCentre) / span : 0.0;
+            return previousMean + t * (centroid.mean - previousMean);
+        }
+        cumulative += centroid.weight;
+        previousCentre = centre;
+        previousMean = centroid.mean;
+    }
+    const G4double span = fTotal - previousCentre;
+    const G4double t = span > 0.0 ? (target - previousCentre) / span : 0.0;
+    return previousMean + t * (fMax - previousMean);
+}
+
+// =============================================
+// RESIDUAL STATISTICS
+// =============================================
+
+void ResidualStatistics::Add(G4double residual)
+{
+    ++n;
+    const G4double delta = residual - mean;
+    mean += delta / n;
+    m2 += delta * (residual - mean);
+    digest.Add(residual);
+}
+
+void ResidualStatistics::Merge(const ResidualStatistics& other)
+{
+    if (other.n == 0) {
+        return;
+    }
+    const G4long total = n + other.n;
+    const G4double delta = other.mean - mean;
+    mean += delta * other.n / total;
+    m2 += other.m2 + delta * delta * (static_cast<G4double>(n) * other.n / total);
+    n = total;
+    digest.Merge(other.digest);
+}
+
+void ResidualStatistics::Reset()
+{
+    n = 0;
+    mean = 0.0;
+    m2 = 0.0;
+    digest.Reset();
+}
+
+G4double ResidualStatistics::StdDev() const
+{
+    return n > 1 ? std::sqrt(m2 / (n - 1)) : std::numeric_limits<G4double>::quiet_NaN();
+}
+
+G4double ResidualStatistics::Rms() const
+{
+    return n > 0 ? std::sqrt(m2 / n + mean * mean) : std::numeric_limits<G4double>::quiet_NaN();
+}
+
+// =============================================
+// ACCUMULABLE
+// =============================================
+
+ResolutionAccumulable::ResolutionAccumulable()
+    : G4VAccumulable("ResolutionSummary"),
+      fEntries(0)
+{
+    for (const ReconstructionMethod& method : EnabledReconstructionMethods()) {
+        fMethods.emplace_back(method.name, Constants::RESOLUTION_TDIGEST_COMPRESSION);
+    }
+}
+
+void ResolutionAccumulable::Fill(const EventRecord& record)
+{
+    const std::vector<ReconstructionMethod>& methods = EnabledReconstructionMethods();
+    for (size_t i = 0; i < methods.size(); ++i) {
+        // A fit that was never attempted is not a failure
+        if (methods[i].fitted && record.hit.is_pixel_hit) continue;
+        const PositionXY delta = methods[i].delta(record);
+        MethodResolution& resolution = fMethods[i];
+        if (!std::isnan(delta.x)) resolution.x.Add(delta.x);
+        if (!std::isnan(delta.y)) resolution.y.Add(delta.y);
+        if (std::isnan(delta.x) || std::isnan(delta.y)) ++resolution.failures;
+    }
+    ++fEntries;
+}
+
+void ResolutionAccumulable::Merge(const G4VAccumulable& other)
+{
+    const ResolutionAccumulable& worker = static_cast<const ResolutionAccumulable&>(other);
+    for (size_t i = 0; i < fMethods.size(); ++i) {
+        fMethods[i].x.Merge(worker.fMethods[i].x);
+        fMethods[i].y.Merge(worker.fMethods[i].y);
+        fMethods[i].failures += worker.fMethods[i].failures;
+    }
+    fEntries += worker.fEntries;
+}
+
+void ResolutionAccumulable::Reset()
+{
+    for (MethodResolution& method : fMethods) {
+        method.x.Reset();
+        method.y.Reset();
+        method.failures = 0;
+    }
+    fEntries = 0;
+}
+
+void ResolutionAccumulable::PrintSummary() const
+{
+    const G4double um = 1000.0;  // Residuals are in mm
+    G4cout << "\n=== RESOLUTION SUMMARY (" << fEntries << " entries, residuals in um) ===" << G4endl;
+    G4cout << std::left << std::setw(24) << "Method" << std::right
+           << std::setw(5) << "Axis" << std::setw(10) << "N" << std::setw(10) << "Failed"
+           << std::setw(10) << "Bias" << std::setw(10) << "Sigma" << std::setw(10) << "RMS"
+           << std::setw(10) << "Q16" << std::setw(10) << "Median" << std::setw(10) << "Q84" << G4endl;
+    for (const MethodResolution& method : fMethods) {
+        const ResidualStatistics* axes[2] = {&method.x, &method.y};
+        for (G4int axis = 0; axis < 2; ++axis) {
+            const ResidualStatistics& s = *axes[axis];
+            G4cout << std::left << std::setw(24) << (axis == 0 ? method.name : "") << std::right
+                   << std::setw(5) << (axis == 0 ? "X" : "Y") << std::setw(10) << s.n
+                   << std::setw(10) << (axis == 0 ? std::to_string(method.failures) : "")
+                   << std::fixed << std::setprecision(2)
+                   << std::setw(10) << s.mean * um << std::setw(10) << s.StdDev() * um
+                   << std::setw(10) << s.Rms() * um
+                   << std::setw(10) << s.digest.Quantile(kResolutionQuantiles[1]) * um
+                   << std::setw(10) << s.digest.Quantile(kResolutionQuantiles[2]) * um
+                   << std::setw(10) << s.digest.Quantile(kResolutionQuantiles[3]) * um
+                   << std::defaultfloat << G4endl;
+        }
+    }
+}
+
+G4bool ResolutionAccumulable::WriteText(const std::string& fileName) const
+{
+    std::ofstream out(fileName);
+    if (!out.is_open()) {
+        G4cerr << "ResolutionSummary: Cannot write " << fileName << G4endl;
+        return false;
+    }
+    out << "# Online resolution summary, " << fEntries << " entries, residuals (reconstructed - true) in mm\n";
+    out << "# Method Axis N Failures Mean StdDev RMS";
+    for (const char* name : kResolutionQuantileNames) {
+        out << " " << name;
+    }
+    out << "\n" << std::setprecision(9);
+    for (const MethodResolution& method : fMethods) {
+        const ResidualStatistics* axes[2] = {&method.x, &method.y};
+        for (G4int axis = 0; axis < 2; ++axis) {
+            const ResidualStatistics& s = *axes[axis];
+            out << method.name << " " << (axis == 0 ? "X" : "Y") << " " << s.n << " " << method.failures
+                << " " << s.mean << " " << s.StdDev() << " " << s.Rms();
+            for (G4double q : kResolutionQuantiles) {
+                out << " " << s.digest.Quantile(q);
+            }
+            out << "\n";
+        }
+    }
+    return true;
+}
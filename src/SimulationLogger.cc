@@ -5,10 +5,13 @@
 #include "3DGaussianFitCeres.hh"
 #include "3DLorentzianFitCeres.hh"
 #include "3DPowerLorentzianFitCeres.hh"
+#include "Constants.hh"
+#include "EventArena.hh"
 #include "G4SystemOfUnits.hh"
 
 #include <iostream>
 #include <iomanip>
+#include <cmath>
 #include <sstream>
 #include <filesystem>
 #include <ctime>
@@ -44,7 +47,28 @@ SimulationLogger::SimulationLogger()
       fTotalFits(0),
       fSuccessfulFits(0),
       fFailedFits(0),
-      fTotalFittingTime(0.0)
+      fTotalFittingTime(0.0),
+      fROIEvents(0),
+      fROICandidatePads(0),
+      fROISelectedPads(0),
+      fSolverFits(0),
+      fSolverSolves(0),
+      fSolverIterations(0),
+      fSolverFallbacks(0),
+      fReferenceFits(0),
+      fReferenceSolves(0),
+      fReferenceIterations(0),
+      fReferenceFallbacks(0),
+      fBatchedFitBatches(0),
+      fBatchedFits(0),
+      fBatchedFitsConverged(0),
+      fBatchedFitTime(0.0),
+      fAllocationEvents(0),
+      fHeapAllocations(0),
+      fMaxHeapAllocations(0),
+      fZeroHeapAllocationEvents(0),
+      fArenaBytes(0),
+      fArenaOverflows(0)
 {
 }
 
@@ -154,9 +178,14 @@ void SimulationLogger::LogSimulationEnd() {
     WriteToMainLog("INFO", "Total simulation time: " + std::to_string(duration.count()) + " seconds");
     WriteToMainLog("INFO", "Timestamp: " + GetTimestamp());
     
-    // Log final statistics
+    // Log final statistics: the fitting time covers every timed fit, so average over the same fits
+    G4int timedFits = 0;
+    for (const auto& entry : fFitTypeCounters) {
+        timedFits += entry.second;
+    }
     LogEventStatistics(fTotalEvents, fSuccessfulFits, fFailedFits, 
-                      fTotalFittingTime / fTotalFits, fTotalFittingTime);
+                      timedFits > 0 ? fTotalFittingTime / timedFits : 0.0, fTotalFittingTime);
+    LogFitTimingSummary();
 }
 
 void SimulationLogger::LogRunStart(G4int runID, G4int totalEvents) {
@@ -601,6 +630,202 @@ void SimulationLogger::LogConvergenceStatistics(const std::string& fitType, G4in
     }
 }
 
+void SimulationLogger::RecordFitTiming(const std::string& fitType, G4double fittingTime,
+                                       G4int numPoints, G4bool converged) {
+    std::lock_guard<std::mutex> lock(fLogMutex);
+    
+    fTotalFittingTime += fittingTime;
+    fFitTypeTimings[fitType] += fittingTime;
+    fFitTypeCounters[fitType]++;
+    fFitTypePointCounts[fitType] += numPoints;
+    if (converged) {
+        fConvergenceCounters[fitType]++;
+    }
+}
+
+void SimulationLogger::RecordRegionOfInterest(G4int candidatePads, G4int selectedPads) {
+    std::lock_guard<std::mutex> lock(fLogMutex);
+    
+    fROIEvents++;
+    fROICandidatePads += candidatePads;
+    fROISelectedPads += selectedPads;
+}
+
+void SimulationLogger::RecordCoarseToFineStage(const std::string& fitType, G4int stage, G4double fittingTime,
+                                               G4double referenceTime) {
+    std::lock_guard<std::mutex> lock(fLogMutex);
+    
+    CoarseToFineStats& stats = fCoarseToFineStats[fitType];
+    if (stage >= 0 && stage < 4) {
+        stats.stageCounts[stage]++;
+    }
+    stats.totalTime += fittingTime;
+    if (referenceTime >= 0) {
+        stats.referenceSamples++;
+        stats.sampledTime += fittingTime;
+        stats.referenceTime += referenceTime;
+    }
+}
+
+void SimulationLogger::RecordSolverStatistics(G4long fits, G4long solves, G4long iterations, G4long fallbacks) {
+    std::lock_guard<std::mutex> lock(fLogMutex);
+    
+    fSolverFits += fits;
+    fSolverSolves += solves;
+    fSolverIterations += iterations;
+    fSolverFallbacks += fallbacks;
+}
+
+void SimulationLogger::RecordRawFrameReferenceStatistics(G4long fits, G4long solves, G4long iterations, G4long fallbacks) {
+    std::lock_guard<std::mutex> lock(fLogMutex);
+    
+    fReferenceFits += fits;
+    fReferenceSolves += solves;
+    fReferenceIterations += iterations;
+    fReferenceFallbacks += fallbacks;
+}
+
+void SimulationLogger::RecordBatchedFits(G4long fits, G4long converged, G4double fittingTime) {
+    std::lock_guard<std::mutex> lock(fLogMutex);
+    
+    fBatchedFitBatches++;
+    fBatchedFits += fits;
+    fBatchedFitsConverged += converged;
+    fBatchedFitTime += fittingTime;
+}
+
+void SimulationLogger::RecordEventAllocations(G4long heapAllocations, G4long arenaBytes, G4long arenaOverflows) {
+    std::lock_guard<std::mutex> lock(fLogMutex);
+    
+    fAllocationEvents++;
+    if (heapAllocations >= 0) {
+        fHeapAllocations += heapAllocations;
+        fMaxHeapAllocations = std::max(fMaxHeapAllocations, heapAllocations);
+        if (heapAllocations == 0) {
+            fZeroHeapAllocationEvents++;
+        }
+    }
+    fArenaBytes += arenaBytes;
+    fArenaOverflows += arenaOverflows;
+}
+
+// Per-model fit cost vs number of fitted points; compare runs with ENABLE_ADAPTIVE_ROI on/off
+// for time saved, and the ROISelectedPads branch vs fit deltas for the resolution change
+void SimulationLogger::LogFitTimingSummary() {
+    if (!fStatsLog) {
+        return;
+    }
+    
+    *fStatsLog << "\n=== FIT TIMING BY MODEL ===\n";
+    *fStatsLog << "Adaptive ROI: " << (Constants::ENABLE_ADAPTIVE_ROI ? "ENABLED" : "DISABLED");
+    if (Constants::ENABLE_ADAPTIVE_ROI) {
+        if (Constants::ROI_TOP_K_PADS > 0) {
+            *fStatsLog << " (top " << Constants::ROI_TOP_K_PADS << " pads)";
+        } else {
+            *fStatsLog << " (threshold " << Constants::ROI_RELATIVE_CHARGE_THRESHOLD << " of max charge)";
+        }
+    }
+    *fStatsLog << "\n";
+    if (fROIEvents > 0) {
+        *fStatsLog << "Average Pads per Event: " << std::fixed << std::setprecision(1)
+                   << (G4double)fROICandidatePads / fROIEvents << " candidate, "
+                   << (G4double)fROISelectedPads / fROIEvents << " fitted\n";
+    }
+    for (const auto& entry : fFitTypeCounters) {
+        const std::string& fitType = entry.first;
+        G4int fits = entry.second;
+        if (fits <= 0) continue;
+        *fStatsLog << fitType << ": " << fits << " fits"
+                   << ", avg time " << std::setprecision(3) << fFitTypeTimings[fitType] / fits << " ms"
+                   << ", avg points " << std::setprecision(1) << (G4double)fFitTypePointCounts[fitType] / fits
+                   << ", converged " << 100.0 * fConvergenceCounters[fitType] / fits << "%"
+                   << ", total " << std::setprecision(1) << fFitTypeTimings[fitType] << " ms\n";
+    }
+    if (Constants::ENABLE_COARSE_TO_FINE_3D) {
+        G4int coreSize = 2 * Constants::COARSE_TO_FINE_CORE_RADIUS + 1;
+        *fStatsLog << "Coarse-to-fine 3D: core " << coreSize << "x" << coreSize
+                   << ", refinement skipped at full-grid chi2red <= " << Constants::COARSE_TO_FINE_SKIP_CHI2
+                   << ", max " << Constants::COARSE_TO_FINE_REFINE_ITERATIONS << " refinement iterations\n";
+        for (const auto& entry : fCoarseToFineStats) {
+            const CoarseToFineStats& stats = entry.second;
+            G4long fits = stats.stageCounts[0] + stats.stageCounts[1] + stats.stageCounts[2] + stats.stageCounts[3];
+            if (fits <= 0) continue;
+            *fStatsLog << entry.first << ": core covers grid " << std::setprecision(1) << 100.0 * stats.stageCounts[0] / fits << "%"
+                       << ", core only " << 100.0 * stats.stageCounts[1] / fits << "%"
+                       << ", core + refinement " << 100.0 * stats.stageCounts[2] / fits << "%"
+                       << ", full-grid fallback " << 100.0 * stats.stageCounts[3] / fits << "%"
+                       << ", avg time " << std::setprecision(3) << stats.totalTime / fits << " ms\n";
+            if (stats.referenceSamples > 0) {
+                G4double savedPerEvent = (stats.referenceTime - stats.sampledTime) / stats.referenceSamples;
+                *fStatsLog << "  " << stats.referenceSamples << " sampled events: full grid "
+                           << stats.referenceTime / stats.referenceSamples << " ms vs coarse-to-fine "
+                           << stats.sampledTime / stats.referenceSamples << " ms, saved "
+                           << savedPerEvent << " ms per event\n";
+            }
+        }
+    }
+    *fStatsLog << "===========================\n\n";
+    
+    // The raw-frame reference re-solves a sample of the same fits without the pitch/charge rescaling,
+    // so iterations per fit and fallback rate before/after the normalized frame come from one run
+    if (fSolverFits > 0) {
+        *fStatsLog << "=== CERES SOLVER WORK ===\n";
+        *fStatsLog << "Normalized fit frame: " << (Constants::ENABLE_NORMALIZED_FIT_FRAME ? "ENABLED" : "DISABLED") << "\n";
+        *fStatsLog << "Fits: " << fSolverFits << ", solves: " << fSolverSolves
+                   << ", iterations: " << fSolverIterations << "\n";
+        *fStatsLog << "Solves per fit: " << std::setprecision(2) << (G4double)fSolverSolves / fSolverFits
+                   << ", iterations per solve: "
+                   << (fSolverSolves > 0 ? (G4double)fSolverIterations / fSolverSolves : 0.0)
+                   << ", fallback rate: " << std::setprecision(1) << 100.0 * fSolverFallbacks / fSolverFits << "%\n";
+        if (fReferenceFits > 0) {
+            *fStatsLog << "Raw-frame reference (1 in " << Constants::NORMALIZED_FRAME_REFERENCE_INTERVAL
+                       << " fits, same data): fits: " << fReferenceFits << ", solves: " << fReferenceSolves
+                       << ", iterations: " << fReferenceIterations << "\n";
+            *fStatsLog << "Iterations per fit: normalized " << std::setprecision(2) << (G4double)fSolverIterations / fSolverFits
+                       << ", raw " << (G4double)fReferenceIterations / fReferenceFits
+                       << "; fallback rate: normalized " << std::setprecision(1) << 100.0 * fSolverFallbacks / fSolverFits
+                       << "%, raw " << 100.0 * fReferenceFallbacks / fReferenceFits << "%\n";
+        }
+        *fStatsLog << "=========================\n\n";
+    }
+    
+    // Fit time is summed over worker threads, so fits per second here is per core
+    if (fBatchedFits > 0 && fBatchedFitTime > 0) {
+        G4double batchedRate = 1000.0 * fBatchedFits / fBatchedFitTime;
+        *fStatsLog << "=== BATCHED GAUSSIAN FITS ===\n";
+        *fStatsLog << "Batches: " << fBatchedFitBatches << ", fits: " << fBatchedFits
+                   << " (" << std::fixed << std::setprecision(1) << (G4double)fBatchedFits / fBatchedFitBatches << " per batch)"
+                   << ", converged " << 100.0 * fBatchedFitsConverged / fBatchedFits << "%\n";
+        *fStatsLog << "Batched throughput: " << std::setprecision(0) << batchedRate << " fits/s per core\n";
+        auto perEvent = fFitTypeTimings.find("Gaussian2D");
+        if (perEvent != fFitTypeTimings.end() && perEvent->second > 0) {
+            // Each per-event Gaussian2D call fits the row and the column
+            G4double perEventRate = 1000.0 * 2.0 * fFitTypeCounters["Gaussian2D"] / perEvent->second;
+            *fStatsLog << "Per-event throughput: " << perEventRate << " fits/s per core"
+                       << ", speed-up " << std::setprecision(2) << batchedRate / perEventRate << "x\n";
+        }
+        *fStatsLog << "=============================\n\n";
+    }
+    
+    // Compare runs with ENABLE_EVENT_ARENA on/off for the heap calls the arena removes
+    if (fAllocationEvents > 0) {
+        *fStatsLog << "=== PER-EVENT ALLOCATIONS ===\n";
+        *fStatsLog << "Event arena: " << (Constants::ENABLE_EVENT_ARENA ? "ENABLED" : "DISABLED") << "\n";
+        if (HeapAllocationsCounted()) {
+            *fStatsLog << "Heap allocations per event: " << std::fixed << std::setprecision(1)
+                       << (G4double)fHeapAllocations / fAllocationEvents << " (max " << fMaxHeapAllocations
+                       << ", zero in " << 100.0 * fZeroHeapAllocationEvents / fAllocationEvents << "% of events)\n";
+        } else {
+            *fStatsLog << "Heap allocations per event: not counted (configure with -DCOUNT_HEAP_ALLOCATIONS=ON, "
+                       << "or run under heaptrack)\n";
+        }
+        *fStatsLog << "Arena bytes per event: " << std::fixed << std::setprecision(0) << (G4double)fArenaBytes / fAllocationEvents
+                   << ", overflow chunks: " << fArenaOverflows << "\n";
+        *fStatsLog << "=============================\n\n";
+    }
+    fStatsLog->flush();
+}
+
 void SimulationLogger::LogCrashInfo(const std::string& signal, G4int eventID, const std::string& additionalInfo) {
     std::ostringstream oss;
     oss << "\n=== CRASH DETECTED ===\n";
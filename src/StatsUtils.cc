@@ -304,4 +304,222 @@ std::tuple<std::vector<double>, std::vector<double>, std::vector<double>> Filter
     }
     
     return std::make_tuple(filtered_x, filtered_y, filtered_z);
-} 
\ No newline at end of file
+} 
+// Order statistics on a small scratch buffer with nth_element (datasets are 9-49 points, so a
+// few linear partitions beat a full sort); matches sorted[n/4], the median and sorted[3n/4]
+static void ComputeDatasetStatistics(DatasetAnalysis& analysis) {
+    analysis.valid = false;
+    const std::vector<double>& charges = *analysis.charges;
+    const std::vector<size_t>& indices = analysis.indices;
+    const size_t n = indices.size();
+    if (n == 0) {
+        return;
+    }
+    
+    std::vector<double> buffer;
+    buffer.reserve(n);
+    double sum = 0.0;
+    for (size_t idx : indices) {
+        buffer.push_back(charges[idx]);
+        sum += charges[idx];
+    }
+    
+    // Min, max, mean and standard deviation in one pass each
+    auto minmax_result = std::minmax_element(buffer.begin(), buffer.end());
+    analysis.min_val = *minmax_result.first;
+    analysis.max_val = *minmax_result.second;
+    analysis.mean = sum / n;
+    
+    double variance = 0.0;
+    for (double val : buffer) {
+        variance += (val - analysis.mean) * (val - analysis.mean);
+    }
+    analysis.std_dev = std::sqrt(variance / n);
+    
+    // Median and quartiles: partition at n/2, then select the quartiles within each half
+    const size_t mid = n / 2;
+    std::nth_element(buffer.begin(), buffer.begin() + mid, buffer.end());
+    const double upper_median = buffer[mid];
+    if (n % 2 == 0) {
+        analysis.median = 0.5 * (*std::max_element(buffer.begin(), buffer.begin() + mid) + upper_median);
+    } else {
+        analysis.median = upper_median;
+    }
+    
+    const size_t q25_index = n / 4;
+    const size_t q75_index = 3 * n / 4;
+    if (q25_index < mid) {
+        std::nth_element(buffer.begin(), buffer.begin() + q25_index, buffer.begin() + mid);
+    }
+    analysis.q25 = buffer[q25_index];
+    if (q75_index > mid) {
+        std::nth_element(buffer.begin() + mid + 1, buffer.begin() + q75_index, buffer.end());
+    }
+    analysis.q75 = buffer[q75_index];
+    
+    // Median absolute deviation, reusing the buffer
+    for (double& val : buffer) {
+        val = std::abs(val - analysis.median);
+    }
+    std::nth_element(buffer.begin(), buffer.begin() + mid, buffer.end());
+    double mad_raw = buffer[mid];
+    if (n % 2 == 0) {
+        mad_raw = 0.5 * (mad_raw + *std::max_element(buffer.begin(), buffer.begin() + mid));
+    }
+    analysis.mad = mad_raw * 1.4826; // Consistency factor for normal distribution
+    
+    // Numerical stability safeguard
+    if (!std::isfinite(analysis.mad) || analysis.mad < 1e-12) {
+        analysis.mad = (std::isfinite(analysis.std_dev) && analysis.std_dev > 1e-12) ?
+                       analysis.std_dev : 1e-12;
+    }
+    
+    // Weighted position moments (charges above Q1 as weights)
+    const std::vector<double>& x_vals = *analysis.x_vals;
+    const std::vector<double>* y_vals = analysis.y_vals;
+    analysis.weighted_mean_x = 0.0;
+    analysis.weighted_mean_y = 0.0;
+    analysis.total_weight = 0.0;
+    double sum_x = 0.0;
+    double sum_y = 0.0;
+    for (size_t idx : indices) {
+        sum_x += x_vals[idx];
+        if (y_vals) sum_y += (*y_vals)[idx];
+        double weight = std::max(0.0, charges[idx] - analysis.q25);
+        if (weight > 0) {
+            analysis.weighted_mean_x += x_vals[idx] * weight;
+            if (y_vals) analysis.weighted_mean_y += (*y_vals)[idx] * weight;
+            analysis.total_weight += weight;
+        }
+    }
+    
+    if (analysis.total_weight > 0) {
+        analysis.weighted_mean_x /= analysis.total_weight;
+        analysis.weighted_mean_y /= analysis.total_weight;
+    } else {
+        analysis.weighted_mean_x = sum_x / n;
+        analysis.weighted_mean_y = sum_y / n;
+    }
+    
+    analysis.valid = true;
+}
+
+static DatasetAnalysis AnalyzeAllPoints(const std::vector<double>& x_vals,
+                                        const std::vector<double>* y_vals,
+                                        const std::vector<double>& charges) {
+    DatasetAnalysis analysis;
+    analysis.x_vals = &x_vals;
+    analysis.y_vals = y_vals;
+    analysis.charges = &charges;
+    
+    if (x_vals.size() != charges.size() || (y_vals && y_vals->size() != charges.size())) {
+        return analysis;
+    }
+    
+    analysis.indices.resize(charges.size());
+    std::iota(analysis.indices.begin(), analysis.indices.end(), 0);
+    ComputeDatasetStatistics(analysis);
+    return analysis;
+}
+
+DatasetAnalysis AnalyzeDataset(const std::vector<double>& x_vals,
+                               const std::vector<double>& charges) {
+    return AnalyzeAllPoints(x_vals, nullptr, charges);
+}
+
+DatasetAnalysis AnalyzeDataset(const std::vector<double>& x_vals,
+                               const std::vector<double>& y_vals,
+                               const std::vector<double>& charges) {
+    return AnalyzeAllPoints(x_vals, &y_vals, charges);
+}
+
+DatasetAnalysis AnalyzeSubset(const DatasetAnalysis& parent, const std::vector<size_t>& indices) {
+    if (indices == parent.indices) {
+        return parent;
+    }
+    
+    DatasetAnalysis analysis;
+    analysis.x_vals = parent.x_vals;
+    analysis.y_vals = parent.y_vals;
+    analysis.charges = parent.charges;
+    analysis.indices = indices;
+    ComputeDatasetStatistics(analysis);
+    return analysis;
+}
+
+std::vector<size_t> SelectOutlierFreeIndices(const DatasetAnalysis& analysis,
+                                             double sigma_threshold,
+                                             double relaxed_threshold,
+                                             size_t min_points,
+                                             bool verbose) {
+    if (!analysis.valid) {
+        return analysis.indices;
+    }
+    
+    const std::vector<double>& charges = *analysis.charges;
+    auto select = [&](double threshold) {
+        std::vector<size_t> kept;
+        kept.reserve(analysis.indices.size());
+        double upper = analysis.median + threshold * analysis.mad;
+        double lower = analysis.median - threshold * analysis.mad;
+        for (size_t idx : analysis.indices) {
+            if (charges[idx] >= lower && charges[idx] <= upper) {
+                kept.push_back(idx);
+            }
+        }
+        return kept;
+    };
+    
+    std::vector<size_t> kept = select(sigma_threshold);
+    size_t outliers_removed = analysis.indices.size() - kept.size();
+    
+    if (kept.size() < analysis.indices.size() / 2) {
+        if (verbose) {
+            std::cout << "Too many outliers detected (" << outliers_removed
+                     << "), relaxing to " << relaxed_threshold << " sigma" << std::endl;
+        }
+        kept = select(relaxed_threshold);
+    }
+    
+    if (kept.size() < min_points) {
+        if (verbose) {
+            std::cout << "Warning: After outlier filtering, only " << kept.size()
+                     << " points remain, keeping all points" << std::endl;
+        }
+        return analysis.indices;
+    }
+    
+    if (verbose && outliers_removed > 0) {
+        std::cout << "Removed " << analysis.indices.size() - kept.size() << " outliers, "
+                 << kept.size() << " points remaining" << std::endl;
+    }
+    return kept;
+}
+
+void GatherDataset(const DatasetAnalysis& analysis,
+                   ArenaDoubleVector& x_out,
+                   ArenaDoubleVector& charge_out) {
+    x_out.clear();
+    charge_out.clear();
+    x_out.reserve(analysis.indices.size());
+    charge_out.reserve(analysis.indices.size());
+    for (size_t idx : analysis.indices) {
+        x_out.push_back((*analysis.x_vals)[idx]);
+        charge_out.push_back((*analysis.charges)[idx]);
+    }
+}
+
+void GatherDataset(const DatasetAnalysis& analysis,
+                   ArenaDoubleVector& x_out,
+                   ArenaDoubleVector& y_out,
+                   ArenaDoubleVector& charge_out) {
+    GatherDataset(analysis, x_out, charge_out);
+    y_out.clear();
+    if (!analysis.y_vals) {
+        return;
+    }
+    y_out.reserve(analysis.indices.size());
+    for (size_t idx : analysis.indices) {
+        y_out.push_back((*analysis.y_vals)[idx]);
+    }
+}
@@ -0,0 +1,25 @@
+#include "3DSymmetricFitCeres.hh"
+#include "Constants.hh"
+
+// Model bookkeeping shared by the fitter, the output branches and the derived-quantity stage.
+// Kept apart from the Ceres fit so code that only needs the labels and flags does not pull in the solver
+
+bool IsSymmetric3DModelEnabled(Symmetric3DModel model) {
+    switch (model) {
+        case Symmetric3DModel::ISOTROPIC_GAUSSIAN: return Constants::ENABLE_3D_GAUSSIAN_ISOTROPIC_FITTING;
+        case Symmetric3DModel::ISOTROPIC_LORENTZIAN: return Constants::ENABLE_3D_LORENTZIAN_ISOTROPIC_FITTING;
+        case Symmetric3DModel::ISOTROPIC_POWER_LORENTZIAN: return Constants::ENABLE_3D_POWER_LORENTZIAN_ISOTROPIC_FITTING;
+        case Symmetric3DModel::RADIAL_CHARGE_SHARING: return Constants::ENABLE_3D_RADIAL_FITTING;
+    }
+    return false;
+}
+
+const char* GetSymmetric3DModelLabel(Symmetric3DModel model) {
+    switch (model) {
+        case Symmetric3DModel::ISOTROPIC_GAUSSIAN: return "3DGaussianIso";
+        case Symmetric3DModel::ISOTROPIC_LORENTZIAN: return "3DLorentzianIso";
+        case Symmetric3DModel::ISOTROPIC_POWER_LORENTZIAN: return "3DPowerLorentzianIso";
+        case Symmetric3DModel::RADIAL_CHARGE_SHARING: return "3DRadialChargeSharing";
+    }
+    return "3DSymmetric";
+}
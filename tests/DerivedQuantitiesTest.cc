@@ -0,0 +1,273 @@
+// Bitwise equivalence of ComputeDerivedQuantities with the per-branch derived-quantity code it
+// replaced (RunAction::UpdateDerivedQuantities and its helpers, kept below as the reference).
+// Randomized records are filled the way EventAction fills them: only the fits enabled in Constants
+// leave the sentinel state. Both implementations run on copies of each record and the whole
+// records, padding included, must compare equal byte for byte.
+
+#include "EventRecord.hh"
+#include "Constants.hh"
+
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace {
+
+// =============================================
+// REFERENCE: DERIVED QUANTITIES BEFORE THE SINGLE STAGE
+// =============================================
+// Verbatim apart from taking the record as an argument and dropping the invalid-truth warnings
+
+void ReferenceTransformedDiagonalCoordinates(const HitRecord& hit, ProfileModelRecord& model)
+{
+    // Safety check for valid true position data
+    if (std::isnan(hit.true_x) || std::isnan(hit.true_y)) {
+        return;
+    }
+
+    const double NaN = std::numeric_limits<G4double>::quiet_NaN();
+    const double invSqrt2 = 1.0 / 1.4142135623730951; // 1/√2
+
+    auto setXY = [&](double xPred, double yPred,
+                     double &outX, double &outY,
+                     double &deltaX, double &deltaY)
+    {
+        outX   = xPred;
+        outY   = yPred;
+        deltaX = std::isnan(xPred) ? NaN : (xPred - hit.true_x);
+        deltaY = std::isnan(yPred) ? NaN : (yPred - hit.true_y);
+    };
+
+    // Diagonal fits return the position along the diagonal; prefer the X projection, fall back to Y
+    auto diagonalPosition = [&](const ProfileFitRecord& xFit, const ProfileFitRecord& yFit) {
+        if (xFit.dof > 0) return xFit.center;
+        if (yFit.dof > 0) return yFit.center;
+        return NaN;
+    };
+
+    // Main diagonal (θ = 45°)
+    double sMain = diagonalPosition(model.main_diag_x, model.main_diag_y);
+    if (!std::isnan(sMain)) {
+        setXY(hit.pixel_x + sMain*invSqrt2, hit.pixel_y + sMain*invSqrt2,
+              model.main_diag_transformed_x, model.main_diag_transformed_y,
+              model.main_diag_transformed_delta_x, model.main_diag_transformed_delta_y);
+    } else {
+        setXY(NaN, NaN,
+              model.main_diag_transformed_x, model.main_diag_transformed_y,
+              model.main_diag_transformed_delta_x, model.main_diag_transformed_delta_y);
+    }
+
+    // Secondary diagonal (θ = -45°)
+    double sSec = diagonalPosition(model.second_diag_x, model.second_diag_y);
+    if (!std::isnan(sSec)) {
+        setXY(hit.pixel_x + sSec*invSqrt2, hit.pixel_y - sSec*invSqrt2,
+              model.second_diag_transformed_x, model.second_diag_transformed_y,
+              model.second_diag_transformed_delta_x, model.second_diag_transformed_delta_y);
+    } else {
+        setXY(NaN, NaN,
+              model.second_diag_transformed_x, model.second_diag_transformed_y,
+              model.second_diag_transformed_delta_x, model.second_diag_transformed_delta_y);
+    }
+}
+
+void ReferenceMeanEstimations(const HitRecord& hit, ProfileModelRecord& model, const SurfaceFitRecord& surface)
+{
+    // Safety check for valid true position data
+    if (std::isnan(hit.true_x) || std::isnan(hit.true_y)) {
+        model.mean_true_delta_x = std::numeric_limits<G4double>::quiet_NaN();
+        model.mean_true_delta_y = std::numeric_limits<G4double>::quiet_NaN();
+        return;
+    }
+
+    // Collect valid coordinate estimations:
+    // ONLY use transformed diagonal coordinates (exclude row/column fits) and the matching 3D fit
+    std::vector<G4double> x_coords, y_coords;
+    if (!std::isnan(model.main_diag_transformed_x)) {
+        x_coords.push_back(model.main_diag_transformed_x);
+    }
+    if (!std::isnan(model.second_diag_transformed_x)) {
+        x_coords.push_back(model.second_diag_transformed_x);
+    }
+    if (!std::isnan(model.main_diag_transformed_y)) {
+        y_coords.push_back(model.main_diag_transformed_y);
+    }
+    if (!std::isnan(model.second_diag_transformed_y)) {
+        y_coords.push_back(model.second_diag_transformed_y);
+    }
+    if (!std::isnan(surface.center_x) && surface.successful) {
+        x_coords.push_back(surface.center_x);
+    }
+    if (!std::isnan(surface.center_y) && surface.successful) {
+        y_coords.push_back(surface.center_y);
+    }
+
+    // Mean coordinate estimation minus true position (NaN without any estimation)
+    auto meanDelta = [](const std::vector<G4double>& coords, G4double truth) {
+        if (coords.empty()) {
+            return std::numeric_limits<G4double>::quiet_NaN();
+        }
+        G4double sum = 0.0;
+        for (const auto& coord : coords) {
+            sum += coord;
+        }
+        return sum / coords.size() - truth;
+    };
+    model.mean_true_delta_x = meanDelta(x_coords, hit.true_x);
+    model.mean_true_delta_y = meanDelta(y_coords, hit.true_y);
+}
+
+void ReferenceDerivedQuantities(EventRecord& record)
+{
+    const HitRecord& hit = record.hit;
+    const G4double NaN = std::numeric_limits<G4double>::quiet_NaN();
+
+    // Row and column deltas vs true position: overall fit successful and the projection has dof
+    for (ProfileModelRecord* model : {&record.gauss, &record.lorentz, &record.power_lorentz}) {
+        model->row_delta_x = (model->row_column_successful && model->row.dof > 0)
+                             ? model->row.center - hit.true_x : NaN;
+        model->column_delta_y = (model->row_column_successful && model->column.dof > 0)
+                                ? model->column.center - hit.true_y : NaN;
+    }
+
+    // 3D, joint and symmetric fit deltas (NaN for failed fits)
+    for (SurfaceFitRecord* surface : {&record.gauss_3d, &record.lorentz_3d, &record.power_lorentz_3d}) {
+        const G4bool valid = surface->successful && surface->dof > 0;
+        surface->delta_x = valid ? surface->center_x - hit.true_x : NaN;
+        surface->delta_y = valid ? surface->center_y - hit.true_y : NaN;
+    }
+
+    JointFitRecord& joint = record.joint;
+    const G4bool jointValid = joint.successful && joint.dof > 0;
+    joint.delta_x = jointValid ? joint.center_x - hit.true_x : NaN;
+    joint.delta_y = jointValid ? joint.center_y - hit.true_y : NaN;
+
+    for (SymmetricFitRecord& symmetric : record.symmetric) {
+        const G4bool valid = symmetric.successful && symmetric.dof > 0;
+        symmetric.delta_x = valid ? symmetric.center_x - hit.true_x : NaN;
+        symmetric.delta_y = valid ? symmetric.center_y - hit.true_y : NaN;
+    }
+
+    // Diagonal centers rotated back to x/y, then the per-model mean estimators
+    ReferenceTransformedDiagonalCoordinates(hit, record.gauss);
+    ReferenceTransformedDiagonalCoordinates(hit, record.lorentz);
+    ReferenceTransformedDiagonalCoordinates(hit, record.power_lorentz);
+    ReferenceMeanEstimations(hit, record.gauss, record.gauss_3d);
+    ReferenceMeanEstimations(hit, record.lorentz, record.lorentz_3d);
+    ReferenceMeanEstimations(hit, record.power_lorentz, record.power_lorentz_3d);
+}
+
+// =============================================
+// RANDOMIZED RECORDS
+// =============================================
+
+class RecordGenerator {
+public:
+    explicit RecordGenerator(unsigned long seed) : fEngine(seed) {}
+
+    // Copy of the template with the enabled fits filled: centers within a few pitches, occasionally
+    // NaN, failed or without degrees of freedom; the true position is occasionally NaN
+    void Fill(EventRecord& record) {
+        std::memcpy(&record, &GetEventRecordTemplate(), sizeof(EventRecord));
+        HitRecord& hit = record.hit;
+        hit.true_x = MaybeNaN(Position(), 0.01);
+        hit.true_y = MaybeNaN(Position(), 0.01);
+        hit.pixel_x = Position();
+        hit.pixel_y = Position();
+
+        const G4bool profiles[3] = {Constants::ENABLE_GAUSSIAN_FITTING, Constants::ENABLE_LORENTZIAN_FITTING,
+                                    Constants::ENABLE_POWER_LORENTZIAN_FITTING};
+        ProfileModelRecord* models[3] = {&record.gauss, &record.lorentz, &record.power_lorentz};
+        const G4bool surfaces[3] = {Constants::ENABLE_3D_GAUSSIAN_FITTING, Constants::ENABLE_3D_LORENTZIAN_FITTING,
+                                    Constants::ENABLE_3D_POWER_LORENTZIAN_FITTING};
+        SurfaceFitRecord* surfaceFits[3] = {&record.gauss_3d, &record.lorentz_3d, &record.power_lorentz_3d};
+        for (G4int i = 0; i < 3; ++i) {
+            if (profiles[i]) {
+                ProfileModelRecord& model = *models[i];
+                model.row_column_successful = Chance(0.9);
+                FillProfileFit(model.row);
+                FillProfileFit(model.column);
+                if (Constants::ENABLE_DIAGONAL_FITTING) {
+                    FillProfileFit(model.main_diag_x);
+                    FillProfileFit(model.main_diag_y);
+                    FillProfileFit(model.second_diag_x);
+                    FillProfileFit(model.second_diag_y);
+                }
+            }
+            if (surfaces[i]) {
+                SurfaceFitRecord& surface = *surfaceFits[i];
+                surface.successful = Chance(0.9);
+                surface.dof = Dof();
+                surface.center_x = MaybeNaN(Position(), 0.02);
+                surface.center_y = MaybeNaN(Position(), 0.02);
+            }
+        }
+
+        if (Constants::ENABLE_JOINT_PROFILE_FITTING) {
+            record.joint.successful = Chance(0.9);
+            record.joint.dof = Dof();
+            record.joint.center_x = MaybeNaN(Position(), 0.02);
+            record.joint.center_y = MaybeNaN(Position(), 0.02);
+        }
+        for (G4int model = 0; model < kNumSymmetric3DModels; ++model) {
+            if (!IsSymmetric3DModelEnabled(static_cast<Symmetric3DModel>(model))) continue;
+            SymmetricFitRecord& symmetric = record.symmetric[model];
+            symmetric.successful = Chance(0.9);
+            symmetric.dof = Dof();
+            symmetric.center_x = MaybeNaN(Position(), 0.02);
+            symmetric.center_y = MaybeNaN(Position(), 0.02);
+        }
+    }
+
+private:
+    G4double Position() { return std::uniform_real_distribution<G4double>(-2.0, 2.0)(fEngine); }
+    G4bool Chance(G4double p) { return std::uniform_real_distribution<G4double>(0.0, 1.0)(fEngine) < p; }
+    G4int Dof() { return Chance(0.1) ? 0 : std::uniform_int_distribution<G4int>(1, 20)(fEngine); }
+    G4double MaybeNaN(G4double value, G4double p) {
+        return Chance(p) ? std::numeric_limits<G4double>::quiet_NaN() : value;
+    }
+
+    void FillProfileFit(ProfileFitRecord& fit) {
+        fit.dof = Dof();
+        fit.center = MaybeNaN(Position(), 0.02);
+    }
+
+    std::mt19937_64 fEngine;
+};
+
+} // namespace
+
+int main()
+{
+    const G4int kNumRecords = 200000;
+
+    // Both implementations warn on records without a true position; keep the test output readable
+    std::streambuf* cerrBuffer = std::cerr.rdbuf(nullptr);
+
+    RecordGenerator generator(20260417);
+    EventRecord filled, reference, current;
+    G4int mismatches = 0;
+    G4int firstMismatch = -1;
+    for (G4int i = 0; i < kNumRecords; ++i) {
+        generator.Fill(filled);
+        std::memcpy(&reference, &filled, sizeof(EventRecord));
+        std::memcpy(&current, &filled, sizeof(EventRecord));
+        ReferenceDerivedQuantities(reference);
+        ComputeDerivedQuantities(current);
+        if (std::memcmp(&reference, &current, sizeof(EventRecord)) != 0) {
+            if (firstMismatch < 0) firstMismatch = i;
+            ++mismatches;
+        }
+    }
+
+    std::cerr.rdbuf(cerrBuffer);
+    if (mismatches > 0) {
+        std::cerr << "DerivedQuantitiesTest: " << mismatches << " of " << kNumRecords
+                  << " records differ from the reference (first: " << firstMismatch << ")" << std::endl;
+        return 1;
+    }
+    std::cout << "DerivedQuantitiesTest: " << kNumRecords << " records bit-identical to the reference" << std::endl;
+    return 0;
+}
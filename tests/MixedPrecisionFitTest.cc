@@ -0,0 +1,207 @@
+// Mixed-precision Gaussian line fit (FitGaussian1DMixedPrecision) against a double-precision Ceres
+// solve of the same model, bounds and starting point, as in the cheap stage of FitGaussianCeres.
+// The central rows of random non-pixel hits are generated with the charge sharing kernel (default
+// geometry, radius 4). Reported per path: center resolution (RMS of fitted - true x), time per fit,
+// and for the mixed path the fits that fell back to Ceres. The mixed-path resolution, with those
+// fallbacks, must match the Ceres resolution to kResolutionTolerance (relative).
+
+#include "MixedPrecisionFit.hh"
+#include "NeighborhoodKernel.hh"
+#include "EventArena.hh"
+#include "Constants.hh"
+
+#include "ceres/ceres.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+
+const double kResolutionTolerance = 0.01;
+
+// y(x) = A * exp(-(x - m)^2 / (2 σ^2)) + B, residual divided by the uncertainty
+struct GaussianResidual {
+    GaussianResidual(double x, double y, double uncertainty) : x_(x), y_(y), uncertainty_(uncertainty) {}
+
+    template <typename T>
+    bool operator()(const T* const params, T* residual) const {
+        const T dx = x_ - params[1];
+        residual[0] = (params[0] * ceres::exp(-(dx * dx) / (T(2.0) * params[2] * params[2])) + params[3] - T(y_))
+                      / T(uncertainty_);
+        return true;
+    }
+
+    const double x_;
+    const double y_;
+    const double uncertainty_;
+};
+
+struct LineFit {
+    std::vector<double> x, y;
+    double uncertainty;
+    double initial[4], lower[4], upper[4];
+    double true_x;
+};
+
+// Cheap-stage Ceres solve (DENSE_NORMAL_CHOLESKY, LM, 1e-10 tolerances, 400 iterations)
+bool SolveCeres(const LineFit& fit, double params[4])
+{
+    std::copy(fit.initial, fit.initial + 4, params);
+    ceres::Problem problem;
+    for (size_t i = 0; i < fit.x.size(); ++i) {
+        problem.AddResidualBlock(new ceres::AutoDiffCostFunction<GaussianResidual, 1, 4>(
+                                     new GaussianResidual(fit.x[i], fit.y[i], fit.uncertainty)),
+                                 nullptr, params);
+    }
+    for (int k = 0; k < 4; ++k) {
+        problem.SetParameterLowerBound(params, k, fit.lower[k]);
+        problem.SetParameterUpperBound(params, k, fit.upper[k]);
+    }
+
+    ceres::Solver::Options options;
+    options.linear_solver_type = ceres::DENSE_NORMAL_CHOLESKY;
+    options.trust_region_strategy_type = ceres::LEVENBERG_MARQUARDT;
+    options.function_tolerance = 1e-10;
+    options.gradient_tolerance = 1e-10;
+    options.parameter_tolerance = 1e-15;
+    options.max_num_iterations = 400;
+    options.logging_type = ceres::SILENT;
+    ceres::Solver::Summary summary;
+    ceres::Solve(options, &problem, &summary);
+    return summary.termination_type == ceres::CONVERGENCE && params[0] > 0 && params[2] > 0;
+}
+
+} // namespace
+
+int main()
+{
+    NeighborhoodKernelGeometry geometry;
+    geometry.pixelSize = Constants::DEFAULT_PIXEL_SIZE;
+    geometry.pixelSpacing = Constants::DEFAULT_PIXEL_SPACING;
+    geometry.pixelCornerOffset = Constants::DEFAULT_PIXEL_CORNER_OFFSET;
+    geometry.detSize = Constants::DEFAULT_DETECTOR_SIZE;
+    geometry.numBlocksPerSide = static_cast<G4int>(std::round(
+        (geometry.detSize - 2 * geometry.pixelCornerOffset - geometry.pixelSize) / geometry.pixelSpacing + 1));
+    geometry.d0 = Constants::D0_CHARGE_SHARING * micrometer;
+    geometry.tableRadius = Constants::NEIGHBORHOOD_RADIUS;
+
+    const G4int radius = Constants::NEIGHBORHOOD_RADIUS;
+    const G4int gridSize = 2 * radius + 1;
+    const G4int centerI = geometry.numBlocksPerSide / 2;
+    const G4double spacing = geometry.pixelSpacing;
+    const G4double centerX = -geometry.detSize / 2 + geometry.pixelCornerOffset + geometry.pixelSize / 2
+                             + centerI * spacing;
+
+    // Central rows of hits uniform over one pixel cell, off the pixel pad
+    std::mt19937_64 rng(20260417);
+    std::uniform_real_distribution<G4double> offset(-spacing / 2, spacing / 2);
+    NeighborhoodKernel kernel;
+    std::vector<G4double> distances(gridSize * gridSize), alphas(gridSize * gridSize), weights(gridSize * gridSize);
+    std::vector<LineFit> fits;
+    while (fits.size() < 20000) {
+        const G4double dx = offset(rng);
+        const G4double dy = offset(rng);
+        if (std::abs(dx) <= geometry.pixelSize / 2 && std::abs(dy) <= geometry.pixelSize / 2) continue;
+        kernel.Compute(geometry, centerX + dx, centerX + dy, centerI, centerI, radius,
+                       distances.data(), alphas.data(), weights.data());
+
+        LineFit fit;
+        G4double total = 0.0;
+        for (G4double w : weights) total += std::max(w, 0.0);
+        for (G4int col = 0; col < gridSize; ++col) {
+            fit.x.push_back(centerX + (col - radius) * spacing);
+            fit.y.push_back(weights[col * gridSize + radius] / total);
+        }
+        fit.true_x = centerX + dx;
+
+        // Starting point and bounds as in FitGaussianCeres
+        const double max_y = *std::max_element(fit.y.begin(), fit.y.end());
+        const double min_y = *std::min_element(fit.y.begin(), fit.y.end());
+        double sum_w = 0.0, sum_wx = 0.0;
+        for (size_t i = 0; i < fit.x.size(); ++i) {
+            sum_w += fit.y[i] - min_y;
+            sum_wx += (fit.y[i] - min_y) * fit.x[i];
+        }
+        const double spread = fit.x.back() - fit.x.front();
+        fit.uncertainty = 0.05 * max_y;
+        fit.initial[0] = max_y - min_y;
+        fit.initial[1] = sum_wx / sum_w;
+        fit.initial[2] = 0.5 * spacing;
+        fit.initial[3] = min_y;
+        const double offset_range = std::max((max_y - min_y) * 0.5, std::max(std::abs(min_y) * 2.0, 1e-12));
+        fit.lower[0] = std::max(fit.initial[0] * 0.01, std::abs(min_y) * 0.1);
+        fit.upper[0] = std::max(std::max(max_y * 1.5, fit.initial[0] * 2.0), fit.initial[0] * 100.0);
+        fit.lower[1] = fit.initial[1] - 3.0 * spacing;
+        fit.upper[1] = fit.initial[1] + 3.0 * spacing;
+        fit.lower[2] = std::max(spacing * 0.05, spread * 0.01);
+        fit.upper[2] = std::min(spacing * 3.0, spread * 0.8);
+        fit.lower[3] = fit.initial[3] - offset_range;
+        fit.upper[3] = fit.initial[3] + offset_range;
+        fits.push_back(fit);
+    }
+
+    // Ceres path
+    std::vector<double> ceres_center(fits.size());
+    std::vector<bool> ceres_ok(fits.size());
+    auto start = std::chrono::steady_clock::now();
+    for (size_t f = 0; f < fits.size(); ++f) {
+        double params[4];
+        ceres_ok[f] = SolveCeres(fits[f], params);
+        ceres_center[f] = params[1];
+    }
+    const double ceres_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+    // Mixed-precision path, falling back to Ceres like FitGaussianCeres
+    std::vector<double> mixed_center(fits.size());
+    std::vector<bool> mixed_ok(fits.size());
+    int fallbacks = 0;
+    start = std::chrono::steady_clock::now();
+    for (size_t f = 0; f < fits.size(); ++f) {
+        ResetEventArena();  // One fit per event, as in the simulation
+        MixedPrecisionFitResult result;
+        if (FitGaussian1DMixedPrecision(fits[f].x.data(), fits[f].y.data(), fits[f].x.size(), fits[f].uncertainty,
+                                        fits[f].initial, fits[f].lower, fits[f].upper, result)) {
+            mixed_ok[f] = true;
+            mixed_center[f] = result.params[1];
+        } else {
+            ++fallbacks;
+            double params[4];
+            mixed_ok[f] = SolveCeres(fits[f], params);
+            mixed_center[f] = params[1];
+        }
+    }
+    const double mixed_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+    // Resolution over the fits both paths report as successful
+    double ceres_sum2 = 0.0, mixed_sum2 = 0.0, max_center_diff = 0.0;
+    int compared = 0, ceres_failed = 0, mixed_failed = 0;
+    for (size_t f = 0; f < fits.size(); ++f) {
+        if (!ceres_ok[f]) ++ceres_failed;
+        if (!mixed_ok[f]) ++mixed_failed;
+        if (!ceres_ok[f] || !mixed_ok[f]) continue;
+        ceres_sum2 += std::pow(ceres_center[f] - fits[f].true_x, 2);
+        mixed_sum2 += std::pow(mixed_center[f] - fits[f].true_x, 2);
+        max_center_diff = std::max(max_center_diff, std::abs(mixed_center[f] - ceres_center[f]));
+        ++compared;
+    }
+    const double ceres_rms = std::sqrt(ceres_sum2 / std::max(compared, 1));
+    const double mixed_rms = std::sqrt(mixed_sum2 / std::max(compared, 1));
+    const double um = 1000.0;  // Lengths are in mm
+
+    std::printf("%zu rows (%d pads, %.0f um pitch)\n", fits.size(), gridSize, spacing * um);
+    std::printf("Ceres:           RMS %.3f um, %.2f us per fit, %d failed\n",
+                ceres_rms * um, ceres_us / fits.size(), ceres_failed);
+    std::printf("Mixed precision: RMS %.3f um, %.2f us per fit, %d failed, %d fell back to Ceres\n",
+                mixed_rms * um, mixed_us / fits.size(), mixed_failed, fallbacks);
+    std::printf("Max center difference %.4f um, speedup %.2fx\n", max_center_diff * um, ceres_us / mixed_us);
+
+    if (compared == 0 || !(std::abs(mixed_rms - ceres_rms) <= kResolutionTolerance * ceres_rms)) {
+        std::printf("FAILED: mixed-precision resolution differs from Ceres\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,109 @@
+// Compile-time radius specialization of the neighborhood kernel against its runtime grid size.
+// Random hits inside the default detector are evaluated by both paths for every specialized radius
+// (4 to 10): the outputs must agree, and the time per call of each path is printed. Timing is
+// reported only, never asserted, so the test stays stable on loaded machines.
+
+#include "NeighborhoodKernel.hh"
+#include "Constants.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+
+struct Hit {
+    G4double x, y;
+    G4int i, j;
+};
+
+// Best of several repetitions, in ns per kernel call
+template <typename Kernel>
+double TimePerCall(const std::vector<Hit>& hits, Kernel kernel)
+{
+    const int kRepetitions = 5;
+    double best = 0.0;
+    for (int rep = 0; rep < kRepetitions; ++rep) {
+        const auto start = std::chrono::steady_clock::now();
+        for (const Hit& hit : hits) {
+            kernel(hit);
+        }
+        const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        best = (rep == 0) ? ns : std::min(best, ns);
+    }
+    return best / hits.size();
+}
+
+} // namespace
+
+int main()
+{
+    NeighborhoodKernelGeometry geometry;
+    geometry.pixelSize = Constants::DEFAULT_PIXEL_SIZE;
+    geometry.pixelSpacing = Constants::DEFAULT_PIXEL_SPACING;
+    geometry.pixelCornerOffset = Constants::DEFAULT_PIXEL_CORNER_OFFSET;
+    geometry.detSize = Constants::DEFAULT_DETECTOR_SIZE;
+    geometry.numBlocksPerSide = static_cast<G4int>(std::round(
+        (geometry.detSize - 2 * geometry.pixelCornerOffset - geometry.pixelSize) / geometry.pixelSpacing + 1));
+    geometry.d0 = Constants::D0_CHARGE_SHARING * micrometer;
+    geometry.tableRadius = Constants::MAX_AUTO_RADIUS;
+
+    // Hits uniform over the detector, with their nearest pixel as the grid center
+    const G4double firstPixelPos = -geometry.detSize / 2 + geometry.pixelCornerOffset + geometry.pixelSize / 2;
+    std::mt19937_64 rng(20260417);
+    std::uniform_real_distribution<G4double> position(-geometry.detSize / 2, geometry.detSize / 2);
+    std::vector<Hit> hits(20000);
+    for (Hit& hit : hits) {
+        hit.x = position(rng);
+        hit.y = position(rng);
+        hit.i = std::clamp(static_cast<G4int>(std::lround((hit.x - firstPixelPos) / geometry.pixelSpacing)),
+                           0, geometry.numBlocksPerSide - 1);
+        hit.j = std::clamp(static_cast<G4int>(std::lround((hit.y - firstPixelPos) / geometry.pixelSpacing)),
+                           0, geometry.numBlocksPerSide - 1);
+    }
+
+    NeighborhoodKernel kernel;
+    int failures = 0;
+    std::printf("%6s %14s %14s %9s\n", "Radius", "Fixed [ns]", "Runtime [ns]", "Speedup");
+    for (G4int radius = 4; radius <= 10; ++radius) {
+        const size_t numPixels = static_cast<size_t>(2 * radius + 1) * (2 * radius + 1);
+        std::vector<G4double> distances(numPixels), alphas(numPixels), weights(numPixels);
+        std::vector<G4double> refDistances(numPixels), refAlphas(numPixels), refWeights(numPixels);
+
+        // Same inputs through both paths; the loops differ only in trip-count knowledge
+        for (const Hit& hit : hits) {
+            kernel.Compute(geometry, hit.x, hit.y, hit.i, hit.j, radius,
+                           distances.data(), alphas.data(), weights.data());
+            kernel.ComputeRuntime(geometry, hit.x, hit.y, hit.i, hit.j, radius,
+                                  refDistances.data(), refAlphas.data(), refWeights.data());
+            for (size_t k = 0; k < numPixels; ++k) {
+                const G4double tolerance = 1e-12 * std::max(1.0, std::abs(refWeights[k]));
+                if (std::abs(distances[k] - refDistances[k]) > 1e-12 ||
+                    std::abs(alphas[k] - refAlphas[k]) > 1e-12 ||
+                    std::abs(weights[k] - refWeights[k]) > tolerance) {
+                    ++failures;
+                }
+            }
+        }
+
+        const double fixedNs = TimePerCall(hits, [&](const Hit& hit) {
+            kernel.Compute(geometry, hit.x, hit.y, hit.i, hit.j, radius,
+                           distances.data(), alphas.data(), weights.data());
+        });
+        const double runtimeNs = TimePerCall(hits, [&](const Hit& hit) {
+            kernel.ComputeRuntime(geometry, hit.x, hit.y, hit.i, hit.j, radius,
+                                  distances.data(), alphas.data(), weights.data());
+        });
+        std::printf("%6d %14.1f %14.1f %8.2fx\n", radius, fixedNs, runtimeNs, runtimeNs / fixedNs);
+    }
+
+    if (failures > 0) {
+        std::printf("FAILED: %d grid values differ between the fixed and runtime kernels\n", failures);
+        return 1;
+    }
+    std::printf("Fixed and runtime kernels agree on %zu hits per radius\n", hits.size());
+    return 0;
+}